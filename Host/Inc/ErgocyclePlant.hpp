@@ -0,0 +1,112 @@
+/*
+ * ErgocyclePlant.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #pragma once
+
+ #include <cstdint>
+
+ #include "VescEmulator.hpp"
+
+ /**
+  * @brief Paramètres mécaniques et électriques de l'ergocycle, vus du VESC.
+  *
+  * Valeurs par défaut tirées du banc : 1.95 A → 0.39 Nm au moteur → 15 Nm au pédalier.
+  */
+ struct ErgocycleParams {
+     // Moteur
+     float torqueConstant;       // Nm/A (= Ke en V·s/rad)
+     float resistance;           // Ω phase
+     float currentTimeConstant;  // s, boucle de courant du VESC (premier ordre)
+     float polePairs;
+     float rotorInertia;         // kg·m² côté moteur
+     float currentLimit;         // A
+     float batteryVoltage;       // V
+     float speedKp;              // A par rad/s moteur : PI de vitesse du mode RPM
+     float speedKi;              // A par rad
+
+     // Transmission
+     float reductionRatio;       // tours moteur par tour de pédalier
+     float gearEfficiency;       // 0..1, appliqué dans le sens de la puissance
+
+     // Pédalier
+     float flywheelInertia;      // kg·m² côté pédalier (volant + manivelles)
+     float bearingCoulomb;       // Nm côté pédalier
+     float bearingViscous;       // Nm·s/rad côté pédalier
+
+     float ambientTemp;          // °C
+     float maxStepSeconds;       // pas d'intégration interne maximal
+ };
+
+ ErgocycleParams defaultErgocycleParams();
+
+ /**
+  * @brief Cycliste paramétrique : couple moyen modulé sur l'angle du pédalier.
+  *
+  * Deux jambes → harmonique 2 dominante : τ(θ) = τmoyen·(1 + modulation·cos(2(θ − phase))).
+  */
+ struct RiderProfile {
+     enum Mode {
+         PASSIVE,         // pieds sur les pédales, aucun effort
+         PEDAL,           // pousse (concentrique), τmoyen ajusté pour tenir targetCadence, retient au-delà
+         RESIST           // freine le pédalier entraîné par le moteur (excentrique)
+     } mode;
+     float meanTorque;    // Nm pédalier, effort de base
+     float modulation;    // 0..1
+     float phaseRad;
+     float targetCadence; // tr/min (PEDAL)
+     float cadenceGain;   // Nm par tr/min d'écart (PEDAL)
+     float maxTorque;     // Nm, force maximale du cycliste
+ };
+
+ RiderProfile defaultRiderProfile();
+
+ /**
+  * @brief Modèle physique complet derrière VescEmulator : moteur, réducteur, volant, paliers, cycliste.
+  *
+  * Intégration d'Euler semi-implicite à pas fixe (maxStepSeconds) : plusieurs ordres de grandeur
+  * plus rapide que le temps réel, pour évaluer les modes de MotorController sur des milliers de sorties.
+  */
+ class ErgocyclePlant : public VescPlant {
+ public:
+     explicit ErgocyclePlant(const ErgocycleParams& params = defaultErgocycleParams(),
+                             const RiderProfile& rider = defaultRiderProfile());
+
+     void step(const VescCommand& command, float dt) override;
+     VescPlantState getState() const override { return state; }
+
+     void setRider(const RiderProfile& profile) { rider = profile; }
+     const RiderProfile& getRider() const { return rider; }
+     const ErgocycleParams& getParams() const { return params; }
+     void reset();
+
+     // Grandeurs côté pédalier (référence pour les métriques de simulation)
+     float getCrankAngle() const { return crankAngle; }        // rad, 0..2π
+     float getCrankOmega() const { return crankOmega; }        // rad/s
+     float getCadence() const;                                 // tr/min
+     float getRiderTorque() const { return riderTorque; }      // Nm
+     float getMotorTorqueAtCrank() const { return motorTorqueAtCrank; }
+     float getRiderPower() const { return riderTorque * crankOmega; }
+     float getMotorPowerAtCrank() const { return motorTorqueAtCrank * crankOmega; }
+     double getTime() const { return time; }                   // s simulées
+
+ private:
+     ErgocycleParams params;
+     RiderProfile rider;
+     VescPlantState state;
+
+     float crankAngle;
+     float crankOmega;
+     float current;          // courant moteur réel (A)
+     float speedIntegral;    // intégrale du PI de vitesse (A)
+     float riderTorque;
+     float motorTorqueAtCrank;
+     double time;
+
+     void substep(const VescCommand& command, float dt);
+     float currentTarget(const VescCommand& command, float motorOmega, float dt);
+     float computeRiderTorque() const;
+ };
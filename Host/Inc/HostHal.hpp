@@ -0,0 +1,79 @@
+/*
+ * HostHal.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #pragma once
+
+ #include <cstdint>
+
+ #include "stm32f4xx_hal.h"
+
+ /**
+  * @brief Extrémité d'un lien UART côté PC : port série, pseudo-terminal ou émulateur en mémoire.
+  */
+ class HostUartDevice {
+ public:
+     virtual ~HostUartDevice() {}
+
+     // Envoie tous les octets (faux si le lien est fermé)
+     virtual bool write(const uint8_t* data, uint16_t len) = 0;
+
+     // Lit au plus len octets en attendant au plus timeoutMs ; renvoie le nombre d'octets lus.
+     // En horloge simulée, un émulateur peut avancer le temps (hostClockAdvance) pour modéliser sa latence.
+     virtual uint16_t read(uint8_t* data, uint16_t len, uint32_t timeoutMs) = 0;
+ };
+
+ /**
+  * @brief Descripteur POSIX en mode brut : port série termios (VESC en USB-série...) ou maître de pty.
+  */
+ class FdUartDevice : public HostUartDevice {
+ public:
+     FdUartDevice();
+     ~FdUartDevice() override;
+
+     bool openSerial(const char* path, uint32_t baudRate);
+     bool openPty();                                // l'autre extrémité est getPtyName()
+     void close();
+
+     bool isOpen() const { return fd >= 0; }
+     const char* getPtyName() const { return ptyName; }
+
+     bool write(const uint8_t* data, uint16_t len) override;
+     uint16_t read(uint8_t* data, uint16_t len, uint32_t timeoutMs) override;
+
+ private:
+     int fd;
+     char ptyName[64];
+
+     bool makeRaw(uint32_t baudRate);
+ };
+
+ // Branche un handle HAL (huart2, huart3...) sur une extrémité
+ void hostAttachUart(UART_HandleTypeDef* huart, HostUartDevice* device, const char* name);
+
+ // --- Horloge ---
+ enum class HostClockMode {
+     REALTIME,   // CLOCK_MONOTONIC, HAL_Delay dort vraiment
+     SIMULATED   // HAL_Delay avance un compteur : plus rapide que le temps réel
+ };
+
+ // L'état de l'horloge est propre à chaque thread : plusieurs simulations peuvent tourner en parallèle
+ void hostClockSetMode(HostClockMode mode);
+ HostClockMode hostClockGetMode();
+ void hostClockAdvance(uint32_t ms);
+ void hostClockAdvanceMicros(uint64_t us);
+ uint64_t hostClockMicros();
+
+ // Appelé à chaque HAL_Delay en horloge simulée (ex. faire avancer un modèle physique)
+ typedef void (*HostDelayHook)(uint32_t ms, void* context);
+ void hostClockSetDelayHook(HostDelayHook hook, void* context);
+
+ // --- IWDG ---
+ // Appelé quand le délai du chien de garde est dépassé ; par défaut : message puis abort() ("reset")
+ typedef void (*HostWatchdogHandler)(uint32_t overdueMs, void* context);
+ void hostIwdgSetHandler(HostWatchdogHandler handler, void* context);
+ uint32_t hostIwdgTimeoutMs();
+ uint32_t hostIwdgWorstMarginMs();  // plus petite marge observée avant expiration
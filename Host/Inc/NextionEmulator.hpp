@@ -0,0 +1,128 @@
+/*
+ * NextionEmulator.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #pragma once
+
+ #include <cstdint>
+ #include <cstdio>
+ #include <deque>
+ #include <map>
+ #include <string>
+ #include <vector>
+
+ #include "HostHal.hpp"
+
+ // Codes de retour Nextion (bkcmd = 2 : seules les erreurs sont renvoyées)
+ #define NEX_RET_INVALID_INSTRUCTION  0x00
+ #define NEX_RET_INVALID_VARIABLE     0x1A
+ #define NEX_RET_STRING_DATA          0x70
+ #define NEX_RET_NUMERIC_DATA         0x71
+
+ struct NextionComponent {
+     std::string txt;
+     int32_t val;
+     uint32_t txtWrites;
+     uint32_t valWrites;
+     uint64_t lastWriteUs;    // fin de réception de la dernière commande d'affichage
+     bool pending;            // saisie utilisateur pas encore relue par le firmware
+     uint64_t pendingSinceUs;
+ };
+
+ // Saisie scriptée : à t = atMs, l'utilisateur met "component".val à value (bouton, curseur, pavé...)
+ struct NextionTouchEvent {
+     uint32_t atMs;
+     std::string component;
+     int32_t value;
+ };
+
+ struct NextionLinkConfig {
+     uint32_t baudRate;          // 10 bits par octet dans les deux sens (0 = instantané)
+     uint32_t commandLatencyUs;  // traitement d'une commande avant la réponse
+     bool reportErrors;          // bkcmd = 2 : 0x1A / 0x00 renvoyés sur le fil
+ };
+
+ NextionLinkConfig defaultNextionLinkConfig();
+
+ struct NextionEmulatorStats {
+     uint32_t commands;
+     uint32_t txtWrites;
+     uint32_t valWrites;
+     uint32_t getRequests;
+     uint32_t unknownComponents;
+     uint32_t invalidCommands;
+     uint32_t bytesReceived;      // firmware → écran
+     uint32_t bytesSent;          // écran → firmware
+     uint64_t uplinkBusyUs;       // temps de fil occupé firmware → écran
+     uint64_t downlinkBusyUs;     // temps de fil occupé écran → firmware
+     uint32_t touchEvents;
+     uint32_t inputLatencyCount;  // saisies relues par un "get"
+     uint64_t inputLatencySumUs;  // saisie → fin de la réponse au "get" qui la relit
+     uint64_t inputLatencyMaxUs;
+ };
+
+ /**
+  * @brief Écran Nextion émulé octet par octet : on le branche sur huart2 à la place de l'écran.
+  *
+  * Modèle de composants (attributs txt/val), réponses 0x71/0x70 aux "get", codes d'erreur,
+  * saisies scriptées et temps de fil au débit configuré. Un HAL_UART_Transmit vers l'écran
+  * bloque pendant le temps de fil, comme le HAL en mode polling sur la cible : on mesure
+  * donc le vrai coût de updateScreen()/updateFromScreen() et l'occupation de la liaison.
+  */
+ class NextionEmulator : public HostUartDevice {
+ public:
+     explicit NextionEmulator(const NextionLinkConfig& link = defaultNextionLinkConfig());
+
+     bool write(const uint8_t* data, uint16_t len) override;
+     uint16_t read(uint8_t* data, uint16_t len, uint32_t timeoutMs) override;
+
+     void setLinkConfig(const NextionLinkConfig& cfg) { link = cfg; }
+
+     // Un composant non défini renvoie 0x1A, comme un nom absent de la page HMI
+     void defineComponent(const char* name, int32_t val = 0, const char* txt = "");
+     void defineErgocyclePage();  // tous les composants lus ou écrits par ScreenDisplay
+     const NextionComponent* getComponent(const char* name) const;
+
+     // atMs est dans la base de temps de HAL_GetTick()
+     void scheduleTouch(uint32_t atMs, const char* component, int32_t value);
+     bool loadScript(const char* path);  // lignes "t_ms composant valeur", '#' = commentaire
+
+     void advanceTo(uint64_t nowUs);  // applique les saisies scriptées échues
+
+     const NextionEmulatorStats& getStats() const { return stats; }
+     float getUplinkUtilisation() const;
+     float getDownlinkUtilisation() const;
+     void printReport(FILE* out) const;
+
+ private:
+     struct PendingByte {
+         uint64_t readyUs;
+         uint8_t value;
+     };
+
+     NextionLinkConfig link;
+     NextionEmulatorStats stats;
+     std::map<std::string, NextionComponent> components;
+     std::vector<NextionTouchEvent> script;
+     size_t nextEvent;
+
+     uint64_t startUs;
+     uint64_t lastUs;
+     bool started;
+
+     std::string command;    // commande en cours de réception
+     uint8_t terminatorCount;
+     std::deque<PendingByte> txQueue;
+     uint64_t lineFreeUs;
+
+     uint64_t byteTimeUs() const;
+     void handleCommand(const std::string& cmd, uint64_t receivedUs);
+     void handleGet(const std::string& target, uint64_t receivedUs);
+     void handleAssign(const std::string& lhs, const std::string& rhs, uint64_t receivedUs);
+     NextionComponent* findComponent(const std::string& name, uint64_t receivedUs);
+     uint64_t sendReply(const uint8_t* payload, uint16_t len, uint64_t receivedUs);  // renvoie la fin d'émission
+     void sendCode(uint8_t code, uint64_t receivedUs);
+ };
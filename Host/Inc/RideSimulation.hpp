@@ -0,0 +1,83 @@
+/*
+ * RideSimulation.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #pragma once
+
+ #include <cstddef>
+ #include <cstdint>
+
+ #include "ControlTypes.hpp"
+ #include "ErgocyclePlant.hpp"
+
+ /**
+  * @brief Une sortie simulée : réglages du contrôleur, écran, cycliste et durée.
+  *
+  * Les consignes passent par l'écran émulé comme sur la cible (composants mode, cad, tor,
+  * pow, gain, ramp), le contrôleur ne voit que ses UART.
+  */
+ struct RideSpec {
+     ControlMode mode;
+     float instruction;       // tr/min, Nm ou W selon le mode (ignoré en LINEAR)
+     float rampRate;          // A/s
+     float linearGain;        // Nm par tr/min (LINEAR)
+     float cadenceAlpha;      // tracker alpha-beta de la cadence
+     float cadenceBeta;
+     float currentCutoffHz;   // biquad du courant
+     uint32_t screenBaud;     // USART2 de l'écran (TARGET_SCREEN_BAUD par défaut)
+     RiderProfile rider;
+     float riderVariation;    // dispersion relative (tirée de seed) sur l'effort et la cadence du cycliste
+     float durationS;
+     float settleS;           // début de sortie exclu des métriques
+     uint32_t loopPeriodMs;   // HAL_Delay de la boucle principale (100 ms dans mainV1.cpp)
+
+     // Perturbations (robustesse) : Kt faux, télémétrie bruitée, trames perdues, liaison lente
+     float ktError;           // erreur relative du Kt utilisé par le contrôleur (0.1 = +10 %)
+     float cadenceNoiseRpm;   // écart-type du bruit ajouté à la cadence renvoyée par le VESC
+     float frameLossRate;     // probabilité de perdre une réponse COMM_GET_VALUES entière
+     uint32_t latencyUs;      // latence du VESC avant réponse
+     uint32_t jitterUs;
+
+     uint64_t seed;
+ };
+
+ // Débit de l'écran sur la cible (MX_USART2_UART_Init) : point de fonctionnement par défaut des sorties
+ static const uint32_t TARGET_SCREEN_BAUD = 9600;
+
+ // Consigne par défaut d'un mode, dans le domaine linéaire du modèle par défaut
+ float defaultRideInstruction(ControlMode mode);
+ RideSpec defaultRideSpec();
+
+ struct RideMetrics {
+     float trackingErrorRms;   // erreur de suivi dans l'unité du mode (tr/min, Nm ou W)
+     float powerErrorRms;      // W, puissance moteur au pédalier vs puissance visée (0 en mode cadence)
+     float torqueRms;          // Nm, couple moteur au pédalier
+     float meanCadence;        // tr/min
+     float meanRiderPower;     // W
+     float saturatedFraction;  // part du temps en limite de courant ou de tension
+     uint32_t limitHits;       // entrées en limite
+     uint32_t safetyTrips;
+     uint32_t watchdogResets;
+     uint32_t ticks;           // boucles de commande exécutées
+     float maxLoopMs;
+ };
+
+ // Colonnes exportées (CSV des outils de balayage et d'analyse)
+ struct RideMetricField {
+     const char* name;
+     float (*get)(const RideMetrics& m);
+ };
+
+ extern const RideMetricField rideMetricFields[];
+ extern const size_t rideMetricFieldCount;
+
+ // Au-delà, la sortie a surtout mesuré les limites du moteur (courant, tension) et non la loi de commande :
+ // les outils d'analyse la comptent à part au lieu de la mêler aux bandes d'erreur de suivi
+ static const float SATURATED_RIDE_FRACTION = 0.05f;
+ bool isSaturatedRide(const RideMetrics& m);
+
+ // Exécute la sortie dans le thread appelant (horloge simulée propre au thread)
+ RideMetrics runRide(const RideSpec& spec);
@@ -0,0 +1,69 @@
+/*
+ * SweepSpec.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #pragma once
+
+ #include <cstddef>
+ #include <cstdint>
+ #include <string>
+ #include <vector>
+
+ #include "RideSimulation.hpp"
+
+ /**
+  * @brief Grille de balayage lue dans un fichier texte :
+  *
+  *   # commentaire
+  *   mode        = power_concentric, linear
+  *   instruction = 20:80:20         # début:fin:pas, bornes incluses
+  *   ramp        = 3, 6
+  *   repeats     = 4                # sorties par combinaison (graines différentes)
+  *   seed        = 1
+  *   kt_error    ~ normal(0, 0.1)   # perturbation tirée à chaque sortie
+  *   dropout     ~ uniform(0, 0.05)
+  *
+  * Paramètres : mode, instruction, ramp, gain, alpha, beta, cutoff, screen_baud, rider,
+  * rider_torque, rider_cadence, rider_variation, duration, settle, loop_ms, kt_error,
+  * cadence_noise, dropout, latency_ms, jitter_ms.
+  * "=" définit un axe de la grille, "~" une loi : uniform(a, b), normal(moyenne, écart-type).
+  * Sans axe "instruction", la consigne suit le mode (defaultRideInstruction).
+  * screen_baud n'accepte que "=" : un axe sans TARGET_SCREEN_BAUD le reçoit en plus, pour que les
+  * résultats au débit de la cible figurent toujours à côté de ceux d'un autre débit.
+  */
+ struct SweepAxis {
+     std::string name;
+     std::vector<std::string> values;
+ };
+
+ struct SweepDistribution {
+     std::string name;
+     enum Kind { UNIFORM, NORMAL } kind;
+     float a, b;  // bornes (UNIFORM) ou moyenne / écart-type (NORMAL)
+ };
+
+ struct SweepSpec {
+     std::vector<SweepAxis> axes;
+     std::vector<SweepDistribution> perturbations;
+     uint32_t repeats;
+     uint64_t seed;
+
+     size_t combinationCount() const;
+     size_t runCount() const { return combinationCount() * repeats; }
+ };
+
+ bool parseSweepSpec(const char* path, SweepSpec& spec, std::string& error);
+
+ // Faux si le nom ou la valeur est invalide
+ bool applySweepParam(RideSpec& ride, const std::string& name, const std::string& value);
+
+ // Sortie n° run : combinaison = run / repeats, répétition = run % repeats ; perturbations tirées de sa graine
+ // (valeurs tirées recopiées dans sampled, dans l'ordre de spec.perturbations, si fourni)
+ RideSpec sweepRideSpec(const SweepSpec& spec, size_t run, std::vector<float>* sampled = nullptr);
+ const std::string& sweepAxisValue(const SweepSpec& spec, size_t combination, size_t axis);
+
+ // Graine d'une sortie : ne dépend que de la graine de base et du numéro de sortie (pas de l'ordonnancement)
+ uint64_t sweepRunSeed(uint64_t baseSeed, size_t run);
@@ -0,0 +1,79 @@
+/*
+ * TelemetryLog.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #pragma once
+
+ #include <cstddef>
+ #include <cstdint>
+ #include <string>
+ #include <vector>
+
+ #include "SessionLogger.hpp"
+
+ /**
+  * @brief Lecture PC des journaux ERGO.LOG (SessionLogger) en colonnes, pour l'analyse.
+  *
+  * Une voie = un tableau contigu (structure de tableaux) : les outils d'analyse parcourent une
+  * voie à la fois, sans charger les autres. Les blocs sont indépendants (image clé en tête) :
+  * ils sont indexés une première fois, puis décodés en parallèle directement à leur place finale.
+  */
+
+ struct TelemetryColumns {
+     std::vector<uint32_t> sessionId;
+     std::vector<uint32_t> tickMs;
+     std::vector<float> setpoint;
+     std::vector<float> cadence;
+     std::vector<float> current;
+     std::vector<float> appliedCurrent;
+     std::vector<float> dutyCycle;
+     std::vector<float> inputVoltage;
+     std::vector<uint8_t> mode;
+     std::vector<uint8_t> flags;
+     std::vector<uint8_t> faults;
+
+     size_t size() const { return tickMs.size(); }
+     void resize(size_t n);
+ };
+
+ struct TelemetryLogSession {
+     uint32_t sessionId;
+     size_t firstSample;   // indice dans TelemetryColumns
+     size_t sampleCount;
+     uint32_t lostSamples;
+     uint32_t blocks;
+     bool hasSummary;         // bilan du dernier bloc lisible qui en porte un (SessionLogger::attachAnalytics)
+     SessionSummary summary;
+ };
+
+ struct TelemetryLogStats {
+     uint64_t fileBytes;
+     uint64_t payloadBytes;   // octets utiles (hors en-têtes et remplissage)
+     uint32_t blocks;
+     uint32_t invalidBlocks;  // CRC faux, bloc tronqué ou remplissage de recalage
+     uint32_t rawBlocks;
+     uint32_t deltaBlocks;
+     uint32_t decodeErrors;   // blocs valides dont le contenu ne se décode pas
+     std::vector<TelemetryLogSession> sessions;
+ };
+
+ struct TelemetryLogOptions {
+     unsigned threads = 0;        // 0 = tous les cœurs
+     bool checkCrc = true;
+     bool filterSession = false;
+     uint32_t session = 0;
+ };
+
+ // Décode un journal déjà en mémoire ; false si des blocs ont été écartés (détail dans stats)
+ bool decodeTelemetryLog(const uint8_t* data, size_t size, const TelemetryLogOptions& options,
+                         TelemetryColumns& out, TelemetryLogStats& stats);
+
+ // Projette le fichier en mémoire (mmap) puis le décode ; false seulement si le fichier est illisible
+ bool loadTelemetryLog(const char* path, const TelemetryLogOptions& options,
+                       TelemetryColumns& out, TelemetryLogStats& stats, std::string& error);
+
+ // CRC32 IEEE par tranches de 8 octets : même résultat que SettingsStore::crc32, ~10x plus rapide
+ uint32_t telemetryLogCrc32(const uint8_t* data, size_t len, uint32_t crc = 0xFFFFFFFFu);
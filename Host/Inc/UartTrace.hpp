@@ -0,0 +1,143 @@
+/*
+ * UartTrace.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #pragma once
+
+ #include <cstdint>
+ #include <cstdio>
+ #include <deque>
+ #include <string>
+ #include <vector>
+
+ #include "HostHal.hpp"
+
+ /**
+  * @brief Trace binaire compacte des liaisons UART (huart2, huart3...) : chaque salve d'octets
+  * écrite ou lue par le firmware, horodatée à la microseconde.
+  *
+  * Format (petit-boutiste, entiers variables LEB128) :
+  *   "ERGT" | version (1) | nombre de liaisons | pour chacune : longueur, nom
+  *   puis des enregistrements : en-tête | Δt µs (varint) | longueur (varint) | octets
+  *   en-tête : bits 7-6 = type (0 données, 1 bloc annexe), bit 5 = sens (1 = reçu), bits 3-0 = liaison
+  *
+  * Le bloc annexe sert à embarquer l'image des réglages flash au démarrage : une trace rejouée
+  * repart exactement du même état (Kt calibré ou non, mode, rampe...).
+  */
+
+ enum class TraceDirection : uint8_t {
+     TX = 0,  // firmware → périphérique
+     RX = 1   // périphérique → firmware
+ };
+
+ struct TraceRecord {
+     uint64_t timeUs;
+     uint8_t link;
+     TraceDirection direction;
+     std::vector<uint8_t> data;
+ };
+
+ class TraceWriter {
+ public:
+     TraceWriter();
+     ~TraceWriter();
+
+     // Les liaisons doivent toutes être déclarées avant open()
+     uint8_t addLink(const char* name);
+     bool open(const char* path);
+     void close();
+     bool isOpen() const { return file != nullptr; }
+
+     void writeBlob(const uint8_t* data, uint32_t len);
+     void record(uint8_t link, TraceDirection direction, uint64_t timeUs, const uint8_t* data, uint16_t len);
+
+     uint64_t getBytesWritten() const { return bytesWritten; }
+
+ private:
+     FILE* file;
+     std::vector<std::string> links;
+     uint64_t lastTimeUs;
+     uint64_t bytesWritten;
+
+     void put(uint8_t byte);
+     void putVarint(uint64_t value);
+ };
+
+ class TraceReader {
+ public:
+     bool load(const char* path, std::string& error);
+
+     const std::vector<std::string>& getLinks() const { return links; }
+     int findLink(const char* name) const;  // -1 si absente
+     const std::vector<TraceRecord>& getRecords() const { return records; }
+     const std::vector<uint8_t>& getBlob() const { return blob; }
+     uint64_t getEndUs() const { return records.empty() ? 0 : records.back().timeUs; }
+
+ private:
+     std::vector<std::string> links;
+     std::vector<TraceRecord> records;
+     std::vector<uint8_t> blob;
+ };
+
+ /**
+  * @brief Enregistre tout ce qui passe par une extrémité existante (port série, pty, émulateur).
+  */
+ class RecordingUartDevice : public HostUartDevice {
+ public:
+     RecordingUartDevice(HostUartDevice& inner, TraceWriter& writer, uint8_t link);
+
+     bool write(const uint8_t* data, uint16_t len) override;
+     uint16_t read(uint8_t* data, uint16_t len, uint32_t timeoutMs) override;
+
+ private:
+     HostUartDevice& inner;
+     TraceWriter& writer;
+     uint8_t link;
+ };
+
+ struct ReplayDivergence {
+     bool diverged;
+     uint64_t timeUs;      // instant du premier écart
+     uint64_t offset;      // rang de l'octet dans le flux émis par le firmware
+     int expected;         // -1 : la trace était déjà épuisée
+     int actual;
+ };
+
+ /**
+  * @brief Rejoue une liaison : les octets reçus sont servis aux instants enregistrés, les octets
+  * émis par le firmware sont comparés à la trace (sortie de référence).
+  *
+  * Horloge simulée : aussi vite que possible, mêmes instants relatifs. Horloge réelle : timing d'origine.
+  */
+ class ReplayUartDevice : public HostUartDevice {
+ public:
+     ReplayUartDevice(const TraceReader& trace, uint8_t link);
+
+     bool write(const uint8_t* data, uint16_t len) override;
+     uint16_t read(uint8_t* data, uint16_t len, uint32_t timeoutMs) override;
+
+     bool isExhausted() const { return rxQueue.empty() && txOffset == expectedTx.size(); }
+     uint64_t getComparedBytes() const { return comparedBytes; }
+     uint64_t getMismatches() const { return mismatches; }
+     uint64_t getMissingTx() const { return expectedTx.size() - txOffset; }  // émissions attendues jamais faites
+     const ReplayDivergence& getDivergence() const { return divergence; }
+
+ private:
+     struct TimedByte {
+         uint64_t timeUs;
+         uint8_t value;
+     };
+
+     std::deque<TimedByte> rxQueue;
+     std::vector<uint8_t> expectedTx;
+     std::vector<uint64_t> txDoneUs;  // fin d'émission enregistrée, par octet
+     size_t txOffset;
+     uint64_t comparedBytes;
+     uint64_t mismatches;
+     ReplayDivergence divergence;
+
+     void waitUntil(uint64_t timeUs);
+ };
@@ -0,0 +1,150 @@
+/*
+ * VescEmulator.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #pragma once
+
+ #include <cstdint>
+ #include <deque>
+ #include <random>
+
+ #include "HostHal.hpp"
+
+ /**
+  * @brief Commande en cours côté VESC (dernier COMM_SET_CURRENT ou COMM_SET_RPM reçu).
+  */
+ struct VescCommand {
+     enum Mode { CURRENT, RPM } mode;
+     float current;  // A
+     float erpm;
+ };
+
+ struct VescPlantState {
+     float erpm;
+     float motorCurrent;  // A
+     float inputCurrent;  // A (batterie)
+     float dutyCycle;     // -1.0 .. 1.0
+     float inputVoltage;  // V
+     float tempFet;       // °C
+     float tempMotor;     // °C
+ };
+
+ /**
+  * @brief Modèle physique derrière l'émulateur (moteur seul, ergocycle complet...).
+  */
+ class VescPlant {
+ public:
+     virtual ~VescPlant() {}
+     virtual void step(const VescCommand& command, float dt) = 0;
+     virtual VescPlantState getState() const = 0;
+ };
+
+ struct SimpleMotorParams {
+     float torqueConstant;  // Nm/A (= Ke en V·s/rad)
+     float polePairs;
+     float resistance;      // Ω phase
+     float inertia;         // kg·m² ramenée au moteur
+     float viscous;         // Nm·s/rad
+     float coulomb;         // Nm
+     float batteryVoltage;  // V
+     float currentLimit;    // A
+     float speedKp;         // A par rad/s : boucle de vitesse du mode RPM
+     float ambientTemp;     // °C
+ };
+
+ SimpleMotorParams defaultSimpleMotorParams();
+
+ // Moteur PM sur une inertie avec frottements ; le mode RPM est régulé par un P borné en courant
+ class SimpleMotorPlant : public VescPlant {
+ public:
+     explicit SimpleMotorPlant(const SimpleMotorParams& params = defaultSimpleMotorParams());
+
+     void step(const VescCommand& command, float dt) override;
+     VescPlantState getState() const override { return state; }
+
+     float getOmega() const { return omega; }
+
+ private:
+     SimpleMotorParams params;
+     VescPlantState state;
+     float omega;  // rad/s mécaniques
+ };
+
+ // Défauts de liaison injectables (latence, gigue, pertes, corruption, débit)
+ struct VescLinkConfig {
+     uint32_t latencyUs;       // délai de traitement avant la réponse
+     uint32_t jitterUs;        // ajout aléatoire uniforme 0..jitterUs
+     uint32_t baudRate;        // temps sur le fil, 10 bits par octet (0 = instantané)
+     float byteLossRate;       // probabilité de perdre un octet de la réponse
+     float byteCorruptRate;    // probabilité d'inverser un bit d'un octet de la réponse
+     float frameLossRate;      // probabilité de ne pas répondre du tout (trame perdue)
+     uint32_t seed;
+ };
+
+ VescLinkConfig defaultVescLinkConfig();
+
+ struct VescEmulatorStats {
+     uint32_t framesReceived;
+     uint32_t crcErrors;
+     uint32_t framingErrors;
+     uint32_t unknownCommands;
+     uint32_t unexpectedCommands;  // identifiant VESC valide mais pas attendu (SET_DUTY, SET_CURRENT_BRAKE)
+     uint32_t repliesSent;
+     uint32_t repliesDropped;
+     uint32_t bytesDropped;
+     uint32_t bytesCorrupted;
+ };
+
+ /**
+  * @brief VESC émulé octet par octet : on le branche sur huart3 à la place du vrai contrôleur.
+  *
+  * Décode les trames courtes (0x02, len, payload, CRC16, 0x03) de VESCInterface, exécute
+  * COMM_SET_CURRENT / COMM_SET_RPM / COMM_GET_VALUES et répond au format du firmware VESC
+  * (entiers big-endian en virgule fixe, trame complète jusqu'au code de défaut). Le modèle physique
+  * avance avec l'horloge de HostHal.
+  */
+ class VescEmulator : public HostUartDevice {
+ public:
+     VescEmulator(VescPlant& plant, const VescLinkConfig& link = defaultVescLinkConfig());
+
+     bool write(const uint8_t* data, uint16_t len) override;
+     uint16_t read(uint8_t* data, uint16_t len, uint32_t timeoutMs) override;
+
+     void setLinkConfig(const VescLinkConfig& link);
+     void advanceTo(uint64_t nowUs);  // fait avancer le modèle jusqu'à l'instant donné
+
+     const VescCommand& getCommand() const { return command; }
+     const VescEmulatorStats& getStats() const { return stats; }
+     VescPlant& getPlant() { return plant; }
+
+     static uint16_t crc16(const uint8_t* data, uint16_t len);
+
+ private:
+     static const uint32_t PLANT_STEP_US = 1000;  // pas fixe de 1 ms
+
+     struct PendingByte {
+         uint64_t readyUs;  // instant où l'octet est disponible sur le fil
+         uint8_t value;
+     };
+
+     VescPlant& plant;
+     VescLinkConfig link;
+     VescCommand command;
+     VescEmulatorStats stats;
+     uint64_t plantTimeUs;
+     bool started;
+
+     uint8_t frame[260];
+     uint16_t frameLen;
+     std::deque<PendingByte> txQueue;
+     uint64_t lineFreeUs;  // fin d'émission du dernier octet en file
+     std::mt19937 rng;
+
+     void handleByte(uint8_t byte);
+     void handlePayload(const uint8_t* payload, uint8_t len);
+     void sendReply(const uint8_t* payload, uint8_t len);
+     void sendValues();
+ };
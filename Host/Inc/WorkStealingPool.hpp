@@ -0,0 +1,51 @@
+/*
+ * WorkStealingPool.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #pragma once
+
+ #include <atomic>
+ #include <cstddef>
+ #include <cstdint>
+ #include <deque>
+ #include <functional>
+ #include <mutex>
+ #include <vector>
+
+ /**
+  * @brief Exécute un lot de tâches indépendantes sur tous les cœurs, avec vol de travail.
+  *
+  * Chaque thread reçoit un bloc contigu d'indices dans sa propre file et la dépile par la fin ;
+  * quand elle est vide il vole par le début de la file d'un autre. Les sorties longues
+  * (modes ou durées différentes) sont ainsi rééquilibrées sans verrou global.
+  */
+ class WorkStealingPool {
+ public:
+     typedef std::function<void(size_t index, unsigned worker)> Task;
+
+     explicit WorkStealingPool(unsigned threads = 0);  // 0 = nombre de cœurs
+
+     unsigned getThreadCount() const { return threadCount; }
+
+     // Appelle task(i, worker) pour chaque i de [0, count) puis rend la main
+     void run(size_t count, const Task& task);
+
+     uint64_t getSteals() const { return steals.load(); }  // vols réussis pendant le dernier run()
+
+ private:
+     struct WorkQueue {
+         std::mutex lock;
+         std::deque<size_t> items;
+     };
+
+     unsigned threadCount;
+     std::vector<WorkQueue> queues;
+     std::atomic<uint64_t> steals;
+
+     bool popLocal(unsigned worker, size_t& index);
+     bool steal(unsigned thief, size_t& index);
+     void workerLoop(unsigned worker, const Task& task);
+ };
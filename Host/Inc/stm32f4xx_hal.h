@@ -0,0 +1,73 @@
+/*
+ * stm32f4xx_hal.h (version PC)
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ /**
+  * Remplace la HAL STM32 pour faire tourner MotorController, VESCInterface et ScreenDisplay
+  * sur Linux, sans modifier leur code. Compiler avec -DERGO_HOST -IHost/Inc -IInc :
+  * ce fichier est alors trouvé à la place de celui de CubeF4.
+  *
+  * Seule la partie de la HAL utilisée au-dessus des drivers est fournie (UART bloquante,
+  * SysTick, IWDG). Le branchement des UART se fait par HostHal.hpp.
+  */
+
+ #pragma once
+
+ #include <stdint.h>
+ #include <stddef.h>
+
+ #ifdef __cplusplus
+ class HostUartDevice;
+ extern "C" {
+ #else
+ typedef struct HostUartDevice HostUartDevice;
+ #endif
+
+ typedef enum {
+     HAL_OK      = 0x00U,
+     HAL_ERROR   = 0x01U,
+     HAL_BUSY    = 0x02U,
+     HAL_TIMEOUT = 0x03U
+ } HAL_StatusTypeDef;
+
+ #define HAL_MAX_DELAY 0xFFFFFFFFU
+
+ typedef struct __UART_HandleTypeDef {
+     HostUartDevice* device;  // port série, pty ou émulateur (voir hostAttachUart)
+     const char* name;        // pour les traces : "huart2", "huart3"...
+ } UART_HandleTypeDef;
+
+ // --- IWDG : mêmes constantes que la HAL, timeout = 4 × 2^prescaler × (reload + 1) / 32 kHz ---
+ #define IWDG_PRESCALER_4    0x00000000U
+ #define IWDG_PRESCALER_8    0x00000001U
+ #define IWDG_PRESCALER_16   0x00000002U
+ #define IWDG_PRESCALER_32   0x00000003U
+ #define IWDG_PRESCALER_64   0x00000004U
+ #define IWDG_PRESCALER_128  0x00000005U
+ #define IWDG_PRESCALER_256  0x00000006U
+
+ typedef struct {
+     uint32_t Prescaler;
+     uint32_t Reload;
+ } IWDG_InitTypeDef;
+
+ typedef struct {
+     void* Instance;
+     IWDG_InitTypeDef Init;
+ } IWDG_HandleTypeDef;
+
+ HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef* huart, const uint8_t* pData, uint16_t Size, uint32_t Timeout);
+ HAL_StatusTypeDef HAL_UART_Receive(UART_HandleTypeDef* huart, uint8_t* pData, uint16_t Size, uint32_t Timeout);
+
+ uint32_t HAL_GetTick(void);
+ void HAL_Delay(uint32_t Delay);
+
+ HAL_StatusTypeDef HAL_IWDG_Init(IWDG_HandleTypeDef* hiwdg);
+ HAL_StatusTypeDef HAL_IWDG_Refresh(IWDG_HandleTypeDef* hiwdg);
+
+ #ifdef __cplusplus
+ }
+ #endif
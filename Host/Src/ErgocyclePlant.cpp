@@ -0,0 +1,194 @@
+/*
+ * ErgocyclePlant.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #include "../Inc/ErgocyclePlant.hpp"
+
+ #include <cmath>
+
+ static const float TWO_PI = 2.0f * static_cast<float>(M_PI);
+ static const float STANDSTILL_OMEGA = 1e-3f;  // rad/s pédalier
+
+ ErgocycleParams defaultErgocycleParams() {
+     ErgocycleParams p;
+     p.torqueConstant = 0.39f / 1.95f;  // 1.95 A → 0.39 Nm
+     p.resistance = 0.1f;
+     p.currentTimeConstant = 0.002f;
+     p.polePairs = 1.0f;                // même valeur par défaut que defaultConditioningConfig()
+     p.rotorInertia = 1e-4f;
+     p.currentLimit = 20.0f;
+     p.batteryVoltage = 48.0f;          // cadence à vide Vbatt / Ke / réduction ≈ 60 tr/min
+     p.speedKp = 0.05f;
+     p.speedKi = 0.5f;
+
+     p.reductionRatio = 15.0f / 0.39f;  // 0.39 Nm moteur → 15 Nm pédalier
+     p.gearEfficiency = 0.9f;
+
+     p.flywheelInertia = 0.4f;
+     p.bearingCoulomb = 0.5f;
+     p.bearingViscous = 0.02f;
+
+     p.ambientTemp = 25.0f;
+     p.maxStepSeconds = 0.0005f;
+     return p;
+ }
+
+ RiderProfile defaultRiderProfile() {
+     RiderProfile r;
+     r.mode = RiderProfile::PEDAL;
+     r.meanTorque = 10.0f;
+     r.modulation = 0.6f;
+     r.phaseRad = 0.0f;
+     r.targetCadence = 40.0f;   // 2/3 de la cadence à vide : rapport cyclique ≈ 0.7, loin de la saturation
+     r.cadenceGain = 2.0f;      // retient : une assistance de 10 Nm se stabilise vers 50 tr/min
+     r.maxTorque = 60.0f;
+     return r;
+ }
+
+ ErgocyclePlant::ErgocyclePlant(const ErgocycleParams& p, const RiderProfile& r)
+     : params(p), rider(r) {
+     reset();
+ }
+
+ void ErgocyclePlant::reset() {
+     state = {0.0f, 0.0f, 0.0f, 0.0f, params.batteryVoltage, params.ambientTemp, params.ambientTemp};
+     crankAngle = 0.0f;
+     crankOmega = 0.0f;
+     current = 0.0f;
+     speedIntegral = 0.0f;
+     riderTorque = 0.0f;
+     motorTorqueAtCrank = 0.0f;
+     time = 0.0;
+ }
+
+ float ErgocyclePlant::getCadence() const {
+     return crankOmega * 60.0f / TWO_PI;
+ }
+
+ void ErgocyclePlant::step(const VescCommand& command, float dt) {
+     int n = static_cast<int>(ceilf(dt / params.maxStepSeconds));
+     if (n < 1) n = 1;
+     float h = dt / n;
+     for (int i = 0; i < n; i++) substep(command, h);
+     time += dt;
+ }
+
+ float ErgocyclePlant::currentTarget(const VescCommand& command, float motorOmega, float dt) {
+     float target;
+     if (command.mode == VescCommand::RPM) {
+         // PI de vitesse du VESC, intégrale bornée au courant max (anti-emballement)
+         float targetOmega = command.erpm / params.polePairs * TWO_PI / 60.0f;
+         float error = targetOmega - motorOmega;
+         speedIntegral += params.speedKi * error * dt;
+         if (speedIntegral > params.currentLimit) speedIntegral = params.currentLimit;
+         if (speedIntegral < -params.currentLimit) speedIntegral = -params.currentLimit;
+         target = params.speedKp * error + speedIntegral;
+     } else {
+         speedIntegral = 0.0f;
+         target = command.current;
+     }
+
+     // Limites du VESC : courant max puis tension disponible (|Ke·ω + R·I| ≤ Vbatt)
+     if (target > params.currentLimit) target = params.currentLimit;
+     if (target < -params.currentLimit) target = -params.currentLimit;
+     float bemf = params.torqueConstant * motorOmega;
+     float iMax = (params.batteryVoltage - bemf) / params.resistance;
+     float iMin = (-params.batteryVoltage - bemf) / params.resistance;
+     if (target > iMax) target = iMax;
+     if (target < iMin) target = iMin;
+     return target;
+ }
+
+ float ErgocyclePlant::computeRiderTorque() const
+ // Effort du cycliste à l'angle courant : amplitude ≥ 0 en RESIST, signé en PEDAL
+ {
+     float base;
+     float floor = 0.0f;
+     switch (rider.mode) {
+         case RiderProfile::PEDAL:
+             // Au-dessus de sa cadence le cycliste retient les pédales : sans cela une assistance
+             // positive n'a d'équilibre qu'à la cadence à vide, moteur en saturation de tension
+             base = rider.meanTorque + rider.cadenceGain * (rider.targetCadence - getCadence());
+             floor = -rider.maxTorque;
+             break;
+         case RiderProfile::RESIST:
+             base = rider.meanTorque;
+             break;
+         default:
+             return 0.0f;
+     }
+     if (base < floor) base = floor;
+     if (base > rider.maxTorque) base = rider.maxTorque;
+
+     float torque = base * (1.0f + rider.modulation * cosf(2.0f * (crankAngle - rider.phaseRad)));
+     if (base < 0.0f) return (torque < 0.0f) ? torque : 0.0f;
+     return (torque > 0.0f) ? torque : 0.0f;
+ }
+
+ void ErgocyclePlant::substep(const VescCommand& command, float dt) {
+     const float ratio = params.reductionRatio;
+     float motorOmega = crankOmega * ratio;
+
+     // Boucle de courant du VESC : premier ordre vers la consigne bornée
+     float target = currentTarget(command, motorOmega, dt);
+     float k = dt / params.currentTimeConstant;
+     current += (target - current) * (k < 1.0f ? k : 1.0f);
+
+     // Couple moteur ramené au pédalier, rendement appliqué dans le sens de la puissance
+     float torque = params.torqueConstant * current * ratio;
+     bool motorDriving = (torque * crankOmega >= 0.0f);
+     motorTorqueAtCrank = motorDriving ? torque * params.gearEfficiency : torque / params.gearEfficiency;
+
+     // Efforts moteurs (motorTorque, cycliste qui pédale) et dissipatifs (paliers, cycliste qui freine)
+     float effort = computeRiderTorque();
+     float drive = motorTorqueAtCrank;
+     float dissipative = params.bearingCoulomb;
+     if (rider.mode == RiderProfile::PEDAL) drive += effort;
+     else dissipative += effort;
+
+     float inertia = params.flywheelInertia + params.rotorInertia * ratio * ratio;
+     float previous = crankOmega;
+
+     if (fabsf(crankOmega) > STANDSTILL_OMEGA) {
+         float sign = (crankOmega > 0.0f) ? 1.0f : -1.0f;
+         float accel = (drive - sign * dissipative - params.bearingViscous * crankOmega) / inertia;
+         crankOmega += accel * dt;
+         // Les frottements arrêtent le pédalier mais ne le font pas repartir en arrière
+         if (crankOmega * previous < 0.0f && fabsf(drive) <= dissipative) crankOmega = 0.0f;
+     } else if (fabsf(drive) > dissipative) {
+         float sign = (drive > 0.0f) ? 1.0f : -1.0f;
+         crankOmega += (drive - sign * dissipative) / inertia * dt;
+     } else {
+         crankOmega = 0.0f;  // adhérence
+     }
+
+     // Euler semi-implicite : la position utilise la nouvelle vitesse
+     crankAngle += crankOmega * dt;
+     crankAngle = fmodf(crankAngle, TWO_PI);
+     if (crankAngle < 0.0f) crankAngle += TWO_PI;
+
+     // Couple du cycliste signé (le freinage s'oppose au mouvement)
+     if (rider.mode == RiderProfile::PEDAL) riderTorque = effort;
+     else if (rider.mode == RiderProfile::RESIST) riderTorque = (crankOmega >= 0.0f) ? -effort : effort;
+     else riderTorque = 0.0f;
+
+     // Télémétrie vue par le VESC
+     motorOmega = crankOmega * ratio;
+     float duty = (params.torqueConstant * motorOmega + params.resistance * current) / params.batteryVoltage;
+     if (duty > 1.0f) duty = 1.0f;
+     if (duty < -1.0f) duty = -1.0f;
+
+     // Échauffement du premier ordre : pertes Joule, Rth = 1 K/W, Cth = 500 J/K (FET : moitié)
+     float joule = current * current * params.resistance;
+     state.tempMotor += (joule - (state.tempMotor - params.ambientTemp)) / 500.0f * dt;
+     state.tempFet += (0.5f * joule - (state.tempFet - params.ambientTemp)) / 250.0f * dt;
+
+     state.erpm = motorOmega * 60.0f / TWO_PI * params.polePairs;
+     state.motorCurrent = current;
+     state.inputCurrent = duty * current;
+     state.dutyCycle = duty;
+     state.inputVoltage = params.batteryVoltage;
+ }
@@ -0,0 +1,276 @@
+/*
+ * HostHal.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #include "../Inc/HostHal.hpp"
+
+ #include <cstdio>
+ #include <cstdlib>
+ #include <cstring>
+ #include <ctime>
+
+ #include <fcntl.h>
+ #include <poll.h>
+ #include <termios.h>
+ #include <unistd.h>
+
+ // --- Horloge ---
+
+ namespace {
+
+ struct ClockState {
+     HostClockMode mode = HostClockMode::REALTIME;
+     uint64_t simulatedUs = 0;
+     uint64_t realStartUs = 0;
+     HostDelayHook delayHook = nullptr;
+     void* delayContext = nullptr;
+ };
+
+ struct WatchdogState {
+     bool enabled = false;
+     uint32_t timeoutMs = 0;
+     uint64_t lastRefreshUs = 0;
+     uint32_t worstMarginMs = 0xFFFFFFFFu;
+     HostWatchdogHandler handler = nullptr;
+     void* context = nullptr;
+ };
+
+ thread_local ClockState clockState;
+ thread_local WatchdogState watchdog;
+
+ uint64_t monotonicMicros() {
+     timespec ts;
+     clock_gettime(CLOCK_MONOTONIC, &ts);
+     return static_cast<uint64_t>(ts.tv_sec) * 1000000u + static_cast<uint64_t>(ts.tv_nsec) / 1000u;
+ }
+
+ void defaultWatchdogHandler(uint32_t overdueMs, void*) {
+     fprintf(stderr, "[IWDG] expiration : boucle en retard de %u ms -> reset\n", overdueMs);
+     abort();
+ }
+
+ void checkWatchdog()
+ // Vérifié à chaque appel HAL : on détecte la dérive là où la vraie puce aurait redémarré
+ {
+     if (!watchdog.enabled) return;
+
+     uint64_t elapsedMs = (hostClockMicros() - watchdog.lastRefreshUs) / 1000u;
+     if (elapsedMs <= watchdog.timeoutMs) return;
+
+     watchdog.enabled = false;  // un seul déclenchement, comme un reset
+     HostWatchdogHandler handler = watchdog.handler ? watchdog.handler : defaultWatchdogHandler;
+     handler(static_cast<uint32_t>(elapsedMs - watchdog.timeoutMs), watchdog.context);
+ }
+
+ }  // namespace
+
+ void hostClockSetMode(HostClockMode mode) {
+     clockState.mode = mode;
+     clockState.simulatedUs = 0;
+     clockState.realStartUs = monotonicMicros();
+ }
+
+ HostClockMode hostClockGetMode() {
+     return clockState.mode;
+ }
+
+ void hostClockAdvance(uint32_t ms) {
+     hostClockAdvanceMicros(static_cast<uint64_t>(ms) * 1000u);
+ }
+
+ void hostClockAdvanceMicros(uint64_t us) {
+     if (clockState.mode == HostClockMode::SIMULATED) clockState.simulatedUs += us;
+ }
+
+ uint64_t hostClockMicros() {
+     if (clockState.mode == HostClockMode::SIMULATED) return clockState.simulatedUs;
+     if (clockState.realStartUs == 0) clockState.realStartUs = monotonicMicros();
+     return monotonicMicros() - clockState.realStartUs;
+ }
+
+ void hostClockSetDelayHook(HostDelayHook hook, void* context) {
+     clockState.delayHook = hook;
+     clockState.delayContext = context;
+ }
+
+ uint32_t HAL_GetTick(void) {
+     return static_cast<uint32_t>(hostClockMicros() / 1000u);
+ }
+
+ void HAL_Delay(uint32_t Delay) {
+     if (clockState.mode == HostClockMode::SIMULATED) {
+         if (clockState.delayHook) clockState.delayHook(Delay, clockState.delayContext);
+         clockState.simulatedUs += static_cast<uint64_t>(Delay) * 1000u;
+     } else {
+         timespec ts = {static_cast<time_t>(Delay / 1000u), static_cast<long>(Delay % 1000u) * 1000000L};
+         nanosleep(&ts, nullptr);
+     }
+     checkWatchdog();
+ }
+
+ // --- IWDG ---
+
+ HAL_StatusTypeDef HAL_IWDG_Init(IWDG_HandleTypeDef* hiwdg) {
+     if (!hiwdg || hiwdg->Init.Prescaler > IWDG_PRESCALER_256 || hiwdg->Init.Reload > 0x0FFFu) return HAL_ERROR;
+
+     // LSI à 32 kHz : 8.2 s pour prescaler 64 et reload 4095
+     uint32_t divider = 4u << hiwdg->Init.Prescaler;
+     watchdog.timeoutMs = static_cast<uint32_t>((static_cast<uint64_t>(divider) * (hiwdg->Init.Reload + 1u)) / 32u);
+     watchdog.lastRefreshUs = hostClockMicros();
+     watchdog.worstMarginMs = 0xFFFFFFFFu;
+     watchdog.enabled = true;
+     return HAL_OK;
+ }
+
+ HAL_StatusTypeDef HAL_IWDG_Refresh(IWDG_HandleTypeDef*) {
+     checkWatchdog();
+     if (!watchdog.enabled) return HAL_OK;
+
+     uint64_t now = hostClockMicros();
+     uint32_t elapsedMs = static_cast<uint32_t>((now - watchdog.lastRefreshUs) / 1000u);
+     uint32_t margin = watchdog.timeoutMs - elapsedMs;
+     if (margin < watchdog.worstMarginMs) watchdog.worstMarginMs = margin;
+
+     watchdog.lastRefreshUs = now;
+     return HAL_OK;
+ }
+
+ void hostIwdgSetHandler(HostWatchdogHandler handler, void* context) {
+     watchdog.handler = handler;
+     watchdog.context = context;
+ }
+
+ uint32_t hostIwdgTimeoutMs() {
+     return watchdog.timeoutMs;
+ }
+
+ uint32_t hostIwdgWorstMarginMs() {
+     return watchdog.worstMarginMs;
+ }
+
+ // --- UART ---
+
+ void hostAttachUart(UART_HandleTypeDef* huart, HostUartDevice* device, const char* name) {
+     huart->device = device;
+     huart->name = name;
+ }
+
+ HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef* huart, const uint8_t* pData, uint16_t Size, uint32_t) {
+     checkWatchdog();
+     if (!huart || !huart->device) return HAL_ERROR;
+     return huart->device->write(pData, Size) ? HAL_OK : HAL_ERROR;
+ }
+
+ HAL_StatusTypeDef HAL_UART_Receive(UART_HandleTypeDef* huart, uint8_t* pData, uint16_t Size, uint32_t Timeout) {
+     checkWatchdog();
+     if (!huart || !huart->device) return HAL_ERROR;
+
+     uint64_t startUs = hostClockMicros();
+     uint16_t received = 0;
+
+     while (received < Size) {
+         uint64_t elapsedMs = (hostClockMicros() - startUs) / 1000u;
+         if (Timeout != HAL_MAX_DELAY && elapsedMs >= Timeout) break;
+
+         uint32_t remaining = (Timeout == HAL_MAX_DELAY) ? 1000u : static_cast<uint32_t>(Timeout - elapsedMs);
+         uint16_t n = huart->device->read(pData + received, Size - received, remaining);
+         if (n == 0 && clockState.mode == HostClockMode::SIMULATED) {
+             // Rien n'arrivera sans faire avancer le temps : la vraie HAL aurait attendu tout le timeout
+             hostClockAdvance(remaining);
+         }
+         received += n;
+     }
+
+     return (received == Size) ? HAL_OK : HAL_TIMEOUT;
+ }
+
+ // --- Descripteur POSIX ---
+
+ FdUartDevice::FdUartDevice() : fd(-1), ptyName{0} {}
+
+ FdUartDevice::~FdUartDevice() {
+     close();
+ }
+
+ static speed_t toSpeed(uint32_t baudRate) {
+     switch (baudRate) {
+         case 9600:    return B9600;
+         case 19200:   return B19200;
+         case 38400:   return B38400;
+         case 57600:   return B57600;
+         case 115200:  return B115200;
+         case 230400:  return B230400;
+         case 460800:  return B460800;
+         case 921600:  return B921600;
+         default:      return B0;
+     }
+ }
+
+ bool FdUartDevice::makeRaw(uint32_t baudRate) {
+     termios tio;
+     if (tcgetattr(fd, &tio) != 0) return false;
+
+     cfmakeraw(&tio);  // 8N1, pas d'écho, pas de traduction de fin de ligne : comme un USART
+     tio.c_cflag |= CLOCAL | CREAD;
+     tio.c_cc[VMIN] = 0;
+     tio.c_cc[VTIME] = 0;
+
+     if (baudRate != 0) {
+         speed_t speed = toSpeed(baudRate);
+         if (speed == B0) return false;
+         cfsetispeed(&tio, speed);
+         cfsetospeed(&tio, speed);
+     }
+     return tcsetattr(fd, TCSANOW, &tio) == 0;
+ }
+
+ bool FdUartDevice::openSerial(const char* path, uint32_t baudRate) {
+     close();
+     fd = ::open(path, O_RDWR | O_NOCTTY);
+     if (fd < 0) return false;
+     if (!makeRaw(baudRate)) {
+         close();
+         return false;
+     }
+     return true;
+ }
+
+ bool FdUartDevice::openPty() {
+     close();
+     fd = posix_openpt(O_RDWR | O_NOCTTY);
+     if (fd < 0) return false;
+
+     if (grantpt(fd) != 0 || unlockpt(fd) != 0 || ptsname_r(fd, ptyName, sizeof(ptyName)) != 0 || !makeRaw(0)) {
+         close();
+         return false;
+     }
+     return true;
+ }
+
+ void FdUartDevice::close() {
+     if (fd >= 0) ::close(fd);
+     fd = -1;
+     ptyName[0] = '\0';
+ }
+
+ bool FdUartDevice::write(const uint8_t* data, uint16_t len) {
+     uint16_t sent = 0;
+     while (sent < len) {
+         ssize_t n = ::write(fd, data + sent, len - sent);
+         if (n <= 0) return false;
+         sent += static_cast<uint16_t>(n);
+     }
+     return true;
+ }
+
+ uint16_t FdUartDevice::read(uint8_t* data, uint16_t len, uint32_t timeoutMs) {
+     pollfd pfd = {fd, POLLIN, 0};
+     int timeout = (timeoutMs > 0x7FFFFFFFu) ? -1 : static_cast<int>(timeoutMs);
+     if (poll(&pfd, 1, timeout) <= 0) return 0;
+
+     ssize_t n = ::read(fd, data, len);
+     return (n > 0) ? static_cast<uint16_t>(n) : 0;
+ }
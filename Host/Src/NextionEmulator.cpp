@@ -0,0 +1,331 @@
+/*
+ * NextionEmulator.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #include "../Inc/NextionEmulator.hpp"
+
+ #include <algorithm>
+ #include <cstdlib>
+ #include <cstring>
+ #include <unistd.h>
+
+ static const size_t MAX_COMMAND_LENGTH = 1024;
+
+ NextionLinkConfig defaultNextionLinkConfig() {
+     NextionLinkConfig cfg;
+     cfg.baudRate = 9600;            // même débit que MX_USART2_UART_Init
+     cfg.commandLatencyUs = 1000;    // ordre de grandeur du traitement d'un "get" par l'écran
+     cfg.reportErrors = true;
+     return cfg;
+ }
+
+ NextionEmulator::NextionEmulator(const NextionLinkConfig& cfg)
+     : link(cfg),
+       stats{},
+       nextEvent(0),
+       startUs(0),
+       lastUs(0),
+       started(false),
+       terminatorCount(0),
+       lineFreeUs(0) {}
+
+ // --- Composants ---
+
+ void NextionEmulator::defineComponent(const char* name, int32_t val, const char* txt) {
+     NextionComponent& c = components[name];
+     c.txt = txt;
+     c.val = val;
+     c.txtWrites = 0;
+     c.valWrites = 0;
+     c.lastWriteUs = 0;
+     c.pending = false;
+     c.pendingSinceUs = 0;
+ }
+
+ void NextionEmulator::defineErgocyclePage()
+ // Noms utilisés par ScreenDisplay.cpp ; les valeurs initiales sont celles d'un écran au repos
+ {
+     // Affichage
+     const char* fields[] = {"t0", "err", "cad_val", "tor_val", "pow_val", "duty",
+                             "mode_show", "gain_val", "dir_show", "calib_stat", "bilan"};
+     for (const char* name : fields) defineComponent(name);
+
+     // Saisies
+     defineComponent("mode", 0);       // 0 = CADENCE
+     defineComponent("dir", 0);        // 0 = FORWARD
+     defineComponent("ramp", 6);       // A/s
+     defineComponent("cad", 0);        // tr/min
+     defineComponent("tor", 0);        // Nm
+     defineComponent("pow", 0);        // W
+     defineComponent("gain", 5);       // centièmes : 0.05
+     defineComponent("stop", 0);
+     defineComponent("btn_calib", 0);
+ }
+
+ const NextionComponent* NextionEmulator::getComponent(const char* name) const {
+     auto it = components.find(name);
+     return (it != components.end()) ? &it->second : nullptr;
+ }
+
+ NextionComponent* NextionEmulator::findComponent(const std::string& name, uint64_t receivedUs) {
+     auto it = components.find(name);
+     if (it != components.end()) return &it->second;
+
+     stats.unknownComponents++;
+     sendCode(NEX_RET_INVALID_VARIABLE, receivedUs);
+     return nullptr;
+ }
+
+ // --- Saisies scriptées ---
+
+ void NextionEmulator::scheduleTouch(uint32_t atMs, const char* component, int32_t value) {
+     NextionTouchEvent event = {atMs, component, value};
+     auto pos = std::upper_bound(script.begin() + nextEvent, script.end(), event,
+                                 [](const NextionTouchEvent& a, const NextionTouchEvent& b) { return a.atMs < b.atMs; });
+     script.insert(pos, event);
+ }
+
+ bool NextionEmulator::loadScript(const char* path) {
+     FILE* f = fopen(path, "r");
+     if (!f) return false;
+
+     char line[160];
+     while (fgets(line, sizeof(line), f)) {
+         if (line[0] == '#' || line[0] == '\n') continue;
+
+         unsigned atMs;
+         char name[64];
+         int value;
+         if (sscanf(line, "%u %63s %d", &atMs, name, &value) == 3) scheduleTouch(atMs, name, value);
+     }
+     fclose(f);
+     return true;
+ }
+
+ void NextionEmulator::advanceTo(uint64_t nowUs) {
+     if (!started) {
+         startUs = nowUs;
+         started = true;
+     }
+     if (nowUs > lastUs) lastUs = nowUs;
+
+     while (nextEvent < script.size() && static_cast<uint64_t>(script[nextEvent].atMs) * 1000u <= nowUs) {
+         const NextionTouchEvent& event = script[nextEvent++];
+         NextionComponent& c = components[event.component];  // un appui crée le composant s'il manque
+         c.val = event.value;
+         c.pending = true;
+         c.pendingSinceUs = static_cast<uint64_t>(event.atMs) * 1000u;
+         stats.touchEvents++;
+     }
+ }
+
+ // --- Réception des commandes ---
+
+ uint64_t NextionEmulator::byteTimeUs() const {
+     return link.baudRate ? (10000000ull / link.baudRate) : 0;  // 8N1
+ }
+
+ bool NextionEmulator::write(const uint8_t* data, uint16_t len) {
+     uint64_t now = hostClockMicros();
+     advanceTo(now);
+
+     uint64_t bt = byteTimeUs();
+     for (uint16_t i = 0; i < len; i++) {
+         uint64_t arrivalUs = now + (i + 1) * bt;
+
+         if (data[i] == 0xFF) {
+             if (++terminatorCount == 3) {
+                 handleCommand(command, arrivalUs);
+                 command.clear();
+                 terminatorCount = 0;
+             }
+             continue;
+         }
+
+         // 0xFF isolés puis autre chose : ce n'était pas une fin de commande
+         command.append(terminatorCount, static_cast<char>(0xFF));
+         terminatorCount = 0;
+         command.push_back(static_cast<char>(data[i]));
+
+         if (command.size() > MAX_COMMAND_LENGTH) {  // tampon de l'écran saturé
+             stats.invalidCommands++;
+             command.clear();
+         }
+     }
+
+     stats.bytesReceived += len;
+     uint64_t wireUs = len * bt;
+     stats.uplinkBusyUs += wireUs;
+
+     // HAL_UART_Transmit en polling ne rend la main qu'une fois le dernier octet parti
+     if (hostClockGetMode() == HostClockMode::SIMULATED) hostClockAdvanceMicros(wireUs);
+     else if (wireUs) usleep(static_cast<useconds_t>(wireUs));
+     if (now + wireUs > lastUs) lastUs = now + wireUs;
+     return true;
+ }
+
+ void NextionEmulator::handleCommand(const std::string& cmd, uint64_t receivedUs) {
+     stats.commands++;
+
+     if (cmd.compare(0, 4, "get ") == 0) {
+         handleGet(cmd.substr(4), receivedUs);
+         return;
+     }
+
+     size_t eq = cmd.find('=');
+     if (eq != std::string::npos) {
+         handleAssign(cmd.substr(0, eq), cmd.substr(eq + 1), receivedUs);
+         return;
+     }
+
+     // Instructions sans réponse utilisées par le firmware (ou utiles depuis un script)
+     const char* accepted[] = {"cls", "page", "ref", "vis", "dim", "sleep"};
+     for (const char* keyword : accepted) {
+         size_t n = strlen(keyword);
+         if (cmd.compare(0, n, keyword) == 0 && (cmd.size() == n || cmd[n] == ' ')) return;
+     }
+
+     stats.invalidCommands++;
+     sendCode(NEX_RET_INVALID_INSTRUCTION, receivedUs);
+ }
+
+ void NextionEmulator::handleAssign(const std::string& lhs, const std::string& rhs, uint64_t receivedUs) {
+     size_t dot = lhs.rfind('.');
+     if (dot == std::string::npos) return;  // variable système (dim=, baud=...) : acceptée sans effet
+
+     NextionComponent* c = findComponent(lhs.substr(0, dot), receivedUs);
+     if (!c) return;
+
+     std::string attr = lhs.substr(dot + 1);
+     if (attr == "txt") {
+         if (rhs.size() < 2 || rhs.front() != '"' || rhs.back() != '"') {
+             stats.invalidCommands++;
+             sendCode(NEX_RET_INVALID_INSTRUCTION, receivedUs);
+             return;
+         }
+         c->txt = rhs.substr(1, rhs.size() - 2);
+         c->txtWrites++;
+         stats.txtWrites++;
+     } else if (attr == "val") {
+         c->val = static_cast<int32_t>(strtol(rhs.c_str(), nullptr, 10));
+         c->valWrites++;
+         stats.valWrites++;
+     }
+     // Autres attributs (pco, bco, font...) : acceptés, non modélisés
+
+     c->lastWriteUs = receivedUs;
+ }
+
+ void NextionEmulator::handleGet(const std::string& target, uint64_t receivedUs) {
+     stats.getRequests++;
+
+     size_t dot = target.rfind('.');
+     NextionComponent* c = findComponent(target.substr(0, dot), receivedUs);
+     if (!c) return;
+
+     std::vector<uint8_t> reply;
+     if (dot != std::string::npos && target.compare(dot + 1, std::string::npos, "txt") == 0) {
+         reply.push_back(NEX_RET_STRING_DATA);
+         reply.insert(reply.end(), c->txt.begin(), c->txt.end());
+     } else {
+         // 0x71 + int32 little-endian, comme lu par ScreenDisplay::readInt32()
+         uint32_t raw = static_cast<uint32_t>(c->val);
+         reply.push_back(NEX_RET_NUMERIC_DATA);
+         for (int i = 0; i < 4; i++) reply.push_back(static_cast<uint8_t>(raw >> (8 * i)));
+     }
+     reply.insert(reply.end(), 3, 0xFF);
+
+     uint64_t doneUs = sendReply(reply.data(), static_cast<uint16_t>(reply.size()), receivedUs);
+
+     if (c->pending) {
+         uint64_t latency = doneUs - c->pendingSinceUs;
+         stats.inputLatencyCount++;
+         stats.inputLatencySumUs += latency;
+         if (latency > stats.inputLatencyMaxUs) stats.inputLatencyMaxUs = latency;
+         c->pending = false;
+     }
+ }
+
+ // --- Émission des réponses ---
+
+ uint64_t NextionEmulator::sendReply(const uint8_t* payload, uint16_t len, uint64_t receivedUs) {
+     uint64_t start = receivedUs + link.commandLatencyUs;
+     if (start < lineFreeUs) start = lineFreeUs;
+
+     uint64_t bt = byteTimeUs();
+     for (uint16_t i = 0; i < len; i++) {
+         txQueue.push_back({start + (i + 1) * bt, payload[i]});
+     }
+
+     lineFreeUs = start + len * bt;
+     stats.bytesSent += len;
+     stats.downlinkBusyUs += len * bt;
+     return lineFreeUs;
+ }
+
+ void NextionEmulator::sendCode(uint8_t code, uint64_t receivedUs) {
+     if (!link.reportErrors) return;
+     const uint8_t reply[4] = {code, 0xFF, 0xFF, 0xFF};
+     sendReply(reply, sizeof(reply), receivedUs);
+ }
+
+ uint16_t NextionEmulator::read(uint8_t* data, uint16_t len, uint32_t timeoutMs) {
+     uint64_t now = hostClockMicros();
+     advanceTo(now);
+     if (txQueue.empty() || len == 0) return 0;
+
+     uint64_t ready = txQueue.front().readyUs;
+     if (ready > now) {
+         uint64_t waitUs = ready - now;
+         if (waitUs > static_cast<uint64_t>(timeoutMs) * 1000u) {
+             if (hostClockGetMode() == HostClockMode::REALTIME) usleep(timeoutMs * 1000u);
+             return 0;  // en simulé, HAL_UART_Receive avance lui-même le temps du timeout
+         }
+         if (hostClockGetMode() == HostClockMode::SIMULATED) hostClockAdvanceMicros(waitUs);
+         else usleep(static_cast<useconds_t>(waitUs));
+         now = ready;
+         if (now > lastUs) lastUs = now;
+     }
+
+     uint16_t n = 0;
+     while (n < len && !txQueue.empty() && txQueue.front().readyUs <= now) {
+         data[n++] = txQueue.front().value;
+         txQueue.pop_front();
+     }
+     return n;
+ }
+
+ // --- Mesures ---
+
+ float NextionEmulator::getUplinkUtilisation() const {
+     uint64_t elapsed = lastUs - startUs;
+     return elapsed ? static_cast<float>(stats.uplinkBusyUs) / elapsed : 0.0f;
+ }
+
+ float NextionEmulator::getDownlinkUtilisation() const {
+     uint64_t elapsed = lastUs - startUs;
+     return elapsed ? static_cast<float>(stats.downlinkBusyUs) / elapsed : 0.0f;
+ }
+
+ void NextionEmulator::printReport(FILE* out) const {
+     fprintf(out, "Ecran émulé (%u bauds) sur %.1f s :\n", link.baudRate, (lastUs - startUs) / 1e6);
+     fprintf(out, "  %u commandes : %u txt, %u val, %u get, %u composants inconnus, %u invalides\n",
+             stats.commands, stats.txtWrites, stats.valWrites, stats.getRequests,
+             stats.unknownComponents, stats.invalidCommands);
+     fprintf(out, "  liaison : %u octets reçus (%.1f %%), %u octets envoyés (%.1f %%)\n",
+             stats.bytesReceived, 100.0f * getUplinkUtilisation(),
+             stats.bytesSent, 100.0f * getDownlinkUtilisation());
+     if (stats.inputLatencyCount) {
+         fprintf(out, "  saisies : %u/%u relues, latence moyenne %.1f ms, pire %.1f ms\n",
+                 stats.inputLatencyCount, stats.touchEvents,
+                 stats.inputLatencySumUs / 1000.0 / stats.inputLatencyCount, stats.inputLatencyMaxUs / 1000.0);
+     }
+     for (const auto& entry : components) {
+         const NextionComponent& c = entry.second;
+         if (!c.txtWrites && !c.valWrites) continue;
+         fprintf(out, "  %-12s %5u écritures  \"%s\"\n", entry.first.c_str(), c.txtWrites + c.valWrites, c.txt.c_str());
+     }
+ }
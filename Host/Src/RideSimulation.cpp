@@ -0,0 +1,277 @@
+/*
+ * RideSimulation.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #include "../Inc/RideSimulation.hpp"
+
+ #include <cmath>
+ #include <random>
+
+ #include "HostHal.hpp"
+ #include "MotorController.hpp"
+ #include "NextionEmulator.hpp"
+ #include "VescEmulator.hpp"
+
+ float defaultRideInstruction(ControlMode mode)
+ // Consignes tenables par le modèle par défaut (cadence à vide ≈ 60 tr/min, cycliste à 40 tr/min)
+ {
+     switch (mode) {
+         case ControlMode::CADENCE:          return 45.0f;  // tr/min
+         case ControlMode::TORQUE:           return 10.0f;  // Nm
+         case ControlMode::POWER_CONCENTRIC:
+         case ControlMode::POWER_ECCENTRIC:  return 50.0f;  // W
+         default:                            return 0.0f;   // LINEAR : linearGain
+     }
+ }
+
+ RideSpec defaultRideSpec() {
+     RideSpec spec;
+     spec.mode = ControlMode::POWER_CONCENTRIC;
+     spec.instruction = defaultRideInstruction(spec.mode);
+     spec.rampRate = 6.0f;
+     spec.linearGain = 0.05f;
+     ConditioningConfig cfg = defaultConditioningConfig();
+     spec.cadenceAlpha = cfg.cadence.alpha;
+     spec.cadenceBeta = cfg.cadence.beta;
+     spec.currentCutoffHz = cfg.current.cutoffHz;
+     // Débit de la cible : les lectures bloquantes de l'écran portent la boucle à ~0.5 s, comme sur le banc.
+     // Un autre débit se déclare comme axe screen_baud (SweepSpec.hpp), la cible reste dans la grille
+     spec.screenBaud = TARGET_SCREEN_BAUD;
+     spec.rider = defaultRiderProfile();
+     spec.riderVariation = 0.1f;
+     spec.durationS = 60.0f;
+     spec.settleS = 5.0f;
+     spec.loopPeriodMs = 100;
+     spec.ktError = 0.0f;
+     spec.cadenceNoiseRpm = 0.0f;
+     spec.frameLossRate = 0.0f;
+     VescLinkConfig link = defaultVescLinkConfig();
+     spec.latencyUs = link.latencyUs;
+     spec.jitterUs = link.jitterUs;
+     spec.seed = 1;
+     return spec;
+ }
+
+ const RideMetricField rideMetricFields[] = {
+     {"tracking_error_rms", [](const RideMetrics& m) { return m.trackingErrorRms; }},
+     {"power_error_rms",    [](const RideMetrics& m) { return m.powerErrorRms; }},
+     {"torque_rms",         [](const RideMetrics& m) { return m.torqueRms; }},
+     {"mean_cadence",       [](const RideMetrics& m) { return m.meanCadence; }},
+     {"mean_rider_power",   [](const RideMetrics& m) { return m.meanRiderPower; }},
+     {"saturated_fraction", [](const RideMetrics& m) { return m.saturatedFraction; }},
+     {"limit_hits",         [](const RideMetrics& m) { return static_cast<float>(m.limitHits); }},
+     {"safety_trips",       [](const RideMetrics& m) { return static_cast<float>(m.safetyTrips); }},
+     {"watchdog_resets",    [](const RideMetrics& m) { return static_cast<float>(m.watchdogResets); }},
+     {"ticks",              [](const RideMetrics& m) { return static_cast<float>(m.ticks); }},
+     {"max_loop_ms",        [](const RideMetrics& m) { return m.maxLoopMs; }},
+ };
+
+ const size_t rideMetricFieldCount = sizeof(rideMetricFields) / sizeof(rideMetricFields[0]);
+
+ bool isSaturatedRide(const RideMetrics& m) {
+     return m.saturatedFraction > SATURATED_RIDE_FRACTION;
+ }
+
+ namespace {
+
+ // Valeur du composant "mode" attendue par ScreenDisplay::getMode()
+ int32_t screenModeValue(ControlMode mode) {
+     switch (mode) {
+         case ControlMode::CADENCE:          return 0;
+         case ControlMode::TORQUE:           return 1;
+         case ControlMode::POWER_CONCENTRIC: return 2;
+         case ControlMode::POWER_ECCENTRIC:  return 3;
+         case ControlMode::LINEAR:           return 4;
+         default:                            return 0;
+     }
+ }
+
+ /**
+  * @brief Ergocycle instrumenté : les métriques sont accumulées à chaque pas du modèle (1 ms),
+  * pas seulement aux ticks de commande.
+  */
+ class MeteredPlant : public VescPlant {
+ public:
+     MeteredPlant(const ErgocycleParams& params, const RiderProfile& rider, const RideSpec& s)
+         : plant(params, rider), spec(s), noiseRng(s.seed ^ 0x6E6F697365ull) {}
+
+     void step(const VescCommand& command, float dt) override {
+         plant.step(command, dt);
+         if (plant.getTime() < spec.settleS) return;
+
+         float cadence = fabsf(plant.getCadence());
+         float omega = fabsf(plant.getCrankOmega());
+         float motorTorque = fabsf(plant.getMotorTorqueAtCrank());
+         float motorPower = fabsf(plant.getMotorPowerAtCrank());
+
+         float error = 0.0f, powerTarget = -1.0f;
+         switch (spec.mode) {
+             case ControlMode::CADENCE:
+                 error = cadence - spec.instruction;
+                 break;
+             case ControlMode::TORQUE:
+                 error = motorTorque - spec.instruction;
+                 powerTarget = spec.instruction * omega;
+                 break;
+             case ControlMode::POWER_CONCENTRIC:
+             case ControlMode::POWER_ECCENTRIC:
+                 error = motorPower - spec.instruction;
+                 powerTarget = spec.instruction;
+                 break;
+             case ControlMode::LINEAR:
+                 error = motorTorque - spec.linearGain * cadence;
+                 powerTarget = spec.linearGain * cadence * omega;
+                 break;
+         }
+
+         const ErgocycleParams& p = plant.getParams();
+         const VescPlantState& state = plant.getState();
+         bool saturated = fabsf(state.motorCurrent) >= 0.99f * p.currentLimit || fabsf(state.dutyCycle) >= 0.999f;
+         if (saturated && !wasSaturated) limitHits++;
+         wasSaturated = saturated;
+
+         samples++;
+         errorSq += static_cast<double>(error) * error;
+         if (powerTarget >= 0.0f) powerErrorSq += static_cast<double>(motorPower - powerTarget) * (motorPower - powerTarget);
+         torqueSq += static_cast<double>(motorTorque) * motorTorque;
+         cadenceSum += cadence;
+         riderPowerSum += plant.getRiderPower();
+         if (saturated) saturatedSamples++;
+     }
+
+     // Ce que le VESC renvoie : la cadence mesurée est bruitée, la physique ne l'est pas
+     VescPlantState getState() const override {
+         VescPlantState state = plant.getState();
+         if (spec.cadenceNoiseRpm > 0.0f) {
+             const ErgocycleParams& p = plant.getParams();
+             float noiseRpm = std::normal_distribution<float>(0.0f, spec.cadenceNoiseRpm)(noiseRng);
+             state.erpm += noiseRpm * p.reductionRatio * p.polePairs;  // cadence pédalier → ERPM
+         }
+         return state;
+     }
+
+     void fill(RideMetrics& m) const {
+         double n = samples ? static_cast<double>(samples) : 1.0;
+         m.trackingErrorRms = static_cast<float>(sqrt(errorSq / n));
+         m.powerErrorRms = static_cast<float>(sqrt(powerErrorSq / n));
+         m.torqueRms = static_cast<float>(sqrt(torqueSq / n));
+         m.meanCadence = static_cast<float>(cadenceSum / n);
+         m.meanRiderPower = static_cast<float>(riderPowerSum / n);
+         m.saturatedFraction = static_cast<float>(saturatedSamples / n);
+         m.limitHits = limitHits;
+     }
+
+ private:
+     ErgocyclePlant plant;
+     const RideSpec& spec;
+     mutable std::mt19937_64 noiseRng;
+
+     uint64_t samples = 0;
+     uint64_t saturatedSamples = 0;
+     double errorSq = 0.0, powerErrorSq = 0.0, torqueSq = 0.0;
+     double cadenceSum = 0.0, riderPowerSum = 0.0;
+     uint32_t limitHits = 0;
+     bool wasSaturated = false;
+ };
+
+ void countWatchdogReset(uint32_t, void* context) {
+     (*static_cast<uint32_t*>(context))++;  // pas d'abort() : la sortie continue et le reset est compté
+ }
+
+ }  // namespace
+
+ RideMetrics runRide(const RideSpec& spec)
+ {
+     RideMetrics metrics = {};
+     hostClockSetMode(HostClockMode::SIMULATED);
+
+     // Cycliste tiré de la graine : deux exécutions avec la même graine sont identiques
+     std::mt19937_64 rng(spec.seed);
+     std::uniform_real_distribution<float> spread(-spec.riderVariation, spec.riderVariation);
+     RiderProfile rider = spec.rider;
+     rider.meanTorque *= 1.0f + spread(rng);
+     rider.targetCadence *= 1.0f + spread(rng);
+     rider.phaseRad = std::uniform_real_distribution<float>(0.0f, static_cast<float>(M_PI))(rng);
+
+     ErgocycleParams params = defaultErgocycleParams();
+     MeteredPlant plant(params, rider, spec);
+
+     VescLinkConfig vescLink = defaultVescLinkConfig();
+     vescLink.seed = static_cast<uint32_t>(spec.seed);
+     vescLink.latencyUs = spec.latencyUs;
+     vescLink.jitterUs = spec.jitterUs;
+     vescLink.frameLossRate = spec.frameLossRate;
+     VescEmulator vesc(plant, vescLink);
+
+     NextionLinkConfig screenLink = defaultNextionLinkConfig();
+     screenLink.baudRate = spec.screenBaud;
+     NextionEmulator screen(screenLink);
+     screen.defineErgocyclePage();
+     screen.defineComponent("mode", screenModeValue(spec.mode));
+     screen.defineComponent("ramp", static_cast<int32_t>(lroundf(spec.rampRate)));
+     screen.defineComponent("cad", static_cast<int32_t>(lroundf(spec.instruction)));
+     screen.defineComponent("tor", static_cast<int32_t>(lroundf(spec.instruction)));
+     screen.defineComponent("pow", static_cast<int32_t>(lroundf(spec.instruction)));
+     screen.defineComponent("gain", static_cast<int32_t>(lroundf(spec.linearGain * 100.0f)));  // centièmes
+
+     UART_HandleTypeDef vescUart = {};
+     UART_HandleTypeDef screenUart = {};
+     hostAttachUart(&vescUart, &vesc, "huart3");
+     hostAttachUart(&screenUart, &screen, "huart2");
+
+     uint32_t watchdogResets = 0;
+     IWDG_HandleTypeDef hiwdg = {};
+     hiwdg.Init.Prescaler = IWDG_PRESCALER_64;  // même réglage que MX_IWDG_Init
+     hiwdg.Init.Reload = 4095;
+     hostIwdgSetHandler(countWatchdogReset, &watchdogResets);
+     HAL_IWDG_Init(&hiwdg);
+
+     // Kt supposé déjà calibré (valeur du modèle, à ktError près) : la sortie commence par la consigne
+     MotorController motor(&vescUart, &screenUart, params.torqueConstant * (1.0f + spec.ktError));
+     ConditioningConfig cfg = defaultConditioningConfig();
+     cfg.polePairs = params.polePairs;
+     cfg.reductionRatio = params.reductionRatio;
+     cfg.cadence.alpha = spec.cadenceAlpha;
+     cfg.cadence.beta = spec.cadenceBeta;
+     cfg.current.cutoffHz = spec.currentCutoffHz;
+     motor.setConditioning(cfg);
+
+     const uint64_t endUs = static_cast<uint64_t>(spec.durationS * 1e6f);
+     uint32_t handledResets = 0;
+     bool wasTripped = false;
+
+     while (hostClockMicros() < endUs) {
+         uint64_t start = hostClockMicros();
+         HAL_IWDG_Refresh(&hiwdg);
+
+         // Même boucle que mainV1.cpp
+         motor.updateFromScreen();
+         motor.sampleTelemetry();
+         float cadence = motor.getCadence();
+         motor.update(cadence);
+         motor.updateScreen();
+
+         float loopMs = (hostClockMicros() - start) / 1000.0f;
+         if (loopMs > metrics.maxLoopMs) metrics.maxLoopMs = loopMs;
+         metrics.ticks++;
+
+         bool tripped = motor.getSafety().isTripped();
+         if (tripped && !wasTripped) metrics.safetyTrips++;
+         wasTripped = tripped;
+
+         if (watchdogResets != handledResets) {  // le chien de garde ne se déclenche qu'une fois : on le réarme
+             handledResets = watchdogResets;
+             HAL_IWDG_Init(&hiwdg);
+         }
+
+         HAL_Delay(spec.loopPeriodMs);
+     }
+
+     hostIwdgSetHandler(nullptr, nullptr);
+     plant.fill(metrics);
+     metrics.watchdogResets = watchdogResets;
+     return metrics;
+ }
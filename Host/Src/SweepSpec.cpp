@@ -0,0 +1,271 @@
+/*
+ * SweepSpec.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #include "../Inc/SweepSpec.hpp"
+
+ #include <cmath>
+ #include <cstdio>
+ #include <cstdlib>
+ #include <cstring>
+ #include <random>
+
+ namespace {
+
+ std::string trim(const std::string& s) {
+     size_t begin = s.find_first_not_of(" \t\r\n");
+     if (begin == std::string::npos) return "";
+     size_t end = s.find_last_not_of(" \t\r\n");
+     return s.substr(begin, end - begin + 1);
+ }
+
+ bool parseFloat(const std::string& text, float& value) {
+     char* end = nullptr;
+     value = strtof(text.c_str(), &end);
+     return end != text.c_str() && *end == '\0';
+ }
+
+ bool parseMode(const std::string& text, ControlMode& mode) {
+     if (text == "cadence")               mode = ControlMode::CADENCE;
+     else if (text == "torque")           mode = ControlMode::TORQUE;
+     else if (text == "power_concentric") mode = ControlMode::POWER_CONCENTRIC;
+     else if (text == "power_eccentric")  mode = ControlMode::POWER_ECCENTRIC;
+     else if (text == "linear")           mode = ControlMode::LINEAR;
+     else return false;
+     return true;
+ }
+
+ bool parseRider(const std::string& text, RiderProfile::Mode& mode) {
+     if (text == "passive")     mode = RiderProfile::PASSIVE;
+     else if (text == "pedal")  mode = RiderProfile::PEDAL;
+     else if (text == "resist") mode = RiderProfile::RESIST;
+     else return false;
+     return true;
+ }
+
+ // "a:b:pas" → a, a+pas, ..., b (bornes incluses) ; sinon la valeur telle quelle
+ bool expandItem(const std::string& item, std::vector<std::string>& out) {
+     size_t c1 = item.find(':');
+     if (c1 == std::string::npos) {
+         out.push_back(item);
+         return true;
+     }
+     size_t c2 = item.find(':', c1 + 1);
+     float start, stop, step;
+     if (c2 == std::string::npos || !parseFloat(trim(item.substr(0, c1)), start) ||
+         !parseFloat(trim(item.substr(c1 + 1, c2 - c1 - 1)), stop) || !parseFloat(trim(item.substr(c2 + 1)), step) ||
+         step <= 0.0f || stop < start) {
+         return false;
+     }
+
+     int count = static_cast<int>(floorf((stop - start) / step + 1e-4f)) + 1;
+     for (int i = 0; i < count; i++) {
+         char buffer[32];
+         snprintf(buffer, sizeof(buffer), "%g", start + i * step);
+         out.push_back(buffer);
+     }
+     return true;
+ }
+
+ // "uniform(a, b)" ou "normal(moyenne, écart-type)"
+ bool parseDistribution(const std::string& text, SweepDistribution& dist) {
+     size_t open = text.find('(');
+     size_t comma = text.find(',', open);
+     size_t close = text.find(')', comma);
+     if (open == std::string::npos || comma == std::string::npos || close == std::string::npos) return false;
+
+     std::string kind = trim(text.substr(0, open));
+     if (kind == "uniform") dist.kind = SweepDistribution::UNIFORM;
+     else if (kind == "normal") dist.kind = SweepDistribution::NORMAL;
+     else return false;
+
+     return parseFloat(trim(text.substr(open + 1, comma - open - 1)), dist.a) &&
+            parseFloat(trim(text.substr(comma + 1, close - comma - 1)), dist.b) &&
+            (dist.kind == SweepDistribution::UNIFORM ? dist.b >= dist.a : dist.b >= 0.0f);
+ }
+
+ }  // namespace
+
+ size_t SweepSpec::combinationCount() const {
+     size_t n = 1;
+     for (const SweepAxis& axis : axes) n *= axis.values.size();
+     return n;
+ }
+
+ bool applySweepParam(RideSpec& ride, const std::string& name, const std::string& value) {
+     float v = 0.0f;
+     bool numeric = parseFloat(value, v);
+
+     if (name == "mode") return parseMode(value, ride.mode);
+     if (name == "rider") return parseRider(value, ride.rider.mode);
+     if (!numeric) return false;
+
+     if (name == "instruction")          ride.instruction = v;
+     else if (name == "ramp")            ride.rampRate = v;
+     else if (name == "gain")            ride.linearGain = v;
+     else if (name == "alpha")           ride.cadenceAlpha = v;
+     else if (name == "beta")            ride.cadenceBeta = v;
+     else if (name == "cutoff")          ride.currentCutoffHz = v;
+     else if (name == "screen_baud")     ride.screenBaud = static_cast<uint32_t>(v);
+     else if (name == "rider_torque")    ride.rider.meanTorque = v;
+     else if (name == "rider_cadence")   ride.rider.targetCadence = v;
+     else if (name == "rider_variation") ride.riderVariation = v;
+     else if (name == "duration")        ride.durationS = v;
+     else if (name == "settle")          ride.settleS = v;
+     else if (name == "loop_ms")         ride.loopPeriodMs = static_cast<uint32_t>(v > 1.0f ? v : 1.0f);
+     else if (name == "kt_error")        ride.ktError = v;
+     else if (name == "cadence_noise")   ride.cadenceNoiseRpm = (v > 0.0f) ? v : 0.0f;
+     else if (name == "dropout")         ride.frameLossRate = (v < 0.0f) ? 0.0f : (v > 1.0f ? 1.0f : v);
+     else if (name == "latency_ms")      ride.latencyUs = static_cast<uint32_t>(v > 0.0f ? v * 1000.0f : 0.0f);
+     else if (name == "jitter_ms")       ride.jitterUs = static_cast<uint32_t>(v > 0.0f ? v * 1000.0f : 0.0f);
+     else return false;
+     return true;
+ }
+
+ bool parseSweepSpec(const char* path, SweepSpec& spec, std::string& error) {
+     spec.axes.clear();
+     spec.perturbations.clear();
+     spec.repeats = 1;
+     spec.seed = 1;
+
+     FILE* f = fopen(path, "r");
+     if (!f) {
+         error = std::string("impossible d'ouvrir ") + path;
+         return false;
+     }
+
+     char line[512];
+     int lineNumber = 0;
+     bool ok = true;
+     while (ok && fgets(line, sizeof(line), f)) {
+         lineNumber++;
+         std::string text(line);
+         size_t hash = text.find('#');
+         if (hash != std::string::npos) text.resize(hash);
+         text = trim(text);
+         if (text.empty()) continue;
+
+         size_t eq = text.find_first_of("=~");
+         std::string name = (eq != std::string::npos) ? trim(text.substr(0, eq)) : "";
+         if (name.empty()) {
+             error = "ligne " + std::to_string(lineNumber) + " : \"nom = valeurs\" ou \"nom ~ loi\" attendu";
+             ok = false;
+             break;
+         }
+         std::string values = trim(text.substr(eq + 1));
+
+         if (text[eq] == '~') {
+             if (name == "screen_baud") {
+                 error = "ligne " + std::to_string(lineNumber) + " : screen_baud se déclare comme axe (=), pas comme loi";
+                 ok = false;
+                 break;
+             }
+             SweepDistribution dist;
+             dist.name = name;
+             RideSpec probe = defaultRideSpec();
+             if (!parseDistribution(values, dist) || !applySweepParam(probe, name, "0")) {
+                 error = "ligne " + std::to_string(lineNumber) + " : loi invalide pour " + name;
+                 ok = false;
+                 break;
+             }
+             spec.perturbations.push_back(dist);
+             continue;
+         }
+
+         if (name == "repeats" || name == "seed") {
+             unsigned long long n = strtoull(values.c_str(), nullptr, 10);
+             if (name == "repeats") spec.repeats = n ? static_cast<uint32_t>(n) : 1;
+             else spec.seed = n;
+             continue;
+         }
+
+         SweepAxis axis;
+         axis.name = name;
+         size_t start = 0;
+         while (start <= values.size()) {
+             size_t comma = values.find(',', start);
+             if (comma == std::string::npos) comma = values.size();
+             std::string item = trim(values.substr(start, comma - start));
+             if (!item.empty() && !expandItem(item, axis.values)) {
+                 error = "ligne " + std::to_string(lineNumber) + " : intervalle invalide \"" + item + "\"";
+                 ok = false;
+                 break;
+             }
+             start = comma + 1;
+         }
+         if (!ok) break;
+
+         // Chaque valeur est vérifiée tout de suite : une faute de frappe ne coûte pas un balayage entier
+         RideSpec probe = defaultRideSpec();
+         for (const std::string& v : axis.values) {
+             if (!applySweepParam(probe, name, v)) {
+                 error = "ligne " + std::to_string(lineNumber) + " : " + name + " = \"" + v + "\" invalide";
+                 ok = false;
+                 break;
+             }
+         }
+         if (ok && axis.values.empty()) {
+             error = "ligne " + std::to_string(lineNumber) + " : aucune valeur";
+             ok = false;
+         }
+         if (ok && name == "screen_baud") {
+             bool hasTarget = false;
+             for (const std::string& v : axis.values) {
+                 if (strtoul(v.c_str(), nullptr, 10) == TARGET_SCREEN_BAUD) hasTarget = true;
+             }
+             if (!hasTarget) axis.values.push_back(std::to_string(TARGET_SCREEN_BAUD));
+         }
+         if (ok) spec.axes.push_back(axis);
+     }
+
+     fclose(f);
+     return ok;
+ }
+
+ const std::string& sweepAxisValue(const SweepSpec& spec, size_t combination, size_t axis)
+ // Indice mixte : le dernier axe du fichier varie le plus vite
+ {
+     size_t stride = 1;
+     for (size_t a = spec.axes.size(); a-- > axis + 1;) stride *= spec.axes[a].values.size();
+     const std::vector<std::string>& values = spec.axes[axis].values;
+     return values[(combination / stride) % values.size()];
+ }
+
+ uint64_t sweepRunSeed(uint64_t baseSeed, size_t run)
+ // splitmix64 : graines bien dispersées même pour des numéros de sortie consécutifs
+ {
+     uint64_t z = baseSeed + 0x9E3779B97F4A7C15ull * (run + 1);
+     z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+     z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+     return z ^ (z >> 31);
+ }
+
+ RideSpec sweepRideSpec(const SweepSpec& spec, size_t run, std::vector<float>* sampled) {
+     RideSpec ride = defaultRideSpec();
+     size_t combination = run / spec.repeats;
+     bool instructionSet = false;
+     for (size_t a = 0; a < spec.axes.size(); a++) {
+         applySweepParam(ride, spec.axes[a].name, sweepAxisValue(spec, combination, a));
+         if (spec.axes[a].name == "instruction") instructionSet = true;
+     }
+     // Sans axe "instruction", chaque mode garde une consigne à son échelle (tr/min, Nm, W)
+     if (!instructionSet) ride.instruction = defaultRideInstruction(ride.mode);
+     ride.seed = sweepRunSeed(spec.seed, run);
+
+     // Flux aléatoire distinct de celui du cycliste (runRide) mais issu de la même graine
+     std::mt19937_64 rng(ride.seed ^ 0x7065727475726245ull);
+     if (sampled) sampled->clear();
+     for (const SweepDistribution& dist : spec.perturbations) {
+         float v = (dist.kind == SweepDistribution::UNIFORM)
+                       ? std::uniform_real_distribution<float>(dist.a, dist.b)(rng)
+                       : std::normal_distribution<float>(dist.a, dist.b)(rng);
+         char buffer[32];
+         snprintf(buffer, sizeof(buffer), "%.9g", v);
+         applySweepParam(ride, dist.name, buffer);
+         if (sampled) sampled->push_back(v);
+     }
+     return ride;
+ }
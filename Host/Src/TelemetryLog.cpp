@@ -0,0 +1,283 @@
+/*
+ * TelemetryLog.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #include "TelemetryLog.hpp"
+ #include "WorkStealingPool.hpp"
+
+ #include <algorithm>
+ #include <atomic>
+ #include <cstddef>
+ #include <cstring>
+ #include <fcntl.h>
+ #include <sys/mman.h>
+ #include <sys/stat.h>
+ #include <unistd.h>
+
+ static const size_t BLOCKS_PER_TASK = 64;  // ~256 Ko par tâche : le coût de la file reste négligeable
+ static const uint32_t CRC_OFFSET = offsetof(LogBlockHeader, crc);
+
+ void TelemetryColumns::resize(size_t n) {
+     sessionId.resize(n);
+     tickMs.resize(n);
+     setpoint.resize(n);
+     cadence.resize(n);
+     current.resize(n);
+     appliedCurrent.resize(n);
+     dutyCycle.resize(n);
+     inputVoltage.resize(n);
+     mode.resize(n);
+     flags.resize(n);
+     faults.resize(n);
+ }
+
+ // --- CRC32 par tranches de 8 (slicing-by-8) ---
+
+ struct CrcTables {
+     uint32_t t[8][256];
+
+     CrcTables() {
+         for (uint32_t i = 0; i < 256; i++) {
+             uint32_t crc = i;
+             for (int bit = 0; bit < 8; bit++) crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+             t[0][i] = crc;
+         }
+         for (uint32_t i = 0; i < 256; i++) {
+             for (int k = 1; k < 8; k++) t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xFFu];
+         }
+     }
+ };
+
+ static const CrcTables crcTables;
+
+ uint32_t telemetryLogCrc32(const uint8_t* data, size_t len, uint32_t crc) {
+     const uint32_t (*t)[256] = crcTables.t;
+     while (len >= 8) {
+         uint32_t lo, hi;
+         memcpy(&lo, data, 4);
+         memcpy(&hi, data + 4, 4);
+         lo ^= crc;
+         crc = t[7][lo & 0xFFu] ^ t[6][(lo >> 8) & 0xFFu] ^ t[5][(lo >> 16) & 0xFFu] ^ t[4][lo >> 24] ^
+               t[3][hi & 0xFFu] ^ t[2][(hi >> 8) & 0xFFu] ^ t[1][(hi >> 16) & 0xFFu] ^ t[0][hi >> 24];
+         data += 8;
+         len -= 8;
+     }
+     while (len--) crc = (crc >> 8) ^ t[0][(crc ^ *data++) & 0xFFu];
+     return ~crc;
+ }
+
+ static bool blockCrcMatches(const uint8_t* block, uint32_t expected) {
+     static const uint8_t zero[4] = {0, 0, 0, 0};
+     uint32_t crc = telemetryLogCrc32(block, CRC_OFFSET);
+     crc = telemetryLogCrc32(zero, sizeof(zero), ~crc);
+     crc = telemetryLogCrc32(block + CRC_OFFSET + 4, LOG_BLOCK_SIZE - CRC_OFFSET - 4, ~crc);
+     return crc == expected;
+ }
+
+ // --- Décodage d'un bloc à sa place dans les colonnes ---
+
+ struct IndexedBlock {
+     const uint8_t* data;
+     LogBlockHeader header;
+     size_t firstSample;
+     bool valid;
+ };
+
+ static bool decodeRaw(const IndexedBlock& block, TelemetryColumns& out) {
+     if (block.header.payloadBytes != block.header.recordCount * sizeof(TelemetrySample)) return false;
+
+     const uint8_t* p = block.data + sizeof(LogBlockHeader);
+     size_t at = block.firstSample;
+     for (uint16_t i = 0; i < block.header.recordCount; i++, at++, p += sizeof(TelemetrySample)) {
+         TelemetrySample s;
+         memcpy(&s, p, sizeof(s));
+         out.tickMs[at] = s.tickMs;
+         out.setpoint[at] = s.setpoint;
+         out.cadence[at] = s.cadence;
+         out.current[at] = s.current;
+         out.appliedCurrent[at] = s.appliedCurrent;
+         out.dutyCycle[at] = s.dutyCycle;
+         out.inputVoltage[at] = s.inputVoltage;
+         out.mode[at] = s.mode;
+         out.flags[at] = s.flags;
+         out.faults[at] = s.faults;
+     }
+     return true;
+ }
+
+ static bool decodeDelta(const IndexedBlock& block, TelemetryColumns& out) {
+     const uint8_t* p = block.data + sizeof(LogBlockHeader);
+     const uint8_t* end = p + block.header.payloadBytes;
+     const float* res = telemetryResolution;
+
+     TelemetryDecoder decoder;
+     TelemetryQuantized q;
+     size_t at = block.firstSample;
+     for (uint16_t i = 0; i < block.header.recordCount; i++, at++) {
+         p = decoder.decode(p, end, q);
+         if (!p) return false;
+         out.tickMs[at] = static_cast<uint32_t>(q.q[TELEMETRY_CH_TICK]);
+         out.setpoint[at] = q.q[TELEMETRY_CH_SETPOINT] * res[TELEMETRY_CH_SETPOINT];
+         out.cadence[at] = q.q[TELEMETRY_CH_CADENCE] * res[TELEMETRY_CH_CADENCE];
+         out.current[at] = q.q[TELEMETRY_CH_CURRENT] * res[TELEMETRY_CH_CURRENT];
+         out.appliedCurrent[at] = q.q[TELEMETRY_CH_APPLIED_CURRENT] * res[TELEMETRY_CH_APPLIED_CURRENT];
+         out.dutyCycle[at] = q.q[TELEMETRY_CH_DUTY] * res[TELEMETRY_CH_DUTY];
+         out.inputVoltage[at] = q.q[TELEMETRY_CH_VOLTAGE] * res[TELEMETRY_CH_VOLTAGE];
+         out.mode[at] = static_cast<uint8_t>(q.q[TELEMETRY_CH_MODE]);
+         out.flags[at] = static_cast<uint8_t>(q.q[TELEMETRY_CH_FLAGS]);
+         out.faults[at] = static_cast<uint8_t>(q.q[TELEMETRY_CH_FAULTS]);
+     }
+     return p == end;
+ }
+
+ static bool decodeBlock(const IndexedBlock& block, TelemetryColumns& out) {
+     bool ok = (block.header.encoding == LOG_ENCODING_DELTA) ? decodeDelta(block, out) : decodeRaw(block, out);
+     if (!ok) return false;
+
+     const size_t first = block.firstSample, last = first + block.header.recordCount;
+     for (size_t at = first; at < last; at++) out.sessionId[at] = block.header.sessionId;
+     return true;
+ }
+
+ // Retire les échantillons des blocs rejetés au décodage (rare : CRC faux sur un en-tête plausible)
+ static size_t compact(std::vector<IndexedBlock>& blocks, TelemetryColumns& out) {
+     size_t write = 0;
+     for (IndexedBlock& block : blocks) {
+         if (!block.valid) continue;
+         const size_t n = block.header.recordCount;
+         if (block.firstSample != write) {
+             const size_t from = block.firstSample;
+             auto move = [&](auto& column) {
+                 memmove(column.data() + write, column.data() + from, n * sizeof(column[0]));
+             };
+             move(out.sessionId); move(out.tickMs); move(out.setpoint); move(out.cadence);
+             move(out.current); move(out.appliedCurrent); move(out.dutyCycle); move(out.inputVoltage);
+             move(out.mode); move(out.flags); move(out.faults);
+             block.firstSample = write;
+         }
+         write += n;
+     }
+     return write;
+ }
+
+ bool decodeTelemetryLog(const uint8_t* data, size_t size, const TelemetryLogOptions& options,
+                         TelemetryColumns& out, TelemetryLogStats& stats)
+ {
+     stats = TelemetryLogStats();
+     stats.fileBytes = size;
+
+     // 1. Index : en-têtes seuls, contrôle de cohérence, place de chaque bloc dans les colonnes
+     std::vector<IndexedBlock> blocks;
+     blocks.reserve(size / LOG_BLOCK_SIZE);
+     size_t total = 0;
+     for (size_t offset = 0; offset + LOG_BLOCK_SIZE <= size; offset += LOG_BLOCK_SIZE) {
+         stats.blocks++;
+         IndexedBlock block;
+         block.data = data + offset;
+         memcpy(&block.header, block.data, sizeof(block.header));
+
+         const LogBlockHeader& h = block.header;
+         bool plausible = h.magic == LOG_BLOCK_MAGIC && h.version == LOG_BLOCK_VERSION &&
+                          h.payloadBytes + h.summaryBytes <= LOG_BLOCK_SIZE - sizeof(LogBlockHeader) &&
+                          (h.encoding == LOG_ENCODING_RAW || h.encoding == LOG_ENCODING_DELTA);
+         if (!plausible) {
+             stats.invalidBlocks++;
+             continue;
+         }
+         if (options.filterSession && h.sessionId != options.session) continue;
+
+         block.firstSample = total;
+         block.valid = true;
+         total += h.recordCount;
+         blocks.push_back(block);
+     }
+     if (size % LOG_BLOCK_SIZE) {
+         stats.blocks++;
+         stats.invalidBlocks++;  // fin de fichier tronquée
+     }
+
+     // 2. Décodage parallèle : chaque bloc écrit sa propre tranche, sans verrou
+     out.resize(total);
+     std::atomic<uint32_t> crcErrors(0), decodeErrors(0);
+     const size_t tasks = (blocks.size() + BLOCKS_PER_TASK - 1) / BLOCKS_PER_TASK;
+     WorkStealingPool pool(options.threads);
+     pool.run(tasks, [&](size_t task, unsigned) {
+         const size_t first = task * BLOCKS_PER_TASK;
+         const size_t last = std::min(first + BLOCKS_PER_TASK, blocks.size());
+         for (size_t i = first; i < last; i++) {
+             IndexedBlock& block = blocks[i];
+             if (options.checkCrc && !blockCrcMatches(block.data, block.header.crc)) {
+                 block.valid = false;
+                 crcErrors++;
+             } else if (!decodeBlock(block, out)) {
+                 block.valid = false;
+                 decodeErrors++;
+             }
+         }
+     });
+     stats.invalidBlocks += crcErrors.load();
+     stats.decodeErrors = decodeErrors.load();
+
+     if (crcErrors.load() || decodeErrors.load()) out.resize(compact(blocks, out));
+
+     // 3. Bilan par séance (les blocs d'une séance se suivent dans le fichier)
+     for (const IndexedBlock& block : blocks) {
+         if (!block.valid) continue;
+         const LogBlockHeader& h = block.header;
+         if (h.encoding == LOG_ENCODING_DELTA) stats.deltaBlocks++;
+         else stats.rawBlocks++;
+         stats.payloadBytes += h.payloadBytes;
+
+         if (stats.sessions.empty() || stats.sessions.back().sessionId != h.sessionId) {
+             stats.sessions.push_back(TelemetryLogSession{h.sessionId, block.firstSample, 0, 0, 0, false, {}});
+         }
+         TelemetryLogSession& session = stats.sessions.back();
+         session.sampleCount += h.recordCount;
+         session.lostSamples += h.lostSamples;
+         session.blocks++;
+         if (h.summaryBytes == sizeof(SessionSummary)) {  // autre taille : format futur, ignoré
+             memcpy(&session.summary, block.data + LOG_BLOCK_SIZE - sizeof(SessionSummary), sizeof(SessionSummary));
+             session.hasSummary = true;
+         }
+     }
+     return stats.invalidBlocks == 0 && stats.decodeErrors == 0;
+ }
+
+ bool loadTelemetryLog(const char* path, const TelemetryLogOptions& options,
+                       TelemetryColumns& out, TelemetryLogStats& stats, std::string& error)
+ {
+     int fd = open(path, O_RDONLY);
+     if (fd < 0) {
+         error = std::string("ouverture impossible : ") + path;
+         return false;
+     }
+     struct stat st;
+     if (fstat(fd, &st) != 0) {
+         close(fd);
+         error = std::string("taille illisible : ") + path;
+         return false;
+     }
+
+     const size_t size = static_cast<size_t>(st.st_size);
+     if (size == 0) {
+         close(fd);
+         out.resize(0);
+         stats = TelemetryLogStats();
+         return true;
+     }
+
+     void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+     close(fd);
+     if (map == MAP_FAILED) {
+         error = std::string("projection mémoire impossible : ") + path;
+         return false;
+     }
+     madvise(map, size, MADV_SEQUENTIAL);
+
+     decodeTelemetryLog(static_cast<const uint8_t*>(map), size, options, out, stats);
+     munmap(map, size);
+     return true;
+ }
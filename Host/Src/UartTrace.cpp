@@ -0,0 +1,275 @@
+/*
+ * UartTrace.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #include "../Inc/UartTrace.hpp"
+
+ #include <cstring>
+ #include <unistd.h>
+
+ static const uint8_t TRACE_MAGIC[4] = {'E', 'R', 'G', 'T'};
+ static const uint8_t TRACE_VERSION = 1;
+
+ static const uint8_t RECORD_DATA = 0x00;
+ static const uint8_t RECORD_BLOB = 0x40;
+ static const uint8_t RECORD_TYPE_MASK = 0xC0;
+ static const uint8_t RECORD_RX = 0x20;
+ static const uint8_t RECORD_LINK_MASK = 0x0F;
+
+ // --- Écriture ---
+
+ TraceWriter::TraceWriter() : file(nullptr), lastTimeUs(0), bytesWritten(0) {}
+
+ TraceWriter::~TraceWriter() {
+     close();
+ }
+
+ uint8_t TraceWriter::addLink(const char* name) {
+     links.push_back(name);
+     return static_cast<uint8_t>(links.size() - 1);
+ }
+
+ bool TraceWriter::open(const char* path) {
+     close();
+     if (links.size() > RECORD_LINK_MASK + 1u) return false;
+
+     file = fopen(path, "wb");
+     if (!file) return false;
+
+     lastTimeUs = 0;
+     bytesWritten = 0;
+     for (uint8_t b : TRACE_MAGIC) put(b);
+     put(TRACE_VERSION);
+     put(static_cast<uint8_t>(links.size()));
+     for (const std::string& name : links) {
+         put(static_cast<uint8_t>(name.size()));
+         for (char c : name) put(static_cast<uint8_t>(c));
+     }
+     return true;
+ }
+
+ void TraceWriter::close() {
+     if (file) fclose(file);
+     file = nullptr;
+ }
+
+ void TraceWriter::put(uint8_t byte) {
+     fputc(byte, file);
+     bytesWritten++;
+ }
+
+ void TraceWriter::putVarint(uint64_t value) {
+     while (value >= 0x80) {
+         put(static_cast<uint8_t>(value | 0x80));
+         value >>= 7;
+     }
+     put(static_cast<uint8_t>(value));
+ }
+
+ void TraceWriter::writeBlob(const uint8_t* data, uint32_t len) {
+     if (!file) return;
+     put(RECORD_BLOB);
+     putVarint(0);
+     putVarint(len);
+     if (len) fwrite(data, 1, len, file);
+     bytesWritten += len;
+     fflush(file);
+ }
+
+ void TraceWriter::record(uint8_t link, TraceDirection direction, uint64_t timeUs, const uint8_t* data, uint16_t len) {
+     if (!file || len == 0) return;
+
+     put(static_cast<uint8_t>(RECORD_DATA | (direction == TraceDirection::RX ? RECORD_RX : 0) | (link & RECORD_LINK_MASK)));
+     putVarint(timeUs >= lastTimeUs ? timeUs - lastTimeUs : 0);
+     putVarint(len);
+     fwrite(data, 1, len, file);
+     bytesWritten += len;
+     lastTimeUs = timeUs;
+
+     // Vidé à chaque salve : une expiration du chien de garde (abort) ne perd pas la fin de la trace
+     fflush(file);
+ }
+
+ // --- Lecture ---
+
+ namespace {
+
+ struct Cursor {
+     const std::vector<uint8_t>& bytes;
+     size_t pos;
+
+     bool get(uint8_t& b) {
+         if (pos >= bytes.size()) return false;
+         b = bytes[pos++];
+         return true;
+     }
+
+     bool getVarint(uint64_t& value) {
+         value = 0;
+         for (int shift = 0; shift < 64; shift += 7) {
+             uint8_t b;
+             if (!get(b)) return false;
+             value |= static_cast<uint64_t>(b & 0x7F) << shift;
+             if (!(b & 0x80)) return true;
+         }
+         return false;
+     }
+ };
+
+ }  // namespace
+
+ bool TraceReader::load(const char* path, std::string& error) {
+     links.clear();
+     records.clear();
+     blob.clear();
+
+     FILE* f = fopen(path, "rb");
+     if (!f) {
+         error = std::string("impossible d'ouvrir ") + path;
+         return false;
+     }
+     std::vector<uint8_t> bytes;
+     uint8_t chunk[4096];
+     size_t n;
+     while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) bytes.insert(bytes.end(), chunk, chunk + n);
+     fclose(f);
+
+     Cursor c = {bytes, 0};
+     uint8_t version, linkCount;
+     if (bytes.size() < 6 || memcmp(bytes.data(), TRACE_MAGIC, 4) != 0) {
+         error = "pas une trace ERGT";
+         return false;
+     }
+     c.pos = 4;
+     c.get(version);
+     if (version != TRACE_VERSION || !c.get(linkCount)) {
+         error = "version de trace non gérée";
+         return false;
+     }
+     for (uint8_t i = 0; i < linkCount; i++) {
+         uint8_t len, ch;
+         std::string name;
+         if (!c.get(len)) break;
+         for (uint8_t k = 0; k < len && c.get(ch); k++) name.push_back(static_cast<char>(ch));
+         links.push_back(name);
+     }
+
+     uint64_t timeUs = 0;
+     uint8_t header;
+     while (c.get(header)) {
+         uint64_t delta, len;
+         // Une fin tronquée (coupure pendant l'enregistrement) garde tout ce qui précède
+         if (!c.getVarint(delta) || !c.getVarint(len) || c.pos + len > bytes.size()) break;
+         timeUs += delta;
+
+         const uint8_t* data = bytes.data() + c.pos;
+         c.pos += len;
+
+         if ((header & RECORD_TYPE_MASK) == RECORD_BLOB) {
+             blob.assign(data, data + len);
+         } else if ((header & RECORD_TYPE_MASK) == RECORD_DATA) {
+             TraceRecord r;
+             r.timeUs = timeUs;
+             r.link = header & RECORD_LINK_MASK;
+             r.direction = (header & RECORD_RX) ? TraceDirection::RX : TraceDirection::TX;
+             r.data.assign(data, data + len);
+             records.push_back(std::move(r));
+         }
+     }
+     return true;
+ }
+
+ int TraceReader::findLink(const char* name) const {
+     for (size_t i = 0; i < links.size(); i++) {
+         if (links[i] == name) return static_cast<int>(i);
+     }
+     return -1;
+ }
+
+ // --- Enregistrement ---
+
+ RecordingUartDevice::RecordingUartDevice(HostUartDevice& dev, TraceWriter& w, uint8_t id)
+     : inner(dev), writer(w), link(id) {}
+
+ bool RecordingUartDevice::write(const uint8_t* data, uint16_t len) {
+     bool ok = inner.write(data, len);
+     // Horodaté à la fin de l'émission : le rejeu reproduit le temps passé dans un write() bloquant (9600 bauds)
+     writer.record(link, TraceDirection::TX, hostClockMicros(), data, len);
+     return ok;
+ }
+
+ uint16_t RecordingUartDevice::read(uint8_t* data, uint16_t len, uint32_t timeoutMs) {
+     uint16_t n = inner.read(data, len, timeoutMs);
+     writer.record(link, TraceDirection::RX, hostClockMicros(), data, n);  // horodaté à la disponibilité
+     return n;
+ }
+
+ // --- Rejeu ---
+
+ ReplayUartDevice::ReplayUartDevice(const TraceReader& trace, uint8_t link)
+     : txOffset(0), comparedBytes(0), mismatches(0), divergence{false, 0, 0, 0, 0}
+ {
+     for (const TraceRecord& r : trace.getRecords()) {
+         if (r.link != link) continue;
+         if (r.direction == TraceDirection::RX) {
+             for (uint8_t b : r.data) rxQueue.push_back({r.timeUs, b});
+         } else {
+             expectedTx.insert(expectedTx.end(), r.data.begin(), r.data.end());
+             txDoneUs.insert(txDoneUs.end(), r.data.size(), r.timeUs);
+         }
+     }
+ }
+
+ bool ReplayUartDevice::write(const uint8_t* data, uint16_t len) {
+     for (uint16_t i = 0; i < len; i++) {
+         int expected = (txOffset < expectedTx.size()) ? expectedTx[txOffset] : -1;
+         if (expected != data[i]) {
+             mismatches++;
+             if (!divergence.diverged) {
+                 divergence = {true, hostClockMicros(), comparedBytes, expected, data[i]};
+             }
+         }
+         if (txOffset < expectedTx.size()) txOffset++;
+         comparedBytes++;
+     }
+
+     // Même durée d'émission qu'à l'enregistrement
+     if (txOffset > 0) waitUntil(txDoneUs[txOffset - 1]);
+     return true;
+ }
+
+ void ReplayUartDevice::waitUntil(uint64_t timeUs) {
+     uint64_t now = hostClockMicros();
+     if (timeUs <= now) return;
+     if (hostClockGetMode() == HostClockMode::SIMULATED) hostClockAdvanceMicros(timeUs - now);
+     else usleep(static_cast<useconds_t>(timeUs - now));
+ }
+
+ uint16_t ReplayUartDevice::read(uint8_t* data, uint16_t len, uint32_t timeoutMs) {
+     if (rxQueue.empty() || len == 0) {
+         if (hostClockGetMode() == HostClockMode::REALTIME) usleep(timeoutMs * 1000u);
+         return 0;
+     }
+
+     uint64_t now = hostClockMicros();
+     uint64_t ready = rxQueue.front().timeUs;
+     if (ready > now) {
+         uint64_t waitUs = ready - now;
+         if (waitUs > static_cast<uint64_t>(timeoutMs) * 1000u) {
+             if (hostClockGetMode() == HostClockMode::REALTIME) usleep(timeoutMs * 1000u);
+             return 0;  // en simulé, HAL_UART_Receive avance lui-même le temps du timeout
+         }
+         waitUntil(ready);
+         now = ready;
+     }
+
+     uint16_t n = 0;
+     while (n < len && !rxQueue.empty() && rxQueue.front().timeUs <= now) {
+         data[n++] = rxQueue.front().value;
+         rxQueue.pop_front();
+     }
+     return n;
+ }
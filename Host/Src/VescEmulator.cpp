@@ -0,0 +1,320 @@
+/*
+ * VescEmulator.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #include "../Inc/VescEmulator.hpp"
+
+ #include <cmath>
+ #include <cstring>
+ #include <unistd.h>
+
+ // COMM_PACKET_ID du firmware VESC (bldc, datatypes.h), repris de la source et non de VESCInterface.cpp :
+ // un identifiant faux côté firmware apparaît ainsi comme une commande inattendue
+ #define COMM_GET_VALUES     4
+ #define COMM_SET_DUTY       5
+ #define COMM_SET_CURRENT    6
+ #define COMM_SET_CURRENT_BRAKE 7
+ #define COMM_SET_RPM        8
+
+ // --- Modèle moteur simple ---
+
+ SimpleMotorParams defaultSimpleMotorParams() {
+     SimpleMotorParams p;
+     p.torqueConstant = 0.39f / 1.95f;  // mesure de MotorController.cpp : 1.95 A → 0.39 Nm
+     p.polePairs = 1.0f;                // même valeur par défaut que defaultConditioningConfig()
+     p.resistance = 0.1f;
+     p.inertia = 0.002f;
+     p.viscous = 1e-4f;
+     p.coulomb = 0.02f;
+     p.batteryVoltage = 36.0f;
+     p.currentLimit = 20.0f;
+     p.speedKp = 0.5f;
+     p.ambientTemp = 25.0f;
+     return p;
+ }
+
+ SimpleMotorPlant::SimpleMotorPlant(const SimpleMotorParams& p)
+     : params(p), state{0.0f, 0.0f, 0.0f, 0.0f, p.batteryVoltage, p.ambientTemp, p.ambientTemp}, omega(0.0f) {}
+
+ void SimpleMotorPlant::step(const VescCommand& cmd, float dt) {
+     float current;
+     if (cmd.mode == VescCommand::RPM) {
+         float target = cmd.erpm / params.polePairs * 2.0f * static_cast<float>(M_PI) / 60.0f;
+         current = params.speedKp * (target - omega);
+     } else {
+         current = cmd.current;
+     }
+
+     // Limites du VESC : courant max puis tension disponible (|Ke·ω + R·I| ≤ Vbatt)
+     if (current > params.currentLimit) current = params.currentLimit;
+     if (current < -params.currentLimit) current = -params.currentLimit;
+     float bemf = params.torqueConstant * omega;
+     float iMax = (params.batteryVoltage - bemf) / params.resistance;
+     float iMin = (-params.batteryVoltage - bemf) / params.resistance;
+     if (current > iMax) current = iMax;
+     if (current < iMin) current = iMin;
+
+     float drive = params.torqueConstant * current;
+     float friction = params.viscous * omega;
+     if (omega > 1e-3f) friction += params.coulomb;
+     else if (omega < -1e-3f) friction -= params.coulomb;
+     else if (fabsf(drive) <= params.coulomb) drive = 0.0f;  // adhérence : ne démarre pas
+     else friction += (drive > 0.0f) ? params.coulomb : -params.coulomb;
+
+     omega += (drive - friction) / params.inertia * dt;
+
+     float duty = (bemf + params.resistance * current) / params.batteryVoltage;
+     if (duty > 1.0f) duty = 1.0f;
+     if (duty < -1.0f) duty = -1.0f;
+
+     // Échauffement du premier ordre : pertes Joule, Rth = 1 K/W, Cth = 500 J/K (FET : moitié)
+     float joule = current * current * params.resistance;
+     state.tempMotor += (joule - (state.tempMotor - params.ambientTemp)) / 500.0f * dt;
+     state.tempFet += (0.5f * joule - (state.tempFet - params.ambientTemp)) / 250.0f * dt;
+
+     state.erpm = omega * 60.0f / (2.0f * static_cast<float>(M_PI)) * params.polePairs;
+     state.motorCurrent = current;
+     state.inputCurrent = duty * current;
+     state.dutyCycle = duty;
+     state.inputVoltage = params.batteryVoltage;
+ }
+
+ // --- Liaison ---
+
+ VescLinkConfig defaultVescLinkConfig() {
+     VescLinkConfig cfg;
+     cfg.latencyUs = 200;
+     cfg.jitterUs = 0;
+     cfg.baudRate = 115200;  // même débit que MX_USART3_UART_Init
+     cfg.byteLossRate = 0.0f;
+     cfg.byteCorruptRate = 0.0f;
+     cfg.frameLossRate = 0.0f;
+     cfg.seed = 1;
+     return cfg;
+ }
+
+ VescEmulator::VescEmulator(VescPlant& p, const VescLinkConfig& cfg)
+     : plant(p),
+       link(cfg),
+       command{VescCommand::CURRENT, 0.0f, 0.0f},
+       stats{},
+       plantTimeUs(0),
+       started(false),
+       frameLen(0),
+       lineFreeUs(0),
+       rng(cfg.seed) {}
+
+ void VescEmulator::setLinkConfig(const VescLinkConfig& cfg) {
+     link = cfg;
+     rng.seed(cfg.seed);
+ }
+
+ uint16_t VescEmulator::crc16(const uint8_t* data, uint16_t len)
+ // CRC-16/XMODEM (poly 0x1021) bit à bit : volontairement indépendant de VESCInterface::crc16
+ {
+     uint16_t crc = 0;
+     for (uint16_t i = 0; i < len; i++) {
+         crc ^= static_cast<uint16_t>(data[i]) << 8;
+         for (uint8_t bit = 0; bit < 8; bit++) {
+             crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+         }
+     }
+     return crc;
+ }
+
+ void VescEmulator::advanceTo(uint64_t nowUs) {
+     if (!started) {
+         plantTimeUs = nowUs;
+         started = true;
+     }
+     while (plantTimeUs + PLANT_STEP_US <= nowUs) {
+         plant.step(command, PLANT_STEP_US * 1e-6f);
+         plantTimeUs += PLANT_STEP_US;
+     }
+ }
+
+ bool VescEmulator::write(const uint8_t* data, uint16_t len) {
+     advanceTo(hostClockMicros());
+     for (uint16_t i = 0; i < len; i++) handleByte(data[i]);
+     return true;
+ }
+
+ void VescEmulator::handleByte(uint8_t byte) {
+     if (frameLen == 0 && byte != 2) {  // attente du start byte
+         stats.framingErrors++;
+         return;
+     }
+
+     frame[frameLen++] = byte;
+     if (frameLen < 2) return;
+
+     uint16_t expected = frame[1] + 5;  // start + len + payload + CRC16 + stop
+     if (frameLen < expected) return;
+
+     frameLen = 0;
+     const uint8_t* payload = &frame[2];
+     uint8_t len = frame[1];
+
+     if (frame[expected - 1] != 3) {
+         stats.framingErrors++;
+         return;
+     }
+     uint16_t crc = (frame[2 + len] << 8) | frame[3 + len];
+     if (crc16(payload, len) != crc) {
+         stats.crcErrors++;
+         return;
+     }
+
+     stats.framesReceived++;
+     handlePayload(payload, len);
+ }
+
+ static int32_t readInt32BE(const uint8_t* p) {
+     return static_cast<int32_t>((static_cast<uint32_t>(p[0]) << 24) | (p[1] << 16) | (p[2] << 8) | p[3]);
+ }
+
+ void VescEmulator::handlePayload(const uint8_t* payload, uint8_t len) {
+     if (len == 0) return;
+
+     switch (payload[0]) {
+         case COMM_SET_CURRENT:
+             if (len < 5) break;
+             command.mode = VescCommand::CURRENT;
+             command.current = readInt32BE(&payload[1]) / 1000.0f;  // mA → A
+             break;
+
+         case COMM_SET_RPM:
+             if (len < 5) break;
+             command.mode = VescCommand::RPM;
+             command.erpm = static_cast<float>(readInt32BE(&payload[1]));
+             break;
+
+         case COMM_GET_VALUES:
+             sendValues();
+             break;
+
+         case COMM_SET_DUTY:
+         case COMM_SET_CURRENT_BRAKE:
+             stats.unexpectedCommands++;  // commandes réelles du VESC, jamais envoyées par VESCInterface
+             break;
+
+         default:
+             stats.unknownCommands++;
+             break;
+     }
+ }
+
+ static uint8_t* writeInt16BE(uint8_t* p, float value, float scale) {
+     long v = lroundf(value * scale);
+     if (v > INT16_MAX) v = INT16_MAX;
+     if (v < INT16_MIN) v = INT16_MIN;
+     *p++ = static_cast<uint8_t>(v >> 8);
+     *p++ = static_cast<uint8_t>(v);
+     return p;
+ }
+
+ static uint8_t* writeInt32BE(uint8_t* p, float value, float scale) {
+     int32_t v = static_cast<int32_t>(lroundf(value * scale));
+     *p++ = static_cast<uint8_t>(v >> 24);
+     *p++ = static_cast<uint8_t>(v >> 16);
+     *p++ = static_cast<uint8_t>(v >> 8);
+     *p++ = static_cast<uint8_t>(v);
+     return p;
+ }
+
+ void VescEmulator::sendValues()
+ // Format du firmware VESC (bldc, commands.c, COMM_GET_VALUES) : entiers big-endian en virgule fixe.
+ // Écrit d'après le protocole, pas d'après VESCInterface : c'est ce qui permet de vérifier son décodage.
+ {
+     VescPlantState s = plant.getState();
+     uint8_t payload[64];
+     uint8_t* ptr = payload;
+     *ptr++ = COMM_GET_VALUES;
+
+     ptr = writeInt16BE(ptr, s.tempFet, 10.0f);
+     ptr = writeInt16BE(ptr, s.tempMotor, 10.0f);
+     ptr = writeInt32BE(ptr, s.motorCurrent, 100.0f);
+     ptr = writeInt32BE(ptr, s.inputCurrent, 100.0f);
+     ptr = writeInt32BE(ptr, 0.0f, 100.0f);            // Id : commande FOC sans défluxage
+     ptr = writeInt32BE(ptr, s.motorCurrent, 100.0f);  // Iq : tout le courant moteur produit du couple
+     ptr = writeInt16BE(ptr, s.dutyCycle, 1000.0f);
+     ptr = writeInt32BE(ptr, s.erpm, 1.0f);
+     ptr = writeInt16BE(ptr, s.inputVoltage, 10.0f);
+     for (int i = 0; i < 4; i++) ptr = writeInt32BE(ptr, 0.0f, 10000.0f);  // Ah, Ah rechargés, Wh, Wh rechargés
+     ptr = writeInt32BE(ptr, 0.0f, 1.0f);  // tachymètre
+     ptr = writeInt32BE(ptr, 0.0f, 1.0f);  // tachymètre absolu
+     *ptr++ = 0;                           // code de défaut : FAULT_CODE_NONE
+
+     sendReply(payload, static_cast<uint8_t>(ptr - payload));
+ }
+
+ void VescEmulator::sendReply(const uint8_t* payload, uint8_t len) {
+     uint8_t out[264];
+     uint16_t n = 0;
+     out[n++] = 2;
+     out[n++] = len;
+     memcpy(&out[n], payload, len);
+     n += len;
+     uint16_t crc = crc16(payload, len);
+     out[n++] = static_cast<uint8_t>(crc >> 8);
+     out[n++] = static_cast<uint8_t>(crc);
+     out[n++] = 3;
+
+     std::uniform_real_distribution<float> chance(0.0f, 1.0f);
+     if (link.frameLossRate > 0.0f && chance(rng) < link.frameLossRate) {
+         stats.repliesDropped++;
+         return;
+     }
+
+     uint64_t now = hostClockMicros();
+     uint64_t start = now + link.latencyUs;
+     if (link.jitterUs > 0) start += std::uniform_int_distribution<uint32_t>(0, link.jitterUs)(rng);
+     if (start < lineFreeUs) start = lineFreeUs;  // la ligne est encore occupée par la réponse précédente
+
+     uint64_t byteUs = link.baudRate ? (10000000ull / link.baudRate) : 0;  // 10 bits par octet (8N1)
+
+     for (uint16_t i = 0; i < n; i++) {
+         uint64_t ready = start + (i + 1) * byteUs;
+         lineFreeUs = ready;
+
+         if (link.byteLossRate > 0.0f && chance(rng) < link.byteLossRate) {
+             stats.bytesDropped++;
+             continue;
+         }
+         uint8_t value = out[i];
+         if (link.byteCorruptRate > 0.0f && chance(rng) < link.byteCorruptRate) {
+             value ^= static_cast<uint8_t>(1u << std::uniform_int_distribution<int>(0, 7)(rng));
+             stats.bytesCorrupted++;
+         }
+         txQueue.push_back({ready, value});
+     }
+     stats.repliesSent++;
+ }
+
+ uint16_t VescEmulator::read(uint8_t* data, uint16_t len, uint32_t timeoutMs) {
+     uint64_t now = hostClockMicros();
+     advanceTo(now);
+     if (txQueue.empty() || len == 0) return 0;
+
+     uint64_t ready = txQueue.front().readyUs;
+     if (ready > now) {
+         uint64_t waitUs = ready - now;
+         if (waitUs > static_cast<uint64_t>(timeoutMs) * 1000u) {
+             if (hostClockGetMode() == HostClockMode::REALTIME) usleep(timeoutMs * 1000u);
+             return 0;  // en simulé, HAL_UART_Receive avance lui-même le temps du timeout
+         }
+         if (hostClockGetMode() == HostClockMode::SIMULATED) hostClockAdvanceMicros(waitUs);
+         else usleep(static_cast<useconds_t>(waitUs));
+         now = ready;
+     }
+
+     uint16_t n = 0;
+     while (n < len && !txQueue.empty() && txQueue.front().readyUs <= now) {
+         data[n++] = txQueue.front().value;
+         txQueue.pop_front();
+     }
+     return n;
+ }
@@ -0,0 +1,68 @@
+/*
+ * WorkStealingPool.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #include "../Inc/WorkStealingPool.hpp"
+
+ #include <thread>
+
+ WorkStealingPool::WorkStealingPool(unsigned threads)
+     : threadCount(threads ? threads : std::thread::hardware_concurrency()),
+       queues(threadCount ? threadCount : 1),
+       steals(0)
+ {
+     if (threadCount == 0) threadCount = 1;
+ }
+
+ bool WorkStealingPool::popLocal(unsigned worker, size_t& index) {
+     WorkQueue& q = queues[worker];
+     std::lock_guard<std::mutex> guard(q.lock);
+     if (q.items.empty()) return false;
+     index = q.items.back();
+     q.items.pop_back();
+     return true;
+ }
+
+ bool WorkStealingPool::steal(unsigned thief, size_t& index)
+ // Victimes parcourues à partir du voisin : pas de point chaud sur la file 0
+ {
+     for (unsigned k = 1; k < threadCount; k++) {
+         WorkQueue& q = queues[(thief + k) % threadCount];
+         std::lock_guard<std::mutex> guard(q.lock);
+         if (q.items.empty()) continue;
+         index = q.items.front();
+         q.items.pop_front();
+         steals++;
+         return true;
+     }
+     return false;
+ }
+
+ void WorkStealingPool::workerLoop(unsigned worker, const Task& task) {
+     size_t index;
+     // Aucune tâche n'en crée d'autres : toutes les files vides = lot terminé
+     while (popLocal(worker, index) || steal(worker, index)) {
+         task(index, worker);
+     }
+ }
+
+ void WorkStealingPool::run(size_t count, const Task& task) {
+     steals = 0;
+
+     // Blocs contigus : le début du lot est dépilé en dernier par son propriétaire, volé en premier
+     for (unsigned w = 0; w < threadCount; w++) {
+         size_t begin = count * w / threadCount;
+         size_t end = count * (w + 1) / threadCount;
+         for (size_t i = begin; i < end; i++) queues[w].items.push_back(i);
+     }
+
+     std::vector<std::thread> threads;
+     for (unsigned w = 1; w < threadCount; w++) {
+         threads.emplace_back(&WorkStealingPool::workerLoop, this, w, std::cref(task));
+     }
+     workerLoop(0, task);  // le thread appelant travaille aussi
+     for (std::thread& t : threads) t.join();
+ }
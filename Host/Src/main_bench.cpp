@@ -0,0 +1,514 @@
+/*
+ * main_bench.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ /**
+  * Banc de micro-mesures des chemins chauds du firmware, compilé pour Linux.
+  *
+  *   ergo_bench                                   # tableau sur la sortie standard
+  *   ergo_bench -o bench.json                     # résultats en JSON
+  *   ergo_bench --baseline bench.json --threshold 10 -o nouveau.json
+  *   ergo_bench --filter vesc. --time 2
+  *
+  * Chaque mesure est répétée (--samples, 7 par défaut) sur un nombre d'itérations calibré pour
+  * durer --time / samples ; on retient la médiane, le min et le max en ns par opération.
+  * Avec --baseline, une mesure régresse si sa médiane dépasse celle de référence de plus de
+  * --threshold % ET si son meilleur échantillon est lui aussi au-dessus : le bruit d'une machine
+  * chargée ne suffit pas à faire échouer. Code de sortie 1 en cas de régression (intégration continue).
+  *
+  * Les UART sont des extrémités en mémoire : "null" avale les émissions, "canned" rejoue une réponse
+  * capturée une fois sur l'émulateur. On mesure le firmware, pas l'émulateur ; le pas complet du
+  * contrôleur tourne contre VescEmulator et NextionEmulator sans latence ni débit, le modèle
+  * physique étant avancé hors chronométrage. "mock.step" fait le même pas sur MockMotorController
+  * (mocks muets) : le coût de la loi de commande seule, sans encodage ni UART ; "mock.step/recording"
+  * y ajoute le journal en mémoire des mocks (MockMode::RECORDING).
+  *
+  * Compilation (depuis la racine, mêmes options que le firmware mesuré) :
+  *   g++ -std=c++17 -O2 -DERGO_HOST -IHost/Inc -IInc Host/Src/main_bench.cpp Host/Src/HostHal.cpp \
+  *       Host/Src/VescEmulator.cpp Host/Src/NextionEmulator.cpp Host/Src/ErgocyclePlant.cpp Src/MotorController.cpp \
+  *       Src/VESCInterface.cpp Src/ScreenDisplay.cpp Src/MotorComputations.cpp Src/SignalConditioning.cpp \
+  *       Src/KtCalibration.cpp Src/SettingsStore.cpp Src/SafetySupervisor.cpp Src/SessionAnalytics.cpp \
+  *       Src/ResponseTest.cpp Src/DrivetrainParams.cpp -o ergo_bench
+  */
+
+ #include <algorithm>
+ #include <chrono>
+ #include <cmath>
+ #include <cstdio>
+ #include <cstdlib>
+ #include <cstring>
+ #include <functional>
+ #include <string>
+ #include <vector>
+
+ #include "HostHal.hpp"
+ #include "MotorController.hpp"
+ #include "MockMotorController.hpp"
+ #include "VESCInterface.hpp"
+ #include "ScreenDisplay.hpp"
+ #include "MotorComputations.hpp"
+ #include "VescEmulator.hpp"
+ #include "NextionEmulator.hpp"
+ #include "ErgocyclePlant.hpp"
+
+ struct BenchOptions {
+     const char* jsonPath = nullptr;      // "-" = sortie standard (le tableau passe alors sur stderr)
+     const char* baselinePath = nullptr;
+     const char* filter = nullptr;
+     double thresholdPct = 10.0;
+     double timeS = 1.0;                  // par mesure, tous échantillons confondus
+     unsigned samples = 7;
+ };
+
+ static bool parseOptions(int argc, char** argv, BenchOptions& opt) {
+     for (int i = 1; i < argc; i++) {
+         bool hasValue = (i + 1 < argc);
+         if (!strcmp(argv[i], "-o") && hasValue) opt.jsonPath = argv[++i];
+         else if (!strcmp(argv[i], "--baseline") && hasValue) opt.baselinePath = argv[++i];
+         else if (!strcmp(argv[i], "--filter") && hasValue) opt.filter = argv[++i];
+         else if (!strcmp(argv[i], "--threshold") && hasValue) opt.thresholdPct = atof(argv[++i]);
+         else if (!strcmp(argv[i], "--time") && hasValue) opt.timeS = atof(argv[++i]);
+         else if (!strcmp(argv[i], "--samples") && hasValue) opt.samples = strtoul(argv[++i], nullptr, 10);
+         else return false;
+     }
+     return opt.samples > 0 && opt.timeS > 0.0 && opt.thresholdPct >= 0.0;
+ }
+
+ // --- Mesure ---
+
+ static uint64_t nowNs() {
+     return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+         std::chrono::steady_clock::now().time_since_epoch()).count());
+ }
+
+ // Empêche le compilateur de supprimer un calcul dont le résultat n'est pas utilisé
+ template <typename T>
+ static inline void keep(const T& value) {
+     asm volatile("" : : "r,m"(value) : "memory");
+ }
+
+ // Exécute n itérations et renvoie le temps mesuré en ns (le corps peut exclure sa préparation)
+ typedef std::function<uint64_t(uint64_t n)> BenchBody;
+
+ template <typename F>
+ static BenchBody timedLoop(F f) {
+     return [f](uint64_t n) mutable {
+         uint64_t start = nowNs();
+         for (uint64_t i = 0; i < n; i++) f(i);
+         return nowNs() - start;
+     };
+ }
+
+ struct Benchmark {
+     const char* name;
+     uint32_t bytesPerOp;  // 0 = pas de débit affiché
+     BenchBody body;
+ };
+
+ struct BenchResult {
+     std::string name;
+     uint64_t iterations;  // par échantillon
+     double medianNs;
+     double minNs;
+     double maxNs;
+     uint32_t bytesPerOp;
+ };
+
+ static BenchResult runBenchmark(const Benchmark& b, const BenchOptions& opt) {
+     // Calibration : doubler n jusqu'à 10 ms, puis viser time / samples par échantillon
+     uint64_t n = 1;
+     uint64_t elapsed = b.body(n);
+     while (elapsed < 10000000u && n < (1ull << 40)) {
+         n *= 2;
+         elapsed = b.body(n);
+     }
+     double perOp = static_cast<double>(elapsed) / n;
+     double target = opt.timeS * 1e9 / opt.samples;
+     n = std::max<uint64_t>(1, static_cast<uint64_t>(target / std::max(perOp, 0.01)));
+
+     std::vector<double> ns(opt.samples);
+     for (unsigned s = 0; s < opt.samples; s++) ns[s] = static_cast<double>(b.body(n)) / n;
+     std::sort(ns.begin(), ns.end());
+
+     BenchResult r;
+     r.name = b.name;
+     r.iterations = n;
+     r.medianNs = (opt.samples % 2) ? ns[opt.samples / 2] : 0.5 * (ns[opt.samples / 2 - 1] + ns[opt.samples / 2]);
+     r.minNs = ns.front();
+     r.maxNs = ns.back();
+     r.bytesPerOp = b.bytesPerOp;
+     return r;
+ }
+
+ // --- Extrémités UART en mémoire ---
+
+ class NullUartDevice : public HostUartDevice {
+ public:
+     bool write(const uint8_t*, uint16_t) override { return true; }
+     uint16_t read(uint8_t*, uint16_t, uint32_t) override { return 0; }
+ };
+
+ // Chaque émission réarme la même réponse (une requête, une réponse, comme le VESC et l'écran)
+ class CannedUartDevice : public HostUartDevice {
+ public:
+     explicit CannedUartDevice(const std::vector<uint8_t>& reply) : reply(reply), position(reply.size()) {}
+
+     bool write(const uint8_t*, uint16_t) override {
+         position = 0;
+         return true;
+     }
+
+     uint16_t read(uint8_t* data, uint16_t len, uint32_t) override {
+         uint16_t n = static_cast<uint16_t>(std::min<size_t>(len, reply.size() - position));
+         memcpy(data, reply.data() + position, n);
+         position += n;
+         return n;
+     }
+
+ private:
+     std::vector<uint8_t> reply;
+     size_t position;
+ };
+
+ // Recopie ce que lit le firmware : sert à capturer une vraie réponse de l'émulateur
+ class CaptureUartDevice : public HostUartDevice {
+ public:
+     explicit CaptureUartDevice(HostUartDevice& inner) : inner(inner) {}
+
+     bool write(const uint8_t* data, uint16_t len) override { return inner.write(data, len); }
+
+     uint16_t read(uint8_t* data, uint16_t len, uint32_t timeoutMs) override {
+         uint16_t n = inner.read(data, len, timeoutMs);
+         captured.insert(captured.end(), data, data + n);
+         return n;
+     }
+
+     std::vector<uint8_t> captured;
+
+ private:
+     HostUartDevice& inner;
+ };
+
+ static VescLinkConfig instantVescLink() {
+     VescLinkConfig link = defaultVescLinkConfig();
+     link.latencyUs = 0;
+     link.baudRate = 0;
+     return link;
+ }
+
+ static NextionLinkConfig instantNextionLink() {
+     NextionLinkConfig link = defaultNextionLinkConfig();
+     link.commandLatencyUs = 0;
+     link.baudRate = 0;
+     return link;
+ }
+
+ // Réponse COMM_GET_VALUES telle que l'émulateur l'envoie, moteur en rotation
+ static std::vector<uint8_t> captureVescReply() {
+     SimpleMotorPlant plant;
+     VescEmulator emulator(plant, instantVescLink());
+     CaptureUartDevice capture(emulator);
+     UART_HandleTypeDef uart = {};
+     hostAttachUart(&uart, &capture, "capture");
+
+     VESCInterface vesc(&uart);
+     vesc.setCurrent(5.0f);
+     HAL_Delay(500);
+     capture.captured.clear();
+     if (!vesc.getValues()) {
+         fprintf(stderr, "capture de la réponse VESC impossible\n");
+         exit(1);
+     }
+     return capture.captured;
+ }
+
+ // --- Mesures ---
+
+ static std::vector<Benchmark> makeBenchmarks()
+ {
+     std::vector<Benchmark> list;
+
+     static uint8_t payload[64];
+     for (size_t i = 0; i < sizeof(payload); i++) payload[i] = static_cast<uint8_t>(i * 37 + 11);
+     list.push_back({"vesc.crc16/64B", 64, timedLoop([](uint64_t i) {
+         payload[0] = static_cast<uint8_t>(i);  // entrée différente à chaque appel
+         keep(VESCInterface::crc16(payload, sizeof(payload)));
+     })});
+
+     static NullUartDevice nullDevice;
+     static UART_HandleTypeDef nullUart = {};
+     hostAttachUart(&nullUart, &nullDevice, "null");
+
+     static VESCInterface encoder(&nullUart);
+     list.push_back({"vesc.setCurrent", 0, timedLoop([](uint64_t i) {
+         encoder.setCurrent(static_cast<float>(i & 63) * 0.25f);  // encodage + CRC + émission
+     })});
+
+     static CannedUartDevice vescReply(captureVescReply());
+     static UART_HandleTypeDef vescUart = {};
+     hostAttachUart(&vescUart, &vescReply, "vesc");
+     static VESCInterface decoder(&vescUart);
+     list.push_back({"vesc.getValues", 0, timedLoop([](uint64_t) {
+         if (!decoder.getValues()) abort();  // requête + réception + CRC + décodage des champs
+         keep(decoder.getLastValues().rpm);
+     })});
+
+     static ScreenDisplay screenOut(&nullUart);
+     list.push_back({"screen.showTorque", 0, timedLoop([](uint64_t i) {
+         screenOut.showTorque(static_cast<float>(i & 127) * 0.1f);  // snprintf "%.1f" + commande
+     })});
+     list.push_back({"screen.showMode", 0, timedLoop([](uint64_t i) {
+         screenOut.showMode(static_cast<ControlMode>(i % 5));
+     })});
+     list.push_back({"screen.sendText", 0, timedLoop([](uint64_t) {
+         screenOut.sendText("t0", "Ergocycle S2M Ready!");
+     })});
+
+     static CannedUartDevice screenReply({NEX_RET_NUMERIC_DATA, 60, 0, 0, 0, 0xFF, 0xFF, 0xFF});
+     static UART_HandleTypeDef screenUart = {};
+     hostAttachUart(&screenUart, &screenReply, "screen");
+     static ScreenDisplay screenIn(&screenUart);
+     list.push_back({"screen.getUserCadence", 0, timedLoop([](uint64_t) {
+         keep(screenIn.getUserCadence());  // "get cad.val" + lecture 0x71
+     })});
+
+     // Entrées variées et hors de portée du repliement de constantes
+     static const size_t BATCH = 1024;
+     static std::vector<float> current(BATCH), cadence(BATCH), temp(BATCH), out(BATCH);
+     for (size_t i = 0; i < BATCH; i++) {
+         current[i] = -20.0f + 40.0f * i / BATCH;
+         cadence[i] = 5.0f + 115.0f * ((i * 7) % BATCH) / BATCH;
+         temp[i] = 25.0f + 0.05f * i;
+     }
+     static MotorComputations computations(0.05f);
+     computations.setReductionRatio(10.0f);
+     computations.setTemperatureModel(-0.0012f);
+     computations.setLossModel(0.3f, 0.02f);
+     computations.setMotorTemperature(40.0f);
+
+     list.push_back({"computations.torqueFromCurrent", 0, timedLoop([](uint64_t i) {
+         keep(computations.computeTorqueFromCurrent(current[i & (BATCH - 1)]));
+     })});
+     list.push_back({"computations.currentFromTorque", 0, timedLoop([](uint64_t i) {
+         keep(computations.computeCurrentFromTorque(current[i & (BATCH - 1)]));
+     })});
+     list.push_back({"computations.shaftTorque", 0, timedLoop([](uint64_t i) {
+         keep(computations.computeShaftTorque(current[i & (BATCH - 1)], cadence[i & (BATCH - 1)]));
+     })});
+     list.push_back({"computations.power", 0, timedLoop([](uint64_t i) {
+         keep(computations.computePower(current[i & (BATCH - 1)], cadence[i & (BATCH - 1)]));
+     })});
+     list.push_back({"computations.torqueBatch/1024", 0, timedLoop([](uint64_t) {
+         computations.computeTorqueBatch(current.data(), temp.data(), cadence.data(), out.data(), BATCH);
+         keep(out[BATCH - 1]);
+     })});
+
+     // Pas complet de la boucle de mainV1.cpp contre les émulateurs
+     static ErgocyclePlant plant;
+     static VescEmulator vesc(plant, instantVescLink());
+     static NextionEmulator screen(instantNextionLink());
+     screen.defineErgocyclePage();
+     screen.defineComponent("mode", 1);  // couple imposé
+     screen.defineComponent("tor", 10);
+     static UART_HandleTypeDef motorVescUart = {};
+     static UART_HandleTypeDef motorScreenUart = {};
+     hostAttachUart(&motorVescUart, &vesc, "huart3");
+     hostAttachUart(&motorScreenUart, &screen, "huart2");
+     static MotorController motor(&motorVescUart, &motorScreenUart, defaultErgocycleParams().torqueConstant);
+
+     list.push_back({"motor.step", 0, [](uint64_t n) {
+         uint64_t timed = 0;
+         for (uint64_t i = 0; i < n; i++) {
+             HAL_Delay(100);                  // période de la boucle
+             vesc.advanceTo(hostClockMicros());  // modèle physique hors chronométrage
+             screen.advanceTo(hostClockMicros());
+
+             uint64_t start = nowNs();
+             motor.updateFromScreen();
+             motor.sampleTelemetry();
+             float cadence = motor.getCadence();
+             motor.update(cadence);
+             motor.updateScreen();
+             timed += nowNs() - start;
+         }
+         return timed;
+     }});
+
+     // Même loi de commande instanciée sur les mocks : ni trames ni texte, seulement les décisions
+     static MockMotorController mock(nullptr, nullptr, defaultErgocycleParams().torqueConstant);
+     mock.getVesc().setMode(MockMode::SILENT);
+     mock.getScreen().setMode(MockMode::SILENT);
+     mock.getScreen().getInputs().mode = ControlMode::TORQUE;
+     mock.getScreen().getInputs().torque = 10.0f;
+     list.push_back({"mock.step", 0, timedLoop([](uint64_t) {
+         mock.getClock().advance(100);
+         mock.updateFromScreen();
+         mock.sampleTelemetry();
+         mock.update(mock.getConditioner().getCadence());
+         mock.updateScreen();
+     })});
+
+     // Même pas avec le journal en mémoire : copie des arguments bruts, mise en forme seulement à l'affichage
+     static MockMotorController recording(nullptr, nullptr, defaultErgocycleParams().torqueConstant);
+     recording.getVesc().setMode(MockMode::RECORDING);
+     recording.getScreen().setMode(MockMode::RECORDING);
+     recording.getScreen().getInputs().mode = ControlMode::TORQUE;
+     recording.getScreen().getInputs().torque = 10.0f;
+     list.push_back({"mock.step/recording", 0, timedLoop([](uint64_t) {
+         MockTrace& vescTrace = recording.getVesc().getTrace();
+         MockTrace& screenTrace = recording.getScreen().getTrace();
+         if (vescTrace.getDropped() || screenTrace.getDropped()) {  // tampon plein : on mesurerait le simple comptage
+             vescTrace.clear();
+             screenTrace.clear();
+         }
+         recording.getClock().advance(100);
+         recording.updateFromScreen();
+         recording.sampleTelemetry();
+         recording.update(recording.getConditioner().getCadence());
+         recording.updateScreen();
+     })});
+
+     return list;
+ }
+
+ // --- JSON ---
+
+ static std::string cpuModel() {
+     FILE* f = fopen("/proc/cpuinfo", "r");
+     if (!f) return "inconnu";
+     char line[256];
+     std::string model = "inconnu";
+     while (fgets(line, sizeof(line), f)) {
+         if (strncmp(line, "model name", 10)) continue;
+         const char* colon = strchr(line, ':');
+         if (!colon) break;
+         model = colon + 2;
+         while (!model.empty() && (model.back() == '\n' || model.back() == '"' || model.back() == '\\')) model.pop_back();
+         break;
+     }
+     fclose(f);
+     return model;
+ }
+
+ static void writeJson(FILE* out, const std::vector<BenchResult>& results, const BenchOptions& opt) {
+     // Une mesure par ligne : lisible par readBaseline() sans bibliothèque JSON
+     fprintf(out, "{\n  \"schema\": 1,\n  \"cpu\": \"%s\",\n  \"compiler\": \"%s\",\n  \"samples\": %u,\n  \"benchmarks\": [\n",
+             cpuModel().c_str(), __VERSION__, opt.samples);
+     for (size_t i = 0; i < results.size(); i++) {
+         const BenchResult& r = results[i];
+         fprintf(out, "    {\"name\": \"%s\", \"iterations\": %llu, \"median_ns\": %.3f, \"min_ns\": %.3f, \"max_ns\": %.3f",
+                 r.name.c_str(), static_cast<unsigned long long>(r.iterations), r.medianNs, r.minNs, r.maxNs);
+         if (r.bytesPerOp) fprintf(out, ", \"mb_per_s\": %.1f", r.bytesPerOp * 1e3 / r.medianNs);
+         fprintf(out, "}%s\n", (i + 1 < results.size()) ? "," : "");
+     }
+     fprintf(out, "  ]\n}\n");
+ }
+
+ struct BaselineEntry {
+     std::string name;
+     double medianNs;
+ };
+
+ static bool jsonNumber(const char* object, const char* key, double& value) {
+     const char* p = strstr(object, key);
+     if (!p) return false;
+     p = strchr(p + strlen(key), ':');
+     if (!p) return false;
+     char* end;
+     value = strtod(p + 1, &end);
+     return end != p + 1;
+ }
+
+ static bool readBaseline(const char* path, std::vector<BaselineEntry>& entries, std::string& cpu) {
+     FILE* f = fopen(path, "r");
+     if (!f) return false;
+     char line[1024];
+     while (fgets(line, sizeof(line), f)) {
+         const char* c = strstr(line, "\"cpu\"");
+         if (c && (c = strchr(c + 5, '"'))) {
+             cpu.assign(c + 1);
+             size_t q = cpu.find('"');
+             if (q != std::string::npos) cpu.resize(q);
+         }
+         const char* n = strstr(line, "\"name\"");
+         if (!n || !(n = strchr(n + 6, '"'))) continue;
+         const char* close = strchr(n + 1, '"');
+         if (!close) continue;
+         BaselineEntry e;
+         e.name.assign(n + 1, close);
+         if (jsonNumber(line, "\"median_ns\"", e.medianNs)) entries.push_back(e);
+     }
+     fclose(f);
+     return true;
+ }
+
+ int main(int argc, char** argv)
+ {
+     BenchOptions opt;
+     if (!parseOptions(argc, argv, opt)) {
+         fprintf(stderr, "usage: %s [-o FILE.json|-] [--baseline FILE.json] [--threshold PCT] [--filter TEXTE]\n"
+                         "          [--time S] [--samples N]\n", argv[0]);
+         return 2;
+     }
+
+     std::vector<BaselineEntry> baseline;
+     std::string baselineCpu;
+     if (opt.baselinePath) {
+         if (!readBaseline(opt.baselinePath, baseline, baselineCpu)) {
+             fprintf(stderr, "lecture impossible : %s\n", opt.baselinePath);
+             return 1;
+         }
+         if (baselineCpu != cpuModel()) {
+             fprintf(stderr, "attention : référence mesurée sur \"%s\", comparaison peu fiable\n", baselineCpu.c_str());
+         }
+     }
+
+     hostClockSetMode(HostClockMode::SIMULATED);  // aucune attente réelle : HAL_Delay et timeouts avancent un compteur
+     std::vector<Benchmark> benchmarks = makeBenchmarks();
+
+     FILE* table = (opt.jsonPath && !strcmp(opt.jsonPath, "-")) ? stderr : stdout;
+     fprintf(table, "%-32s %12s %12s %12s %10s", "mesure", "médiane ns", "min ns", "max ns", "Mo/s");
+     if (!baseline.empty()) fprintf(table, " %10s", "vs réf.");
+     fprintf(table, "\n");
+
+     std::vector<BenchResult> results;
+     unsigned regressions = 0;
+     for (const Benchmark& b : benchmarks) {
+         if (opt.filter && !strstr(b.name, opt.filter)) continue;
+         BenchResult r = runBenchmark(b, opt);
+         results.push_back(r);
+
+         fprintf(table, "%-32s %12.2f %12.2f %12.2f ", r.name.c_str(), r.medianNs, r.minNs, r.maxNs);
+         if (r.bytesPerOp) fprintf(table, "%10.1f", r.bytesPerOp * 1e3 / r.medianNs);
+         else fprintf(table, "%10s", "-");
+
+         for (const BaselineEntry& e : baseline) {
+             if (e.name != r.name || e.medianNs <= 0.0) continue;
+             double limit = e.medianNs * (1.0 + opt.thresholdPct / 100.0);
+             bool regressed = r.medianNs > limit && r.minNs > limit;
+             fprintf(table, " %+9.1f%%%s", (r.medianNs / e.medianNs - 1.0) * 100.0, regressed ? "  RÉGRESSION" : "");
+             if (regressed) regressions++;
+         }
+         fprintf(table, "\n");
+         fflush(table);
+     }
+
+     if (opt.jsonPath) {
+         FILE* out = strcmp(opt.jsonPath, "-") ? fopen(opt.jsonPath, "w") : stdout;
+         if (!out) {
+             fprintf(stderr, "écriture impossible : %s\n", opt.jsonPath);
+             return 1;
+         }
+         writeJson(out, results, opt);
+         if (out != stdout) fclose(out);
+     }
+
+     if (regressions) {
+         fprintf(stderr, "%u régression(s) au-delà de %.1f %%\n", regressions, opt.thresholdPct);
+         return 1;
+     }
+     return 0;
+ }
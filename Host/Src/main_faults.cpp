@@ -0,0 +1,370 @@
+/*
+ * main_faults.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ /**
+  * Injection de défauts sur la loi de commande du firmware, compilée pour Linux.
+  *
+  *   ergo_faults            # chaque scénario affiche OK ou ÉCHEC ; code de sortie 1 au moindre échec
+  *
+  * MockMotorController est exactement BasicMotorController : les mocks fixent température,
+  * courant mesuré et état de la liaison (MockVESCInputs), l'horloge avance d'un tick de 100 ms
+  * dans le même ordre que la boucle principale de mainV1. "boucle lente" rejoue les mêmes défauts
+  * à la période réelle de la cible (~600 ms avec l'écran à 9600 bauds). "protocole VESC" envoie les
+  * trames du vrai VESCInterface à VescEmulator, dont les identifiants viennent du firmware VESC.
+  * "réglages" fait échouer la programmation de SettingsStore en plein enregistrement.
+  *
+  * Compilation (depuis la racine) :
+  *   g++ -std=c++17 -O2 -DERGO_HOST -IHost/Inc -IInc Host/Src/main_faults.cpp Src/MotorComputations.cpp \
+  *       Src/SignalConditioning.cpp Src/KtCalibration.cpp Src/SettingsStore.cpp Src/SafetySupervisor.cpp \
+  *       Src/SessionAnalytics.cpp Src/ResponseTest.cpp Src/DrivetrainParams.cpp Src/VESCInterface.cpp \
+  *       Host/Src/VescEmulator.cpp Host/Src/HostHal.cpp -o ergo_faults
+  */
+
+ #include <cmath>
+ #include <cstdio>
+ #include <cstring>
+
+ #include "HostHal.hpp"
+ #include "MockMotorController.hpp"
+ #include "VESCInterface.hpp"
+ #include "VescEmulator.hpp"
+
+ static const uint32_t TICK_MS = 100;
+ static const uint32_t TARGET_LOOP_MS = 600;  // boucle mesurée sur la cible : 360 à 700 ms
+ static int failures = 0;
+
+ #define CHECK(cond)                                                             \
+     do {                                                                        \
+         if (!(cond)) {                                                          \
+             printf("    ligne %d : %s\n", __LINE__, #cond);                     \
+             failures++;                                                         \
+             return false;                                                       \
+         }                                                                       \
+     } while (0)
+
+ // Contrôleur muet, commandé en couple depuis l'écran simulé
+ static void setUp(MockMotorController& motor, ControlMode mode, float setpoint) {
+     motor.getVesc().setMode(MockMode::SILENT);
+     motor.getScreen().setMode(MockMode::SILENT);
+     MockScreenInputs& screen = motor.getScreen().getInputs();
+     screen.mode = mode;
+     screen.torque = setpoint;
+     screen.cadence = setpoint;
+ }
+
+ // Un tour de la boucle principale (mainV1) : écran, télémétrie, commande
+ static void tick(MockMotorController& motor, uint32_t periodMs = TICK_MS) {
+     motor.getClock().advance(periodMs);
+     motor.updateFromScreen();
+     motor.sampleTelemetry();
+     motor.update(motor.getConditioner().getCadence());
+ }
+
+ // Pas de repli en A par tick : rampDownRate est en A/s, la période est mesurée par le superviseur
+ static float rampStep(uint32_t periodMs = TICK_MS) {
+     return defaultSafetyConfig().rampDownRate * periodMs * 0.001f;
+ }
+
+ static bool overTemperature() {
+     MockMotorController motor(nullptr, nullptr, 0.45f);
+     setUp(motor, ControlMode::TORQUE, 400.0f);  // > maxCurrent : borné par le superviseur
+     MockVESCInputs& vesc = motor.getVesc().getInputs();
+     SafetyConfig cfg = defaultSafetyConfig();
+
+     for (int i = 0; i < 3; i++) tick(motor);
+     CHECK(fabsf(motor.getVesc().getCommandedCurrent() - cfg.maxCurrent) < 1e-3f);
+
+     // Déclassement : à mi-chemin de la courbe, la moitié du courant maximal
+     vesc.tempFet = 0.5f * (cfg.fetDerateStartC + cfg.fetLimitC);
+     tick(motor);  // la trame de ce tick met à jour le déclassement
+     tick(motor);
+     CHECK(!motor.getSafety().isTripped());
+     CHECK(fabsf(motor.getVesc().getCommandedCurrent() - 0.5f * cfg.maxCurrent) < 1e-3f);
+
+     vesc.tempMotor = cfg.motorLimitC + 1.0f;
+     tick(motor);
+     CHECK(motor.getSafety().getFaults() & FAULT_OVER_TEMP_MOTOR);
+     CHECK(motor.getScreen().getTrace().count(MockCall::SCREEN_SHOW_ERROR) > 0);
+     return true;
+ }
+
+ static bool overcurrent() {
+     MockMotorController motor(nullptr, nullptr, 0.45f);
+     setUp(motor, ControlMode::TORQUE, 100.0f);
+     MockVESCInputs& vesc = motor.getVesc().getInputs();
+
+     for (int i = 0; i < 3; i++) tick(motor);
+     CHECK(!motor.getSafety().isTripped());
+
+     vesc.forceCurrent = true;
+     vesc.motorCurrent = defaultSafetyConfig().maxCurrent + 5.0f;
+     tick(motor);
+     CHECK(motor.getSafety().getFaults() & FAULT_OVERCURRENT);
+
+     // Verrouillé : le retour à la normale ne suffit pas, il faut acquitter (bouton stop)
+     vesc.forceCurrent = false;
+     for (int i = 0; i < 60; i++) tick(motor);  // repli depuis 25 A mesurés : 42 ticks
+     CHECK(motor.getSafety().isTripped());
+     CHECK(motor.getVesc().getCommandedCurrent() == 0.0f);
+
+     motor.getScreen().getInputs().stop = true;
+     tick(motor);
+     CHECK(!motor.getSafety().isTripped());
+     return true;
+ }
+
+ static bool telemetryLoss() {
+     MockMotorController motor(nullptr, nullptr, 0.45f);
+     setUp(motor, ControlMode::TORQUE, 100.0f);
+     uint32_t timeoutMs = defaultSafetyConfig().telemetryTimeoutMs;
+
+     for (int i = 0; i < 3; i++) tick(motor);
+     motor.getVesc().getInputs().linkDown = true;
+
+     // Déclenche au premier tick où l'âge de la dernière trame dépasse le délai, pas avant
+     uint32_t ticks = 0;
+     while (!motor.getSafety().isTripped() && ticks < 50) {
+         tick(motor);
+         ticks++;
+     }
+     CHECK(motor.getSafety().getFaults() & FAULT_COMMS_LOSS);
+     CHECK(ticks == timeoutMs / TICK_MS + 1);
+     return true;
+ }
+
+ static bool rampDownTiming() {
+     MockMotorController motor(nullptr, nullptr, 0.45f);
+     setUp(motor, ControlMode::TORQUE, 150.0f);
+     MockVESCInterface& vesc = motor.getVesc();
+
+     for (int i = 0; i < 3; i++) tick(motor);
+     float start = vesc.getCommandedCurrent();
+     CHECK(start > 5.0f);
+
+     vesc.getInputs().tempFet = defaultSafetyConfig().fetLimitC + 1.0f;
+
+     // Exactement un pas de repli par tick, bien que updateFromScreen() redonne la consigne à chaque tour
+     uint32_t expected = static_cast<uint32_t>(ceilf(start / rampStep()));
+     float previous = start;
+     uint32_t ticks = 0;
+     while (ticks < expected + 5) {
+         tick(motor);
+         ticks++;
+         float now = vesc.getCommandedCurrent();
+         if (now > 0.0f) CHECK(fabsf((previous - now) - rampStep()) < 1e-3f);
+         previous = now;
+         if (now == 0.0f) break;
+     }
+     CHECK(previous == 0.0f);
+     CHECK(ticks == expected);
+     return true;
+ }
+
+ static bool cadenceTrip() {
+     MockMotorController motor(nullptr, nullptr, 0.45f);
+     setUp(motor, ControlMode::CADENCE, 60.0f);
+     MockVESCInterface& vesc = motor.getVesc();
+
+     for (int i = 0; i < 3; i++) tick(motor);
+     uint32_t rpmCommands = vesc.getTrace().count(MockCall::VESC_SET_RPM);
+     CHECK(rpmCommands > 0);
+
+     // En cadence le VESC régule seul : le repli part du courant qu'il mesure, plus aucune consigne RPM
+     vesc.getInputs().forceCurrent = true;
+     vesc.getInputs().motorCurrent = 6.0f;
+     tick(motor);
+     vesc.getInputs().tempFet = defaultSafetyConfig().fetLimitC + 1.0f;
+     tick(motor);
+     CHECK(motor.getSafety().isTripped());
+     uint32_t afterTrip = vesc.getTrace().count(MockCall::VESC_SET_RPM);
+     CHECK(fabsf(vesc.getCommandedCurrent() - (6.0f - rampStep())) < 1e-3f);
+
+     for (int i = 0; i < 5; i++) tick(motor);
+     CHECK(vesc.getTrace().count(MockCall::VESC_SET_RPM) == afterTrip);
+     return true;
+ }
+
+ static bool slowLoop() {
+     MockMotorController motor(nullptr, nullptr, 0.45f);
+     setUp(motor, ControlMode::TORQUE, 150.0f);
+     MockVESCInterface& vesc = motor.getVesc();
+     SafetyConfig cfg = defaultSafetyConfig();
+     vesc.getInputs().forceRpm = true;  // pédalier à ~40 tr/min : 20 A sur une minute sans blocage
+     vesc.getInputs().erpm = 40.0f * defaultConditioningConfig().reductionRatio * defaultConditioningConfig().polePairs;
+
+     // Une trame perdue de temps en temps : plus d'un délai de liaison entre deux trames, pas une perte
+     for (int i = 0; i < 20; i++) {
+         vesc.getInputs().linkDown = (i % 4 == 3);
+         tick(motor, TARGET_LOOP_MS);
+     }
+     CHECK(!motor.getSafety().isTripped());
+     CHECK(vesc.getCommandedCurrent() > 5.0f);
+
+     // Repli en A/s : chaque tick de 600 ms retire six fois le pas d'un tick de 100 ms
+     vesc.getInputs().linkDown = false;
+     tick(motor, TARGET_LOOP_MS);
+     float previous = vesc.getCommandedCurrent();
+     vesc.getInputs().tempFet = cfg.fetLimitC + 1.0f;
+     tick(motor, TARGET_LOOP_MS);
+     CHECK(motor.getSafety().isTripped());
+     float now = vesc.getCommandedCurrent();
+     CHECK(fabsf((previous - now) - rampStep(TARGET_LOOP_MS)) < 1e-3f);
+     uint32_t ticks = 1;
+     while (now > 0.0f && ticks < 50) {
+         tick(motor, TARGET_LOOP_MS);
+         now = vesc.getCommandedCurrent();
+         ticks++;
+     }
+     CHECK(ticks == static_cast<uint32_t>(ceilf(previous / rampStep(TARGET_LOOP_MS))));
+
+     // Liaison réellement coupée : déclenche après telemetryMaxMissed + 1 trames manquées
+     MockMotorController lost(nullptr, nullptr, 0.45f);
+     setUp(lost, ControlMode::TORQUE, 10.0f);
+     for (int i = 0; i < 3; i++) tick(lost, TARGET_LOOP_MS);
+     lost.getVesc().getInputs().linkDown = true;
+     uint32_t missed = 0;
+     while (!lost.getSafety().isTripped() && missed < 20) {
+         tick(lost, TARGET_LOOP_MS);
+         missed++;
+     }
+     CHECK(lost.getSafety().getFaults() & FAULT_COMMS_LOSS);
+     CHECK(missed == cfg.telemetryMaxMissed + 1u);
+     return true;
+ }
+
+ static bool calibrationMissedFrames() {
+     MockMotorController motor(nullptr, nullptr, 0.45f);
+     setUp(motor, ControlMode::TORQUE, 0.0f);
+     MockVESCInputs& vesc = motor.getVesc().getInputs();
+     uint8_t tolerated = defaultCalibrationConfig().maxMissedTicks;
+
+     tick(motor);
+     motor.calibrateTorqueConstant();
+     CHECK(motor.isCalibrating());
+
+     // Quelques trames perdues d'affilée : la calibration continue
+     vesc.linkDown = true;
+     for (uint8_t i = 0; i < tolerated; i++) tick(motor);
+     vesc.linkDown = false;
+     tick(motor);
+     CHECK(motor.isCalibrating());
+
+     // Une de plus que toléré : abandon
+     vesc.linkDown = true;
+     for (uint8_t i = 0; i <= tolerated; i++) tick(motor);
+     CHECK(!motor.isCalibrating());
+     CHECK(motor.getCalibrationResult().success == false);
+     return true;
+ }
+
+ static bool vescProtocol() {
+     hostClockSetMode(HostClockMode::SIMULATED);
+     SimpleMotorPlant plant;
+     VescEmulator emulator(plant);
+     UART_HandleTypeDef uart = {};
+     hostAttachUart(&uart, &emulator, "huart3");
+     VESCInterface vesc(&uart);
+
+     // Chaque trame doit être décodée comme la commande voulue, pas comme une voisine (5 = SET_DUTY)
+     vesc.setCurrent(3.5f);
+     CHECK(emulator.getCommand().mode == VescCommand::CURRENT);
+     CHECK(fabsf(emulator.getCommand().current - 3.5f) < 1e-3f);
+     vesc.setRPM(1200);
+     CHECK(emulator.getCommand().mode == VescCommand::RPM);
+     CHECK(emulator.getCommand().erpm == 1200.0f);
+     CHECK(vesc.getValues());
+
+     const VescEmulatorStats& stats = emulator.getStats();
+     CHECK(stats.unknownCommands == 0 && stats.unexpectedCommands == 0);
+     return true;
+ }
+
+ // Deux secteurs NOR en RAM, programmés mot par mot comme Stm32FlashStorage ; failAfterWords >= 0 fait
+ // échouer la prochaine programmation après ce nombre de mots écrits
+ class FaultyFlashStorage : public SettingsStorage {
+ public:
+     int failAfterWords = -1;
+
+     FaultyFlashStorage() { memset(flash, 0xFF, sizeof(flash)); }
+
+     uint32_t sectorSize() const override { return SIZE; }
+     bool eraseSector(uint8_t sector) override {
+         if (sector > 1) return false;
+         memset(flash[sector], 0xFF, SIZE);
+         return true;
+     }
+     bool program(uint8_t sector, uint32_t offset, const uint8_t* data, uint32_t len) override {
+         if (sector > 1 || (len % 4) != 0 || offset + len > SIZE) return false;
+         for (uint32_t i = 0; i < len; i += 4) {
+             if (failAfterWords >= 0 && i / 4 == static_cast<uint32_t>(failAfterWords)) {
+                 failAfterWords = -1;
+                 return false;
+             }
+             for (uint32_t b = 0; b < 4; b++) flash[sector][offset + i + b] &= data[i + b];
+         }
+         return true;
+     }
+     bool read(uint8_t sector, uint32_t offset, uint8_t* data, uint32_t len) override {
+         if (sector > 1 || offset + len > SIZE) return false;
+         memcpy(data, &flash[sector][offset], len);
+         return true;
+     }
+
+ private:
+     static const uint32_t SIZE = 1024;
+     uint8_t flash[2][SIZE];
+ };
+
+ static bool settingsProgramFailure() {
+     FaultyFlashStorage flash;
+     SettingsStore store(flash);
+     CHECK(store.mount());
+     CHECK(store.setFloat(SettingKey::RAMP_RATE, 6.0f));
+
+     // Coupure au milieu d'un enregistrement, puis sauvegarde d'une autre clé
+     flash.failAfterWords = 2;
+     CHECK(!store.setFloat(SettingKey::LINEAR_GAIN, 0.05f));
+     CHECK(store.setFloat(SettingKey::RAMP_RATE, 3.0f));
+
+     // Échec avant le premier mot : l'emplacement vierge ne doit pas clore le journal au montage
+     flash.failAfterWords = 0;
+     CHECK(!store.setFloat(SettingKey::LINEAR_GAIN, 0.05f));
+     CHECK(store.setFloat(SettingKey::LINEAR_GAIN, 0.08f));
+     CHECK(store.setInt(SettingKey::POLE_PAIRS, 7));
+
+     SettingsStore reloaded(flash);
+     CHECK(reloaded.mount());
+     CHECK(reloaded.getFloat(SettingKey::RAMP_RATE, 0.0f) == 3.0f);
+     CHECK(reloaded.getFloat(SettingKey::LINEAR_GAIN, 0.0f) == 0.08f);
+     CHECK(reloaded.getInt(SettingKey::POLE_PAIRS, 0) == 7);
+     return true;
+ }
+
+ int main() {
+     struct Scenario {
+         const char* name;
+         bool (*run)();
+     };
+     const Scenario scenarios[] = {
+         {"surchauffe (déclassement puis déclenchement)", overTemperature},
+         {"surintensité verrouillée jusqu'à l'acquittement", overcurrent},
+         {"perte de télémétrie", telemetryLoss},
+         {"durée du repli en couple", rampDownTiming},
+         {"déclenchement en mode cadence", cadenceTrip},
+         {"boucle lente (600 ms) : pertes isolées, repli", slowLoop},
+         {"calibration : trames perdues tolérées", calibrationMissedFrames},
+         {"protocole VESC (identifiants bldc)", vescProtocol},
+         {"réglages : échec de programmation flash", settingsProgramFailure},
+     };
+
+     for (const Scenario& s : scenarios) {
+         bool ok = s.run();
+         printf("%-50s %s\n", s.name, ok ? "OK" : "ÉCHEC");
+     }
+     printf("%d échec(s)\n", failures);
+     return failures ? 1 : 0;
+ }
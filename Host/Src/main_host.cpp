@@ -0,0 +1,444 @@
+/*
+ * main_host.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ /**
+  * Le firmware (même boucle que mainV1.cpp) en processus Linux.
+  *
+  *   ergo_host --vesc /dev/ttyACM0 --screen pty
+  *   ergo_host --vesc pty --screen pty --ticks 600
+  *   ergo_host --vesc emu --screen emu --screen-script saisies.txt --sim --ticks 600
+  *   ergo_host --vesc emu --plant ergocycle --screen emu --sim --ticks 600
+  *
+  * "pty" crée un pseudo-terminal dont le nom est affiché : on y branche un émulateur,
+  * un vrai écran Nextion via un adaptateur USB, ou un outil comme socat.
+  * "emu" branche un émulateur en processus (VescEmulator, NextionEmulator) : la trame, le CRC
+  * et le décodage de VESCInterface.cpp et ScreenDisplay.cpp sont exercés sans matériel.
+  * "--plant ergocycle" remplace le moteur seul par le modèle complet (volant, réducteur, cycliste).
+  * Le script d'écran contient des lignes "t_ms composant valeur" (ex : "2000 mode 4").
+  *
+  * Enregistrement / rejeu octet pour octet des deux liaisons (voir UartTrace.hpp) :
+  *   ergo_host --vesc /dev/ttyACM0 --screen /dev/ttyUSB0 --record sortie.ergt
+  *   ergo_host --replay sortie.ergt --sim     # aussi vite que possible ; sans --sim : timing d'origine
+  * Le rejeu sert les réponses enregistrées au firmware et compare ses émissions à la trace :
+  * code de sortie 3 à la première divergence (utilisable en intégration continue).
+  * L'image des réglages est embarquée dans la trace : le rejeu n'utilise pas --settings.
+  *
+  * "--log FILE" journalise la télémétrie plein débit comme sur la clé USB (même format que ERGO.LOG).
+  * "--stream PATH|pty" ouvre la liaison de télémétrie en direct (USART1 sur la cible) : voir ergo_telemetry.
+  * "--response-test" lance les échelons et le chirp de ResponseTest (comme le firmware -DERGO_RESPONSE_TEST),
+  * affiche l'analyse et s'arrête à la fin du programme ; avec --log, ergo_response relit le même test.
+  * "--params FILE" applique un modèle de transmission (ERGO.PAR d'ergo_sysid) comme la cible depuis la clé USB.
+  * "--rider passive|pedal|resist" choisit le cycliste du modèle ergocycle (journaux d'identification : passive).
+  *
+  * Compilation (depuis la racine) :
+  *   g++ -std=c++17 -O2 -DERGO_HOST -IHost/Inc -IInc Host/Src/main_host.cpp Host/Src/HostHal.cpp \
+  *       Host/Src/UartTrace.cpp Host/Src/VescEmulator.cpp Host/Src/NextionEmulator.cpp Host/Src/ErgocyclePlant.cpp \
+  *       Src/MotorController.cpp Src/VESCInterface.cpp Src/ScreenDisplay.cpp Src/MotorComputations.cpp \
+  *       Src/SignalConditioning.cpp Src/KtCalibration.cpp Src/SettingsStore.cpp Src/SettingsStorageFile.cpp \
+  *       Src/SafetySupervisor.cpp Src/SessionLogger.cpp Src/SessionLogStorageFile.cpp Src/TelemetryCodec.cpp \
+  *       Src/TelemetryStream.cpp Src/TelemetryLinkUart.cpp Src/LoopProfiler.cpp Src/WatchdogMonitor.cpp \
+  *       Src/SessionAnalytics.cpp Src/ResponseTest.cpp Src/DrivetrainParams.cpp Src/DrivetrainParamsFile.cpp \
+  *       -o ergo_host
+  * Ajouter -DERGO_PROFILE pour le temps par étape de la boucle (LoopProfiler.hpp), affiché en fin de course.
+  * Expiration de l'IWDG : le post-mortem du WatchdogMonitor (étape en cours) est affiché avant l'arrêt.
+  */
+
+ #include <cstdio>
+ #include <cstdlib>
+ #include <cstring>
+ #include <string>
+ #include <unistd.h>
+ #include <vector>
+
+ #include "HostHal.hpp"
+ #include "MotorController.hpp"
+ #include "SettingsStore.hpp"
+ #include "SessionLogger.hpp"
+ #include "TelemetryStream.hpp"
+ #include "LoopProfiler.hpp"
+ #include "WatchdogMonitor.hpp"
+ #include "VescEmulator.hpp"
+ #include "NextionEmulator.hpp"
+ #include "ErgocyclePlant.hpp"
+ #include "UartTrace.hpp"
+
+ UART_HandleTypeDef huart1;  // Télémétrie en direct
+ UART_HandleTypeDef huart2;  // Ecran
+ UART_HandleTypeDef huart3;  // VESC
+ IWDG_HandleTypeDef hiwdg;
+
+ // Comme mainV1.cpp : tâche courante pour le moniteur du watchdog, et zone de profilage
+ #define LOOP_STAGE_BEGIN(zone) (watchdogMonitor.enter(zone), PROFILE_BEGIN(zone))
+
+ struct HostOptions {
+     const char* vescPath = "pty";
+     const char* plant = "simple";  // modèle derrière "--vesc emu"
+     const char* screenPath = "pty";
+     uint32_t vescBaud = 115200;   // mêmes débits que MX_USART3/2_UART_Init
+     uint32_t screenBaud = 9600;
+     const char* screenScript = nullptr;
+     const char* settingsPath = "ergo_settings.bin";
+     const char* recordPath = nullptr;
+     const char* replayPath = nullptr;
+     const char* logPath = nullptr;
+     const char* streamPath = nullptr;
+     uint32_t streamBaud = 921600;  // MX_USART1_UART_Init
+     long ticks = -1;              // -1 = infini
+     bool simulated = false;
+     bool responseTest = false;
+     const char* paramsPath = nullptr;
+     const char* rider = nullptr;  // nullptr : cycliste par défaut du modèle
+ };
+
+ static bool parseOptions(int argc, char** argv, HostOptions& opt) {
+     for (int i = 1; i < argc; i++) {
+         bool hasValue = (i + 1 < argc);
+         if (!strcmp(argv[i], "--vesc") && hasValue) opt.vescPath = argv[++i];
+         else if (!strcmp(argv[i], "--plant") && hasValue) opt.plant = argv[++i];
+         else if (!strcmp(argv[i], "--screen") && hasValue) opt.screenPath = argv[++i];
+         else if (!strcmp(argv[i], "--vesc-baud") && hasValue) opt.vescBaud = strtoul(argv[++i], nullptr, 10);
+         else if (!strcmp(argv[i], "--screen-baud") && hasValue) opt.screenBaud = strtoul(argv[++i], nullptr, 10);
+         else if (!strcmp(argv[i], "--screen-script") && hasValue) opt.screenScript = argv[++i];
+         else if (!strcmp(argv[i], "--settings") && hasValue) opt.settingsPath = argv[++i];
+         else if (!strcmp(argv[i], "--ticks") && hasValue) opt.ticks = strtol(argv[++i], nullptr, 10);
+         else if (!strcmp(argv[i], "--sim")) opt.simulated = true;
+         else if (!strcmp(argv[i], "--record") && hasValue) opt.recordPath = argv[++i];
+         else if (!strcmp(argv[i], "--replay") && hasValue) opt.replayPath = argv[++i];
+         else if (!strcmp(argv[i], "--log") && hasValue) opt.logPath = argv[++i];
+         else if (!strcmp(argv[i], "--stream") && hasValue) opt.streamPath = argv[++i];
+         else if (!strcmp(argv[i], "--response-test")) opt.responseTest = true;
+         else if (!strcmp(argv[i], "--params") && hasValue) opt.paramsPath = argv[++i];
+         else if (!strcmp(argv[i], "--rider") && hasValue) opt.rider = argv[++i];
+         else {
+             fprintf(stderr, "usage: %s [--vesc PATH|pty|emu] [--plant simple|ergocycle] [--screen PATH|pty|emu] [--vesc-baud N] [--screen-baud N]\n"
+                             "          [--screen-script FILE] [--settings FILE] [--ticks N] [--sim] [--record FILE | --replay FILE] [--log FILE]\n"
+                            "          [--stream PATH|pty] [--response-test] [--params FILE] [--rider passive|pedal|resist]\n", argv[0]);
+             return false;
+         }
+     }
+     return !(opt.recordPath && opt.replayPath);
+ }
+
+ static std::vector<uint8_t> readWholeFile(const char* path) {
+     std::vector<uint8_t> bytes;
+     FILE* f = fopen(path, "rb");
+     if (!f) return bytes;
+     uint8_t chunk[4096];
+     size_t n;
+     while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) bytes.insert(bytes.end(), chunk, chunk + n);
+     fclose(f);
+     return bytes;
+ }
+
+ static bool makeReplaySettings(const std::vector<uint8_t>& image, std::string& path)
+ // Copie temporaire des réglages enregistrés : le rejeu ne modifie jamais le fichier de l'utilisateur
+ {
+     char name[] = "/tmp/ergo_replay_XXXXXX";
+     int fd = mkstemp(name);
+     if (fd < 0) return false;
+     bool ok = image.empty() || write(fd, image.data(), image.size()) == static_cast<ssize_t>(image.size());
+     ::close(fd);
+     // Pas de réglages à l'enregistrement : FileFlashStorage doit créer (et effacer) le fichier lui-même
+     if (image.empty()) unlink(name);
+     path = name;
+     return ok;
+ }
+
+ static bool printReplayReport(const char* label, const ReplayUartDevice& link) {
+     const ReplayDivergence& d = link.getDivergence();
+     printf("%s : %llu octets émis comparés, %llu différents, %llu attendus non émis\n", label,
+            static_cast<unsigned long long>(link.getComparedBytes()), static_cast<unsigned long long>(link.getMismatches()),
+            static_cast<unsigned long long>(link.getMissingTx()));
+     if (d.diverged) {
+         printf("  première divergence à %.3f ms, octet %llu : attendu ", d.timeUs / 1000.0,
+                static_cast<unsigned long long>(d.offset));
+         if (d.expected < 0) printf("(fin de trace)");
+         else printf("0x%02X", d.expected);
+         printf(", émis 0x%02X\n", d.actual);
+     }
+     return !d.diverged && link.getMissingTx() == 0;
+ }
+
+ static bool openLink(FdUartDevice& device, const char* path, uint32_t baud, const char* label) {
+     bool ok = !strcmp(path, "pty") ? device.openPty() : device.openSerial(path, baud);
+     if (!ok) {
+         fprintf(stderr, "%s : impossible d'ouvrir %s\n", label, path);
+         return false;
+     }
+     if (!strcmp(path, "pty")) printf("%s : %s\n", label, device.getPtyName());
+     return true;
+ }
+
+ static void onWatchdogExpired(uint32_t overdueMs, void* context)
+ // Pas de SysTick sur PC : dernier relevé du moniteur au moment où la cible aurait redémarré
+ {
+     static_cast<WatchdogMonitor*>(context)->onTick();
+     const WatchdogPostMortem& record = *watchdogBackupRecord();
+     fprintf(stderr, "[IWDG] expiration : boucle en retard de %u ms pendant %s (%u ms sans rafraîchissement, "
+                     "pire intervalle précédent %u ms) -> reset\n",
+             overdueMs, profileZoneName(record.task), record.sinceRefreshMs, record.worstIntervalMs);
+     abort();
+ }
+
+ int main(int argc, char** argv)
+ {
+     HostOptions opt;
+     if (!parseOptions(argc, argv, opt)) return 2;
+
+     hostClockSetMode(opt.simulated ? HostClockMode::SIMULATED : HostClockMode::REALTIME);
+
+     FdUartDevice vescLink, screenLink, streamLink;
+     SimpleMotorPlant simplePlant;
+     ErgocyclePlant ergocyclePlant;
+     VescPlant& vescPlant = !strcmp(opt.plant, "ergocycle") ? static_cast<VescPlant&>(ergocyclePlant) : simplePlant;
+     if (opt.rider) {
+         RiderProfile rider = defaultRiderProfile();
+         if (!strcmp(opt.rider, "passive")) rider.mode = RiderProfile::PASSIVE;
+         else if (!strcmp(opt.rider, "pedal")) rider.mode = RiderProfile::PEDAL;
+         else if (!strcmp(opt.rider, "resist")) rider.mode = RiderProfile::RESIST;
+         else {
+             fprintf(stderr, "cycliste inconnu : %s\n", opt.rider);
+             return 2;
+         }
+         ergocyclePlant.setRider(rider);
+     }
+     VescLinkConfig emulatedLink = defaultVescLinkConfig();
+     emulatedLink.baudRate = opt.vescBaud;
+     VescEmulator vescEmulator(vescPlant, emulatedLink);
+
+     NextionLinkConfig screenConfig = defaultNextionLinkConfig();
+     screenConfig.baudRate = opt.screenBaud;
+     NextionEmulator screenEmulator(screenConfig);
+     screenEmulator.defineErgocyclePage();
+
+     TraceReader replayTrace;
+     if (opt.replayPath) {
+         std::string error;
+         if (!replayTrace.load(opt.replayPath, error)) {
+             fprintf(stderr, "%s : %s\n", opt.replayPath, error.c_str());
+             return 1;
+         }
+         if (replayTrace.findLink("huart3") < 0 || replayTrace.findLink("huart2") < 0) {
+             fprintf(stderr, "%s : liaisons huart2/huart3 absentes\n", opt.replayPath);
+             return 1;
+         }
+         // Le rejeu remplace les deux extrémités
+         opt.vescPath = "replay";
+         opt.screenPath = "replay";
+     }
+     ReplayUartDevice vescReplay(replayTrace, static_cast<uint8_t>(replayTrace.findLink("huart3")));
+     ReplayUartDevice screenReplay(replayTrace, static_cast<uint8_t>(replayTrace.findLink("huart2")));
+
+     TraceWriter recorder;
+     uint8_t vescTraceId = recorder.addLink("huart3");
+     uint8_t screenTraceId = recorder.addLink("huart2");
+     HostUartDevice* vescDevice = &vescEmulator;
+     HostUartDevice* screenDevice = &screenEmulator;
+
+     if (opt.replayPath) {
+         vescDevice = &vescReplay;
+     } else if (strcmp(opt.vescPath, "emu")) {
+         if (!openLink(vescLink, opt.vescPath, opt.vescBaud, "VESC (huart3)")) return 1;
+         vescDevice = &vescLink;
+     }
+
+
+     if (opt.replayPath) {
+         screenDevice = &screenReplay;
+     } else if (!strcmp(opt.screenPath, "emu")) {
+         if (opt.screenScript && !screenEmulator.loadScript(opt.screenScript)) {
+             fprintf(stderr, "Ecran : script %s illisible\n", opt.screenScript);
+             return 1;
+         }
+     } else {
+         if (!openLink(screenLink, opt.screenPath, opt.screenBaud, "Ecran (huart2)")) return 1;
+         screenDevice = &screenLink;
+     }
+
+     if (opt.streamPath) {
+         if (!openLink(streamLink, opt.streamPath, opt.streamBaud, "Télémétrie (huart1)")) return 1;
+         hostAttachUart(&huart1, &streamLink, "huart1");
+     }
+
+     std::string settingsPath = opt.settingsPath;
+     if (opt.replayPath && !makeReplaySettings(replayTrace.getBlob(), settingsPath)) {
+         fprintf(stderr, "impossible de créer la copie temporaire des réglages\n");
+         return 1;
+     }
+
+     RecordingUartDevice vescRecorder(*vescDevice, recorder, vescTraceId);
+     RecordingUartDevice screenRecorder(*screenDevice, recorder, screenTraceId);
+     if (opt.recordPath) {
+         if (!recorder.open(opt.recordPath)) {
+             fprintf(stderr, "impossible d'écrire %s\n", opt.recordPath);
+             return 1;
+         }
+         std::vector<uint8_t> image = readWholeFile(opt.settingsPath);  // avant mount() : état de départ
+         recorder.writeBlob(image.data(), static_cast<uint32_t>(image.size()));
+         vescDevice = &vescRecorder;
+         screenDevice = &screenRecorder;
+     }
+     hostAttachUart(&huart3, vescDevice, "huart3");
+     hostAttachUart(&huart2, screenDevice, "huart2");
+
+     // Même watchdog que MX_IWDG_Init (prescaler 64, reload 4095)
+     hiwdg.Init.Prescaler = IWDG_PRESCALER_64;
+     hiwdg.Init.Reload = 4095;
+     HAL_IWDG_Init(&hiwdg);
+     static WatchdogMonitor watchdogMonitor(&hiwdg, 2000);
+     watchdogMonitor.begin();
+     watchdogMonitor.enter(PROFILE_STARTUP);
+     hostIwdgSetHandler(onWatchdogExpired, &watchdogMonitor);
+
+     FileFlashStorage flashStorage(settingsPath.c_str());
+     SettingsStore settings(flashStorage);
+     static MotorController motor(&huart3, &huart2, 0.05f);
+     static TelemetryBuffer telemetry;
+     FileLogStorage logStorage(opt.logPath ? opt.logPath : "");
+     static SessionLogger sessionLog(logStorage, telemetry);
+     static TelemetryBuffer streamTelemetry;
+     UartTelemetryLink telemetryLink(&huart1);
+     static TelemetryStream telemetryStream(telemetryLink, streamTelemetry);
+     telemetryStream.attachWatchdog(&watchdogMonitor);
+
+     settings.mount();
+     motor.attachSettings(&settings);
+     if (opt.logPath) {
+         motor.attachTelemetry(&telemetry);
+         uint32_t sessionId = static_cast<uint32_t>(settings.getInt(SettingKey::SESSION_COUNT, 0)) + 1;
+         settings.setInt(SettingKey::SESSION_COUNT, static_cast<int32_t>(sessionId));
+         sessionLog.attachAnalytics(&motor.getAnalytics());
+         sessionLog.start(sessionId);
+     }
+     if (opt.streamPath) motor.attachTelemetry(&streamTelemetry);
+     if (!motor.loadSettings()) {
+         motor.calibrateTorqueConstant();
+     }
+     if (opt.paramsPath) {
+         DrivetrainParams drivetrain;
+         if (!readDrivetrainParams(opt.paramsPath, drivetrain) || !motor.applyDrivetrainParams(drivetrain)) {
+             fprintf(stderr, "%s : modèle de transmission invalide ou rapport de réduction différent\n", opt.paramsPath);
+             return 1;
+         }
+         printf("Modèle de transmission %s :\n", opt.paramsPath);
+         drivetrainParamsPrint(stdout, drivetrain);
+     }
+     motor.updateScreen();
+     motor.getScreen().showWelcome();
+
+     PROFILE_INIT();
+     uint64_t worstUs = 0, totalUs = 0;
+     long count = 0;
+     bool responseTestStarted = false;
+
+     while (opt.ticks < 0 || count < opt.ticks)
+     {
+         // Fin du rejeu : trace entièrement consommée, ou firmware muet bien après la fin enregistrée
+         if (opt.replayPath && ((vescReplay.isExhausted() && screenReplay.isExhausted()) ||
+                                hostClockMicros() > replayTrace.getEndUs() + 1000000u)) break;
+
+         // Test de réponse : lancé une fois la calibration finie, fin de course à la fin du programme
+         if (opt.responseTest && !responseTestStarted && !motor.isCalibrating()) {
+             responseTestStarted = motor.startResponseTest(defaultResponseTestConfig());
+         }
+         if (responseTestStarted && !motor.isResponseTesting()) break;
+
+         uint64_t start = hostClockMicros();
+         watchdogMonitor.onTick();  // une fois par boucle, faute de SysTick
+         watchdogMonitor.refresh();
+
+         PROFILE_BEGIN(PROFILE_LOOP);
+         LOOP_STAGE_BEGIN(PROFILE_UPDATE_FROM_SCREEN);
+         motor.updateFromScreen();
+         PROFILE_END(PROFILE_UPDATE_FROM_SCREEN);
+         LOOP_STAGE_BEGIN(PROFILE_SAMPLE_TELEMETRY);
+         motor.sampleTelemetry();
+         PROFILE_END(PROFILE_SAMPLE_TELEMETRY);
+         LOOP_STAGE_BEGIN(PROFILE_GET_CADENCE);
+         float cadence = motor.getCadence();
+         PROFILE_END(PROFILE_GET_CADENCE);
+         LOOP_STAGE_BEGIN(PROFILE_UPDATE);
+         motor.update(cadence);
+         PROFILE_END(PROFILE_UPDATE);
+         LOOP_STAGE_BEGIN(PROFILE_UPDATE_SCREEN);
+         motor.updateScreen();
+         PROFILE_END(PROFILE_UPDATE_SCREEN);
+         PROFILE_END(PROFILE_LOOP);
+
+         uint64_t elapsed = hostClockMicros() - start;
+         if (elapsed > worstUs) worstUs = elapsed;
+         totalUs += elapsed;
+         count++;
+
+         LOOP_STAGE_BEGIN(PROFILE_SESSION_LOG);
+         if (opt.logPath) sessionLog.service(HAL_GetTick());  // hors mesure du tick, comme après MX_USB_HOST_Process()
+         PROFILE_END(PROFILE_SESSION_LOG);
+         LOOP_STAGE_BEGIN(PROFILE_TELEMETRY_STREAM);
+         if (opt.streamPath) telemetryStream.service();
+         PROFILE_END(PROFILE_TELEMETRY_STREAM);
+         watchdogMonitor.enter(PROFILE_DELAY);
+         HAL_Delay(100);  // rafraîchissement toutes les 100 ms, comme sur la cible
+     }
+
+     printf("%ld boucles, moyenne %.3f ms, pire %.3f ms, marge IWDG min %u ms\n",
+            count, count ? totalUs / 1000.0 / count : 0.0, worstUs / 1000.0, hostIwdgWorstMarginMs());
+     const WatchdogStats& wd = watchdogMonitor.getStats();
+     printf("Watchdog : pire intervalle %u ms (étape la plus longue : %s, %u ms), %u alertes (seuil %u ms)\n",
+            wd.worstIntervalMs, profileZoneName(wd.worstTask), wd.worstTaskMs, wd.nearMisses, wd.warningMs);
+     if (!strcmp(opt.vescPath, "emu")) {
+         const VescEmulatorStats& st = vescEmulator.getStats();
+         printf("VESC émulé : %u trames reçues, %u réponses (%u perdues), %u erreurs CRC, %u erreurs de trame\n",
+                st.framesReceived, st.repliesSent, st.repliesDropped, st.crcErrors, st.framingErrors);
+         if (st.unknownCommands || st.unexpectedCommands) {
+             printf("VESC émulé : %u commandes inconnues, %u commandes inattendues (identifiant COMM_* faux ?)\n",
+                    st.unknownCommands, st.unexpectedCommands);
+         }
+         if (&vescPlant == &ergocyclePlant) {
+             printf("Ergocycle : %.1f s simulées, cadence %.1f tr/min, cycliste %.1f Nm, moteur %.1f Nm au pédalier\n",
+                    ergocyclePlant.getTime(), ergocyclePlant.getCadence(),
+                    ergocyclePlant.getRiderTorque(), ergocyclePlant.getMotorTorqueAtCrank());
+         }
+     }
+     if (!strcmp(opt.screenPath, "emu")) {
+         screenEmulator.advanceTo(hostClockMicros());
+         screenEmulator.printReport(stdout);
+     }
+     if (responseTestStarted) {
+         const ResponseTest& test = motor.getResponseTest();
+         printf("Test de réponse %s :\n", test.isComplete() ? "terminé" : "interrompu");
+         responseTestPrint(stdout, test.getResult(), test.getConfig().mode == ControlMode::CADENCE ? "tr/min" : "A");
+     }
+     if (opt.logPath) {
+         bool flushed = sessionLog.flush();
+         const SessionLoggerStats& st = sessionLog.getStats();
+         printf("Journal %s : %u blocs, %u échantillons, %u perdus, %u erreurs d'écriture%s\n", opt.logPath,
+                st.blocksWritten, st.samplesLogged, st.samplesLost, st.writeErrors, flushed ? "" : " (dernier bloc non écrit)");
+     }
+     if (opt.streamPath) {
+         TelemetryStreamStatus st = telemetryStream.getStatus();
+         printf("Télémétrie : %u trames, %u abandonnées (liaison saturée), %u commandes invalides, %u erreurs UART\n",
+                st.framesSent, st.framesDropped, st.rxErrors, st.linkErrors);
+     }
+ #ifdef ERGO_PROFILE
+     profilerPrint(stdout);
+ #endif
+     if (opt.recordPath) {
+         recorder.close();
+         printf("Trace %s : %llu octets\n", opt.recordPath, static_cast<unsigned long long>(recorder.getBytesWritten()));
+     }
+     if (opt.replayPath) {
+         unlink(settingsPath.c_str());
+         bool same = printReplayReport("VESC (huart3)", vescReplay);
+         same = printReplayReport("Ecran (huart2)", screenReplay) && same;
+         if (!same) {
+             printf("Rejeu : DIVERGENCE par rapport à %s\n", opt.replayPath);
+             return 3;
+         }
+         printf("Rejeu : identique à %s\n", opt.replayPath);
+     }
+     return 0;
+ }
@@ -0,0 +1,134 @@
+/*
+ * main_logdecode.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ /**
+  * Décodage PC d'un journal de séance (ERGO.LOG de la clé USB, ou --log de ergo_host).
+  *
+  *   ergo_logdecode ERGO.LOG                          # bilan : blocs, séances, taux de compression
+  *   ergo_logdecode ERGO.LOG -o echantillons.csv --session 12
+  *   ergo_logdecode ERGO.LOG --bench 20 -j 4          # débit de décodage (Mo/s), fichier en cache
+  *
+  * Les blocs corrompus sont comptés et sautés, le reste du fichier est décodé normalement.
+  *
+  * Compilation (depuis la racine) :
+  *   g++ -std=c++17 -O2 -pthread -DERGO_HOST -IHost/Inc -IInc Host/Src/main_logdecode.cpp \
+  *       Host/Src/TelemetryLog.cpp Host/Src/WorkStealingPool.cpp Src/TelemetryCodec.cpp -o ergo_logdecode
+  */
+
+ #include <chrono>
+ #include <cstdio>
+ #include <cstdlib>
+ #include <cstring>
+ #include <string>
+
+ #include "TelemetryLog.hpp"
+
+ struct DecodeOptions {
+     const char* logPath = nullptr;
+     const char* csvPath = nullptr;
+     unsigned bench = 0;
+     TelemetryLogOptions log;
+ };
+
+ static bool parseOptions(int argc, char** argv, DecodeOptions& opt) {
+     for (int i = 1; i < argc; i++) {
+         bool hasValue = (i + 1 < argc);
+         if (!strcmp(argv[i], "-o") && hasValue) opt.csvPath = argv[++i];
+         else if (!strcmp(argv[i], "-j") && hasValue) opt.log.threads = strtoul(argv[++i], nullptr, 10);
+         else if (!strcmp(argv[i], "--session") && hasValue) {
+             opt.log.filterSession = true;
+             opt.log.session = strtoul(argv[++i], nullptr, 10);
+         }
+         else if (!strcmp(argv[i], "--bench") && hasValue) opt.bench = strtoul(argv[++i], nullptr, 10);
+         else if (!strcmp(argv[i], "--no-crc")) opt.log.checkCrc = false;
+         else if (argv[i][0] != '-' && !opt.logPath) opt.logPath = argv[i];
+         else return false;
+     }
+     return opt.logPath != nullptr;
+ }
+
+ static bool writeCsv(const char* path, const TelemetryColumns& c) {
+     FILE* f = fopen(path, "w");
+     if (!f) return false;
+
+     fprintf(f, "session,tick_ms,setpoint,cadence_rpm,current_a,applied_current_a,duty,voltage_v,mode,flags,faults\n");
+     for (size_t i = 0; i < c.size(); i++) {
+         fprintf(f, "%u,%u,%.2f,%.2f,%.3f,%.3f,%.4f,%.2f,%u,%u,%u\n",
+                 c.sessionId[i], c.tickMs[i], c.setpoint[i], c.cadence[i], c.current[i], c.appliedCurrent[i],
+                 c.dutyCycle[i], c.inputVoltage[i], c.mode[i], c.flags[i], c.faults[i]);
+     }
+     return fclose(f) == 0;
+ }
+
+ static void printStats(const TelemetryLogStats& stats, size_t samples) {
+     printf("fichier : %.2f Mo, %u blocs (%u delta, %u bruts, %u invalides, %u indécodables)\n",
+            stats.fileBytes / 1e6, stats.blocks, stats.deltaBlocks, stats.rawBlocks,
+            stats.invalidBlocks, stats.decodeErrors);
+
+     const double rawBytes = static_cast<double>(samples) * sizeof(TelemetrySample);
+     if (samples > 0) {
+         printf("échantillons : %zu, %.1f o/échantillon utiles, %.1f o/échantillon sur disque (brut : %zu)\n",
+                samples, stats.payloadBytes / static_cast<double>(samples),
+                stats.fileBytes / static_cast<double>(samples), sizeof(TelemetrySample));
+         printf("compression : x%.2f contre les échantillons bruts\n", rawBytes / stats.fileBytes);
+     }
+
+     for (const TelemetryLogSession& s : stats.sessions) {
+         printf("  séance %u : %zu échantillons, %u blocs, %u perdus\n",
+                s.sessionId, s.sampleCount, s.blocks, s.lostSamples);
+         if (!s.hasSummary) continue;
+
+         const SessionSummary& b = s.summary;
+         printf("    bilan : %u s (%u s en mouvement), %.1f kJ, moyenne %.0f W, NP %.0f W, "
+                "pic 3 s %.0f W, couple max %.1f Nm, cadence max %.0f tr/min\n",
+                b.elapsedMs / 1000u, b.movingMs / 1000u, b.energyJ / 1000.0f, b.averagePower,
+                b.normalizedPower, b.peakPower3s, b.peakTorque, b.peakCadence);
+         printf("    zones puissance (s) :");
+         for (uint8_t z = 0; z < ANALYTICS_POWER_ZONES; z++) printf(" %u", b.powerZoneS[z]);
+         printf("   zones cadence (s) :");
+         for (uint8_t z = 0; z < ANALYTICS_CADENCE_ZONES; z++) printf(" %u", b.cadenceZoneS[z]);
+         printf("\n");
+     }
+ }
+
+ int main(int argc, char** argv)
+ {
+     DecodeOptions opt;
+     if (!parseOptions(argc, argv, opt)) {
+         fprintf(stderr, "usage: %s ERGO.LOG [-o echantillons.csv] [--session N] [-j N] [--bench R] [--no-crc]\n", argv[0]);
+         return 2;
+     }
+
+     TelemetryColumns columns;
+     TelemetryLogStats stats;
+     std::string error;
+
+     auto t0 = std::chrono::steady_clock::now();
+     if (!loadTelemetryLog(opt.logPath, opt.log, columns, stats, error)) {
+         fprintf(stderr, "%s\n", error.c_str());
+         return 1;
+     }
+     double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+     // Répétitions : le fichier est alors en cache, on mesure le décodeur et non le disque
+     for (unsigned r = 0; r < opt.bench; r++) {
+         auto t = std::chrono::steady_clock::now();
+         loadTelemetryLog(opt.logPath, opt.log, columns, stats, error);
+         double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t).count();
+         if (r == 0 || s < seconds) seconds = s;
+     }
+
+     printStats(stats, columns.size());
+     printf("décodage : %.1f ms, %.0f Mo/s, %.1f M échantillons/s%s\n", seconds * 1e3,
+            stats.fileBytes / seconds / 1e6, columns.size() / seconds / 1e6, opt.bench ? " (meilleur passage)" : "");
+
+     if (opt.csvPath && !writeCsv(opt.csvPath, columns)) {
+         fprintf(stderr, "écriture impossible : %s\n", opt.csvPath);
+         return 1;
+     }
+     return 0;
+ }
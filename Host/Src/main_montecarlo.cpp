@@ -0,0 +1,247 @@
+/*
+ * main_montecarlo.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ /**
+  * Analyse de robustesse Monte-Carlo : des milliers de sorties tirées au hasard par groupe
+  * (mode, période de boucle...), bandes de percentiles de l'erreur de suivi et taux de
+  * violation des limites de sécurité.
+  *
+  *   ergo_montecarlo robustesse.txt --bands bandes.csv -o sorties.csv
+  *
+  * Exemple de fichier (même format que ergo_sweep, voir SweepSpec.hpp) :
+  *   mode          = cadence, torque, power_concentric, power_eccentric, linear
+  *   loop_ms       = 50, 100, 200
+  *   repeats       = 2000
+  *   kt_error      ~ normal(0, 0.1)     # erreur résiduelle de calibrateTorqueConstant()
+  *   cadence_noise ~ uniform(0, 3)      # tr/min
+  *   dropout       ~ uniform(0, 0.05)   # trames COMM_GET_VALUES perdues
+  *   latency_ms    ~ uniform(0.2, 5)
+  *
+  * Un groupe est déclaré "sûr" si aucune sortie n'a réarmé le chien de garde et si la part
+  * de sorties avec un déclenchement du superviseur reste sous --max-trip-rate.
+  *
+  * Les sorties saturées (isSaturatedRide) sont comptées à part : les bandes d'erreur de suivi ne
+  * portent que sur les sorties restées dans le domaine linéaire du modèle.
+  *
+  * Compilation : mêmes fichiers que ergo_sweep, en remplaçant main_sweep.cpp par ce fichier.
+  */
+
+ #include <algorithm>
+ #include <chrono>
+ #include <cstdio>
+ #include <cstdlib>
+ #include <cstring>
+ #include <string>
+ #include <vector>
+
+ #include "RideSimulation.hpp"
+ #include "SweepSpec.hpp"
+ #include "WorkStealingPool.hpp"
+
+ struct MonteCarloOptions {
+     const char* specPath = nullptr;
+     const char* ridesPath = nullptr;
+     const char* bandsPath = nullptr;
+     unsigned threads = 0;
+     float maxTripRate = 0.01f;
+ };
+
+ // Bandes d'une métrique sur un groupe
+ struct PercentileBand {
+     float p5, p50, p95, p99, max;
+ };
+
+ struct GroupReport {
+     PercentileBand tracking;  // sorties non saturées seulement
+     PercentileBand power;
+     uint32_t linearRides;
+     float saturatedRate;     // part des sorties saturées
+     float tripRate;          // part des sorties avec au moins un déclenchement du superviseur
+     float watchdogRate;
+     float meanLimitHits;
+     float meanSaturation;
+     bool safe;
+ };
+
+ static bool parseOptions(int argc, char** argv, MonteCarloOptions& opt) {
+     for (int i = 1; i < argc; i++) {
+         bool hasValue = (i + 1 < argc);
+         if (!strcmp(argv[i], "-o") && hasValue) opt.ridesPath = argv[++i];
+         else if (!strcmp(argv[i], "--bands") && hasValue) opt.bandsPath = argv[++i];
+         else if (!strcmp(argv[i], "-j") && hasValue) opt.threads = strtoul(argv[++i], nullptr, 10);
+         else if (!strcmp(argv[i], "--max-trip-rate") && hasValue) opt.maxTripRate = strtof(argv[++i], nullptr);
+         else if (argv[i][0] != '-' && !opt.specPath) opt.specPath = argv[i];
+         else return false;
+     }
+     return opt.specPath != nullptr;
+ }
+
+ static float percentile(const std::vector<float>& sorted, float p)
+ // Interpolation linéaire entre les deux rangs voisins
+ {
+     if (sorted.empty()) return 0.0f;
+     float rank = p * (sorted.size() - 1);
+     size_t lo = static_cast<size_t>(rank);
+     size_t hi = (lo + 1 < sorted.size()) ? lo + 1 : lo;
+     float frac = rank - lo;
+     return sorted[lo] + (sorted[hi] - sorted[lo]) * frac;
+ }
+
+ static PercentileBand band(std::vector<float> values) {
+     std::sort(values.begin(), values.end());
+     PercentileBand b;
+     b.p5 = percentile(values, 0.05f);
+     b.p50 = percentile(values, 0.50f);
+     b.p95 = percentile(values, 0.95f);
+     b.p99 = percentile(values, 0.99f);
+     b.max = values.empty() ? 0.0f : values.back();
+     return b;
+ }
+
+ static GroupReport analyseGroup(const SweepSpec& spec, size_t combination, const std::vector<RideMetrics>& results,
+                                 float maxTripRate) {
+     std::vector<float> tracking, power;
+     uint32_t trips = 0, resets = 0;
+     double limitHits = 0.0, saturation = 0.0;
+
+     for (uint32_t r = 0; r < spec.repeats; r++) {
+         const RideMetrics& m = results[combination * spec.repeats + r];
+         if (!isSaturatedRide(m)) {
+             tracking.push_back(m.trackingErrorRms);
+             power.push_back(m.powerErrorRms);
+         }
+         if (m.safetyTrips) trips++;
+         if (m.watchdogResets) resets++;
+         limitHits += m.limitHits;
+         saturation += m.saturatedFraction;
+     }
+
+     GroupReport g;
+     g.tracking = band(tracking);
+     g.power = band(power);
+     g.linearRides = static_cast<uint32_t>(tracking.size());
+     g.saturatedRate = 1.0f - static_cast<float>(g.linearRides) / spec.repeats;
+     g.tripRate = static_cast<float>(trips) / spec.repeats;
+     g.watchdogRate = static_cast<float>(resets) / spec.repeats;
+     g.meanLimitHits = static_cast<float>(limitHits / spec.repeats);
+     g.meanSaturation = static_cast<float>(saturation / spec.repeats);
+     g.safe = (resets == 0) && (g.tripRate <= maxTripRate);
+     return g;
+ }
+
+ static std::string groupLabel(const SweepSpec& spec, size_t combination) {
+     std::string label;
+     for (size_t a = 0; a < spec.axes.size(); a++) {
+         if (!label.empty()) label += " ";
+         label += spec.axes[a].name + "=" + sweepAxisValue(spec, combination, a);
+     }
+     return label.empty() ? "tout" : label;
+ }
+
+ static bool writeBands(const char* path, const SweepSpec& spec, const std::vector<GroupReport>& groups) {
+     FILE* f = fopen(path, "w");
+     if (!f) return false;
+
+     fprintf(f, "combination,rides,linear_rides,saturated_rate");
+     for (const SweepAxis& axis : spec.axes) fprintf(f, ",%s", axis.name.c_str());
+     const char* metrics[] = {"tracking_error_rms", "power_error_rms"};
+     for (const char* m : metrics) fprintf(f, ",%s_p5,%s_p50,%s_p95,%s_p99,%s_max", m, m, m, m, m);
+     fprintf(f, ",trip_rate,watchdog_rate,mean_limit_hits,mean_saturation,safe\n");
+
+     for (size_t c = 0; c < groups.size(); c++) {
+         const GroupReport& g = groups[c];
+         fprintf(f, "%zu,%u,%u,%.6g", c, spec.repeats, g.linearRides, g.saturatedRate);
+         for (size_t a = 0; a < spec.axes.size(); a++) fprintf(f, ",%s", sweepAxisValue(spec, c, a).c_str());
+         for (const PercentileBand* b : {&g.tracking, &g.power}) {
+             fprintf(f, ",%.6g,%.6g,%.6g,%.6g,%.6g", b->p5, b->p50, b->p95, b->p99, b->max);
+         }
+         fprintf(f, ",%.6g,%.6g,%.6g,%.6g,%d\n", g.tripRate, g.watchdogRate, g.meanLimitHits, g.meanSaturation, g.safe ? 1 : 0);
+     }
+     fclose(f);
+     return true;
+ }
+
+ static bool writeRides(const char* path, const SweepSpec& spec, const std::vector<RideMetrics>& results)
+ // Une ligne par sortie avec les perturbations tirées : pour retrouver ce qui a causé une queue de distribution
+ {
+     FILE* f = fopen(path, "w");
+     if (!f) return false;
+
+     fprintf(f, "run,combination,seed");
+     for (const SweepDistribution& dist : spec.perturbations) fprintf(f, ",%s", dist.name.c_str());
+     for (size_t m = 0; m < rideMetricFieldCount; m++) fprintf(f, ",%s", rideMetricFields[m].name);
+     fprintf(f, "\n");
+
+     std::vector<float> sampled;
+     for (size_t run = 0; run < results.size(); run++) {
+         RideSpec ride = sweepRideSpec(spec, run, &sampled);
+         fprintf(f, "%zu,%zu,%llu", run, run / spec.repeats, static_cast<unsigned long long>(ride.seed));
+         for (float v : sampled) fprintf(f, ",%.6g", v);
+         for (size_t m = 0; m < rideMetricFieldCount; m++) fprintf(f, ",%.6g", rideMetricFields[m].get(results[run]));
+         fprintf(f, "\n");
+     }
+     fclose(f);
+     return true;
+ }
+
+ int main(int argc, char** argv)
+ {
+     MonteCarloOptions opt;
+     if (!parseOptions(argc, argv, opt)) {
+         fprintf(stderr, "usage: %s FICHIER [--bands bandes.csv] [-o sorties.csv] [-j N] [--max-trip-rate R]\n", argv[0]);
+         return 2;
+     }
+
+     SweepSpec spec;
+     std::string error;
+     if (!parseSweepSpec(opt.specPath, spec, error)) {
+         fprintf(stderr, "%s : %s\n", opt.specPath, error.c_str());
+         return 1;
+     }
+     if (spec.perturbations.empty()) {
+         fprintf(stderr, "%s : aucune perturbation (\"nom ~ loi\"), toutes les sorties d'un groupe seraient identiques\n",
+                 opt.specPath);
+     }
+
+     std::vector<RideMetrics> results(spec.runCount());
+     WorkStealingPool pool(opt.threads);
+     printf("%zu groupes x %u sorties = %zu sorties sur %u threads\n",
+            spec.combinationCount(), spec.repeats, spec.runCount(), pool.getThreadCount());
+
+     auto start = std::chrono::steady_clock::now();
+     pool.run(spec.runCount(), [&](size_t run, unsigned) {
+         results[run] = runRide(sweepRideSpec(spec, run));
+     });
+     double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+     printf("%.1f s (%.0f sorties/s)\n\n", wall, spec.runCount() / wall);
+
+     std::vector<GroupReport> groups;
+     printf("%-40s %28s %10s %10s %10s %8s\n", "groupe", "erreur de suivi p50/p95/p99", "saturées %", "décl. %",
+            "IWDG %", "verdict");
+     for (size_t c = 0; c < spec.combinationCount(); c++) {
+         groups.push_back(analyseGroup(spec, c, results, opt.maxTripRate));
+         const GroupReport& g = groups.back();
+         if (g.linearRides) {
+             printf("%-40s %8.2f / %8.2f / %8.2f", groupLabel(spec, c).c_str(), g.tracking.p50, g.tracking.p95,
+                    g.tracking.p99);
+         } else {
+             printf("%-40s %28s", groupLabel(spec, c).c_str(), "(toutes saturées)");
+         }
+         printf(" %10.2f %10.2f %10.2f %8s\n", 100.0f * g.saturatedRate, 100.0f * g.tripRate, 100.0f * g.watchdogRate,
+                g.safe ? "sûr" : "NON");
+     }
+
+     if (opt.bandsPath && !writeBands(opt.bandsPath, spec, groups)) {
+         fprintf(stderr, "impossible d'écrire %s\n", opt.bandsPath);
+         return 1;
+     }
+     if (opt.ridesPath && !writeRides(opt.ridesPath, spec, results)) {
+         fprintf(stderr, "impossible d'écrire %s\n", opt.ridesPath);
+         return 1;
+     }
+     return 0;
+ }
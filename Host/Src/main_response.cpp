@@ -0,0 +1,148 @@
+/*
+ * main_response.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ /**
+  * Analyse PC des tests de réponse enregistrés dans un journal de séance (ERGO.LOG ou --log de ergo_host).
+  *
+  *   ergo_response ERGO.LOG                               # chaque test trouvé : échelons, bandes, synthèse
+  *   ergo_response ERGO.LOG --session 12 -o bode.csv      # réponse en fréquence en CSV
+  *   ergo_response ERGO.LOG --hold 6000 --chirp 0.02 0.5 90000 --bands 8
+  *
+  * Un test = une suite d'échantillons marqués TELEMETRY_RESPONSE_TEST ; le temps écoulé part du premier.
+  * Le programme n'est pas dans le journal : les options de durée doivent reprendre celles du firmware
+  * (par défaut defaultResponseTestConfig()). Le mode (CADENCE ou TORQUE) est lu dans les échantillons.
+  *
+  * Compilation (depuis la racine) :
+  *   g++ -std=c++17 -O2 -pthread -DERGO_HOST -IHost/Inc -IInc Host/Src/main_response.cpp \
+  *       Host/Src/TelemetryLog.cpp Host/Src/WorkStealingPool.cpp Src/TelemetryCodec.cpp Src/ResponseTest.cpp \
+  *       -o ergo_response
+  */
+
+ #include <cstdio>
+ #include <cstdlib>
+ #include <cstring>
+ #include <string>
+
+ #include "TelemetryLog.hpp"
+ #include "TelemetryRing.hpp"
+ #include "ResponseTest.hpp"
+
+ struct ResponseOptions {
+     const char* logPath = nullptr;
+     const char* csvPath = nullptr;
+     TelemetryLogOptions log;
+     ResponseTestConfig config = defaultResponseTestConfig();
+ };
+
+ static bool parseOptions(int argc, char** argv, ResponseOptions& opt) {
+     for (int i = 1; i < argc; i++) {
+         bool hasValue = (i + 1 < argc);
+         if (!strcmp(argv[i], "-o") && hasValue) opt.csvPath = argv[++i];
+         else if (!strcmp(argv[i], "-j") && hasValue) opt.log.threads = strtoul(argv[++i], nullptr, 10);
+         else if (!strcmp(argv[i], "--session") && hasValue) {
+             opt.log.filterSession = true;
+             opt.log.session = strtoul(argv[++i], nullptr, 10);
+         }
+         else if (!strcmp(argv[i], "--steps") && hasValue) opt.config.stepCount = static_cast<uint8_t>(atoi(argv[++i]));
+         else if (!strcmp(argv[i], "--hold") && hasValue) opt.config.stepHoldMs = strtoul(argv[++i], nullptr, 10);
+         else if (!strcmp(argv[i], "--bands") && hasValue) opt.config.chirpBands = static_cast<uint8_t>(atoi(argv[++i]));
+         else if (!strcmp(argv[i], "--chirp") && i + 3 < argc) {
+             opt.config.chirpStartHz = strtof(argv[++i], nullptr);
+             opt.config.chirpEndHz = strtof(argv[++i], nullptr);
+             opt.config.chirpMs = strtoul(argv[++i], nullptr, 10);
+         }
+         else if (argv[i][0] != '-' && !opt.logPath) opt.logPath = argv[i];
+         else return false;
+     }
+     return opt.logPath != nullptr;
+ }
+
+ static void writeCsvRows(FILE* f, uint32_t session, uint32_t test, const ResponseTestResult& r) {
+     for (uint8_t b = 0; b < r.bandCount; b++) {
+         const FrequencyPoint& p = r.bands[b];
+         fprintf(f, "%u,%u,%u,%.4f,%.4f,%.2f,%.1f,%u,%u\n", session, test, b, p.hz, p.gain, p.phaseDeg,
+                 p.delayMs, p.samples, p.valid ? 1u : 0u);
+     }
+ }
+
+ int main(int argc, char** argv)
+ {
+     ResponseOptions opt;
+     if (!parseOptions(argc, argv, opt)) {
+         fprintf(stderr, "usage: %s ERGO.LOG [-o bode.csv] [--session N] [-j N] [--steps N] [--hold MS]\n"
+                         "          [--chirp F0 F1 MS] [--bands N]\n", argv[0]);
+         return 2;
+     }
+
+     TelemetryColumns c;
+     TelemetryLogStats stats;
+     std::string error;
+     if (!loadTelemetryLog(opt.logPath, opt.log, c, stats, error)) {
+         fprintf(stderr, "%s\n", error.c_str());
+         return 1;
+     }
+     if (stats.invalidBlocks || stats.decodeErrors) {
+         fprintf(stderr, "attention : %u blocs invalides, %u indécodables (ignorés)\n", stats.invalidBlocks, stats.decodeErrors);
+     }
+
+     FILE* csv = nullptr;
+     if (opt.csvPath) {
+         csv = fopen(opt.csvPath, "w");
+         if (!csv) {
+             fprintf(stderr, "écriture impossible : %s\n", opt.csvPath);
+             return 1;
+         }
+         fprintf(csv, "session,test,band,hz,gain,phase_deg,delay_ms,samples,valid\n");
+     }
+
+     ResponseAnalyzer analyzer;
+     uint32_t tests = 0;
+     for (size_t i = 0; i < c.size();) {
+         if (!(c.flags[i] & TELEMETRY_RESPONSE_TEST)) {
+             i++;
+             continue;
+         }
+
+         // Un test : échantillons marqués consécutifs d'une même séance
+         const size_t first = i;
+         const uint32_t session = c.sessionId[first];
+         while (i < c.size() && (c.flags[i] & TELEMETRY_RESPONSE_TEST) && c.sessionId[i] == session) i++;
+
+         ResponseTestConfig cfg = opt.config;
+         cfg.mode = static_cast<ControlMode>(c.mode[first]);
+         const bool cadence = cfg.mode == ControlMode::CADENCE;
+         analyzer.configure(cfg);
+
+         const uint32_t t0 = c.tickMs[first];
+         for (size_t k = first; k < i; k++) {
+             if (!(c.flags[k] & TELEMETRY_VALID)) continue;  // comme sur cible : tick sans mesure non analysé
+             float reference = cadence ? c.setpoint[k] : c.appliedCurrent[k];
+             float measured = cadence ? ((c.flags[k] & TELEMETRY_REVERSE) ? -c.cadence[k] : c.cadence[k]) : c.current[k];
+             analyzer.push(c.tickMs[k] - t0, reference, measured);
+         }
+         analyzer.finish();
+
+         const uint32_t span = c.tickMs[i - 1] - t0;
+         const uint32_t expected = analyzer.getProgram().getDurationMs();
+         tests++;
+         printf("séance %u, test %u : mode %s, %zu échantillons sur %.1f s (programme %.1f s%s)\n",
+                session, tests, cadence ? "cadence" : "couple", i - first, span / 1000.0, expected / 1000.0,
+                span + 1000u < expected ? ", interrompu" : "");
+         responseTestPrint(stdout, analyzer.getResult(), cadence ? "tr/min" : "A");
+         if (csv) writeCsvRows(csv, session, tests, analyzer.getResult());
+     }
+
+     if (csv && fclose(csv) != 0) {
+         fprintf(stderr, "écriture impossible : %s\n", opt.csvPath);
+         return 1;
+     }
+     if (tests == 0) {
+         printf("aucun test de réponse dans %s\n", opt.logPath);
+         return 1;
+     }
+     return 0;
+ }
@@ -0,0 +1,206 @@
+/*
+ * main_sweep.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ /**
+  * Balayage de réglages en simulation plus rapide que le temps réel, sur tous les cœurs.
+  *
+  *   ergo_sweep grille.txt -o sorties.csv --summary resume.csv
+  *   ergo_sweep grille.txt --scaling        # temps et accélération pour 1, 2, 4... threads
+  *
+  * Chaque sortie fait tourner le contrôleur réel contre VescEmulator(ErgocyclePlant) et
+  * NextionEmulator. Sa graine ne dépend que de son numéro : le CSV est identique quel que
+  * soit le nombre de threads. Format de la grille : voir SweepSpec.hpp.
+  *
+  * Compilation (depuis la racine) :
+  *   g++ -std=c++17 -O2 -pthread -DERGO_HOST -IHost/Inc -IInc Host/Src/main_sweep.cpp Host/Src/SweepSpec.cpp \
+  *       Host/Src/RideSimulation.cpp Host/Src/WorkStealingPool.cpp Host/Src/HostHal.cpp Host/Src/VescEmulator.cpp \
+  *       Host/Src/NextionEmulator.cpp Host/Src/ErgocyclePlant.cpp Src/MotorController.cpp Src/VESCInterface.cpp \
+  *       Src/ScreenDisplay.cpp Src/MotorComputations.cpp Src/SignalConditioning.cpp Src/KtCalibration.cpp \
+  *       Src/SettingsStore.cpp Src/SafetySupervisor.cpp Src/SessionAnalytics.cpp \
+  *       Src/ResponseTest.cpp Src/DrivetrainParams.cpp -o ergo_sweep
+  */
+
+ #include <chrono>
+ #include <cmath>
+ #include <cstdio>
+ #include <cstdlib>
+ #include <cstring>
+ #include <string>
+ #include <thread>
+ #include <vector>
+
+ #include "RideSimulation.hpp"
+ #include "SweepSpec.hpp"
+ #include "WorkStealingPool.hpp"
+
+ struct SweepOptions {
+     const char* specPath = nullptr;
+     const char* resultsPath = "sweep_results.csv";
+     const char* summaryPath = nullptr;
+     unsigned threads = 0;  // 0 = tous les cœurs
+     bool scaling = false;
+ };
+
+ static bool parseOptions(int argc, char** argv, SweepOptions& opt) {
+     for (int i = 1; i < argc; i++) {
+         bool hasValue = (i + 1 < argc);
+         if (!strcmp(argv[i], "-o") && hasValue) opt.resultsPath = argv[++i];
+         else if (!strcmp(argv[i], "--summary") && hasValue) opt.summaryPath = argv[++i];
+         else if (!strcmp(argv[i], "-j") && hasValue) opt.threads = strtoul(argv[++i], nullptr, 10);
+         else if (!strcmp(argv[i], "--scaling")) opt.scaling = true;
+         else if (argv[i][0] != '-' && !opt.specPath) opt.specPath = argv[i];
+         else return false;
+     }
+     return opt.specPath != nullptr;
+ }
+
+ static double runSweep(const SweepSpec& spec, unsigned threads, std::vector<RideMetrics>& results, uint64_t& steals) {
+     results.assign(spec.runCount(), RideMetrics());
+     WorkStealingPool pool(threads);
+
+     auto start = std::chrono::steady_clock::now();
+     pool.run(spec.runCount(), [&](size_t run, unsigned) {
+         results[run] = runRide(sweepRideSpec(spec, run));  // une case par sortie : pas de verrou
+     });
+     steals = pool.getSteals();
+     return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+ }
+
+ static bool writeResults(const char* path, const SweepSpec& spec, const std::vector<RideMetrics>& results) {
+     FILE* f = fopen(path, "w");
+     if (!f) return false;
+
+     fprintf(f, "run,combination,repeat,seed");
+     for (const SweepAxis& axis : spec.axes) fprintf(f, ",%s", axis.name.c_str());
+     for (const SweepDistribution& dist : spec.perturbations) fprintf(f, ",%s", dist.name.c_str());
+     for (size_t m = 0; m < rideMetricFieldCount; m++) fprintf(f, ",%s", rideMetricFields[m].name);
+     fprintf(f, ",saturated\n");
+
+     std::vector<float> sampled;
+     for (size_t run = 0; run < results.size(); run++) {
+         size_t combination = run / spec.repeats;
+         sweepRideSpec(spec, run, &sampled);
+         fprintf(f, "%zu,%zu,%zu,%llu", run, combination, run % spec.repeats,
+                 static_cast<unsigned long long>(sweepRunSeed(spec.seed, run)));
+         for (size_t a = 0; a < spec.axes.size(); a++) fprintf(f, ",%s", sweepAxisValue(spec, combination, a).c_str());
+         for (float v : sampled) fprintf(f, ",%.6g", v);
+         for (size_t m = 0; m < rideMetricFieldCount; m++) fprintf(f, ",%.6g", rideMetricFields[m].get(results[run]));
+         fprintf(f, ",%d\n", isSaturatedRide(results[run]) ? 1 : 0);
+     }
+     fclose(f);
+     return true;
+ }
+
+ static bool writeSummary(const char* path, const SweepSpec& spec, const std::vector<RideMetrics>& results)
+ // Une ligne par combinaison : moyenne et écart-type de chaque métrique sur les répétitions restées
+ // dans le domaine linéaire ; les sorties saturées sont seulement comptées (toutes saturées : moyennes vides)
+ {
+     FILE* f = fopen(path, "w");
+     if (!f) return false;
+
+     fprintf(f, "combination,linear_runs,saturated_runs");
+     for (const SweepAxis& axis : spec.axes) fprintf(f, ",%s", axis.name.c_str());
+     for (size_t m = 0; m < rideMetricFieldCount; m++) {
+         fprintf(f, ",%s_mean,%s_std", rideMetricFields[m].name, rideMetricFields[m].name);
+     }
+     fprintf(f, "\n");
+
+     for (size_t c = 0; c < spec.combinationCount(); c++) {
+         uint32_t linear = 0;
+         for (uint32_t r = 0; r < spec.repeats; r++) {
+             if (!isSaturatedRide(results[c * spec.repeats + r])) linear++;
+         }
+         fprintf(f, "%zu,%u,%u", c, linear, spec.repeats - linear);
+         for (size_t a = 0; a < spec.axes.size(); a++) fprintf(f, ",%s", sweepAxisValue(spec, c, a).c_str());
+
+         for (size_t m = 0; m < rideMetricFieldCount; m++) {
+             double sum = 0.0, sumSq = 0.0;
+             for (uint32_t r = 0; r < spec.repeats; r++) {
+                 const RideMetrics& ride = results[c * spec.repeats + r];
+                 if (isSaturatedRide(ride)) continue;
+                 double v = rideMetricFields[m].get(ride);
+                 sum += v;
+                 sumSq += v * v;
+             }
+             if (!linear) {
+                 fprintf(f, ",,");
+                 continue;
+             }
+             double mean = sum / linear;
+             double var = (linear > 1) ? (sumSq - linear * mean * mean) / (linear - 1) : 0.0;
+             fprintf(f, ",%.6g,%.6g", mean, sqrt(var > 0.0 ? var : 0.0));
+         }
+         fprintf(f, "\n");
+     }
+     fclose(f);
+     return true;
+ }
+
+ static bool sameResults(const std::vector<RideMetrics>& a, const std::vector<RideMetrics>& b) {
+     return a.size() == b.size() && (a.empty() || memcmp(a.data(), b.data(), a.size() * sizeof(RideMetrics)) == 0);
+ }
+
+ int main(int argc, char** argv)
+ {
+     SweepOptions opt;
+     if (!parseOptions(argc, argv, opt)) {
+         fprintf(stderr, "usage: %s GRILLE [-o sorties.csv] [--summary resume.csv] [-j N] [--scaling]\n", argv[0]);
+         return 2;
+     }
+
+     SweepSpec spec;
+     std::string error;
+     if (!parseSweepSpec(opt.specPath, spec, error)) {
+         fprintf(stderr, "%s : %s\n", opt.specPath, error.c_str());
+         return 1;
+     }
+     printf("%zu combinaisons x %u répétitions = %zu sorties\n", spec.combinationCount(), spec.repeats, spec.runCount());
+
+     std::vector<RideMetrics> results;
+     uint64_t steals = 0;
+
+     if (opt.scaling) {
+         unsigned maxThreads = opt.threads ? opt.threads : std::thread::hardware_concurrency();
+         std::vector<RideMetrics> reference;
+         double base = runSweep(spec, 1, reference, steals);
+         printf("threads  temps (s)  accélération  efficacité\n");
+         printf("%7u  %9.3f  %12.2f  %9.0f %%\n", 1u, base, 1.0, 100.0);
+
+         for (unsigned t = 2; t <= maxThreads; t *= 2) {
+             double wall = runSweep(spec, t, results, steals);
+             printf("%7u  %9.3f  %12.2f  %9.0f %%  (%llu vols)%s\n", t, wall, base / wall, 100.0 * base / wall / t,
+                    static_cast<unsigned long long>(steals), sameResults(reference, results) ? "" : "  RESULTATS DIFFERENTS");
+             if (t < maxThreads && t * 2 > maxThreads) t = maxThreads / 2;  // dernier palier = tous les cœurs
+         }
+         results.swap(reference);
+     } else {
+         double wall = runSweep(spec, opt.threads, results, steals);
+         double simulated = 0.0;
+         for (size_t run = 0; run < spec.runCount(); run++) simulated += sweepRideSpec(spec, run).durationS;
+         printf("%.3f s, %.1f sorties/s, %.0fx le temps réel (%llu vols)\n", wall, spec.runCount() / wall,
+                simulated / wall, static_cast<unsigned long long>(steals));
+     }
+
+     size_t saturated = 0;
+     for (const RideMetrics& m : results) {
+         if (isSaturatedRide(m)) saturated++;
+     }
+     if (saturated) {
+         printf("%zu sortie(s) saturée(s) (> %.0f %% du temps en limite), exclues des moyennes du résumé\n",
+                saturated, 100.0f * SATURATED_RIDE_FRACTION);
+     }
+
+     if (!writeResults(opt.resultsPath, spec, results)) {
+         fprintf(stderr, "impossible d'écrire %s\n", opt.resultsPath);
+         return 1;
+     }
+     if (opt.summaryPath && !writeSummary(opt.summaryPath, spec, results)) {
+         fprintf(stderr, "impossible d'écrire %s\n", opt.summaryPath);
+         return 1;
+     }
+     return 0;
+ }
@@ -0,0 +1,377 @@
+/*
+ * main_sysid.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ /**
+  * Identification hors ligne de la transmission à partir des journaux de séance (ERGO.LOG, --log de ergo_host).
+  *
+  *   ergo_sysid ERGO.LOG                                  # écrit ERGO.PAR, à copier sur la clé USB
+  *   ergo_sysid S1.LOG S2.LOG S3.LOG -j 8 -o ERGO.PAR     # plusieurs journaux, un par thread
+  *   ergo_sysid ERGO.LOG --all --kt 0.2                   # toutes les phases, Kt imposé
+  *
+  * Deux régressions linéaires, cadence et courant pris dans le repère du VESC (signés) :
+  *   électrique  duty·Vbatt = Ke·ω_moteur + R·I                     → Kt = Ke (unités SI)
+  *   mécanique   I = (J·α + visqueux·ω + coulomb·signe(ω)) / (Kt·rapport)
+  * La seconde est résolue en ampères puis mise à l'échelle par Kt·rapport : J et les frottements sont
+  * dans l'unité du firmware (MotorComputations), rendement du réducteur inclus. α est la différence
+  * centrée de la cadence, jamais à travers une séance ou un trou de télémétrie. Le courant journalisé
+  * est filtré (biquad) et retarde sur la cadence : la régression mécanique est faite pour un retard
+  * de 0 à CURRENT_LAGS - 1 ticks, celle de meilleur R² est retenue.
+  *
+  * Le couple du cycliste n'est pas mesuré : par défaut, seules les phases où le firmware impose la
+  * consigne (calibration, test de réponse) entrent dans la régression mécanique, cycliste supposé
+  * passif. --all prend tous les échantillons (banc sans cycliste). La régression électrique ne dépend
+  * pas du cycliste : elle prend toujours tout.
+  *
+  * Moindres carrés par équations normales : chaque journal est découpé en lots de colonnes contiguës
+  * (une colonne par régresseur), accumulés dans XᵀX et Xᵀy en double ; les journaux sont traités en
+  * parallèle puis leurs sommes additionnées, sans garder les échantillons.
+  *
+  * Compilation (depuis la racine) :
+  *   g++ -std=c++17 -O2 -pthread -DERGO_HOST -IHost/Inc -IInc Host/Src/main_sysid.cpp Host/Src/TelemetryLog.cpp \
+  *       Host/Src/WorkStealingPool.cpp Src/TelemetryCodec.cpp Src/SignalConditioning.cpp Src/SettingsStore.cpp \
+  *       Src/DrivetrainParams.cpp Src/DrivetrainParamsFile.cpp -o ergo_sysid
+  */
+
+ #include <cmath>
+ #include <cstdio>
+ #include <cstdlib>
+ #include <cstring>
+ #include <string>
+ #include <vector>
+
+ #include "TelemetryLog.hpp"
+ #include "TelemetryRing.hpp"
+ #include "WorkStealingPool.hpp"
+ #include "SignalConditioning.hpp"
+ #include "DrivetrainParams.hpp"
+
+ struct SysidOptions {
+     std::vector<const char*> logPaths;
+     const char* outPath = "ERGO.PAR";
+     unsigned threads = 0;          // 0 = tous les cœurs
+     bool allSamples = false;
+     float reductionRatio = defaultConditioningConfig().reductionRatio;
+     float torqueConstant = 0.0f;   // > 0 : imposé, la régression électrique n'est qu'indicative
+     float minCadence = 5.0f;       // tr/min : en dessous, signe(ω) et Ke sont mal définis
+     float maxSteadyRate = 1.0f;    // tr/min/s : régime établi pour la régression électrique
+     uint32_t maxGapMs = 1000;      // intervalle au-delà duquel α n'est pas calculée
+     size_t minSamples = 100;
+ };
+
+ static bool parseOptions(int argc, char** argv, SysidOptions& opt) {
+     for (int i = 1; i < argc; i++) {
+         bool hasValue = (i + 1 < argc);
+         if (!strcmp(argv[i], "-o") && hasValue) opt.outPath = argv[++i];
+         else if (!strcmp(argv[i], "-j") && hasValue) opt.threads = strtoul(argv[++i], nullptr, 10);
+         else if (!strcmp(argv[i], "--all")) opt.allSamples = true;
+         else if (!strcmp(argv[i], "--ratio") && hasValue) opt.reductionRatio = strtof(argv[++i], nullptr);
+         else if (!strcmp(argv[i], "--kt") && hasValue) opt.torqueConstant = strtof(argv[++i], nullptr);
+         else if (!strcmp(argv[i], "--min-cadence") && hasValue) opt.minCadence = strtof(argv[++i], nullptr);
+         else if (argv[i][0] != '-') opt.logPaths.push_back(argv[i]);
+         else return false;
+     }
+     return !opt.logPaths.empty() && opt.reductionRatio > 0.0f;
+ }
+
+ /**
+  * @brief Équations normales d'une régression à N régresseurs sans constante.
+  *
+  * accumulate() prend un lot de colonnes contiguës : chaque produit scalaire est une boucle à
+  * LANES voies indépendantes, vectorisée par le compilateur sans réassocier les sommes (pas besoin
+  * de -ffast-math) ; le lot reste court pour que les sommes en float ne perdent pas de précision.
+  */
+ template <size_t N>
+ struct NormalEquations {
+     double xtx[N][N];
+     double xty[N];
+     double yty;
+     double ysum;
+     uint64_t count;
+
+     NormalEquations() { clear(); }
+
+     void clear() {
+         memset(xtx, 0, sizeof(xtx));
+         memset(xty, 0, sizeof(xty));
+         yty = ysum = 0.0;
+         count = 0;
+     }
+
+     void accumulate(const float* const x[N], const float* y, size_t n) {
+         for (size_t a = 0; a < N; a++) {
+             for (size_t b = a; b < N; b++) xtx[a][b] += dot(x[a], x[b], n);
+             xty[a] += dot(x[a], y, n);
+         }
+         yty += dot(y, y, n);
+         for (size_t i = 0; i < n; i++) ysum += y[i];
+         count += n;
+     }
+
+     void merge(const NormalEquations& other) {
+         for (size_t a = 0; a < N; a++) {
+             for (size_t b = a; b < N; b++) xtx[a][b] += other.xtx[a][b];
+             xty[a] += other.xty[a];
+         }
+         yty += other.yty;
+         ysum += other.ysum;
+         count += other.count;
+     }
+
+     bool solve(double beta[N]) const
+     // Cholesky de XᵀX (symétrique, triangle supérieur rempli) ; faux si un régresseur est dégénéré
+     {
+         double l[N][N] = {};
+         for (size_t j = 0; j < N; j++) {
+             double d = xtx[j][j];
+             for (size_t k = 0; k < j; k++) d -= l[j][k] * l[j][k];
+             if (d <= 1e-12 * (xtx[j][j] + 1e-30)) return false;
+             l[j][j] = sqrt(d);
+             for (size_t i = j + 1; i < N; i++) {
+                 double s = xtx[j][i];
+                 for (size_t k = 0; k < j; k++) s -= l[i][k] * l[j][k];
+                 l[i][j] = s / l[j][j];
+             }
+         }
+         double z[N];
+         for (size_t i = 0; i < N; i++) {
+             double s = xty[i];
+             for (size_t k = 0; k < i; k++) s -= l[i][k] * z[k];
+             z[i] = s / l[i][i];
+         }
+         for (size_t i = N; i-- > 0;) {
+             double s = z[i];
+             for (size_t k = i + 1; k < N; k++) s -= l[k][i] * beta[k];
+             beta[i] = s / l[i][i];
+         }
+         return true;
+     }
+
+     double rSquared(const double beta[N]) const
+     // Résidu calculé depuis les sommes : ‖y - Xβ‖² = yᵀy - 2βᵀXᵀy + βᵀXᵀXβ
+     {
+         double sse = yty;
+         for (size_t a = 0; a < N; a++) {
+             sse -= 2.0 * beta[a] * xty[a];
+             for (size_t b = 0; b < N; b++) sse += beta[a] * beta[b] * (a <= b ? xtx[a][b] : xtx[b][a]);
+         }
+         double sst = yty - ysum * ysum / static_cast<double>(count);
+         return (sst > 0.0) ? 1.0 - sse / sst : 0.0;
+     }
+
+ private:
+     static const size_t LANES = 8;
+
+     static double dot(const float* u, const float* v, size_t n) {
+         float lane[LANES] = {};
+         size_t i = 0;
+         for (; i + LANES <= n; i += LANES) {
+             for (size_t k = 0; k < LANES; k++) lane[k] += u[i + k] * v[i + k];
+         }
+         double sum = 0.0;
+         for (size_t k = 0; k < LANES; k++) sum += lane[k];
+         for (; i < n; i++) sum += static_cast<double>(u[i]) * v[i];
+         return sum;
+     }
+ };
+
+ typedef NormalEquations<2> ElectricalFit;   // ω moteur, I        → duty·Vbatt
+ typedef NormalEquations<3> MechanicalFit;   // α, ω, signe(ω)     → I
+
+ static const size_t CURRENT_LAGS = 4;
+
+ struct MechanicalFits {
+     MechanicalFit lag[CURRENT_LAGS];  // courant pris lag ticks après la cadence
+
+     void merge(const MechanicalFits& other) {
+         for (size_t k = 0; k < CURRENT_LAGS; k++) lag[k].merge(other.lag[k]);
+     }
+ };
+
+ /**
+  * @brief Lot d'échantillons retenus, une colonne par régresseur (structure de tableaux).
+  */
+ struct SampleBatch {
+     static const size_t SIZE = 1024;  // 4 Ko par colonne : le lot tient en cache L1/L2
+
+     size_t electricalCount = 0;
+     float motorOmega[SIZE], current[SIZE], phaseVoltage[SIZE];
+     size_t mechanicalCount = 0;
+     float alpha[SIZE], omega[SIZE], sign[SIZE], mechanicalCurrent[CURRENT_LAGS][SIZE];
+
+     void flushElectrical(ElectricalFit& fit) {
+         const float* x[2] = {motorOmega, current};
+         fit.accumulate(x, phaseVoltage, electricalCount);
+         electricalCount = 0;
+     }
+
+     void flushMechanical(MechanicalFits& fits) {
+         const float* x[3] = {alpha, omega, sign};
+         for (size_t k = 0; k < CURRENT_LAGS; k++) fits.lag[k].accumulate(x, mechanicalCurrent[k], mechanicalCount);
+         mechanicalCount = 0;
+     }
+ };
+
+ struct LogFit {
+     bool loaded = false;
+     std::string error;
+     size_t samples = 0;
+     uint32_t sessions = 0;
+     ElectricalFit electrical;
+     MechanicalFits mechanical;
+ };
+
+ static void fitLog(const char* path, const SysidOptions& opt, LogFit& fit)
+ // Un journal par tâche : décodage mono-thread (le parallélisme est entre journaux), un seul parcours
+ {
+     TelemetryLogOptions logOptions;
+     logOptions.threads = 1;
+     TelemetryColumns c;
+     TelemetryLogStats stats;
+     if (!loadTelemetryLog(path, logOptions, c, stats, fit.error)) return;
+     fit.loaded = true;
+     fit.samples = c.size();
+     fit.sessions = static_cast<uint32_t>(stats.sessions.size());
+
+     const float rpmToOmega = 2.0f * static_cast<float>(M_PI) / 60.0f;
+     const uint8_t imposed = TELEMETRY_CALIBRATING | TELEMETRY_RESPONSE_TEST;
+     SampleBatch* batch = new SampleBatch;  // 40 Ko : hors pile des threads
+
+     for (size_t i = 1; i + CURRENT_LAGS < c.size(); i++) {
+         // Voisins valides de la même séance, sans trou : α est définie
+         if ((c.flags[i] & (TELEMETRY_VALID | TELEMETRY_TRIPPED)) != TELEMETRY_VALID) continue;
+         if (!(c.flags[i - 1] & TELEMETRY_VALID) || !(c.flags[i + 1] & TELEMETRY_VALID)) continue;
+         if (c.sessionId[i - 1] != c.sessionId[i] || c.sessionId[i + 1] != c.sessionId[i]) continue;
+         const uint32_t span = c.tickMs[i + 1] - c.tickMs[i - 1];
+         if (span == 0 || span > 2 * opt.maxGapMs) continue;
+         if (fabsf(c.cadence[i]) < opt.minCadence) continue;
+
+         const float omega = c.cadence[i] * rpmToOmega;
+         const float rate = (c.cadence[i + 1] - c.cadence[i - 1]) * 1000.0f / span;  // tr/min/s
+
+         // Électrique : régime établi seulement, les filtres de cadence et de duty n'ont pas le même retard
+         if (fabsf(rate) <= opt.maxSteadyRate) {
+             size_t& e = batch->electricalCount;
+             batch->motorOmega[e] = omega * opt.reductionRatio;
+             batch->current[e] = c.current[i];
+             batch->phaseVoltage[e] = c.dutyCycle[i] * c.inputVoltage[i];
+             if (++e == SampleBatch::SIZE) batch->flushElectrical(fit.electrical);
+         }
+
+         // Mécanique : consigne imposée par le firmware (sauf --all)
+         if (!opt.allSamples && !(c.flags[i] & imposed)) continue;
+         const size_t last = i + CURRENT_LAGS - 1;
+         if (c.sessionId[last] != c.sessionId[i] || c.tickMs[last] - c.tickMs[i] > (CURRENT_LAGS - 1) * opt.maxGapMs) continue;
+         size_t& m = batch->mechanicalCount;
+         batch->alpha[m] = rate * rpmToOmega;
+         batch->omega[m] = omega;
+         batch->sign[m] = (omega > 0.0f) ? 1.0f : -1.0f;
+         for (size_t k = 0; k < CURRENT_LAGS; k++) batch->mechanicalCurrent[k][m] = c.current[i + k];
+         if (++m == SampleBatch::SIZE) batch->flushMechanical(fit.mechanical);
+     }
+     batch->flushElectrical(fit.electrical);
+     batch->flushMechanical(fit.mechanical);
+     delete batch;
+ }
+
+ static DrivetrainParams identify(const ElectricalFit& electrical, const MechanicalFits& mechanical, const SysidOptions& opt,
+                                  size_t& lag)
+ // Solutions et plausibilité : un groupe non plausible reste dans le fichier mais sans son drapeau
+ {
+     DrivetrainParams p;
+     memset(&p, 0, sizeof(p));
+     p.reductionRatio = opt.reductionRatio;
+     p.samples = static_cast<uint32_t>(mechanical.lag[0].count);
+     lag = 0;
+
+     double e[2];
+     bool ktIdentified = false;
+     if (electrical.count >= opt.minSamples && electrical.solve(e)) {
+         p.torqueConstant = static_cast<float>(e[0]);
+         p.resistance = static_cast<float>(e[1]);
+         p.electricalR2 = static_cast<float>(electrical.rSquared(e));
+         // Plage de la calibration. R n'entre pas dans le critère : R·I ne pèse que quelques dizaines de mV
+         // devant Ke·ω, sa valeur est indicative (le retard du filtre de courant suffit à la fausser)
+         ktIdentified = p.torqueConstant > 0.01f && p.torqueConstant < 1.0f;
+     }
+     if (opt.torqueConstant > 0.0f) p.torqueConstant = opt.torqueConstant;  // imposé : déjà celui du firmware
+     else if (ktIdentified) p.flags |= DRIVETRAIN_KT;
+     if (!(opt.torqueConstant > 0.0f || ktIdentified)) return p;  // sans Kt, pas de mise à l'échelle en Nm
+
+     double m[3] = {0.0, 0.0, 0.0};
+     double best = -1e30;
+     bool solved = false;
+     for (size_t k = 0; k < CURRENT_LAGS; k++) {
+         double beta[3];
+         const MechanicalFit& fit = mechanical.lag[k];
+         if (fit.count < opt.minSamples || !fit.solve(beta)) continue;
+         double r2 = fit.rSquared(beta);
+         if (r2 <= best) continue;
+         best = r2;
+         lag = k;
+         memcpy(m, beta, sizeof(m));
+         solved = true;
+     }
+     if (!solved) return p;
+     const double scale = static_cast<double>(p.torqueConstant) * opt.reductionRatio;  // A → Nm au pédalier
+     p.inertia = static_cast<float>(m[0] * scale);
+     p.viscous = static_cast<float>(m[1] * scale);
+     p.coulomb = static_cast<float>(m[2] * scale);
+     p.mechanicalR2 = static_cast<float>(best);
+     if (p.inertia > 0.0f) p.flags |= DRIVETRAIN_INERTIA;
+     if (p.viscous >= 0.0f && p.coulomb >= 0.0f) p.flags |= DRIVETRAIN_FRICTION;
+     return p;
+ }
+
+ int main(int argc, char** argv)
+ {
+     SysidOptions opt;
+     if (!parseOptions(argc, argv, opt)) {
+         fprintf(stderr, "usage: %s LOG... [-o ERGO.PAR] [-j N] [--all] [--ratio R] [--kt KT] [--min-cadence RPM]\n", argv[0]);
+         return 2;
+     }
+
+     std::vector<LogFit> fits(opt.logPaths.size());
+     WorkStealingPool pool(opt.threads);
+     pool.run(fits.size(), [&](size_t index, unsigned) { fitLog(opt.logPaths[index], opt, fits[index]); });
+
+     // Rapport par journal (dans l'ordre des arguments) : un journal aberrant se repère à ses coefficients
+     ElectricalFit electrical;
+     MechanicalFits mechanical;
+     size_t loaded = 0;
+     size_t lag;
+     printf("journal                        séances  échantillons  électr.  méca.    Kt      R²     J      R²   retard\n");
+     for (size_t i = 0; i < fits.size(); i++) {
+         const LogFit& f = fits[i];
+         if (!f.loaded) {
+             fprintf(stderr, "%s : %s\n", opt.logPaths[i], f.error.c_str());
+             continue;
+         }
+         loaded++;
+         electrical.merge(f.electrical);
+         mechanical.merge(f.mechanical);
+         DrivetrainParams p = identify(f.electrical, f.mechanical, opt, lag);
+         printf("%-30s %7u %13zu %8llu %6u  %6.4f %6.3f  %6.3f %6.3f %4zu\n", opt.logPaths[i], f.sessions, f.samples,
+                static_cast<unsigned long long>(f.electrical.count), p.samples,
+                p.torqueConstant, p.electricalR2, p.inertia, p.mechanicalR2, lag);
+     }
+     if (loaded == 0) return 1;
+
+     DrivetrainParams params = identify(electrical, mechanical, opt, lag);
+     printf("\nEnsemble (%zu journaux, %s, courant retardé de %zu ticks) :\n", loaded,
+            opt.allSamples ? "tous les échantillons" : "consignes imposées seulement", lag);
+     drivetrainParamsPrint(stdout, params);
+     if (!(params.flags & (DRIVETRAIN_KT | DRIVETRAIN_FRICTION | DRIVETRAIN_INERTIA))) {
+         fprintf(stderr, "aucune grandeur plausible : %s non écrit\n", opt.outPath);
+         return 1;
+     }
+     if (!writeDrivetrainParams(opt.outPath, params)) {
+         fprintf(stderr, "écriture impossible : %s\n", opt.outPath);
+         return 1;
+     }
+     printf("%s écrit (%zu octets)\n", opt.outPath, sizeof(params));
+     return 0;
+ }
@@ -0,0 +1,327 @@
+/*
+ * main_telemetry.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ /**
+  * Récepteur PC de la télémétrie en direct (USART1 de la cible, ou "ergo_host --stream pty").
+  *
+  *   ergo_telemetry /dev/ttyUSB0 -o direct.csv
+  *   ergo_telemetry /dev/ttyUSB0 --decimation 5 --channels tick,cadence,current --plot cadence
+  *   ergo_telemetry /dev/pts/7 --duration 60 -o direct.csv
+  *   ergo_telemetry /dev/ttyUSB0 --profile --duration 2    # temps par étape (firmware -DERGO_PROFILE)
+  *   ergo_telemetry /dev/ttyUSB0 --watchdog --duration 1   # marge de l'IWDG, cause du dernier reset
+  *
+  * Chaque trame est horodatée à la réception (µs depuis le lancement) et écrite en CSV ;
+  * les trous de séquence et les pertes annoncées par la cible sont comptés. Une ligne d'état
+  * par seconde (débit, pertes, dernières valeurs) ; "--plot VOIE" trace la voie en barres.
+  * Les commandes (--decimation, --channels) sont envoyées au démarrage et confirmées par la cible.
+  *
+  * Compilation (depuis la racine) :
+  *   g++ -std=c++17 -O2 -DERGO_HOST -IHost/Inc -IInc Host/Src/main_telemetry.cpp Host/Src/HostHal.cpp \
+  *       Src/TelemetryStream.cpp Src/LoopProfiler.cpp -o ergo_telemetry
+  */
+
+ #include <chrono>
+ #include <cmath>
+ #include <csignal>
+ #include <cstdio>
+ #include <cstdlib>
+ #include <cstring>
+ #include <string>
+
+ #include "HostHal.hpp"
+ #include "TelemetryStream.hpp"
+ #include "LoopProfiler.hpp"
+
+ static const char* const channelNames[TELEMETRY_CHANNELS] = {
+     "tick", "setpoint", "cadence", "current", "applied_current", "duty", "voltage", "mode", "flags", "faults"
+ };
+
+ struct ReceiverOptions {
+     const char* port = nullptr;
+     uint32_t baud = 921600;
+     const char* csvPath = nullptr;
+     int decimation = -1;          // -1 = ne pas changer
+     int channels = -1;
+     int plotChannel = -1;
+     double duration = 0.0;        // 0 = jusqu'à Ctrl-C
+     int profile = -1;             // -1 = non demandé, 0 = lecture, 1 = lecture puis remise à zéro
+     bool watchdog = false;
+ };
+
+ static volatile sig_atomic_t stopRequested = 0;
+
+ static void onSignal(int) {
+     stopRequested = 1;
+ }
+
+ static int findChannel(const char* name, size_t len) {
+     for (int ch = 0; ch < TELEMETRY_CHANNELS; ch++) {
+         if (strlen(channelNames[ch]) == len && !strncmp(channelNames[ch], name, len)) return ch;
+     }
+     return -1;
+ }
+
+ static int parseChannels(const char* list) {
+     int mask = 0;
+     while (*list) {
+         const char* comma = strchr(list, ',');
+         size_t len = comma ? static_cast<size_t>(comma - list) : strlen(list);
+         if (len == 3 && !strncmp(list, "all", 3)) mask |= TELEMETRY_STREAM_ALL_CHANNELS;
+         else {
+             int ch = findChannel(list, len);
+             if (ch < 0) return -1;
+             mask |= 1 << ch;
+         }
+         list += len + (comma ? 1 : 0);
+     }
+     return mask;
+ }
+
+ static bool parseOptions(int argc, char** argv, ReceiverOptions& opt) {
+     for (int i = 1; i < argc; i++) {
+         bool hasValue = (i + 1 < argc);
+         if (!strcmp(argv[i], "--baud") && hasValue) opt.baud = strtoul(argv[++i], nullptr, 10);
+         else if (!strcmp(argv[i], "-o") && hasValue) opt.csvPath = argv[++i];
+         else if (!strcmp(argv[i], "--decimation") && hasValue) opt.decimation = atoi(argv[++i]);
+         else if (!strcmp(argv[i], "--channels") && hasValue) {
+             opt.channels = parseChannels(argv[++i]);
+             if (opt.channels < 0) return false;
+         }
+         else if (!strcmp(argv[i], "--plot") && hasValue) {
+             const char* name = argv[++i];
+             opt.plotChannel = findChannel(name, strlen(name));
+             if (opt.plotChannel < 0) return false;
+         }
+         else if (!strcmp(argv[i], "--duration") && hasValue) opt.duration = atof(argv[++i]);
+         else if (!strcmp(argv[i], "--profile")) opt.profile = 0;
+         else if (!strcmp(argv[i], "--profile-reset")) opt.profile = 1;
+         else if (!strcmp(argv[i], "--watchdog")) opt.watchdog = true;
+         else if (argv[i][0] != '-' && !opt.port) opt.port = argv[i];
+         else return false;
+     }
+     return opt.port != nullptr;
+ }
+
+ static double channelValue(const TelemetrySample& s, int ch) {
+     switch (ch) {
+         case TELEMETRY_CH_TICK: return s.tickMs;
+         case TELEMETRY_CH_SETPOINT: return s.setpoint;
+         case TELEMETRY_CH_CADENCE: return s.cadence;
+         case TELEMETRY_CH_CURRENT: return s.current;
+         case TELEMETRY_CH_APPLIED_CURRENT: return s.appliedCurrent;
+         case TELEMETRY_CH_DUTY: return s.dutyCycle;
+         case TELEMETRY_CH_VOLTAGE: return s.inputVoltage;
+         case TELEMETRY_CH_MODE: return s.mode;
+         case TELEMETRY_CH_FLAGS: return s.flags;
+         default: return s.faults;
+     }
+ }
+
+ static bool sendCommand(FdUartDevice& port, uint8_t type, const uint8_t* body, uint32_t len) {
+     uint8_t frame[TELEMETRY_FRAME_ENCODED_MAX];
+     uint32_t n = telemetryFrameBuild(type, body, len, frame);
+     return n > 0 && port.write(frame, static_cast<uint16_t>(n));
+ }
+
+ /**
+  * @brief Trace une voie en barres horizontales, échelle élargie au fil des valeurs reçues.
+  */
+ class BarPlot {
+ public:
+     explicit BarPlot(int channel) : channel(channel), low(INFINITY), high(-INFINITY) {}
+
+     void add(double t, const TelemetrySample& s) {
+         double v = channelValue(s, channel);
+         if (v < low) low = v;
+         if (v > high) high = v;
+         int width = (high > low) ? static_cast<int>((v - low) / (high - low) * 60.0 + 0.5) : 0;
+         printf("%9.3f s %12.4f |%.*s\n", t, v, width, "############################################################");
+     }
+
+ private:
+     int channel;
+     double low, high;
+ };
+
+ static void printProfile(const TelemetryProfileFrame& p) {
+     const double perUs = p.unitsPerUs ? p.unitsPerUs : 1.0;
+     printf("profil %-18s %8u appels  min %9.2f µs  moy %9.2f µs  max %9.2f µs |", profileZoneName(p.zone),
+            p.count, p.min / perUs, p.mean / perUs, p.max / perUs);
+     for (uint8_t i = 0; i < TELEMETRY_PROFILE_BINS; i++) {
+         if (p.bins[i]) printf(" <%.3g:%u", static_cast<double>(2ull << (p.firstBin + i)) / perUs, p.bins[i]);
+     }
+     printf("\n");
+ }
+
+ static void printWatchdog(const TelemetryWatchdogFrame& w) {
+     const WatchdogStats& st = w.stats;
+     printf("watchdog : délai %u ms (alerte à %u ms), dernier intervalle %u ms, pire %u ms (%s : %u ms), "
+            "%u alertes (dernière : %s), %u rafraîchissements\n",
+            st.timeoutMs, st.warningMs, st.lastIntervalMs, st.worstIntervalMs, profileZoneName(st.worstTask),
+            st.worstTaskMs, st.nearMisses, st.nearMisses ? profileZoneName(st.nearMissTask) : "-", st.refreshes);
+     if (!w.watchdogReset) {
+         printf("watchdog : dernier démarrage normal\n");
+     } else if (w.previous.magic == WATCHDOG_RECORD_MAGIC && w.previous.armed) {
+         printf("watchdog : reset par l'IWDG pendant %s, %u ms sans rafraîchissement (à %u ms de fonctionnement)\n",
+                profileZoneName(w.previous.task), w.previous.sinceRefreshMs, w.previous.uptimeMs);
+     } else {
+         printf("watchdog : reset par l'IWDG sans alerte préalable (interruptions masquées : Error_Handler, HardFault)\n");
+     }
+ }
+
+ struct ReceiverStats {
+     uint64_t frames = 0;
+     uint64_t bytes = 0;
+     uint64_t sequenceGaps = 0;   // trames perdues sur la liaison (trou de numéro)
+     uint64_t targetLost = 0;     // échantillons perdus côté cible (annoncés)
+     bool haveSequence = false;
+     uint16_t nextSequence = 0;
+ };
+
+ int main(int argc, char** argv)
+ {
+     ReceiverOptions opt;
+     if (!parseOptions(argc, argv, opt)) {
+         fprintf(stderr, "usage: %s PORT [--baud N] [-o direct.csv] [--decimation N] [--channels a,b|all]\n"
+                         "          [--plot VOIE] [--duration S] [--profile | --profile-reset] [--watchdog]\n"
+                         "voies : tick setpoint cadence current applied_current duty voltage mode flags faults\n", argv[0]);
+         return 2;
+     }
+
+     FdUartDevice port;
+     if (!port.openSerial(opt.port, opt.baud)) {
+         fprintf(stderr, "impossible d'ouvrir %s\n", opt.port);
+         return 1;
+     }
+
+     FILE* csv = nullptr;
+     static char csvBuffer[1 << 20];
+     if (opt.csvPath) {
+         csv = fopen(opt.csvPath, "w");
+         if (!csv) {
+             fprintf(stderr, "écriture impossible : %s\n", opt.csvPath);
+             return 1;
+         }
+         setvbuf(csv, csvBuffer, _IOFBF, sizeof(csvBuffer));  // écriture par gros blocs : la lecture ne prend pas de retard
+         fprintf(csv, "host_us,seq,lost");
+         for (int ch = 0; ch < TELEMETRY_CHANNELS; ch++) fprintf(csv, ",%s", channelNames[ch]);
+         fprintf(csv, "\n");
+     }
+
+     signal(SIGINT, onSignal);
+     signal(SIGTERM, onSignal);
+
+     uint8_t body[2];
+     if (opt.decimation >= 0) {
+         body[0] = static_cast<uint8_t>(opt.decimation);
+         body[1] = static_cast<uint8_t>(opt.decimation >> 8);
+         sendCommand(port, TELEMETRY_CMD_SET_DECIMATION, body, 2);
+     }
+     if (opt.channels >= 0) {
+         body[0] = static_cast<uint8_t>(opt.channels);
+         body[1] = static_cast<uint8_t>(opt.channels >> 8);
+         sendCommand(port, TELEMETRY_CMD_SUBSCRIBE, body, 2);
+     }
+     sendCommand(port, TELEMETRY_CMD_GET_STATUS, nullptr, 0);
+     if (opt.profile >= 0) {
+         uint8_t reset = static_cast<uint8_t>(opt.profile);
+         sendCommand(port, TELEMETRY_CMD_GET_PROFILE, &reset, 1);
+     }
+     if (opt.watchdog) sendCommand(port, TELEMETRY_CMD_GET_WATCHDOG, nullptr, 0);
+
+     BarPlot plot(opt.plotChannel);
+     TelemetryFrameReader reader;
+     ReceiverStats stats;
+     TelemetrySample last = {};
+     uint16_t lastChannels = 0;
+
+     const auto start = std::chrono::steady_clock::now();
+     double nextReport = 1.0;
+     uint64_t framesAtReport = 0;
+     uint8_t buffer[4096];
+
+     while (!stopRequested) {
+         uint16_t n = port.read(buffer, sizeof(buffer), 100);
+         double now = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+         uint64_t hostUs = static_cast<uint64_t>(now * 1e6);
+         stats.bytes += n;
+
+         for (uint16_t i = 0; i < n; i++) {
+             if (!reader.push(buffer[i])) continue;
+
+             const uint8_t* frame = reader.frame();
+             uint32_t len = reader.getFrameLength();
+             if (frame[0] == TELEMETRY_FRAME_STATUS) {
+                 TelemetryStreamStatus st;
+                 if (telemetryStatusParse(frame + 1, len - 1, st)) {
+                     printf("cible : commande 0x%02X → %u, décimation %u, voies 0x%03X, %u trames, %u abandonnées, %u erreurs UART\n",
+                            st.command, st.result, st.decimation, st.channels, st.framesSent, st.framesDropped,
+                            st.linkErrors);
+                 }
+                 continue;
+             }
+             if (frame[0] == TELEMETRY_FRAME_PROFILE) {
+                 TelemetryProfileFrame p;
+                 if (telemetryProfileParse(frame + 1, len - 1, p)) printProfile(p);
+                 continue;
+             }
+             if (frame[0] == TELEMETRY_FRAME_WATCHDOG) {
+                 TelemetryWatchdogFrame w;
+                 if (telemetryWatchdogParse(frame + 1, len - 1, w)) printWatchdog(w);
+                 continue;
+             }
+             if (frame[0] != TELEMETRY_FRAME_SAMPLE) continue;
+
+             TelemetrySample s;
+             uint16_t channels, seq, lost;
+             if (!telemetrySampleParse(frame + 1, len - 1, s, channels, seq, lost)) continue;
+
+             if (stats.haveSequence && seq != stats.nextSequence) {
+                 stats.sequenceGaps += static_cast<uint16_t>(seq - stats.nextSequence);
+             }
+             stats.haveSequence = true;
+             stats.nextSequence = static_cast<uint16_t>(seq + 1);
+             stats.targetLost += lost;
+             stats.frames++;
+             last = s;
+             lastChannels = channels;
+
+             if (csv) {
+                 fprintf(csv, "%llu,%u,%u", static_cast<unsigned long long>(hostUs), seq, lost);
+                 for (int ch = 0; ch < TELEMETRY_CHANNELS; ch++) {
+                     if (!(channels & (1u << ch))) fprintf(csv, ",");
+                     else if (ch == TELEMETRY_CH_TICK || ch >= TELEMETRY_CH_MODE) fprintf(csv, ",%.0f", channelValue(s, ch));
+                     else fprintf(csv, ",%.6g", channelValue(s, ch));
+                 }
+                 fprintf(csv, "\n");
+             }
+             if (opt.plotChannel >= 0 && (channels & (1u << opt.plotChannel))) plot.add(now, s);
+         }
+
+         if (opt.plotChannel < 0 && now >= nextReport) {
+             printf("%6.0f s  %5llu trames/s  %llu trous  %llu perdus cible  %u erreurs CRC |", now,
+                    static_cast<unsigned long long>(stats.frames - framesAtReport),
+                    static_cast<unsigned long long>(stats.sequenceGaps),
+                    static_cast<unsigned long long>(stats.targetLost), reader.getErrors());
+             for (int ch = 0; ch < TELEMETRY_CHANNELS; ch++) {
+                 if (lastChannels & (1u << ch)) printf(" %s=%.4g", channelNames[ch], channelValue(last, ch));
+             }
+             printf("\n");
+             fflush(stdout);
+             framesAtReport = stats.frames;
+             nextReport += 1.0;
+         }
+         if (opt.duration > 0.0 && now >= opt.duration) break;
+     }
+
+     if (csv) fclose(csv);
+     printf("%llu trames, %llu octets, %llu trous de séquence, %llu échantillons perdus côté cible, %u erreurs de trame\n",
+            static_cast<unsigned long long>(stats.frames), static_cast<unsigned long long>(stats.bytes),
+            static_cast<unsigned long long>(stats.sequenceGaps), static_cast<unsigned long long>(stats.targetLost),
+            reader.getErrors());
+     return 0;
+ }
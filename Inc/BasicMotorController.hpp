@@ -0,0 +1,941 @@
+/*
+ * BasicMotorController.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #pragma once
+
+ #include <cstdint>
+ #include <cmath>
+ #include <cstdio>
+
+ #include "stm32f4xx_hal.h"
+ #include "ControlTypes.hpp"
+ #include "MotorComputations.hpp"
+ #include "SignalConditioning.hpp"
+ #include "KtCalibration.hpp"
+ #include "SettingsStore.hpp"
+ #include "SafetySupervisor.hpp"
+ #include "TelemetryRing.hpp"
+ #include "SessionAnalytics.hpp"
+ #include "ResponseTest.hpp"
+ #include "DrivetrainParams.hpp"
+
+ /**
+  * @brief Loi de commande de l'ergocycle, écrite une seule fois pour la cible et pour le PC.
+  *
+  * Les périphériques sont des paramètres de template, résolus à la compilation (aucun appel virtuel) :
+  *  - Vesc   : setCurrent(float), setRPM(int32_t), getValues(), getLastValues()
+  *  - Screen : show*(), get*(), lastReadOk(), sendText(), showCalibrationStatus(), showSessionSummary()
+  *  - Clock  : now() en ms, delay(ms)
+  *
+  * MotorController (firmware) et MockMotorController (tests, bancs PC) ne sont que des instanciations.
+  */
+ template <typename Vesc, typename Screen, typename Clock>
+ class BasicMotorController {
+ public:
+     BasicMotorController(UART_HandleTypeDef* controlUart, UART_HandleTypeDef* screenUart, float torqueConstant);
+
+     void stop(float rampRate = 6.0f);
+
+     void setTorque(float torque, float rampRate = 6.0f); //réecrire la fonction pour respecter le ramprate
+     void setCadence(float rpm, float rampRate = 6.0f); //réecrire la fonction pour respecter le ramprate
+
+     bool sampleTelemetry();  // un seul aller-retour VESC par tick, filtré pour la commande ET l'affichage
+
+     float getCadence();  // tr/min au pédalier (filtrée)
+     float getTorque();
+     float getDutyCycle();
+     float getPower();
+     float getGain();
+     ControlMode getControlMode();
+     DirectionMode getDirection();
+     UART_HandleTypeDef* getscreen();
+     void setPowerConcentric(float power, float rampRate = 6.0f); //réecrire la fonction pour respecter le ramprate
+     void setPowerEccentric(float power, float rampRate = 6.0f); //réecrire la fonction pour respecter le ramprate
+     void setLinear(float gain, float cadence);
+     void update(float measured_cadence);  // à appeler à chaque boucle, ex: toutes les 100ms
+
+     void setDirection(DirectionMode dir);
+     void setControlMode(ControlMode mode);
+     void setInstruction(float value);
+     void setLinearGain(float gain);
+     void setrampRate(float rampRate);
+     void setTorqueConstant(float torque);
+     void setConditioning(const ConditioningConfig& cfg);
+     const SignalConditioner& getConditioner() const { return conditioner; }
+
+
+     void updateFromScreen();
+     void updateScreen();
+
+     void calibrateTorqueConstant();  // non bloquant, avance dans update()
+     bool isCalibrating() const { return calibrator.isRunning(); }
+     const CalibrationResult& getCalibrationResult() const { return calibrator.getResult(); }
+
+     // Échelons et chirp de consigne (ResponseTest.hpp), non bloquant comme la calibration ;
+     // faux si une calibration tourne, si un défaut est actif ou si le mode n'est ni CADENCE ni TORQUE
+     bool startResponseTest(const ResponseTestConfig& cfg);
+     void abortResponseTest();
+     bool isResponseTesting() const { return responseTest.isRunning(); }
+     const ResponseTest& getResponseTest() const { return responseTest; }
+
+     // Réglages persistants : loadSettings() renvoie vrai si une calibration valide est en flash
+     void attachSettings(SettingsStore* store);
+     bool loadSettings();
+
+     // Modèle de transmission identifié hors ligne (ERGO.PAR, ergo_sysid) : appliqué puis sauvegardé ;
+     // faux si l'image est invalide ou a été identifiée avec un autre rapport de réduction
+     bool applyDrivetrainParams(const DrivetrainParams& params);
+     float getFeedforwardTorque();  // J·dω/dt + pertes à la cadence filtrée (Nm, sens FORWARD/REVERSE)
+
+     const SafetySupervisor& getSafety() const { return safety; }
+
+     // Télémétrie plein débit : un échantillon poussé à chaque update() dans chaque file attachée
+     // (une file par lecteur : journal USB, liaison série...) ; faux si toutes les places sont prises
+     bool attachTelemetry(TelemetryBuffer* buffer);
+
+     // Bilan de séance tenu à chaque update() ; affiché par updateScreen() toutes les SUMMARY_PERIOD_MS
+     const SessionAnalytics& getAnalytics() const { return analytics; }
+     void resetAnalytics() { analytics.reset(); }
+
+     // Accès aux périphériques (injection de valeurs dans les tests, message d'accueil...)
+     Vesc& getVesc() { return vesc; }
+     Screen& getScreen() { return screen; }
+     Clock& getClock() { return clock; }
+
+ private:
+     UART_HandleTypeDef* control_uart;
+     UART_HandleTypeDef* screen_uart;
+
+     DirectionMode direction;
+     ControlMode controlMode;
+     float instruction; //la valeur cible que l’on veut imposer au moteur, en fonction du mode actif.
+     float linearGain;  //Pour le mode linéaire
+     float lastAppliedCurrent;
+     float ramp;
+     float torqueConstant;  // Nm/A
+     MotorComputations computations;
+     SignalConditioner conditioner;
+     bool telemetryValid;  // faux tant qu'aucune trame VESC valide n'a été reçue
+     KtCalibrator calibrator;
+     ResponseTest responseTest;
+     SettingsStore* settings;  // optionnel : nullptr = rien n'est sauvegardé
+     SafetySupervisor safety;
+     SafetyInputs safetyInputs;  // dernier état évalué (sert à l'acquittement)
+     static const uint8_t TELEMETRY_CONSUMERS = 2;
+     TelemetryBuffer* telemetry[TELEMETRY_CONSUMERS];  // remplies par la boucle de commande seulement
+     uint8_t telemetryCount;
+     SessionAnalytics analytics;
+     static const uint32_t SUMMARY_PERIOD_MS = 5000;  // champ texte lent à 9600 bauds : pas à chaque tick
+     uint32_t lastSummaryMs;
+
+     // Périphériques détenus par valeur : pas d'allocation, pas d'indirection
+     Screen screen;
+     Vesc vesc;
+     Clock clock;
+
+     // Plages acceptées pour les réglages venant de l'écran ou de la flash
+     static constexpr float RAMP_RATE_MAX = 100.0f;   // A/s
+     static constexpr float LINEAR_GAIN_MAX = 2.0f;   // Nm par tr/min
+     static bool validRampRate(float value) { return value > 0.0f && value <= RAMP_RATE_MAX; }
+     static bool validLinearGain(float value) { return value >= 0.0f && value <= LINEAR_GAIN_MAX; }
+
+     float applyDirection(float value);
+     bool motorIdle() const;
+     void serviceSettings();
+     void serviceCalibration();
+     void serviceResponseTest();
+     void persistUserSettings();
+     bool superviseSafety();
+     void applyCurrent(float current);
+     void runControl(float measured_cadence);
+     void recordTelemetry();
+     void updateAnalytics();
+ };
+
+ template <typename Vesc, typename Screen, typename Clock>
+ BasicMotorController<Vesc, Screen, Clock>::BasicMotorController(UART_HandleTypeDef* controlUart, UART_HandleTypeDef* screenUart, float torquecst)
+     : control_uart(controlUart),
+     screen_uart(screenUart),
+     direction(DirectionMode::FORWARD),
+     controlMode(ControlMode::CADENCE),
+     instruction(0.0f),
+     linearGain(0.05f),
+     lastAppliedCurrent(0.0f),
+     ramp(6.0f),
+     torqueConstant(torquecst),
+     computations(torquecst),
+     conditioner(defaultConditioningConfig()),
+     telemetryValid(false),
+     calibrator(defaultCalibrationConfig()),
+     responseTest(defaultResponseTestConfig()),
+     settings(nullptr),
+     safety(defaultSafetyConfig()),
+     safetyInputs{0, false, 0.0f, 0.0f, 0.0f, 0.0f},
+     telemetry{nullptr, nullptr},
+     telemetryCount(0),
+     analytics(defaultAnalyticsConfig()),
+     lastSummaryMs(0),
+     screen(screenUart),
+     vesc(controlUart),
+     clock()
+ {
+     computations.setReductionRatio(conditioner.getConfig().reductionRatio);
+ }
+ //Par défaut le moteur est en modes forward et cadence avec une vitesse nulle
+ 
+ template <typename Vesc, typename Screen, typename Clock>
+ void BasicMotorController<Vesc, Screen, Clock>::setDirection(DirectionMode dir) {
+     direction = dir;
+ }
+ 
+ template <typename Vesc, typename Screen, typename Clock>
+ void BasicMotorController<Vesc, Screen, Clock>::setControlMode(ControlMode mode) {
+     controlMode = mode;
+ }
+ 
+ template <typename Vesc, typename Screen, typename Clock>
+ void BasicMotorController<Vesc, Screen, Clock>::setInstruction(float value) {
+     if (calibrator.isRunning() || responseTest.isRunning()) return;  // la séquence en cours pilote le moteur
+     instruction = value;
+     if (controlMode == ControlMode::LINEAR) return;  // linear se gère dynamiquement
+     if (safety.isTripped()) return;  // consigne gardée ; superviseSafety() fait seul un pas de repli par tick
+     switch (controlMode) {
+         case ControlMode::CADENCE:
+             setCadence(value);
+             break;
+         case ControlMode::TORQUE:
+             setTorque(value);
+             break;
+         case ControlMode::POWER_CONCENTRIC:
+             setPowerConcentric(value);
+             break;
+         case ControlMode::POWER_ECCENTRIC:
+             setPowerEccentric(value);
+             break;
+         default:
+             break;
+     }
+ }
+ 
+ template <typename Vesc, typename Screen, typename Clock>
+ void BasicMotorController<Vesc, Screen, Clock>::setLinearGain(float gain)  
+ {
+     linearGain = gain;
+ }
+
+ template <typename Vesc, typename Screen, typename Clock>
+ void BasicMotorController<Vesc, Screen, Clock>::setTorqueConstant(float torquecst)  
+ {
+    torqueConstant = torquecst;
+    computations.setTorqueConstant(torquecst); 
+
+ }
+
+ template <typename Vesc, typename Screen, typename Clock>
+ void BasicMotorController<Vesc, Screen, Clock>::setConditioning(const ConditioningConfig& cfg)
+ {
+    conditioner.configure(cfg);
+    computations.setReductionRatio(cfg.reductionRatio);  // couple et cadence restent tous deux ramenés au pédalier
+
+    if (settings) {  // relus par loadSettings() ; le store n'écrit rien si les valeurs sont inchangées
+        settings->setFloat(SettingKey::POLE_PAIRS, cfg.polePairs);
+        settings->setFloat(SettingKey::REDUCTION_RATIO, cfg.reductionRatio);
+        settings->setFloat(SettingKey::CADENCE_ALPHA, cfg.cadence.alpha);
+        settings->setFloat(SettingKey::CADENCE_BETA, cfg.cadence.beta);
+        settings->setFloat(SettingKey::CURRENT_CUTOFF_HZ, cfg.current.cutoffHz);
+    }
+ }
+
+ template <typename Vesc, typename Screen, typename Clock>
+ void BasicMotorController<Vesc, Screen, Clock>::setrampRate(float rampRate)
+ {
+    ramp = rampRate;
+ }
+ 
+ template <typename Vesc, typename Screen, typename Clock>
+ void BasicMotorController<Vesc, Screen, Clock>::setCadence(float rpm, [[maybe_unused]] float rampRate) //Implémenter une version avec rampRate
+ {
+     if (safety.isTripped()) return;  // après un déclenchement, seul le repli en courant pilote le moteur
+
+     // Le VESC régule la vitesse avec ses propres limites : si le courant mesuré dépasse la borne
+     // du superviseur (déclassement thermique), ce tick passe en courant borné par applyCurrent()
+     float measured = vesc.getLastValues().motorCurrent;
+     if (telemetryValid && fabsf(measured) > safety.getCurrentLimit()) {
+         applyCurrent(measured);
+         return;
+     }
+
+     float value = applyDirection(rpm);
+     //sendCommand("v 0 %.2f\n", value);
+     vesc.setRPM(static_cast<int32_t>(conditioner.cadenceToErpm(value)));  // cadence pédalier → ERPM
+     lastAppliedCurrent = telemetryValid ? measured : 0.0f;  // point de départ de stop() et du repli
+ }
+ 
+ template <typename Vesc, typename Screen, typename Clock>
+ void BasicMotorController<Vesc, Screen, Clock>::setTorque(float torque, [[maybe_unused]] float rampRate) //Implementer une version avec rampRate
+ {
+     if (safety.isTripped()) return;  // un seul pas de repli par tick, fait par superviseSafety()
+
+     float effectiveTorque = applyDirection(torque);
+     float current = computations.computeCurrentFromTorque(effectiveTorque);
+     applyCurrent(current);
+ }
+ 
+ template <typename Vesc, typename Screen, typename Clock>
+ bool BasicMotorController<Vesc, Screen, Clock>::sampleTelemetry()
+ // À appeler une fois par tick, avant update() et updateScreen() : les getters lisent ensuite l'état filtré
+ {
+    if (!vesc.getValues()) {
+        telemetryValid = false;
+        return false;
+    }
+
+    const VESCValues& raw = vesc.getLastValues();
+    conditioner.update(raw.rpm, raw.motorCurrent, raw.dutyCycle);
+    computations.setMotorTemperature(raw.tempMotor);  // Kt suit l'échauffement des aimants
+    telemetryValid = true;
+    return true;
+ }
+
+ template <typename Vesc, typename Screen, typename Clock>
+ float BasicMotorController<Vesc, Screen, Clock>::getCadence()
+ {
+    // Seul telemetryValid signale une lecture échouée : une cadence négative (REVERSE, excentrique) est valide
+    if (!telemetryValid) {
+        screen.showError("Erreur: réception cadence");
+        return 0.0f;
+    }
+
+    return conditioner.getCadence();  // cadence pédalier filtrée (tr/min), signée
+ }
+
+ template <typename Vesc, typename Screen, typename Clock>
+ float BasicMotorController<Vesc, Screen, Clock>::getTorque() {
+    if (!telemetryValid) {
+        screen.showError("Erreur: réception courant");
+        return 0.0f;
+    }
+
+    float current = conditioner.getCurrent();  // Courant moteur filtré, négatif en freinage
+    float torque = computations.computeShaftTorque(current, conditioner.getCadence());  // Kt(T) et pertes
+    return applyDirection(torque);  // Respecte le sens FORWARD/REVERSE
+}
+
+template <typename Vesc, typename Screen, typename Clock>
+float BasicMotorController<Vesc, Screen, Clock>::getDutyCycle() 
+{
+    if (!telemetryValid) {
+        screen.showError("Erreur: Duty invalide");
+        return 0.0f;
+    }
+
+    float duty = conditioner.getDutyCycle();  // Duty filtré (dernier échantillon VESC), -1..1
+
+    if (duty > 0.95f) 
+    {
+        screen.sendText("t0", "ALERTE: Duty élevé !");
+    }
+
+    return duty;
+}
+
+template <typename Vesc, typename Screen, typename Clock>
+float BasicMotorController<Vesc, Screen, Clock>::getPower() {
+    if (!telemetryValid) {
+        screen.showError("Erreur: couple invalide");
+        return 0.0f;
+    }
+
+    float torque = getTorque();                  // signé : négatif en freinage
+    float cadence = conditioner.getCadence();    // tr/min, signée
+
+    // Puissance mécanique P = τ × ω
+    float power = computations.computePower(torque, cadence);
+
+    return power;  // En watts signé
+}
+
+template <typename Vesc, typename Screen, typename Clock>
+ControlMode BasicMotorController<Vesc, Screen, Clock>::getControlMode() {
+    return controlMode;
+}
+
+template <typename Vesc, typename Screen, typename Clock>
+float BasicMotorController<Vesc, Screen, Clock>::getGain() {
+    return linearGain;
+}
+
+ template <typename Vesc, typename Screen, typename Clock>
+ void BasicMotorController<Vesc, Screen, Clock>::setPowerConcentric(float power, [[maybe_unused]] float rampRate)
+ {
+    if (safety.isTripped()) return;  // un seul pas de repli par tick, fait par superviseSafety()
+
+    // Télémétrie absente : on garde la consigne précédente (le superviseur surveille la liaison)
+    if (!telemetryValid)
+    {
+        screen.showError("Erreur: réception cadence");
+        return;
+    }
+
+    // Vitesse réelle en valeur absolue (le sens est appliqué par applyDirection) ;
+    // sécurité : éviter division par zéro ou valeurs trop basses
+    float cadence = fabsf(conditioner.getCadence());
+    if (cadence < 1.0f)
+    {
+        cadence = 1.0f;
+    }
+
+    // Conversion cadence (tr/min) → vitesse angulaire ω (rad/s)
+    float omega = computations.computeOmega(cadence);
+
+    // Calcul du couple réel à appliquer : τ = P / ω
+    float torque = power / omega;
+
+    // Appliquer la direction (FORWARD ou REVERSE)
+    float effectiveTorque = applyDirection(torque);
+
+    // Conversion couple → courant moteur : I = τ / Kt
+    float current = computations.computeCurrentFromTorque(effectiveTorque);
+    
+    // Envoi de la commande au VESC (borné par le superviseur de sécurité)
+    applyCurrent(current);
+ }
+ 
+ 
+ template <typename Vesc, typename Screen, typename Clock>
+ void BasicMotorController<Vesc, Screen, Clock>::setPowerEccentric(float power, [[maybe_unused]] float rampRate)
+ {
+    if (safety.isTripped()) return;  // un seul pas de repli par tick, fait par superviseSafety()
+
+    // Télémétrie absente : on garde la consigne précédente (le superviseur surveille la liaison)
+    if (!telemetryValid)
+    {
+        screen.showError("Erreur: réception cadence");
+        return;
+    }
+
+    // Vitesse réelle en valeur absolue (le sens est appliqué par applyDirection) ;
+    // sécurité : éviter division par zéro ou valeurs trop basses
+    float cadence = fabsf(conditioner.getCadence());
+    if (cadence < 1.0f)
+    {
+        cadence = 1.0f;
+    }
+
+    // Conversion cadence → vitesse angulaire ω (rad/s)
+    float omega = computations.computeOmega(cadence);
+
+    // Calcul du couple nécessaire (négatif pour excentrique)
+    float torque = -power / omega;
+
+    // Applique la direction choisie (FORWARD ou REVERSE)
+    float effectiveTorque = applyDirection(torque);
+    
+    // Conversion couple → courant moteur : I = τ / Kt
+    float current = computations.computeCurrentFromTorque(effectiveTorque);
+    
+    // Envoi au VESC (borné par le superviseur de sécurité)
+    applyCurrent(current);
+ }
+ 
+ 
+ template <typename Vesc, typename Screen, typename Clock>
+ void BasicMotorController<Vesc, Screen, Clock>::setLinear(float gain, float cadence) {
+     linearGain = gain;
+     if (safety.isTripped()) return;  // un seul pas de repli par tick, fait par superviseSafety()
+     float torque = linearGain * cadence;
+     float value = applyDirection(torque);
+     // Conversion couple → courant : I = τ / Kt
+     float current = computations.computeCurrentFromTorque(value);
+     
+     // Envoi au VESC (borné par le superviseur de sécurité)
+     applyCurrent(current);
+ }
+    
+ template <typename Vesc, typename Screen, typename Clock>
+ void BasicMotorController<Vesc, Screen, Clock>::update(float measured_cadence) {
+     runControl(measured_cadence);
+     updateAnalytics();
+     if (telemetryCount) recordTelemetry();  // état après la décision de ce tick
+     serviceSettings();
+ }
+
+ template <typename Vesc, typename Screen, typename Clock>
+ bool BasicMotorController<Vesc, Screen, Clock>::motorIdle() const
+ // Volant arrêté, aucun courant et aucune séquence en cours : un arrêt de plusieurs secondes est sans effet
+ {
+     if (!telemetryValid || calibrator.isRunning() || responseTest.isRunning()) return false;
+     return fabsf(conditioner.getCadence()) < 1.0f && fabsf(conditioner.getCurrent()) < 0.2f &&
+            fabsf(lastAppliedCurrent) < 0.05f;
+ }
+
+ template <typename Vesc, typename Screen, typename Clock>
+ void BasicMotorController<Vesc, Screen, Clock>::serviceSettings()
+ // Compactage différé (effacement d'un secteur de 128 Ko, 1 à 2 s) : seulement moteur à l'arrêt
+ {
+     if (settings && settings->compactionPending() && motorIdle()) settings->compact();
+ }
+
+ template <typename Vesc, typename Screen, typename Clock>
+ void BasicMotorController<Vesc, Screen, Clock>::updateAnalytics()
+ // Mêmes grandeurs que l'affichage, sans passer par les getters (qui signalent les erreurs à l'écran)
+ {
+     if (!telemetryValid || calibrator.isRunning()) {
+         analytics.pause(clock.now());  // la calibration n'est pas un effort du cycliste
+         return;
+     }
+     float cadence = conditioner.getCadence();
+     float torque = computations.computeShaftTorque(conditioner.getCurrent(), cadence);
+     analytics.update(clock.now(), computations.computePower(torque, cadence), torque, cadence);
+ }
+
+ template <typename Vesc, typename Screen, typename Clock>
+ bool BasicMotorController<Vesc, Screen, Clock>::attachTelemetry(TelemetryBuffer* buffer) {
+     if (!buffer || telemetryCount == TELEMETRY_CONSUMERS) return false;
+     telemetry[telemetryCount++] = buffer;
+     return true;
+ }
+
+ template <typename Vesc, typename Screen, typename Clock>
+ void BasicMotorController<Vesc, Screen, Clock>::runControl(float measured_cadence) {
+     if (superviseSafety()) return;  // défaut actif : repli contrôlé, aucune autre commande
+
+     if (calibrator.isRunning()) {
+         serviceCalibration();
+         return;
+     }
+     if (responseTest.isRunning()) {
+         serviceResponseTest();
+         return;
+     }
+     if (controlMode == ControlMode::LINEAR) {
+         setLinear(linearGain, measured_cadence);
+     }
+ }
+ 
+ template <typename Vesc, typename Screen, typename Clock>
+ void BasicMotorController<Vesc, Screen, Clock>::stop(float rampRate) 
+ {
+    calibrator.abort();  // un stop interrompt aussi une calibration ou un test de réponse en cours
+    responseTest.abort();
+
+    // Lire le courant actuel
+    float current = lastAppliedCurrent;  // À maintenir dans ta classe
+    const float timeStepMs = 50.0f;      // Intervalle entre chaque pas (50 ms)
+    const float timeStepS = timeStepMs / 1000.0f; //conversion en secondes
+    const float maxStep = rampRate * timeStepS; //On calcule combien on doit diminuer le courant à chaque pas
+
+    while (fabs(current) > 0.05f) 
+    {  // Tant qu'on n'est pas (quasiment) à 0
+        if (current > 0) //Si le courant est positif, on le réduit vers zéro
+        {
+            current -= maxStep;
+            if (current < 0) current = 0.0f;
+        } 
+        else //Si le courant est négatif (ex : freinage), on l’augmente vers zéro
+
+        {
+            current += maxStep;
+            if (current > 0) current = 0.0f;
+        }
+
+        vesc.setCurrent(current);
+        clock.delay(static_cast<uint32_t>(timeStepMs));
+    }
+
+    // Finalise à zéro pour s'assurer que c'est bien arrêté
+    vesc.setCurrent(0.0f);
+    instruction = 0.0f;
+    lastAppliedCurrent = 0.0f;
+}
+ 
+ template <typename Vesc, typename Screen, typename Clock>
+ bool BasicMotorController<Vesc, Screen, Clock>::superviseSafety()
+ // Évalué à chaque tick, que le mode actif commande le moteur ou non
+ {
+     const VESCValues& raw = vesc.getLastValues();
+     safetyInputs = {clock.now(), telemetryValid, raw.tempFet, raw.tempMotor, raw.motorCurrent, conditioner.getCadence()};
+
+     bool wasTripped = safety.isTripped();
+     safety.evaluate(safetyInputs);
+     if (!safety.isTripped()) return false;
+
+     if (!wasTripped) {
+         calibrator.abort();
+         responseTest.abort();
+         // En mode cadence le VESC régule seul : le repli part du courant mesuré
+         safety.resetOutput(telemetryValid ? raw.motorCurrent : lastAppliedCurrent);
+
+         const SafetyEvent& event = safety.getEvent(safety.getEventCount() - 1);
+         screen.showError(SafetySupervisor::faultName(event.fault));
+     }
+
+     applyCurrent(lastAppliedCurrent);  // seul pas de repli du tick : les set*() ne commandent plus rien
+     return true;
+ }
+
+ template <typename Vesc, typename Screen, typename Clock>
+ void BasicMotorController<Vesc, Screen, Clock>::recordTelemetry()
+ // Coût constant : lecture de l'état déjà calculé, aucune conversion ni formatage
+ {
+     const VESCValues& raw = vesc.getLastValues();
+     TelemetrySample sample;
+     sample.tickMs = clock.now();
+     sample.setpoint = instruction;
+     sample.cadence = conditioner.getCadence();
+     sample.current = conditioner.getCurrent();
+     sample.appliedCurrent = lastAppliedCurrent;
+     sample.dutyCycle = conditioner.getDutyCycle();
+     sample.inputVoltage = raw.inputVoltage;
+     sample.mode = static_cast<uint8_t>(controlMode);
+     sample.flags = (telemetryValid ? TELEMETRY_VALID : 0) | (safety.isTripped() ? TELEMETRY_TRIPPED : 0) |
+                    (calibrator.isRunning() ? TELEMETRY_CALIBRATING : 0) |
+                    (responseTest.isRunning() ? TELEMETRY_RESPONSE_TEST : 0) |
+                    (direction == DirectionMode::REVERSE ? TELEMETRY_REVERSE : 0);
+     sample.faults = safety.getFaults();
+     sample.reserved = 0;
+     for (uint8_t i = 0; i < telemetryCount; i++) telemetry[i]->push(sample);
+ }
+
+ template <typename Vesc, typename Screen, typename Clock>
+ void BasicMotorController<Vesc, Screen, Clock>::applyCurrent(float current)
+ // Point de passage unique de toutes les consignes de courant
+ {
+     float allowed = safety.limitCurrent(current);
+     lastAppliedCurrent = allowed;
+     vesc.setCurrent(allowed);
+ }
+
+ template <typename Vesc, typename Screen, typename Clock>
+ float BasicMotorController<Vesc, Screen, Clock>::applyDirection(float value) {
+     return (direction == DirectionMode::REVERSE) ? -value : value;
+ }
+ 
+ /*if (direction == DirectionMode::REVERSE)
+     return -value;
+ else
+     return value;*/
+
+
+template <typename Vesc, typename Screen, typename Clock>
+void BasicMotorController<Vesc, Screen, Clock>::updateFromScreen()
+{
+    // Une lecture expirée ou hors plage laisse le réglage en cours intact et n'est jamais sauvegardée
+    bool screenOk = true;
+
+    DirectionMode selectedDirection = screen.getDirection();
+    if (screen.lastReadOk()) setDirection(selectedDirection);
+    else screenOk = false;
+    
+    ControlMode selectedMode = screen.getMode();
+    if (screen.lastReadOk()) setControlMode(selectedMode);
+    else screenOk = false;
+
+    float ramprate = screen.getRampRate();
+    if (screen.lastReadOk() && validRampRate(ramprate)) setrampRate(ramprate);
+    else screenOk = false;
+
+    switch (controlMode)
+    {
+        case ControlMode::CADENCE:
+        {
+            float rpm = screen.getUserCadence();
+            if (screen.lastReadOk()) setInstruction(rpm);
+            break;
+        }
+
+        case ControlMode::TORQUE:
+        {
+            float torque = screen.getUserTorque();
+            if (screen.lastReadOk()) setInstruction(torque);
+            break;
+        }
+
+        case ControlMode::POWER_CONCENTRIC:
+        case ControlMode::POWER_ECCENTRIC:
+        {
+            float power = screen.getUserPower();
+            if (screen.lastReadOk()) setInstruction(power);
+            break;
+        }
+
+        case ControlMode::LINEAR:
+        {
+            float gain = screen.getUserLinearGain();  
+            if (screen.lastReadOk() && validLinearGain(gain)) {
+                setLinearGain(gain);
+                setInstruction(gain);
+            } else {
+                screenOk = false;
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+    if (screenOk) persistUserSettings();
+
+    if (screen.getStop()) 
+    {
+        stop(3.0f);  // Stop progressif avec rampRate = 3 A/s (à adapter si besoin)
+        safety.clearFaults(safetyInputs);  // acquittement : réarmé seulement si plus aucune condition n'est active
+    }
+
+    if (screen.getCalibrateRequest()) 
+    {
+        calibrateTorqueConstant();
+    }
+    
+}
+
+template <typename Vesc, typename Screen, typename Clock>
+void BasicMotorController<Vesc, Screen, Clock>::updateScreen() {
+    float rpm     = getCadence();
+    float torque  = getTorque();
+    float power   = getPower();
+    float dutyCycle = getDutyCycle();
+    ControlMode mode = getControlMode();
+    float LinearGain = getGain();
+    DirectionMode direction = getDirection();
+    
+
+    // Affichage à l’écran
+    //screen.showWelcome();
+    screen.showCadence(rpm);
+    screen.showTorque(torque);
+    screen.showPower(power);
+    screen.showDutyCycle(dutyCycle);
+    screen.showMode(mode);
+    screen.showGain(LinearGain);
+    screen.showDirection(direction);
+
+    uint32_t now = clock.now();
+    if (now - lastSummaryMs >= SUMMARY_PERIOD_MS) {
+        lastSummaryMs = now;
+        screen.showSessionSummary(analytics.getSummary());
+    }
+}
+
+template <typename Vesc, typename Screen, typename Clock>
+void BasicMotorController<Vesc, Screen, Clock>::calibrateTorqueConstant()
+// Lance la calibration sans bloquer : update() fait avancer les paliers à chaque boucle
+{
+    if (calibrator.isRunning()) return;
+
+    // Paliers placés sous la vitesse à vide Vbatt / Kt : il faut une tension batterie mesurée
+    if (!telemetryValid) sampleTelemetry();
+    float noLoadOmega = (telemetryValid && torqueConstant > 0.0f) ? vesc.getLastValues().inputVoltage / torqueConstant : 0.0f;
+    calibrator.start(clock.now(), noLoadOmega);
+    if (!calibrator.isRunning()) {
+        screen.showCalibrationStatus(false);
+        return;
+    }
+    vesc.setRPM(static_cast<int32_t>(calibrator.getTargetRpm() * conditioner.getConfig().polePairs));
+}
+
+template <typename Vesc, typename Screen, typename Clock>
+void BasicMotorController<Vesc, Screen, Clock>::serviceCalibration()
+{
+    if (!telemetryValid) {
+        calibrator.missed();  // trame perdue : tolérée quelques ticks, puis abandon
+    } else {
+        const VESCValues& raw = vesc.getLastValues();
+        float motorRpm = raw.rpm / conditioner.getConfig().polePairs;  // ERPM → tr/min mécaniques moteur
+        float omegaMotor = computations.computeOmega(motorRpm);
+        float phaseVoltage = raw.dutyCycle * raw.inputVoltage;
+        calibrator.tick(clock.now(), omegaMotor, phaseVoltage, raw.inputVoltage);
+    }
+
+    if (calibrator.isRunning()) {
+        vesc.setRPM(static_cast<int32_t>(calibrator.getTargetRpm() * conditioner.getConfig().polePairs));
+        return;
+    }
+
+    // Fin de calibration : moteur en roue libre puis compte rendu
+    vesc.setCurrent(0.0f);
+    lastAppliedCurrent = 0.0f;
+
+    const CalibrationResult& result = calibrator.getResult();
+    if (result.success) {
+        screen.showCalibrationStatus(true);  // ✅ calibration OK
+        // Kt mesuré à chaud → ramené à la température de référence du modèle
+        float ktRef = computations.referenceTorqueConstant(result.torqueConstant, vesc.getLastValues().tempMotor);
+        setTorqueConstant(ktRef);
+        if (settings) {
+            settings->setFloat(SettingKey::TORQUE_CONSTANT, ktRef);
+            settings->setFloat(SettingKey::CALIBRATION_R2, result.rSquared);
+        }
+    } else {
+        screen.showCalibrationStatus(false); // ❌ calibration échouée (R² insuffisant ou Kt hors plage)
+    }
+}
+
+template <typename Vesc, typename Screen, typename Clock>
+bool BasicMotorController<Vesc, Screen, Clock>::startResponseTest(const ResponseTestConfig& cfg)
+{
+    if (calibrator.isRunning() || safety.isTripped()) return false;
+    if (cfg.mode != ControlMode::CADENCE && cfg.mode != ControlMode::TORQUE) return false;
+
+    controlMode = cfg.mode;
+    responseTest.start(cfg, clock.now());
+    return true;
+}
+
+template <typename Vesc, typename Screen, typename Clock>
+void BasicMotorController<Vesc, Screen, Clock>::abortResponseTest()
+{
+    responseTest.abort();
+    setInstruction(responseTest.getConfig().base);  // reste sur la consigne de repos du programme
+}
+
+template <typename Vesc, typename Screen, typename Clock>
+void BasicMotorController<Vesc, Screen, Clock>::serviceResponseTest()
+// Consigne du programme à chaque tick, puis le couple (référence, mesure) de ce tick à l'analyse.
+// Un tick sans télémétrie n'est pas analysé mais la consigne continue : le programme garde son horloge.
+{
+    uint32_t now = clock.now();
+    const ResponseTestConfig& cfg = responseTest.getConfig();
+    instruction = responseTest.getSetpoint(now);
+
+    float reference, measured;
+    if (cfg.mode == ControlMode::CADENCE) {
+        setCadence(instruction);
+        reference = instruction;
+        measured = applyDirection(conditioner.getCadence());  // ramenée dans le sens de la consigne
+    } else {
+        setTorque(instruction);
+        reference = lastAppliedCurrent;  // boucle de courant du VESC : commandé → mesuré
+        measured = conditioner.getCurrent();
+    }
+    responseTest.tick(now, reference, measured, telemetryValid);
+    if (responseTest.isRunning()) return;
+
+    // Fin du programme : retour à la consigne de repos, synthèse à l'écran (détail : getResponseTest())
+    setInstruction(cfg.base);
+    const ResponseTestResult& r = responseTest.getResult();
+    char message[52];  // + 't0.txt=""' : tient dans le tampon de 64 octets de sendText()
+    snprintf(message, sizeof(message), "Réponse: retard %d ms montée %d ms BP %.2f Hz",
+             static_cast<int>(r.meanDeadTimeMs), static_cast<int>(r.meanRiseTimeMs), r.bandwidthHz);
+    screen.sendText("t0", message);
+}
+
+template <typename Vesc, typename Screen, typename Clock>
+void BasicMotorController<Vesc, Screen, Clock>::attachSettings(SettingsStore* store)
+{
+    settings = store;
+    if (settings) settings->setDeferCompaction(true);  // compacté par serviceSettings(), moteur à l'arrêt
+}
+
+template <typename Vesc, typename Screen, typename Clock>
+bool BasicMotorController<Vesc, Screen, Clock>::loadSettings()
+// Applique les réglages sauvegardés. Sans calibration valide en flash, il faudra calibrer.
+{
+    if (!settings) return false;
+
+    // Valeur hors plage (ancienne version, enregistrement d'avant les contrôles) : on garde le défaut
+    float savedRamp = settings->getFloat(SettingKey::RAMP_RATE, ramp);
+    if (validRampRate(savedRamp)) setrampRate(savedRamp);
+    float savedGain = settings->getFloat(SettingKey::LINEAR_GAIN, linearGain);
+    if (validLinearGain(savedGain)) setLinearGain(savedGain);
+
+    int32_t savedMode = settings->getInt(SettingKey::CONTROL_MODE, static_cast<int32_t>(controlMode));
+    if (savedMode >= 0 && savedMode <= static_cast<int32_t>(ControlMode::LINEAR)) {
+        setControlMode(static_cast<ControlMode>(savedMode));
+    }
+    int32_t savedDirection = settings->getInt(SettingKey::DIRECTION, static_cast<int32_t>(direction));
+    if (savedDirection == static_cast<int32_t>(DirectionMode::FORWARD) ||
+        savedDirection == static_cast<int32_t>(DirectionMode::REVERSE)) {
+        setDirection(static_cast<DirectionMode>(savedDirection));
+    }
+
+    ConditioningConfig cfg = conditioner.getConfig();
+    cfg.polePairs        = settings->getFloat(SettingKey::POLE_PAIRS, cfg.polePairs);
+    cfg.reductionRatio   = settings->getFloat(SettingKey::REDUCTION_RATIO, cfg.reductionRatio);
+    cfg.cadence.alpha    = settings->getFloat(SettingKey::CADENCE_ALPHA, cfg.cadence.alpha);
+    cfg.cadence.beta     = settings->getFloat(SettingKey::CADENCE_BETA, cfg.cadence.beta);
+    cfg.current.cutoffHz = settings->getFloat(SettingKey::CURRENT_CUTOFF_HZ, cfg.current.cutoffHz);
+    if (cfg.polePairs > 0.0f && cfg.reductionRatio > 0.0f && cfg.current.cutoffHz > 0.0f) {
+        setConditioning(cfg);
+    }
+
+    computations.setLossModel(settings->getFloat(SettingKey::COULOMB_FRICTION, 0.0f),
+                              settings->getFloat(SettingKey::VISCOUS_FRICTION, 0.0f));
+    computations.setInertia(settings->getFloat(SettingKey::INERTIA, 0.0f));
+
+    float kt = settings->getFloat(SettingKey::TORQUE_CONSTANT, -1.0f);
+    if (kt > 0.01f && kt < 1.0f) {  // même plage que la calibration
+        setTorqueConstant(kt);
+        return true;
+    }
+    return false;
+}
+
+template <typename Vesc, typename Screen, typename Clock>
+bool BasicMotorController<Vesc, Screen, Clock>::applyDrivetrainParams(const DrivetrainParams& params)
+// Seuls les groupes marqués plausibles par ergo_sysid sont appliqués ; les autres gardent leur valeur
+{
+    if (!drivetrainParamsValid(params)) return false;
+
+    // J, frottements et Kt sont ramenés au pédalier avec le rapport de l'identification :
+    // un autre rapport ici changerait leur sens physique, on refuse plutôt que de convertir
+    float ratio = conditioner.getConfig().reductionRatio;
+    if (fabsf(params.reductionRatio - ratio) > 0.01f * ratio) return false;
+
+    if ((params.flags & DRIVETRAIN_KT) && params.torqueConstant > 0.01f && params.torqueConstant < 1.0f) {
+        setTorqueConstant(params.torqueConstant);
+        if (settings) settings->setFloat(SettingKey::TORQUE_CONSTANT, params.torqueConstant);
+    }
+    if (params.flags & DRIVETRAIN_FRICTION) {
+        computations.setLossModel(params.coulomb, params.viscous);
+        if (settings) {
+            settings->setFloat(SettingKey::COULOMB_FRICTION, params.coulomb);
+            settings->setFloat(SettingKey::VISCOUS_FRICTION, params.viscous);
+        }
+    }
+    if (params.flags & DRIVETRAIN_INERTIA) {
+        computations.setInertia(params.inertia);
+        if (settings) settings->setFloat(SettingKey::INERTIA, params.inertia);
+    }
+    return true;
+}
+
+template <typename Vesc, typename Screen, typename Clock>
+float BasicMotorController<Vesc, Screen, Clock>::getFeedforwardTorque()
+{
+    if (!telemetryValid) return 0.0f;
+    float torque = computations.computeFeedforwardTorque(conditioner.getCadence(), conditioner.getCadenceRate());
+    return applyDirection(torque);
+}
+
+template <typename Vesc, typename Screen, typename Clock>
+void BasicMotorController<Vesc, Screen, Clock>::persistUserSettings()
+// Appelé après chaque lecture d'écran réussie : le store n'écrit en flash que si une valeur a changé
+{
+    if (!settings) return;
+
+    settings->setFloat(SettingKey::RAMP_RATE, ramp);
+    settings->setFloat(SettingKey::LINEAR_GAIN, linearGain);
+    settings->setInt(SettingKey::CONTROL_MODE, static_cast<int32_t>(controlMode));
+    settings->setInt(SettingKey::DIRECTION, static_cast<int32_t>(direction));
+}
+
+template <typename Vesc, typename Screen, typename Clock>
+DirectionMode BasicMotorController<Vesc, Screen, Clock>::getDirection()
+{
+    return direction;
+}
+
+/*On donne 1.95A au moteur, il fournit 0.39 Nm,
+ce qui devient 15 Nm au pédalier via le réducteur.
+La réduction est prise en compte via ConditioningConfig::reductionRatio*/
+
+template <typename Vesc, typename Screen, typename Clock>
+UART_HandleTypeDef* BasicMotorController<Vesc, Screen, Clock>::getscreen()
+{
+    return screen_uart;
+}
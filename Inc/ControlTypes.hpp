@@ -0,0 +1,34 @@
+/*
+ * ControlTypes.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #pragma once
+
+ // Types partagés par le contrôleur, l'écran et les mocks (un seul endroit, plus de redéfinition)
+
+ enum class DirectionMode {
+     FORWARD,
+     REVERSE
+ };
+
+ enum class ControlMode {
+     TORQUE,
+     CADENCE,
+     POWER_CONCENTRIC,
+     POWER_ECCENTRIC,
+     LINEAR
+ };
+
+ // Dernière trame COMM_GET_VALUES décodée en une seule transaction UART
+ struct VESCValues {
+     float tempFet;       // °C
+     float tempMotor;     // °C
+     float motorCurrent;  // A
+     float inputCurrent;  // A
+     float rpm;           // ERPM brut (pas encore converti en cadence)
+     float inputVoltage;  // V
+     float dutyCycle;     // -1.0 .. 1.0
+ };
@@ -0,0 +1,65 @@
+/*
+ * DrivetrainParams.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #pragma once
+
+ #include <cstdint>
+
+ #ifdef ERGO_HOST
+ #include <cstdio>
+ #endif
+
+ /**
+  * @brief Modèle de la transmission identifié hors ligne (ergo_sysid) : fichier ERGO.PAR.
+  *
+  * Couple au pédalier vu par le firmware (MotorComputations) :
+  *   I·Kt·rapport = J·dω/dt + visqueux·ω + coulomb·signe(ω) + couple du cycliste
+  * Les grandeurs sont "effectives" : le rendement du réducteur et l'inertie du rotor y sont inclus,
+  * c'est exactement ce que le firmware doit retrancher ou anticiper.
+  *
+  * Image binaire de 48 octets, little-endian (cible et PC), scellée par CRC32 (SettingsStore::crc32).
+  * flags indique les groupes jugés plausibles par l'identification : les autres ne sont pas appliqués.
+  */
+
+ enum DrivetrainParamFlag : uint16_t {
+     DRIVETRAIN_KT       = 1 << 0,  // torqueConstant (et resistance)
+     DRIVETRAIN_FRICTION = 1 << 1,  // viscous, coulomb
+     DRIVETRAIN_INERTIA  = 1 << 2   // inertia
+ };
+
+ struct DrivetrainParams {
+     static const uint32_t MAGIC = 0x50475245u;  // "ERGP"
+     static const uint16_t VERSION = 1;
+
+     uint32_t magic;
+     uint16_t version;
+     uint16_t flags;           // DrivetrainParamFlag
+     float torqueConstant;     // Nm/A côté moteur (= Ke en V·s/rad)
+     float resistance;         // Ω, sous-produit de la régression électrique
+     float inertia;            // kg·m² ramenée au pédalier
+     float viscous;            // Nm·s/rad au pédalier
+     float coulomb;            // Nm au pédalier
+     float reductionRatio;     // rapport utilisé pour ramener au pédalier (doit être celui du firmware)
+     float electricalR2;
+     float mechanicalR2;
+     uint32_t samples;         // échantillons de la régression mécanique
+     uint32_t crc;             // CRC32 des octets qui précèdent
+ };
+
+ static_assert(sizeof(DrivetrainParams) == 48, "image ERGO.PAR : 48 octets");
+
+ void drivetrainParamsSeal(DrivetrainParams& params);  // magic, version et CRC
+ bool drivetrainParamsValid(const DrivetrainParams& params);
+
+ // Lecture du fichier : clé USB sur cible (DrivetrainParamsUsb.cpp), fichier sur PC (DrivetrainParamsFile.cpp).
+ // Faux si absent, tronqué ou corrompu ; params n'est alors pas modifié.
+ bool readDrivetrainParams(const char* path, DrivetrainParams& params);
+
+ #ifdef ERGO_HOST
+ bool writeDrivetrainParams(const char* path, const DrivetrainParams& params);  // scelle une copie
+ void drivetrainParamsPrint(FILE* out, const DrivetrainParams& params);
+ #endif
@@ -0,0 +1,121 @@
+/*
+ * KtCalibration.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #pragma once
+
+ #include <cstdint>
+ #include <cmath>
+
+ /**
+  * @brief Régression linéaire incrémentale y = pente × x + offset.
+  * Mise à jour de Welford (moyennes centrées) : stable en float, O(1) par point, sans stocker les points.
+  */
+ class StreamingLinearFit {
+ public:
+     StreamingLinearFit();
+
+     void reset();
+     void add(float x, float y);
+
+     uint16_t getCount() const { return count; }
+     float getSlope() const;
+     float getOffset() const;
+     float getRSquared() const;       // qualité de l'ajustement (1.0 = parfait)
+     float getResidualStd() const;    // écart-type des résidus
+     float residual(float x, float y) const;
+
+ private:
+     uint16_t count;
+     float meanX, meanY;
+     float sxx, sxy, syy;  // sommes des produits centrés
+ };
+
+ enum class CalibrationState {
+     IDLE,
+     SETTLING,   // attente de la stabilisation sur le palier courant
+     SAMPLING,   // accumulation des points du palier
+     DONE,
+     FAILED
+ };
+
+ struct CalibrationResult {
+     bool success;
+     float torqueConstant;  // Nm/A côté moteur
+     float offset;          // V : chute résistive due au courant de frottement
+     float rSquared;
+     uint16_t samples;
+     uint16_t rejected;     // points écartés comme aberrants
+ };
+
+ struct CalibrationConfig {
+     static const uint8_t MAX_LEVELS = 8;
+
+     float levelFractions[MAX_LEVELS];  // paliers en fraction de la vitesse à vide Vbatt / Ke
+     uint8_t levelCount;
+     uint8_t maxMissedTicks;       // ticks consécutifs sans télémétrie tolérés avant abandon
+     uint32_t settleMs;            // durée de stabilisation par palier
+     uint16_t samplesPerLevel;
+     float outlierSigma;           // rejet si |résidu| > outlierSigma × écart-type
+     uint16_t minSamplesForRejection;
+     float minRSquared;            // qualité minimale pour accepter le résultat
+     float ktPerKe;                // Kt = ktPerKe × Ke (1.0 en unités SI)
+     float ktMin, ktMax;           // plage plausible (Nm/A)
+ };
+
+ CalibrationConfig defaultCalibrationConfig();
+
+ /**
+  * @brief Calibration non bloquante de Kt par la force contre-électromotrice.
+  *
+  * Pour un moteur PM, Kt (Nm/A) = Ke (V·s/rad) en unités SI. On balaie plusieurs
+  * paliers de vitesse ; à vitesse stabilisée la tension de phase vaut
+  * duty × Vbatt ≈ Ke × ω + R × I_frottement. La pente donne Ke, l'offset
+  * absorbe la chute résistive du courant de frottement. Aucune mesure ne dépend
+  * du Kt courant : plus de calcul circulaire.
+  *
+  * Les paliers sont placés sous la vitesse à vide Vbatt / Ke : au départ avec le Kt connu,
+  * puis avec le Ke mesuré à la fin de chaque palier (un Kt initial faux ne mène pas en butée de duty).
+  *
+  * tick() est appelé à chaque boucle et ne bloque jamais.
+  */
+ class KtCalibrator {
+ public:
+     explicit KtCalibrator(const CalibrationConfig& cfg = defaultCalibrationConfig());
+
+     void configure(const CalibrationConfig& cfg) { config = cfg; }
+     // noLoadOmega : estimation de Vbatt / Ke (rad/s moteur) ; échoue aussitôt si elle n'est pas positive
+     void start(uint32_t nowMs, float noLoadOmega);
+     void abort();
+
+     // omegaMotor en rad/s mécaniques, phaseVoltage = duty × Vbatt, inputVoltage = Vbatt
+     void tick(uint32_t nowMs, float omegaMotor, float phaseVoltage, float inputVoltage);
+     void missed();  // tick sans télémétrie : abandon au-delà de maxMissedTicks consécutifs
+
+     bool isRunning() const { return state == CalibrationState::SETTLING || state == CalibrationState::SAMPLING; }
+     CalibrationState getState() const { return state; }
+     float getTargetRpm() const;  // consigne à appliquer pendant la calibration (tr/min moteur)
+     uint8_t getLevel() const { return level; }
+     const CalibrationResult& getResult() const { return result; }
+
+ private:
+     CalibrationConfig config;
+     CalibrationState state;
+     uint8_t level;
+     uint16_t levelSamples;
+     uint32_t levelStartMs;
+     uint8_t missedTicks;
+     float noLoadOmega;          // rad/s, réestimée à chaque palier
+     float levelOmegaSum;        // sommes du palier courant (Ke = tension moyenne / vitesse moyenne)
+     float levelVoltageSum;
+     float levelInputSum;
+     StreamingLinearFit fit;
+     CalibrationResult result;
+
+     void nextLevel(uint32_t nowMs);
+     void updateNoLoadSpeed();
+     void finish();
+ };
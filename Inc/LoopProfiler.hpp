@@ -0,0 +1,118 @@
+/*
+ * LoopProfiler.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #pragma once
+
+ #include <cstdint>
+
+ /**
+  * @brief Profilage par zones de la boucle principale : min, max, moyenne et histogramme log2.
+  *
+  * Cible : compteur de cycles DWT->CYCCNT du Cortex-M4 (1 cycle = 1/SystemCoreClock).
+  * PC : std::chrono::steady_clock, en nanosecondes. Une zone coûte deux lectures du compteur
+  * et une mise à jour de compteurs entiers (CLZ pour l'histogramme) ; sans -DERGO_PROFILE,
+  * les macros ne produisent aucun code et les statistiques n'existent pas.
+  *
+  *   PROFILE_BEGIN(PROFILE_UPDATE);
+  *   motor.update(cadence);
+  *   PROFILE_END(PROFILE_UPDATE);
+  *
+  * Lecture : commande GET_PROFILE de la liaison de télémétrie (ergo_telemetry --profile),
+  * tableau profileZones[] au débogueur, ou profilerPrint() sur PC.
+  */
+
+ enum ProfileZone : uint8_t {
+     PROFILE_LOOP,                // itération complète, hors HAL_Delay
+     PROFILE_UPDATE_FROM_SCREEN,
+     PROFILE_SAMPLE_TELEMETRY,
+     PROFILE_GET_CADENCE,
+     PROFILE_UPDATE,
+     PROFILE_UPDATE_SCREEN,
+     PROFILE_USB_HOST,
+     PROFILE_SESSION_LOG,
+     PROFILE_TELEMETRY_STREAM,
+     PROFILE_DELAY,               // HAL_Delay de fin de boucle (tâche du moniteur du watchdog, non profilée)
+     PROFILE_STARTUP,             // initialisation avant la boucle (idem)
+     PROFILE_ZONES
+ };
+
+ static const uint8_t PROFILE_HISTOGRAM_BINS = 32;  // classe k : [2^k, 2^(k+1)) unités
+
+ struct ProfileZoneStats {
+     uint32_t count;
+     uint32_t min;
+     uint32_t max;
+     uint64_t total;
+     uint32_t histogram[PROFILE_HISTOGRAM_BINS];
+ };
+
+ const char* profileZoneName(uint8_t zone);
+
+ #ifdef ERGO_PROFILE
+
+ #ifdef ERGO_HOST
+ #include <chrono>
+ #include <cstdio>
+
+ inline uint32_t profileNow() {
+     return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+         std::chrono::steady_clock::now().time_since_epoch()).count());
+ }
+ #else
+ #include "main.h"
+
+ inline uint32_t profileNow() {
+     return DWT->CYCCNT;
+ }
+ #endif
+
+ extern ProfileZoneStats profileZones[PROFILE_ZONES];
+ extern uint32_t profileStart[PROFILE_ZONES];
+
+ void profilerInit();    // active DWT->CYCCNT (cible) et remet les statistiques à zéro
+ void profilerReset();
+ uint32_t profilerUnitsPerMicrosecond();  // cycles/µs sur cible, 1000 (ns) sur PC
+
+ inline void profileRecord(uint8_t zone, uint32_t elapsed) {
+     ProfileZoneStats& z = profileZones[zone];
+     z.count++;
+     z.total += elapsed;
+     if (elapsed < z.min) z.min = elapsed;
+     if (elapsed > z.max) z.max = elapsed;
+     z.histogram[31 - __builtin_clz(elapsed | 1u)]++;  // une instruction CLZ sur Cortex-M4
+ }
+
+ // Zone délimitée par la portée (retours anticipés compris)
+ class ProfileScope {
+ public:
+     explicit ProfileScope(uint8_t zone) : zone(zone), start(profileNow()) {}
+     ~ProfileScope() { profileRecord(zone, profileNow() - start); }
+
+ private:
+     uint8_t zone;
+     uint32_t start;
+ };
+
+ #ifdef ERGO_HOST
+ void profilerPrint(FILE* out);
+ #endif
+
+ #define PROFILE_INIT() profilerInit()
+ #define PROFILE_BEGIN(zone) (profileStart[(zone)] = profileNow())
+ #define PROFILE_END(zone) profileRecord((zone), profileNow() - profileStart[(zone)])
+ #define PROFILE_CONCAT2(a, b) a##b
+ #define PROFILE_CONCAT(a, b) PROFILE_CONCAT2(a, b)
+ #define PROFILE_SCOPE(zone) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(zone)
+
+ #else
+
+ #define PROFILE_INIT() ((void)0)
+ #define PROFILE_BEGIN(zone) ((void)0)
+ #define PROFILE_END(zone) ((void)0)
+ #define PROFILE_SCOPE(zone) ((void)0)
+
+ #endif
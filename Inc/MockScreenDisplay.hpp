@@ -11,34 +11,58 @@
  #include <string>
  #include <cstdint>
  
- class MotorController;
- #include "MotorController.hpp"
+ #include "stm32f4xx_hal.h"
+ #include "ControlTypes.hpp"
+ #include "MockTrace.hpp"
+ #include "SessionAnalytics.hpp"
  
+ /**
+  * Saisies renvoyées par les get*() hors mode VERBOSE : un banc les fixe au lieu de les taper.
+  */
+ struct MockScreenInputs {
+     ControlMode mode = ControlMode::CADENCE;
+     DirectionMode direction = DirectionMode::FORWARD;
+     float rampRate = 6.0f;      // A/s, valeur par défaut de l'écran
+     float cadence = 0.0f;       // tr/min
+     float torque = 0.0f;        // Nm
+     float power = 0.0f;         // W
+     float linearGain = 0.0f;
+     bool stop = false;
+     bool calibrate = false;
+     int32_t raw = 0;            // readInt32()
+     bool readFails = false;     // simule un délai UART dépassé : get*() renvoie -1, lastReadOk() faux
+ };
+
  /**
   * Mock de ScreenDisplay pour tests sans Nextion.
-  * Affiche les interactions via la console (printf).
+  * En VERBOSE (défaut), affiche les interactions sur la console et lit les saisies au clavier ;
+  * en SILENT / RECORDING, aucune entrée/sortie : les saisies viennent de getInputs().
   */
  class MockScreenDisplay {
  public:
-     MOckScreenDisplay(UART_HandleTypeDef* uart = nullptr) {
+     explicit MockScreenDisplay(UART_HandleTypeDef* uart = nullptr) : readOk(false) {
          (void)uart; // inutilisé dans le mock
      }
+
+     MockTrace& getTrace() { return trace; }
+     void setMode(MockMode mode) { trace.setMode(mode); }
+     MockScreenInputs& getInputs() { return inputs; }
  
      // --- Affichage dynamique simulé ---
      void showCadence(float rpm) {
-         printf("[Écran] Cadence: %.1f tr/min\n", rpm);
+         trace.record(MockCall::SCREEN_SHOW_CADENCE, rpm);
      }
  
      void showTorque(float torque) {
-         printf("[Écran] Couple: %.2f Nm\n", torque);
+         trace.record(MockCall::SCREEN_SHOW_TORQUE, torque);
      }
  
      void showPower(float power) {
-         printf("[Écran] Puissance: %.2f W\n", power);
+         trace.record(MockCall::SCREEN_SHOW_POWER, power);
      }
  
      void showMode(const char* modeName) {
-         printf("[Écran] Mode: %s\n", modeName);
+         trace.record(MockCall::SCREEN_SHOW_MODE, 0.0f, modeName);
      }
  
      void showMode(ControlMode mode) {
@@ -51,110 +75,115 @@
              case ControlMode::LINEAR:           str = "Linéaire"; break;
              default: break;
          }
-         showMode(str);
+         trace.record(MockCall::SCREEN_SHOW_MODE, static_cast<float>(mode), str);
      }
  
      void showGain(float gain) {
-         printf("[Écran] Gain linéaire: %.2f\n", gain);
+         trace.record(MockCall::SCREEN_SHOW_GAIN, gain);
      }
  
      void showDutyCycle(float duty) {
-         printf("[Écran] Duty Cycle: %.1f%%\n", duty * 100.0f);
+         trace.record(MockCall::SCREEN_SHOW_DUTY, duty);
      }
  
      void showDirection(DirectionMode dir) {
          const char* label = (dir == DirectionMode::REVERSE) ? "REVERSE" : "FORWARD";
-         printf("[Écran] Direction: %s\n", label);
+         trace.record(MockCall::SCREEN_SHOW_DIRECTION, static_cast<float>(dir), label);
      }
  
      // --- Messages statiques simulés ---
      void showError(const char* message) {
-         printf("[Écran - ERREUR]: %s\n", message);
+         trace.record(MockCall::SCREEN_SHOW_ERROR, 0.0f, message);
      }
  
      void showWelcome() {
-         printf("[Écran] Ergocycle S2M prêt !\n");
+         trace.record(MockCall::SCREEN_SHOW_WELCOME, 0.0f);
      }
  
      void clearScreen() {
-         printf("[Écran] --- Écran effacé ---\n");
+         trace.record(MockCall::SCREEN_CLEAR, 0.0f);
      }
  
      // --- Entrées utilisateur simulées ---
      int32_t readInt32() {
-         int32_t val;
-         printf("→ [Simu Écran] Entrez un int32 : ");
-         std::cin >> val;
-         return val;
+         return prompt("readInt32", "→ [Simu Écran] Entrez un int32 : ", inputs.raw);
      }
  
      float getUserCadence() {
-         float rpm;
-         printf("→ Cadence cible (tr/min) : ");
-         std::cin >> rpm;
-         return rpm;
+         return prompt("cadence", "→ Cadence cible (tr/min) : ", inputs.cadence);
      }
  
      float getUserPower() {
-         float power;
-         printf("→ Puissance cible (W) : ");
-         std::cin >> power;
-         return power;
+         return prompt("puissance", "→ Puissance cible (W) : ", inputs.power);
      }
  
      float getUserTorque() {
-         float torque;
-         printf("→ Couple cible (Nm) : ");
-         std::cin >> torque;
-         return torque;
+         return prompt("couple", "→ Couple cible (Nm) : ", inputs.torque);
      }
  
      float getUserLinearGain() {
-         float gain;
-         printf("→ Gain linéaire : ");
-         std::cin >> gain;
-         return gain;
+         return prompt("gain", "→ Gain linéaire : ", inputs.linearGain);
      }
  
      ControlMode getMode() {
-         int val;
-         printf("→ Mode (0:CAD, 1:TOR, 2:P_CONC, 3:P_ECC, 4:LIN): ");
-         std::cin >> val;
+         int val = prompt("mode", "→ Mode (0:CAD, 1:TOR, 2:P_CONC, 3:P_ECC, 4:LIN): ", static_cast<int>(inputs.mode));
+         if (val < 0 || val > static_cast<int>(ControlMode::LINEAR)) {
+             readOk = false;  // hors énumération : rejeté comme sur l'écran réel
+             return ControlMode::CADENCE;
+         }
          return static_cast<ControlMode>(val);
      }
  
      bool getStop() {
-         int stop;
-         printf("→ Stop demandé ? (0:non, 1:oui): ");
-         std::cin >> stop;
-         return stop == 1;
+         return prompt("stop", "→ Stop demandé ? (0:non, 1:oui): ", inputs.stop ? 1 : 0) == 1;
      }
  
      bool getCalibrateRequest() {
-         int req;
-         printf("→ Calibration demandée ? (0:non, 1:oui): ");
-         std::cin >> req;
-         return req == 1;
+         return prompt("calibration", "→ Calibration demandée ? (0:non, 1:oui): ", inputs.calibrate ? 1 : 0) == 1;
      }
- 
- private:
-     // Pas d’UART ici → tout est simulé
-     void sendCommand(const char* cmd) {
-         printf("[SendCmd] %s\n", cmd);
+
+     DirectionMode getDirection() {
+         int dir = prompt("direction", "→ Direction (0:FORWARD, 1:REVERSE): ", inputs.direction == DirectionMode::REVERSE ? 1 : 0);
+         if (dir != 0 && dir != 1) readOk = false;
+         return (dir == 1) ? DirectionMode::REVERSE : DirectionMode::FORWARD;
      }
- 
+
+     float getRampRate() {
+         return prompt("rampe", "→ Rampe (A/s) : ", inputs.rampRate);
+     }
+
+     bool lastReadOk() const { return readOk; }
+
+     void showCalibrationStatus(bool success) {
+         trace.record(MockCall::SCREEN_SHOW_CALIBRATION, success ? 1.0f : 0.0f);
+     }
+
      void sendText(const char* component, const char* message) {
-         printf("[Écran] %s = \"%s\"\n", component, message);
+         trace.record(MockCall::SCREEN_SEND_TEXT, 0.0f, component, message);
+     }
+
+     void showSessionSummary(const SessionSummary& summary) {
+         trace.record(MockCall::SCREEN_SHOW_SUMMARY, summary.energyJ / 1000.0f);
      }
  
-     void sendValue(const char* component, float value, const char* format = "%.1f") {
-         char buffer[64];
-         snprintf(buffer, sizeof(buffer), format, value);
-         sendText(component, buffer);
+ private:
+     MockTrace trace;
+     MockScreenInputs inputs;
+     bool readOk;
+
+     // VERBOSE : saisie clavier comme avant ; sinon valeur préréglée, sans aucune entrée/sortie
+     template <typename T>
+     T prompt(const char* name, const char* question, T preset) {
+         T value = preset;
+         readOk = !inputs.readFails;
+         if (!readOk) {
+             value = static_cast<T>(-1);  // même valeur d'erreur que ScreenDisplay::readInt32()
+         } else if (trace.getMode() == MockMode::VERBOSE) {
+             printf("%s", question);
+             fflush(stdout);
+             std::cin >> value;
+         }
+         trace.record(MockCall::SCREEN_READ_INPUT, static_cast<float>(value), name);
+         return value;
      }
  };
- 
- 
- 
- 
- 
\ No newline at end of file
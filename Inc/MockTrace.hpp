@@ -0,0 +1,189 @@
+/*
+ * MockTrace.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #pragma once
+
+ #include <cstdint>
+ #include <cstdio>
+ #include <vector>
+
+ /**
+  * Niveau de bavardage des mocks (MockVESCInterface, MockScreenDisplay).
+  */
+ enum class MockMode : uint8_t {
+     SILENT,     // compteurs seulement : pour mesurer le coût de la loi de commande elle-même
+     RECORDING,  // compteurs + journal en mémoire, affiché à la demande (print)
+     VERBOSE     // comportement historique : chaque appel affiché, saisies écran au clavier
+ };
+
+ enum class MockCall : uint8_t {
+     VESC_SET_CURRENT,
+     VESC_SET_RPM,
+     VESC_GET_VALUES,
+     VESC_GET_RPM,
+     VESC_GET_CURRENT,
+     VESC_GET_DUTY,
+     SCREEN_SHOW_CADENCE,
+     SCREEN_SHOW_TORQUE,
+     SCREEN_SHOW_POWER,
+     SCREEN_SHOW_MODE,
+     SCREEN_SHOW_GAIN,
+     SCREEN_SHOW_DUTY,
+     SCREEN_SHOW_DIRECTION,
+     SCREEN_SHOW_ERROR,
+     SCREEN_SHOW_WELCOME,
+     SCREEN_CLEAR,
+     SCREEN_SHOW_CALIBRATION,
+     SCREEN_SEND_TEXT,
+     SCREEN_READ_INPUT,
+     SCREEN_SHOW_SUMMARY,
+     COUNT
+ };
+
+ // Arguments bruts copiés tels quels (tronqués) : les messages peuvent venir d'un tampon temporaire,
+ // la mise en forme n'a lieu qu'à l'affichage
+ struct MockCallRecord {
+     MockCall call;
+     float value;
+     char text[32];
+     char detail[48];
+ };
+
+ /**
+  * Journal d'appels d'un mock : tampon alloué une fois à la construction, plus aucune allocation
+  * ni entrée/sortie pendant la simulation. Une fois plein, les appels suivants ne sont plus que comptés.
+  */
+ class MockTrace {
+ public:
+     explicit MockTrace(size_t capacity = 4096, MockMode initialMode = MockMode::VERBOSE)
+         : mode(initialMode), capacity(capacity), dropped(0), counts{}
+     {
+         records.reserve(capacity);
+     }
+
+     void setMode(MockMode m) { mode = m; }
+     MockMode getMode() const { return mode; }
+
+     // detail : valeur associée à text (ex. sendText : composant et message)
+     void record(MockCall call, float value, const char* text = nullptr, const char* detail = nullptr) {
+         counts[static_cast<size_t>(call)]++;
+         if (mode == MockMode::SILENT) return;
+
+         MockCallRecord r = {call, value, {}, {}};
+         copyTruncated(r.text, sizeof(r.text), text);
+         copyTruncated(r.detail, sizeof(r.detail), detail);
+
+         if (mode == MockMode::VERBOSE) printRecord(stdout, r);
+         if (records.size() < capacity) records.push_back(r);
+         else dropped++;
+     }
+
+     uint32_t count(MockCall call) const { return counts[static_cast<size_t>(call)]; }
+     uint32_t totalCalls() const {
+         uint32_t total = 0;
+         for (uint32_t c : counts) total += c;
+         return total;
+     }
+     const std::vector<MockCallRecord>& getRecords() const { return records; }
+     uint32_t getDropped() const { return dropped; }
+
+     // Dernière valeur enregistrée pour un appel (ex. dernier courant commandé) ; faux si aucune
+     bool last(MockCall call, float& value) const {
+         for (size_t i = records.size(); i-- > 0;) {
+             if (records[i].call == call) {
+                 value = records[i].value;
+                 return true;
+             }
+         }
+         return false;
+     }
+
+     void clear() {
+         records.clear();  // garde la capacité réservée
+         dropped = 0;
+         for (uint32_t& c : counts) c = 0;
+     }
+
+     // Mise en forme différée : le coût d'affichage n'est payé qu'ici
+     void print(FILE* out) const {
+         for (const MockCallRecord& r : records) printRecord(out, r);
+         if (dropped) fprintf(out, "... %u appels non journalisés (tampon plein)\n", dropped);
+     }
+
+     void printSummary(FILE* out) const {
+         for (size_t i = 0; i < static_cast<size_t>(MockCall::COUNT); i++) {
+             if (counts[i]) fprintf(out, "%-22s %10u\n", callName(static_cast<MockCall>(i)), counts[i]);
+         }
+     }
+
+     static const char* callName(MockCall call) {
+         switch (call) {
+             case MockCall::VESC_SET_CURRENT:        return "vesc.setCurrent";
+             case MockCall::VESC_SET_RPM:            return "vesc.setRPM";
+             case MockCall::VESC_GET_VALUES:         return "vesc.getValues";
+             case MockCall::VESC_GET_RPM:            return "vesc.getRPM";
+             case MockCall::VESC_GET_CURRENT:        return "vesc.getCurrent";
+             case MockCall::VESC_GET_DUTY:           return "vesc.getDutyCycle";
+             case MockCall::SCREEN_SHOW_CADENCE:     return "screen.showCadence";
+             case MockCall::SCREEN_SHOW_TORQUE:      return "screen.showTorque";
+             case MockCall::SCREEN_SHOW_POWER:       return "screen.showPower";
+             case MockCall::SCREEN_SHOW_MODE:        return "screen.showMode";
+             case MockCall::SCREEN_SHOW_GAIN:        return "screen.showGain";
+             case MockCall::SCREEN_SHOW_DUTY:        return "screen.showDutyCycle";
+             case MockCall::SCREEN_SHOW_DIRECTION:   return "screen.showDirection";
+             case MockCall::SCREEN_SHOW_ERROR:       return "screen.showError";
+             case MockCall::SCREEN_SHOW_WELCOME:     return "screen.showWelcome";
+             case MockCall::SCREEN_CLEAR:            return "screen.clearScreen";
+             case MockCall::SCREEN_SHOW_CALIBRATION: return "screen.calibration";
+             case MockCall::SCREEN_SEND_TEXT:        return "screen.sendText";
+             case MockCall::SCREEN_READ_INPUT:       return "screen.get*";
+             case MockCall::SCREEN_SHOW_SUMMARY:     return "screen.showSessionSummary";
+             default:                                return "?";
+         }
+     }
+
+     static void printRecord(FILE* out, const MockCallRecord& r) {
+         switch (r.call) {
+             case MockCall::VESC_SET_CURRENT:        fprintf(out, "[VESC] Commande courant: %g A\n", r.value); break;
+             case MockCall::VESC_SET_RPM:            fprintf(out, "[VESC] Commande RPM: %g tr/min\n", r.value); break;
+             case MockCall::VESC_GET_VALUES:         fprintf(out, "[VESC] getValues appelé\n"); break;
+             case MockCall::VESC_GET_RPM:            fprintf(out, "[VESC] Lecture RPM simulé: %g\n", r.value); break;
+             case MockCall::VESC_GET_CURRENT:        fprintf(out, "[VESC] Lecture courant simulé: %g\n", r.value); break;
+             case MockCall::VESC_GET_DUTY:           fprintf(out, "[VESC] Lecture duty cycle simulé: %g\n", r.value); break;
+             case MockCall::SCREEN_SHOW_CADENCE:     fprintf(out, "[Écran] Cadence: %.1f tr/min\n", r.value); break;
+             case MockCall::SCREEN_SHOW_TORQUE:      fprintf(out, "[Écran] Couple: %.2f Nm\n", r.value); break;
+             case MockCall::SCREEN_SHOW_POWER:       fprintf(out, "[Écran] Puissance: %.2f W\n", r.value); break;
+             case MockCall::SCREEN_SHOW_MODE:        fprintf(out, "[Écran] Mode: %s\n", r.text); break;
+             case MockCall::SCREEN_SHOW_GAIN:        fprintf(out, "[Écran] Gain linéaire: %.2f\n", r.value); break;
+             case MockCall::SCREEN_SHOW_DUTY:        fprintf(out, "[Écran] Duty Cycle: %.1f%%\n", r.value * 100.0f); break;
+             case MockCall::SCREEN_SHOW_DIRECTION:   fprintf(out, "[Écran] Direction: %s\n", r.text); break;
+             case MockCall::SCREEN_SHOW_ERROR:       fprintf(out, "[Écran - ERREUR]: %s\n", r.text); break;
+             case MockCall::SCREEN_SHOW_WELCOME:     fprintf(out, "[Écran] Ergocycle S2M prêt !\n"); break;
+             case MockCall::SCREEN_CLEAR:            fprintf(out, "[Écran] --- Écran effacé ---\n"); break;
+             case MockCall::SCREEN_SHOW_CALIBRATION: fprintf(out, "[Écran] Calibration: %s\n", r.value ? "OK" : "Erreur"); break;
+             case MockCall::SCREEN_SEND_TEXT:        fprintf(out, "[Écran] %s = \"%s\"\n", r.text, r.detail); break;
+             case MockCall::SCREEN_READ_INPUT:       fprintf(out, "[Écran] lecture %s = %g\n", r.text, r.value); break;
+             case MockCall::SCREEN_SHOW_SUMMARY:     fprintf(out, "[Écran] Bilan: %.1f kJ\n", r.value); break;
+             default: break;
+         }
+     }
+
+ private:
+     static void copyTruncated(char* dst, size_t size, const char* src) {
+         size_t i = 0;
+         if (src) {
+             for (; i + 1 < size && src[i]; i++) dst[i] = src[i];
+         }
+         dst[i] = '\0';
+     }
+
+     MockMode mode;
+     size_t capacity;
+     uint32_t dropped;
+     uint32_t counts[static_cast<size_t>(MockCall::COUNT)];
+     std::vector<MockCallRecord> records;
+ };
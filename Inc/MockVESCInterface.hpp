@@ -7,43 +7,77 @@
 
  #pragma once
 
- #include <iostream>
  #include <cstdint>
+
+ #include "stm32f4xx_hal.h"
+ #include "ControlTypes.hpp"
+ #include "MockTrace.hpp"
  
+ /**
+  * Mesures renvoyées par getValues() : un test de défaut les fixe pour déclencher le superviseur.
+  */
+ struct MockVESCInputs {
+     float tempFet = 25.0f;        // °C
+     float tempMotor = 25.0f;      // °C
+     float inputVoltage = 36.0f;   // V
+     bool forceCurrent = false;    // vrai : motorCurrent imposé au lieu du dernier courant commandé
+     float motorCurrent = 0.0f;    // A
+     bool forceRpm = false;        // vrai : erpm imposé (cycliste qui pédale) au lieu de la dernière consigne RPM
+     float erpm = 0.0f;
+     bool linkDown = false;        // getValues() échoue : perte de télémétrie
+ };
+
  /**
   * Mock de VESCInterface pour simulation sans VESC.
+  * Chaque appel passe par getTrace() : muet, journalisé en mémoire ou affiché (voir MockMode).
   */
  class MockVESCInterface {
  public:
      explicit MockVESCInterface(UART_HandleTypeDef* = nullptr) {}
  
      void setCurrent(float current) {
-         std::cout << "[VESC] Commande courant: " << current << " A" << std::endl;
+         trace.record(MockCall::VESC_SET_CURRENT, current);
          lastCurrent = current;
      }
  
      void setRPM(int32_t rpmVal) {
-         std::cout << "[VESC] Commande RPM: " << rpmVal << " tr/min" << std::endl;
+         trace.record(MockCall::VESC_SET_RPM, static_cast<float>(rpmVal));
          simulatedRPM = static_cast<float>(rpmVal);
      }
  
      bool getValues() {
-         std::cout << "[VESC] getValues appelé" << std::endl;
+         trace.record(MockCall::VESC_GET_VALUES, 0.0f);
+         if (inputs.linkDown) return false;  // dernières valeurs conservées, comme VESCInterface
+         float current = inputs.forceCurrent ? inputs.motorCurrent : lastCurrent;
+         values.tempFet = inputs.tempFet;
+         values.tempMotor = inputs.tempMotor;
+         values.motorCurrent = current;
+         values.inputCurrent = current;
+         values.rpm = inputs.forceRpm ? inputs.erpm : simulatedRPM;
+         values.inputVoltage = inputs.inputVoltage;
+         values.dutyCycle = duty;
          return true;
      }
+
+     const VESCValues& getLastValues() const { return values; }
+     MockVESCInputs& getInputs() { return inputs; }
+     float getCommandedCurrent() const { return lastCurrent; }  // dernier setCurrent(), sans trace
+
+     MockTrace& getTrace() { return trace; }
+     void setMode(MockMode mode) { trace.setMode(mode); }
  
      float getRPM() {
-         std::cout << "[VESC] Lecture RPM simulé: " << simulatedRPM << std::endl;
+         trace.record(MockCall::VESC_GET_RPM, simulatedRPM);
          return simulatedRPM;
      }
  
      float getCurrent() {
-         std::cout << "[VESC] Lecture courant simulé: " << lastCurrent << std::endl;
+         trace.record(MockCall::VESC_GET_CURRENT, lastCurrent);
          return lastCurrent;
      }
  
      float getDutyCycle() {
-         std::cout << "[VESC] Lecture duty cycle simulé: " << duty << std::endl;
+         trace.record(MockCall::VESC_GET_DUTY, duty);
          return duty;
      }
  
@@ -51,6 +85,9 @@
      float simulatedRPM = 60.0f;  // valeur fictive
      float lastCurrent = 1.5f;    // courant simulé
      float duty = 0.25f;          // 25%
+     VESCValues values = {};
+     MockVESCInputs inputs;
+     MockTrace trace;
  };
  
  
@@ -9,19 +9,57 @@
  using namespace std;
 
  #include <cmath>
+ #include <cstddef>
 
  class MotorComputations {
     public:
         MotorComputations(float torqueConstant = 0.05f); 
     
+        // Couple ramené au pédalier : τ = I × Kt(T) × rapport de réduction
         float computeTorqueFromCurrent(float current) const;
         float computeCurrentFromTorque(float torque) const;
+
+        // Couple à l'arbre : couple électromagnétique moins pertes frottement/fer à cette vitesse
+        float computeShaftTorque(float current, float cadence_rpm) const;
+        float computeLossTorque(float cadence_rpm) const;
     
         float computePower(float torque, float cadence_rpm) const;
         float computeOmega(float cadence_rpm) const;
-        void setTorqueConstant(float value);
+        void setTorqueConstant(float value);  // Kt à la température de référence
+        void setReductionRatio(float ratio);
+
+        // Modèle thermique : Kt(T) = Kt_ref × (1 + α × (T - T_ref)), α < 0 pour des aimants NdFeB
+        void setTemperatureModel(float alphaPerKelvin, float referenceTempC = 25.0f);
+        void setMotorTemperature(float tempC);  // à appeler à chaque trame VESC (quelques multiplications)
+        float referenceTorqueConstant(float measuredKt, float tempC) const;  // ramène un Kt mesuré à T_ref
+
+        // Pertes : τ_pertes = coulomb × signe(ω) + visqueux × ω (Nm, Nm·s/rad, au pédalier)
+        void setLossModel(float coulombNm, float viscousNmPerRadS);
+
+        // Anticipation : couple à fournir pour suivre cette cadence et cette accélération
+        // τ = J × dω/dt + pertes (J en kg·m² au pédalier, cadenceRate en tr/min/s)
+        void setInertia(float kgm2);
+        float computeFeedforwardTorque(float cadence_rpm, float cadenceRate) const;
+
+        // Réanalyse de journaux : mêmes formules, tableaux contigus, sans appel virtuel
+        void computeTorqueBatch(const float* current, const float* tempC, const float* cadence_rpm,
+                                float* torqueOut, size_t count) const;
+        void computePowerBatch(const float* torque, const float* cadence_rpm, float* powerOut, size_t count) const;
     
     private:
-        float torqueConstant;  // en Nm/A
+        float torqueConstant;  // en Nm/A, à la température de référence
+        float reductionRatio;  // tours moteur par tour de pédalier (1.0 = couple côté moteur)
+        float tempCoefficient; // α en 1/K
+        float referenceTemp;   // °C
+        float motorTemp;       // °C, dernière mesure
+        float coulombLoss;     // Nm
+        float viscousLoss;     // Nm·s/rad
+        float inertia;         // kg·m²
+
+        // Coefficients précalculés : le chemin par appel reste une multiplication
+        float torquePerAmp;    // Kt(T) × rapport
+        float ampsPerTorque;   // 1 / torquePerAmp
+        float ktSlope;         // Kt_ref × α × rapport, pour le calcul par lot
+
+        void updateCoefficients();
     };
-    
\ No newline at end of file
@@ -0,0 +1,206 @@
+/*
+ * ResponseTest.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #pragma once
+
+ #include <cstdint>
+
+ #include "ControlTypes.hpp"
+
+ #ifdef ERGO_HOST
+ #include <cstdio>
+ #endif
+
+ /**
+  * @brief Réponse consigne → mesure : échelons et chirp programmés, analysés au fil de l'eau.
+  *
+  * Programme (temps écoulé depuis start(), tout en ms) :
+  *   [palier de repos à base] [stepCount échelons base+A / base / ...] [repos si stepCount impair] [chirp]
+  * chaque palier dure stepHoldMs ; le chirp base + a·sin φ(t) balaie chirpStartHz → chirpEndHz en
+  * fréquence exponentielle (temps égal par octave), découpé en chirpBands bandes analysées séparément.
+  *
+  * Référence et mesure sont dans la même unité : mode CADENCE, consigne et cadence filtrée (tr/min) ;
+  * mode TORQUE, courant commandé et courant mesuré filtré (A), la boucle de courant du VESC.
+  *
+  * Par échelon : retard pur (premier passage à settleBand de la variation), temps de montée 10-90 %,
+  * dépassement, temps d'établissement (dernier passage hors ±settleBand), erreur statique. La valeur
+  * finale est la moyenne du dernier quart du palier. Par bande du chirp : moindres carrés
+  * x ≈ a·sin φ + b·cos φ + c sur la référence et sur la mesure (sommes pondérées par la durée de
+  * chaque tick, exact même sur un nombre non entier de périodes) → gain, phase et retard équivalent. Une bande échantillonnée à moins de 2,5 points par période est marquée invalide :
+  * c'est la cadence de la boucle qui limite alors la mesure, pas le système.
+  *
+  * ResponseAnalyzer ne dépend que du temps écoulé : le même code tourne sur cible pendant le test
+  * et sur PC sur un journal rejoué (échantillons marqués TELEMETRY_RESPONSE_TEST).
+  */
+
+ struct ResponseTestConfig {
+     static const uint8_t MAX_STEPS = 8;
+     static const uint8_t MAX_BANDS = 8;
+
+     ControlMode mode;         // CADENCE ou TORQUE
+     float base;               // tr/min ou Nm
+     float stepAmplitude;
+     uint8_t stepCount;
+     uint32_t stepHoldMs;      // durée de chaque palier (repos compris)
+     float chirpAmplitude;
+     float chirpStartHz;
+     float chirpEndHz;
+     uint32_t chirpMs;         // 0 : pas de chirp
+     uint8_t chirpBands;
+     float settleBand;         // fraction de la variation (retard pur et établissement)
+ };
+
+ ResponseTestConfig defaultResponseTestConfig();
+
+ struct StepMetrics {
+     bool valid;               // faux : la mesure n'a pas suivi (moins de 10 % de la variation) ou trop peu de points
+     float from, to;           // référence avant / fin de palier
+     float initial, final;     // mesure avant / moyenne du dernier quart
+     float deadTimeMs;
+     float riseTimeMs;         // 10 % → 90 %
+     float overshootPct;       // de la variation mesurée
+     float settlingTimeMs;     // < 0 : jamais établi dans le palier
+     float steadyStateError;   // to - final
+     uint16_t samples;
+ };
+
+ struct FrequencyPoint {
+     bool valid;
+     float hz;                 // moyenne géométrique des bords de la bande
+     float gain;               // |mesure| / |référence|
+     float phaseDeg;           // déroulée d'une bande à l'autre
+     float delayMs;            // -phase / (360 f)
+     uint16_t samples;
+ };
+
+ struct ResponseTestResult {
+     uint8_t stepCount;
+     StepMetrics steps[ResponseTestConfig::MAX_STEPS];
+     uint8_t bandCount;
+     FrequencyPoint bands[ResponseTestConfig::MAX_BANDS];
+     float meanDeadTimeMs;     // moyennes et pires cas sur les échelons valides
+     float meanRiseTimeMs;
+     float maxOvershootPct;
+     float maxSettlingTimeMs;  // < 0 si un échelon ne s'est pas établi
+     float bandwidthHz;        // première bande sous -3 dB de la bande basse (0 : non atteinte)
+ };
+
+ enum class ResponseSegment : uint8_t {
+     SETTLE,
+     STEP,
+     CHIRP,
+     DONE
+ };
+
+ /**
+  * @brief Programme de consignes : fonction pure du temps écoulé.
+  */
+ class ResponseProgram {
+ public:
+     explicit ResponseProgram(const ResponseTestConfig& cfg) : config(cfg) {}
+
+     const ResponseTestConfig& getConfig() const { return config; }
+     uint8_t getStepCount() const;   // bornés à MAX_STEPS / MAX_BANDS
+     uint8_t getBandCount() const;
+     uint32_t getChirpStartMs() const;
+     uint32_t getDurationMs() const { return getChirpStartMs() + config.chirpMs; }
+
+     // Segment en cours et son rang (échelon ou bande) ; startMs = début du segment
+     ResponseSegment segmentAt(uint32_t elapsedMs, uint8_t& index, uint32_t& startMs) const;
+     float setpointAt(uint32_t elapsedMs) const;
+     float chirpPhase(uint32_t chirpMs) const;  // rad, depuis le début du chirp
+     float bandEdgeHz(uint8_t band) const;      // bande b : [bandEdgeHz(b), bandEdgeHz(b + 1)]
+
+ private:
+     ResponseTestConfig config;
+ };
+
+ /**
+  * @brief Analyse incrémentale : push() à chaque tick, résultat complet après finish().
+  *
+  * Mémoire fixe : un tampon de STEP_SAMPLES points pour l'échelon en cours (au-delà, la fin du
+  * palier n'est plus stockée et la valeur finale est prise sur ce qui l'a été), des sommes par bande.
+  */
+ class ResponseAnalyzer {
+ public:
+     explicit ResponseAnalyzer(const ResponseTestConfig& cfg = defaultResponseTestConfig());
+
+     void configure(const ResponseTestConfig& cfg);  // nouveau programme, puis reset()
+     void reset();
+     void push(uint32_t elapsedMs, float reference, float measured);
+     void finish();  // clôt le segment en cours et calcule les synthèses
+
+     const ResponseProgram& getProgram() const { return program; }
+     const ResponseTestResult& getResult() const { return result; }
+
+ private:
+     static const uint16_t STEP_SAMPLES = 256;
+     static const uint32_t MAX_GAP_MS = 2000;  // intervalle plus long : non pondéré (télémétrie perdue)
+
+     ResponseProgram program;
+     ResponseTestResult result;
+
+     ResponseSegment segment;
+     uint8_t index;
+     uint32_t segmentStartMs;
+     bool started;
+     uint32_t lastMs;
+     float lastReference;
+     float lastMeasured;
+
+     // Échelon en cours
+     float stepFrom;
+     float stepInitial;
+     uint32_t stepCommandMs;             // premier tick du palier : la consigne part à ce moment
+     uint16_t stepCount;
+     uint32_t stepTimeMs[STEP_SAMPLES];  // depuis stepCommandMs
+     float stepMeasured[STEP_SAMPLES];
+     float tailReference;                // Σ référence sur le dernier quart du palier
+     uint16_t tailCount;
+
+     // Bande de chirp en cours : matrice normale de (sin φ, cos φ, 1) et seconds membres, pondérés par dt
+     float w, ws, wc, wss, wsc, wcc;
+     float ru, rs, rc;
+     float yu, ys, yc;
+     uint16_t bandSamples;
+
+     void openSegment(ResponseSegment next, uint8_t nextIndex, uint32_t startMs);
+     void closeSegment();
+     void closeStep();
+     void closeBand();
+     void summarize();
+ };
+
+ /**
+  * @brief Séquenceur non bloquant, sur le modèle de KtCalibrator : le contrôleur applique
+  * getSetpoint() à chaque tick puis transmet référence et mesure à tick().
+  */
+ class ResponseTest {
+ public:
+     explicit ResponseTest(const ResponseTestConfig& cfg = defaultResponseTestConfig());
+
+     void start(const ResponseTestConfig& cfg, uint32_t nowMs);
+     void abort();
+
+     float getSetpoint(uint32_t nowMs) const;
+     void tick(uint32_t nowMs, float reference, float measured, bool valid = true);  // valid = faux : tick sans mesure, non analysé
+
+     bool isRunning() const { return running; }
+     bool isComplete() const { return complete; }  // terminé normalement (pas interrompu)
+     const ResponseTestConfig& getConfig() const { return analyzer.getProgram().getConfig(); }
+     const ResponseTestResult& getResult() const { return analyzer.getResult(); }
+
+ private:
+     ResponseAnalyzer analyzer;
+     bool running;
+     bool complete;
+     uint32_t startMs;
+ };
+
+ #ifdef ERGO_HOST
+ void responseTestPrint(FILE* out, const ResponseTestResult& result, const char* unit);
+ #endif
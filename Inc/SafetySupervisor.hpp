@@ -0,0 +1,115 @@
+/*
+ * SafetySupervisor.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #pragma once
+
+ #include <cstdint>
+ #include <cmath>
+
+ /**
+  * @brief Superviseur de sécurité évalué à chaque tick de commande.
+  *
+  * Ne dépend d'aucun périphérique : on lui donne l'état mesuré et l'heure, il renvoie
+  * le courant autorisé. Nombre de règles fixe, aucune boucle dépendant des données
+  * → temps d'exécution borné. Scénarios de défaut injectables sur PC via SafetyInputs.
+  */
+
+ enum SafetyFault : uint8_t {
+     FAULT_NONE            = 0,
+     FAULT_OVER_TEMP_FET   = 1 << 0,
+     FAULT_OVER_TEMP_MOTOR = 1 << 1,
+     FAULT_OVERCURRENT     = 1 << 2,
+     FAULT_STALL           = 1 << 3,   // fort courant à cadence nulle
+     FAULT_COMMS_LOSS      = 1 << 4    // télémétrie VESC périmée
+ };
+
+ struct SafetyInputs {
+     uint32_t nowMs;
+     bool telemetryFresh;   // vrai si une trame VESC valide vient d'être reçue
+     float tempFet;         // °C
+     float tempMotor;       // °C
+     float current;         // A mesurés
+     float cadence;         // tr/min pédalier
+ };
+
+ struct SafetyConfig {
+     // Courbes de déclassement : facteur 1 jusqu'à "start", 0 à "limit" (linéaire entre les deux)
+     float fetDerateStartC, fetLimitC;
+     float motorDerateStartC, motorLimitC;
+
+     float maxCurrent;          // A, déclenchement immédiat au-delà (mesuré)
+     float stallCurrent;        // A
+     float stallCadence;        // tr/min
+     uint32_t stallMs;          // durée avant déclenchement du blocage
+     // Perte de liaison : il faut les deux, pour tenir à 100 ms comme à ~0.5 s de boucle (écran à 9600 bauds)
+     uint32_t telemetryTimeoutMs;   // âge minimal de la dernière trame valide
+     uint8_t telemetryMaxMissed;    // trames manquées d'affilée tolérées
+     float rampDownRate;        // A/s, retour à zéro contrôlé après un déclenchement
+     float tickSeconds;         // période supposée au premier tick ; ensuite mesurée entre deux evaluate()
+ };
+
+ SafetyConfig defaultSafetyConfig();
+
+ struct SafetyEvent {
+     uint32_t timestampMs;
+     uint8_t fault;     // SafetyFault
+     float value;       // grandeur qui a déclenché (°C, A, ms...)
+ };
+
+ class SafetySupervisor {
+ public:
+     static const uint8_t LOG_SIZE = 16;
+
+     explicit SafetySupervisor(const SafetyConfig& cfg = defaultSafetyConfig());
+
+     void configure(const SafetyConfig& cfg) { config = cfg; }
+
+     // À appeler une fois par tick, avant de commander le moteur
+     void evaluate(const SafetyInputs& in);
+
+     // Courant réellement autorisé pour cette consigne (déclassement, bornes, rampe de repli)
+     float limitCurrent(float requested);
+
+     // Point de départ du repli (ex : courant mesuré quand le VESC régulait lui-même la vitesse)
+     void resetOutput(float current) { lastOutput = current; }
+
+     bool isTripped() const { return faults != FAULT_NONE; }
+     uint8_t getFaults() const { return faults; }
+     float getDerating() const { return derating; }
+     float getCurrentLimit() const { return config.maxCurrent * derating; }  // borne hors déclenchement (A)
+
+     // Acquittement opérateur : ne réarme que si plus aucune condition n'est active
+     bool clearFaults(const SafetyInputs& in);
+
+     uint8_t getEventCount() const { return eventCount; }
+     const SafetyEvent& getEvent(uint8_t i) const;  // 0 = plus ancien conservé
+
+     static const char* faultName(uint8_t fault);
+
+ private:
+     static const uint8_t RULE_COUNT = 5;
+
+     SafetyConfig config;
+     uint8_t faults;            // défauts verrouillés
+     float derating;            // 0..1
+     float lastOutput;          // dernier courant autorisé (point de départ du repli)
+     uint32_t lastTelemetryMs;
+     uint32_t lastEvalMs;
+     float tickSeconds;         // durée mesurée du dernier tick (pas de la rampe de repli)
+     uint8_t missedFrames;      // ticks consécutifs sans trame valide
+     uint32_t stallSinceMs;
+     bool stallTiming;
+     bool started;
+
+     SafetyEvent events[LOG_SIZE];
+     uint8_t eventHead;
+     uint8_t eventCount;
+
+     uint8_t activeConditions(const SafetyInputs& in, float values[RULE_COUNT]) const;
+     void logEvent(uint32_t nowMs, uint8_t fault, float value);
+     static float derate(float temp, float start, float limit);
+ };
@@ -13,8 +13,8 @@
  #include <cstdint>
 
  #include "stm32f4xx_hal.h"
- #include "MotorController.hpp"
- class MotorController;
+ #include "ControlTypes.hpp"
+ #include "SessionAnalytics.hpp"
 
  /**
   * @brief Classe pour gérer la communication avec un écran Nextion via UART
@@ -24,40 +24,43 @@
  class ScreenDisplay {
  public:
 
-     ScreenDisplay(UART_HandleTypeDef* EcranUart);*
+     ScreenDisplay(UART_HandleTypeDef* EcranUart);
 
      // Affichage des valeurs dynamiques
-     void showCadence(float rpm);*
-     void showTorque(float torque);*
-     void showPower(float power);*
-     void showMode(const char* modeName);*
-     void showMode(ControlMode mode);*
-     void showGain(float LinearGain);*
-     void showDutyCycle(float duty);*
-     void showDirection(DirectionMode dir);*
-
-     void showCalibrationStatus(bool success);*
+     void showCadence(float rpm);
+     void showTorque(float torque);
+     void showPower(float power);
+     void showMode(const char* modeName);
+     void showMode(ControlMode mode);
+     void showGain(float LinearGain);
+     void showDutyCycle(float duty);
+     void showDirection(DirectionMode dir);
+
+     void showCalibrationStatus(bool success);
+     void showSessionSummary(const SessionSummary& summary);  // une ligne : durée, kJ, moyenne, NP, couple max
 
      // Affichage de messages statiques
-     void showError(const char* message);*
-     void showWelcome();* //utiliser dans le main *
+     void showError(const char* message);
+     void showWelcome(); //utiliser dans le main
      void clearScreen(); //utiliser dans le main
 
-     int32_t readInt32();*
-     float getUserCadence();*
-     float getUserPower();*
+     int32_t readInt32();
+     float getUserCadence();
+     float getUserPower();
      float getUserTorque();
-     ControlMode getMode();*
-     float getUserLinearGain();*
-     bool getStop();*
-     bool getCalibrateRequest();*
-     DirectionMode getDirection();*
+     ControlMode getMode();
+     float getUserLinearGain();
+     bool getStop();
+     bool getCalibrateRequest();
+     DirectionMode getDirection();
      float getRampRate();
+     bool lastReadOk() const { return readOk; }  // faux si la dernière lecture a expiré ou était invalide
 
-     void sendText(const char* component, const char* message);*
+     void sendText(const char* component, const char* message);
 
  private:
      UART_HandleTypeDef* ecran_uart;
+     bool readOk;
 
      // Méthodes internes d'envoi
      void sendCommand(const char* cmd);
@@ -0,0 +1,105 @@
+/*
+ * SessionAnalytics.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #pragma once
+
+ #include <cstdint>
+
+ /**
+  * @brief Bilan de séance calculé au fil de l'eau : travail, puissances moyennes, pics, zones.
+  *
+  * update() est appelé à chaque tick de commande avec la puissance, le couple et la cadence du
+  * tick ; il intègre sur la durée réelle du tick (la boucle n'est pas strictement périodique).
+  * Les moyennes glissantes 3 s et 30 s reposent sur des cases d'une seconde dans une file
+  * circulaire de 30 cases : chaque case close ajoute sa valeur aux sommes et retire celle qui
+  * sort de la fenêtre. Puissance normalisée = (moyenne de P30s^4)^(1/4), une fois la première
+  * fenêtre de 30 s remplie. Le temps par zone (puissance 3 s, cadence) est compté par case.
+  *
+  * Mémoire fixe (~250 octets), coût constant par tick : au plus trois cases closes par appel,
+  * un intervalle de plus de MAX_GAP_MS (télémétrie perdue, pause) n'est pas intégré.
+  * Puissances en valeur absolue : le travail concentrique et excentrique du cycliste s'ajoutent.
+  */
+
+ static const uint8_t ANALYTICS_POWER_ZONES = 6;     // limites : ANALYTICS_POWER_ZONES - 1 seuils
+ static const uint8_t ANALYTICS_CADENCE_ZONES = 6;
+
+ struct AnalyticsConfig {
+     float powerZoneLimits[ANALYTICS_POWER_ZONES - 1];      // W, croissants
+     float cadenceZoneLimits[ANALYTICS_CADENCE_ZONES - 1];  // tr/min, croissants
+     float movingCadence;                                   // tr/min : en dessous, le cycliste est arrêté
+ };
+
+ AnalyticsConfig defaultAnalyticsConfig();
+
+ // Instantané du bilan : affiché à l'écran et recopié dans chaque bloc du journal (64 octets)
+ struct SessionSummary {
+     uint32_t elapsedMs;          // temps intégré (hors trous de télémétrie)
+     uint32_t movingMs;           // dont cadence au-dessus de movingCadence
+     float energyJ;
+     float averagePower;          // W, énergie / temps intégré
+     float normalizedPower;       // W, 0 avant 30 s
+     float power3s;              // W, moyennes glissantes courantes
+     float power30s;
+     float peakPower3s;
+     float peakTorque;            // Nm, valeur absolue
+     float peakCadence;           // tr/min
+     uint16_t powerZoneS[ANALYTICS_POWER_ZONES];      // secondes par zone (puissance 3 s)
+     uint16_t cadenceZoneS[ANALYTICS_CADENCE_ZONES];  // secondes par zone de cadence
+ };
+
+ static_assert(sizeof(SessionSummary) == 64, "bilan de séance : 64 octets attendus");
+
+ class SessionAnalytics {
+ public:
+     explicit SessionAnalytics(const AnalyticsConfig& config = defaultAnalyticsConfig());
+
+     void reset();
+     void update(uint32_t nowMs, float power, float torque, float cadence);
+     void pause(uint32_t nowMs);  // tick sans télémétrie : l'intervalle jusqu'au prochain update() est ignoré
+
+     SessionSummary getSummary() const;
+     const AnalyticsConfig& getConfig() const { return config; }
+
+ private:
+     static const uint32_t BIN_MS = 1000;
+     static const uint32_t MAX_GAP_MS = 2000;
+     static const uint8_t SHORT_BINS = 3;
+     static const uint8_t LONG_BINS = 30;
+
+     AnalyticsConfig config;
+
+     bool started;
+     uint32_t lastMs;
+     uint32_t elapsedMs;
+     uint32_t movingMs;
+     float energyJ;
+     float peakTorque;
+     float peakCadence;
+     float peakPower3s;
+
+     // Case d'une seconde en cours
+     uint32_t binMs;
+     float binEnergy;        // J
+     float binCadence;       // tr/min × ms
+
+     // Fenêtres glissantes sur les cases closes
+     float bins[LONG_BINS];  // W moyens par case
+     uint8_t binIndex;       // prochaine case écrite
+     uint32_t binsClosed;
+     float sumShort;
+     float sumLong;
+
+     double np4Sum;          // somme de P30s^4 (double : ~1e14 après quelques heures)
+     uint32_t np4Count;
+
+     uint32_t powerZoneMs[ANALYTICS_POWER_ZONES];
+     uint32_t cadenceZoneMs[ANALYTICS_CADENCE_ZONES];
+
+     void accumulate(uint32_t dt, float power, float cadence);
+     void closeBin();
+     float average(float sum, uint8_t window) const;
+ };
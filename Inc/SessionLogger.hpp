@@ -0,0 +1,172 @@
+/*
+ * SessionLogger.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #pragma once
+
+ #include <cstdint>
+
+ #include "TelemetryRing.hpp"
+ #include "TelemetryCodec.hpp"
+ #include "SessionAnalytics.hpp"
+
+ /**
+  * @brief Journal de séance sur clé USB : la télémétrie de TelemetryRing écrite par blocs de 4 Ko.
+  *
+  * Chemin d'un échantillon : push() dans la file (boucle de commande, ~ns) → service() le recopie
+  * dans le bloc en cours de remplissage → un bloc plein part sur la clé pendant que l'autre se
+  * remplit (double tampon). service() est appelé hors du tick de commande, écrit au plus un bloc
+  * par appel, et ne fait rien tant que la clé est absente : la commande n'attend jamais le stockage.
+  *
+  * Format du fichier : une suite de blocs de 4 Ko autonomes (en-tête + échantillons, CRC32).
+  * En codage delta (défaut), chaque bloc commence par une image clé : ~330 échantillons par bloc
+  * au lieu de 127, et tout bloc se décode sans ses voisins.
+  * Lisible en flux, ré-ouvert en ajout à chaque séance ; un bloc tronqué (clé arrachée) est
+  * simplement ignoré à la lecture, le suivant repart sur une frontière de bloc.
+  * Avec attachAnalytics(), chaque bloc se termine par le bilan de séance au moment de sa
+  * fermeture (summaryBytes octets en fin de bloc) : le dernier bloc lisible donne le bilan final.
+  */
+
+ enum LogEncoding : uint8_t {
+     LOG_ENCODING_RAW = 0,   // TelemetrySample tels quels
+     LOG_ENCODING_DELTA = 1  // TelemetryEncoder : quantifié, delta, varint (image clé en tête de bloc)
+ };
+
+ struct LogBlockHeader {
+     uint32_t magic;          // LOG_BLOCK_MAGIC
+     uint8_t version;
+     uint8_t encoding;        // LogEncoding
+     uint16_t recordCount;    // échantillons dans ce bloc
+     uint16_t payloadBytes;   // octets utiles après l'en-tête
+     uint16_t summaryBytes;   // SessionSummary dans les derniers octets du bloc (0 : aucun)
+     uint32_t sessionId;
+     uint32_t blockIndex;     // rang du bloc dans la séance
+     uint32_t lostSamples;    // échantillons perdus depuis le bloc précédent (file pleine)
+     uint32_t firstTickMs;
+     uint32_t crc;            // CRC32 du bloc entier, ce champ à 0
+ };
+
+ static_assert(sizeof(LogBlockHeader) == 32, "en-tête de bloc : 32 octets attendus");
+
+ static const uint32_t LOG_BLOCK_MAGIC = 0x4C475245u;  // "ERGL"
+ static const uint8_t LOG_BLOCK_VERSION = 1;
+ static const uint32_t LOG_BLOCK_SIZE = 4096;         // multiple du secteur FAT (512 o)
+ static const uint32_t LOG_BLOCK_SAMPLES = (LOG_BLOCK_SIZE - sizeof(LogBlockHeader)) / sizeof(TelemetrySample);  // sans bilan
+
+ // Vérifie magie, version, tailles et CRC d'un bloc lu
+ bool logBlockIsValid(const uint8_t* block);
+
+ /**
+  * @brief Fichier de journal ouvert en ajout sur un support amovible.
+  */
+ class LogStorage {
+ public:
+     virtual ~LogStorage() {}
+
+     virtual bool isPresent() = 0;                              // support branché et prêt
+     virtual bool open() = 0;                                   // ouverture en ajout (création si absent)
+     virtual uint32_t size() = 0;                               // taille actuelle du fichier
+     virtual bool write(const uint8_t* data, uint32_t len) = 0; // tout ou rien, données sur le support au retour
+     virtual void close() = 0;
+ };
+
+ struct SessionLoggerStats {
+     uint32_t blocksWritten;
+     uint32_t samplesLogged;
+     uint32_t samplesLost;     // file pleine : clé absente ou trop lente
+     uint32_t writeErrors;
+     uint32_t reconnects;      // ré-ouvertures après retrait de la clé
+ };
+
+ class SessionLogger {
+ public:
+     SessionLogger(LogStorage& storage, TelemetryBuffer& telemetry, LogEncoding encoding = LOG_ENCODING_DELTA);
+
+     void start(uint32_t sessionId);
+
+     // Bilan recopié en fin de chaque bloc (nullptr : aucun, toute la place pour les échantillons)
+     void attachAnalytics(const SessionAnalytics* source) { analytics = source; }
+
+     // Hors tick de commande (boucle principale, entre deux ticks) : vide la file, écrit au plus un bloc
+     void service(uint32_t nowMs);
+
+     // Termine le bloc en cours (partiel) et l'écrit : fin de séance
+     bool flush();
+
+     bool isStorageReady() const { return opened; }
+     const SessionLoggerStats& getStats() const { return stats; }
+
+ private:
+     static const uint32_t RETRY_MS = 1000;  // nouvelle tentative d'ouverture après retrait
+
+     LogStorage& storage;
+     TelemetryBuffer& ring;
+
+     // Deux blocs alignés : l'un se remplit pendant que l'autre attend son écriture
+     alignas(4) uint8_t blocks[2][LOG_BLOCK_SIZE];
+     uint8_t filling;         // indice du bloc en cours de remplissage
+     bool pending;            // l'autre bloc est plein, en attente d'écriture
+     uint16_t fillCount;      // échantillons dans le bloc en cours
+     uint16_t fillBytes;      // octets utiles après l'en-tête
+     LogEncoding encoding;
+     TelemetryEncoder encoder;
+     uint32_t firstTickMs;
+
+     uint32_t sessionId;
+     uint32_t blockIndex;
+     uint32_t lastOverruns;
+     bool opened;
+     bool started;
+     uint32_t lastAttemptMs;
+     SessionLoggerStats stats;
+     const SessionAnalytics* analytics;
+
+     uint32_t payloadCapacity() const;
+     bool openStorage();
+     void drainRing();
+     void drainRaw();
+     void drainDelta();
+     void sealBlock();
+     bool writePending();
+ };
+
+ #ifndef ERGO_HOST
+ // Clé USB via la pile USB Host MSC + FatFs générées par CubeMX (MX_USB_HOST_Init / MX_FATFS_Init)
+ class UsbLogStorage : public LogStorage {
+ public:
+     bool isPresent() override;
+     bool open() override;
+     uint32_t size() override;
+     bool write(const uint8_t* data, uint32_t len) override;
+     void close() override;
+
+ private:
+     bool mounted = false;
+     bool fileOpen = false;
+ };
+ #else
+ #include <cstdio>
+
+ // Implémentation PC : fichier ordinaire ; setPresent(false) simule le retrait de la clé
+ class FileLogStorage : public LogStorage {
+ public:
+     explicit FileLogStorage(const char* path);
+     ~FileLogStorage() override;
+
+     void setPresent(bool value) { present = value; }
+
+     bool isPresent() override { return present; }
+     bool open() override;
+     uint32_t size() override;
+     bool write(const uint8_t* data, uint32_t len) override;
+     void close() override;
+
+ private:
+     const char* path;
+     FILE* file;
+     bool present;
+ };
+ #endif
@@ -0,0 +1,156 @@
+/*
+ * SettingsStore.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #pragma once
+
+ #include <cstdint>
+ #include <cstring>
+
+ /**
+  * @brief Stockage clé/valeur persistant (EEPROM émulée) pour Kt, rampe, gains, filtres et dernier mode.
+  *
+  * Deux secteurs flash utilisés en alternance :
+  *  - chaque écriture ajoute un enregistrement de 16 octets à la suite (jamais de réécriture en place),
+  *  - chaque enregistrement est protégé par un CRC32 (une coupure pendant l'écriture est ignorée au montage),
+  *  - quand le secteur actif est presque plein, on recopie les dernières valeurs dans l'autre secteur
+  *    (compactage) : chaque secteur n'est effacé qu'une fois par remplissage complet → usure répartie.
+  */
+
+ enum class SettingKey : uint16_t {
+     TORQUE_CONSTANT = 1,   // Nm/A, issu de la calibration
+     CALIBRATION_R2,        // qualité de la dernière calibration
+     RAMP_RATE,             // A/s
+     LINEAR_GAIN,
+     CONTROL_MODE,
+     DIRECTION,
+     POLE_PAIRS,
+     REDUCTION_RATIO,
+     CADENCE_ALPHA,         // tracker alpha-beta de la cadence
+     CADENCE_BETA,
+     CURRENT_CUTOFF_HZ,     // biquad du courant
+     SESSION_COUNT,         // numéro de la dernière séance journalisée (SessionLogger)
+     INERTIA,               // kg·m² au pédalier, identifiée hors ligne (ERGO.PAR)
+     VISCOUS_FRICTION,      // Nm·s/rad
+     COULOMB_FRICTION,      // Nm
+     COUNT                  // nombre de clés (doit rester en dernier)
+ };
+
+ /**
+  * @brief Accès bas niveau à deux secteurs "flash" (0 et 1).
+  * Sémantique NOR : l'effacement met tout à 0xFF, la programmation ne peut que passer des bits à 0.
+  */
+ class SettingsStorage {
+ public:
+     virtual ~SettingsStorage() {}
+
+     virtual uint32_t sectorSize() const = 0;
+     virtual bool eraseSector(uint8_t sector) = 0;
+     virtual bool program(uint8_t sector, uint32_t offset, const uint8_t* data, uint32_t len) = 0;  // len multiple de 4
+     virtual bool read(uint8_t sector, uint32_t offset, uint8_t* data, uint32_t len) = 0;
+ };
+
+ class SettingsStore {
+ public:
+     explicit SettingsStore(SettingsStorage& storage);
+
+     // Lit les deux secteurs et reconstruit le cache RAM. Formate si aucun secteur n'est valide.
+     bool mount();
+
+     bool has(SettingKey key) const;
+     float getFloat(SettingKey key, float defaultValue) const;
+     int32_t getInt(SettingKey key, int32_t defaultValue) const;
+
+     // N'écrit rien si la valeur est inchangée (économise la flash)
+     bool setFloat(SettingKey key, float value);
+     bool setInt(SettingKey key, int32_t value);
+
+     // Compactage différé : set() écrit alors dans la réserve au lieu d'effacer un secteur (1 à 2 s
+     // sur la cible) ; le propriétaire appelle compact() quand un arrêt est sans danger.
+     // Réserve épuisée avant le compactage → set() renvoie faux, la valeur reste à sauvegarder.
+     void setDeferCompaction(bool defer) { deferCompaction = defer; }
+     bool compactionPending() const;
+     bool compact();
+
+     uint32_t getGeneration() const { return generation; }
+     uint32_t getUsedBytes() const { return writeOffset; }
+
+     static uint32_t crc32(const uint8_t* data, uint32_t len, uint32_t crc = 0xFFFFFFFFu);
+
+ private:
+     static const uint32_t HEADER_SIZE = 16;
+     static const uint32_t RECORD_SIZE = 16;
+     static const uint32_t SECTOR_MAGIC = 0x53475245u;  // "ERGS"
+     static const uint16_t KEY_ERASED = 0xFFFF;
+     static const uint8_t KEY_COUNT = static_cast<uint8_t>(SettingKey::COUNT);
+
+     struct Record {
+         uint16_t key;
+         uint16_t reserved;
+         uint32_t value;
+         uint32_t sequence;
+         uint32_t crc;        // CRC32 des 12 premiers octets
+     };
+
+     struct SectorHeader {
+         uint32_t magic;
+         uint32_t generation;  // le secteur valide de génération la plus haute est le secteur actif
+         uint32_t reserved;
+         uint32_t crc;
+     };
+
+     SettingsStorage& storage;
+     uint8_t activeSector;
+     uint32_t generation;
+     uint32_t writeOffset;   // prochain emplacement libre dans le secteur actif
+     uint32_t sequence;
+     bool deferCompaction;
+
+     uint32_t values[KEY_COUNT];
+     bool present[KEY_COUNT];
+
+     bool set(SettingKey key, uint32_t raw);
+     bool readHeader(uint8_t sector, SectorHeader& header);
+     bool writeHeader(uint8_t sector, uint32_t gen);
+     bool appendRecord(uint16_t key, uint32_t raw);
+     void scanSector(uint8_t sector);
+     bool format();
+ };
+
+ // Secteurs 10 et 11 du STM32F407 (128 Ko chacun), à exclure de la zone programme dans le linker script
+ class Stm32FlashStorage : public SettingsStorage {
+ public:
+     uint32_t sectorSize() const override { return 128u * 1024u; }
+     bool eraseSector(uint8_t sector) override;
+     bool program(uint8_t sector, uint32_t offset, const uint8_t* data, uint32_t len) override;
+     bool read(uint8_t sector, uint32_t offset, uint8_t* data, uint32_t len) override;
+
+ private:
+     static uint32_t baseAddress(uint8_t sector);
+ };
+
+ #ifdef ERGO_HOST
+ #include <cstdio>
+
+ // Implémentation PC : fichier de 2 × sectorSize octets, mêmes règles qu'une NOR (tests, simulation)
+ class FileFlashStorage : public SettingsStorage {
+ public:
+     FileFlashStorage(const char* path, uint32_t sectorSize = 16u * 1024u);
+     ~FileFlashStorage() override;
+
+     uint32_t sectorSize() const override { return size; }
+     bool eraseSector(uint8_t sector) override;
+     bool program(uint8_t sector, uint32_t offset, const uint8_t* data, uint32_t len) override;
+     bool read(uint8_t sector, uint32_t offset, uint8_t* data, uint32_t len) override;
+
+     uint32_t getEraseCount(uint8_t sector) const { return sector < 2 ? eraseCount[sector] : 0; }
+
+ private:
+     FILE* file;
+     uint32_t size;
+     uint32_t eraseCount[2];
+ };
+ #endif
@@ -0,0 +1,134 @@
+/*
+ * SignalConditioning.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #pragma once
+
+ #include <cstdint>
+ #include <cmath>
+
+ /**
+  * @brief Conditionnement de la télémétrie VESC avant la loi de commande et l'affichage.
+  *
+  * Chaîne par canal : conversion d'unités -> rejet de pics (médiane 3) -> filtre
+  * (biquad passe-bas ou tracker alpha-beta). Chaque étage est incrémental, O(1)
+  * par échantillon, sans allocation.
+  */
+
+ enum class FilterType {
+     NONE,
+     BIQUAD_LOWPASS,
+     ALPHA_BETA
+ };
+
+ // Biquad passe-bas (Butterworth, forme directe II transposée)
+ class BiquadLowPass {
+ public:
+     BiquadLowPass();
+
+     void configure(float cutoffHz, float sampleHz, float q = 0.7071f);
+     void reset(float value);
+     float process(float x);
+
+ private:
+     float b0, b1, b2, a1, a2;
+     float z1, z2;
+ };
+
+ // Rejet des pics isolés : médiane des 3 derniers échantillons
+ class MedianFilter3 {
+ public:
+     MedianFilter3();
+
+     void reset(float value);
+     float process(float x);
+
+ private:
+     float window[3];
+     uint8_t index;
+ };
+
+ // Tracker alpha-beta : estime la valeur et sa dérivée, faible retard sur les rampes
+ class AlphaBetaTracker {
+ public:
+     AlphaBetaTracker();
+
+     void configure(float alpha, float beta, float dt);
+     void reset(float value);
+     float process(float x);
+     float getRate() const { return rate; }
+
+ private:
+     float alpha, beta, dt;
+     float estimate;
+     float rate;
+ };
+
+ struct ChannelConfig {
+     bool medianEnabled;
+     FilterType filter;
+     float cutoffHz;      // BIQUAD_LOWPASS
+     float alpha;         // ALPHA_BETA
+     float beta;          // ALPHA_BETA
+ };
+
+ class SignalChannel {
+ public:
+     SignalChannel();
+
+     void configure(const ChannelConfig& cfg, float sampleHz);
+     float process(float x);
+     float getValue() const { return value; }
+     float getRate() const;
+
+ private:
+     ChannelConfig config;
+     MedianFilter3 median;
+     BiquadLowPass lowpass;
+     AlphaBetaTracker tracker;
+     float value;
+     float previous;
+     float sampleHz;
+     bool primed;  // premier échantillon : on initialise les états pour éviter le transitoire
+ };
+
+ struct ConditioningConfig {
+     float polePairs;       // paires de pôles du moteur (ERPM = RPM moteur × paires de pôles)
+     float reductionRatio;  // tours moteur par tour de pédalier
+     float sampleHz;        // fréquence d'appel de update()
+     ChannelConfig cadence;
+     ChannelConfig current;
+     ChannelConfig duty;
+ };
+
+ // Valeurs par défaut : réducteur de 1.95 A → 0.39 Nm → 15 Nm (≈ 38.5:1), boucle à 10 Hz
+ ConditioningConfig defaultConditioningConfig();
+
+ class SignalConditioner {
+ public:
+     explicit SignalConditioner(const ConditioningConfig& cfg = defaultConditioningConfig());
+
+     void configure(const ConditioningConfig& cfg);
+     const ConditioningConfig& getConfig() const { return config; }
+
+     // Un échantillon brut VESC (ERPM, A, duty) par tick de commande
+     void update(float erpm, float current, float duty);
+
+     float getCadence() const { return cadence.getValue(); }    // tr/min au pédalier
+     float getCurrent() const { return current.getValue(); }    // A
+     float getDutyCycle() const { return duty.getValue(); }     // -1.0 .. 1.0
+     float getCadenceRate() const { return cadence.getRate(); } // tr/min/s
+
+     float erpmToCadence(float erpm) const;
+     float cadenceToErpm(float cadenceRpm) const;
+
+ private:
+     ConditioningConfig config;
+     float erpmPerCadence;  // précalculé : paires de pôles × rapport de réduction
+     SignalChannel cadence;
+     SignalChannel current;
+     SignalChannel duty;
+ };
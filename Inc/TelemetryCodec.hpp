@@ -0,0 +1,108 @@
+/*
+ * TelemetryCodec.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #pragma once
+
+ #include <cstdint>
+
+ #include "TelemetryRing.hpp"
+
+ /**
+  * @brief Compression des échantillons de télémétrie : quantification + delta + varint zigzag.
+  *
+  * Chaque voie est quantifiée à sa résolution utile (0,01 tr/min, 1 mA...), puis codée comme
+  * l'écart à l'échantillon précédent : entre deux ticks ces écarts tiennent presque toujours sur
+  * 1 ou 2 octets (contre 32 octets bruts). Le premier échantillon après reset() est une image clé
+  * (écart à zéro) : dans le journal, chaque bloc de 4 Ko commence par une image clé et se décode seul.
+  */
+
+ enum TelemetryChannel : uint8_t {
+     TELEMETRY_CH_TICK,
+     TELEMETRY_CH_SETPOINT,
+     TELEMETRY_CH_CADENCE,
+     TELEMETRY_CH_CURRENT,
+     TELEMETRY_CH_APPLIED_CURRENT,
+     TELEMETRY_CH_DUTY,
+     TELEMETRY_CH_VOLTAGE,
+     TELEMETRY_CH_MODE,
+     TELEMETRY_CH_FLAGS,
+     TELEMETRY_CH_FAULTS,
+     TELEMETRY_CHANNELS
+ };
+
+ // Pas de quantification des voies flottantes (unité de la voie par pas), 1 pour les voies entières
+ extern const float telemetryResolution[TELEMETRY_CHANNELS];
+
+ // Pire cas d'un échantillon codé : tick 5 octets, 6 flottants × 5, 3 octets × 2
+ static const uint32_t TELEMETRY_ENCODED_MAX = 41;
+
+ struct TelemetryQuantized {
+     int32_t q[TELEMETRY_CHANNELS];
+ };
+
+ void telemetryQuantize(const TelemetrySample& sample, TelemetryQuantized& out);
+ void telemetryDequantize(const TelemetryQuantized& in, TelemetrySample& out);
+
+ class TelemetryEncoder {
+ public:
+     TelemetryEncoder() { reset(); }
+
+     void reset();  // prochain échantillon = image clé
+
+     // Écrit au plus TELEMETRY_ENCODED_MAX octets dans out, renvoie le nombre écrit
+     uint32_t encode(const TelemetrySample& sample, uint8_t* out);
+
+ private:
+     TelemetryQuantized previous;
+ };
+
+ class TelemetryDecoder {
+ public:
+     TelemetryDecoder() { reset(); }
+
+     void reset();
+
+     // Décode un échantillon à partir de in ; renvoie la position suivante, nullptr si tronqué/invalide
+     const uint8_t* decode(const uint8_t* in, const uint8_t* end, TelemetryQuantized& out);
+
+ private:
+     TelemetryQuantized previous;
+ };
+
+ // --- Varints (LEB128) et zigzag, partagés avec le décodeur PC ---
+
+ inline uint32_t zigzagEncode(int32_t v) {
+     return (static_cast<uint32_t>(v) << 1) ^ static_cast<uint32_t>(v >> 31);
+ }
+
+ inline int32_t zigzagDecode(uint32_t v) {
+     return static_cast<int32_t>(v >> 1) ^ -static_cast<int32_t>(v & 1u);
+ }
+
+ inline uint8_t* varintEncode(uint32_t v, uint8_t* out) {
+     while (v >= 0x80u) {
+         *out++ = static_cast<uint8_t>(v | 0x80u);
+         v >>= 7;
+     }
+     *out++ = static_cast<uint8_t>(v);
+     return out;
+ }
+
+ inline const uint8_t* varintDecode(const uint8_t* in, const uint8_t* end, uint32_t& v) {
+     // Cas courant en tête : un seul octet
+     if (in < end && *in < 0x80u) {
+         v = *in;
+         return in + 1;
+     }
+     v = 0;
+     for (uint32_t shift = 0; shift < 35 && in < end; shift += 7) {
+         uint8_t b = *in++;
+         v |= static_cast<uint32_t>(b & 0x7Fu) << shift;
+         if (!(b & 0x80u)) return in;
+     }
+     return nullptr;
+ }
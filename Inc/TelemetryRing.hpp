@@ -0,0 +1,98 @@
+/*
+ * TelemetryRing.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #pragma once
+
+ #include <atomic>
+ #include <cstdint>
+
+ /**
+  * @brief Télémétrie plein débit en RAM : un échantillon binaire de taille fixe par tick de commande.
+  *
+  * File circulaire à un seul producteur (la boucle de commande) et un seul consommateur
+  * (écrivain USB, liaison série, banc PC). Aucun verrou, aucune allocation : push() est une
+  * copie de 32 octets et deux accès atomiques, quel que soit l'état du lecteur.
+  * File pleine : l'échantillon le plus récent est abandonné et compté (getOverruns()),
+  * la boucle de commande n'attend jamais.
+  */
+
+ #ifndef TELEMETRY_RING_SIZE
+ #define TELEMETRY_RING_SIZE 512   // 16 Ko ; 51 s à 10 Hz
+ #endif
+
+ enum TelemetryFlag : uint8_t {
+     TELEMETRY_VALID       = 1 << 0,   // trame VESC valide ce tick
+     TELEMETRY_TRIPPED     = 1 << 1,   // superviseur de sécurité déclenché
+     TELEMETRY_CALIBRATING = 1 << 2,
+     TELEMETRY_REVERSE     = 1 << 3,
+     TELEMETRY_RESPONSE_TEST = 1 << 4  // programme de ResponseTest en cours (consigne imposée)
+ };
+
+ struct TelemetrySample {
+     uint32_t tickMs;        // HAL_GetTick()
+     float setpoint;         // consigne du mode actif (tr/min, Nm, W ou gain)
+     float cadence;          // tr/min pédalier, filtrée
+     float current;          // A mesurés, filtrés
+     float appliedCurrent;   // A commandés après le superviseur
+     float dutyCycle;        // -1.0 .. 1.0
+     float inputVoltage;     // V
+     uint8_t mode;           // ControlMode
+     uint8_t flags;          // TelemetryFlag
+     uint8_t faults;         // SafetyFault
+     uint8_t reserved;
+ };
+
+ static_assert(sizeof(TelemetrySample) == 32, "échantillon de télémétrie : 32 octets attendus");
+
+ template <uint32_t Size>
+ class TelemetryRing {
+     static_assert(Size >= 2 && (Size & (Size - 1)) == 0, "taille de file : puissance de 2");
+
+ public:
+     TelemetryRing() : head(0), tail(0), overruns(0), pushed(0) {}
+
+     // Producteur (boucle de commande) uniquement
+     bool push(const TelemetrySample& sample) {
+         uint32_t h = head.load(std::memory_order_relaxed);
+         if (h - tail.load(std::memory_order_acquire) >= Size) {
+             overruns.store(overruns.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+             return false;
+         }
+         samples[h & (Size - 1)] = sample;
+         head.store(h + 1, std::memory_order_release);  // publie l'échantillon après sa copie
+         pushed.store(pushed.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+         return true;
+     }
+
+     // Consommateur uniquement : vide jusqu'à maxCount échantillons, renvoie le nombre copié
+     uint32_t drain(TelemetrySample* out, uint32_t maxCount) {
+         uint32_t t = tail.load(std::memory_order_relaxed);
+         uint32_t available = head.load(std::memory_order_acquire) - t;
+         uint32_t n = (available < maxCount) ? available : maxCount;
+         for (uint32_t i = 0; i < n; i++) out[i] = samples[(t + i) & (Size - 1)];
+         tail.store(t + n, std::memory_order_release);  // libère les cases après leur copie
+         return n;
+     }
+
+     bool pop(TelemetrySample& out) { return drain(&out, 1) == 1; }
+
+     uint32_t size() const { return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire); }
+     static constexpr uint32_t capacity() { return Size; }
+     uint32_t getOverruns() const { return overruns.load(std::memory_order_relaxed); }
+     uint32_t getPushed() const { return pushed.load(std::memory_order_relaxed); }
+
+ private:
+     TelemetrySample samples[Size];
+     // Index libres (jamais ramenés modulo Size) : plein/vide se distinguent sans case perdue
+     std::atomic<uint32_t> head;      // écrit par le producteur
+     std::atomic<uint32_t> tail;      // écrit par le consommateur
+     std::atomic<uint32_t> overruns;  // échantillons abandonnés, file pleine
+     std::atomic<uint32_t> pushed;
+ };
+
+ // File du firmware (un seul exemplaire statique, voir mainV1.cpp)
+ typedef TelemetryRing<TELEMETRY_RING_SIZE> TelemetryBuffer;
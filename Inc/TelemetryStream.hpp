@@ -0,0 +1,238 @@
+/*
+ * TelemetryStream.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #pragma once
+
+ #include <cstdint>
+
+ #include "stm32f4xx_hal.h"
+ #include "TelemetryRing.hpp"
+ #include "TelemetryCodec.hpp"
+ #include "WatchdogMonitor.hpp"
+
+ /**
+  * @brief Télémétrie en direct sur une UART libre (USART1, PA9/PA10) vers un PC.
+  *
+  * Trame = COBS( type | corps | CRC-16/XMODEM ) puis 0x00. Le 0x00 n'apparaît jamais dans une
+  * trame codée : le PC se recale sur le délimiteur suivant après un octet perdu, sans état.
+  *
+  *   cible → PC   SAMPLE  : seq u16, perdus u16, masque u16, puis les voies du masque dans l'ordre
+  *                          de TelemetryChannel (tick u32, flottants f32, mode/drapeaux/défauts u8)
+  *                STATUS  : réponse à une commande (voir TelemetryStreamStatus)
+  *                PROFILE : statistiques d'une zone de LoopProfiler (voir TelemetryProfileFrame)
+  *                WATCHDOG : marge de l'IWDG et post-mortem du dernier reset (voir TelemetryWatchdogFrame)
+  *   PC → cible   SET_DECIMATION u16 (0 = pause), SUBSCRIBE u16 (masque de voies), GET_STATUS,
+  *                GET_PROFILE u8 (1 = remise à zéro après lecture), GET_WATCHDOG
+  *
+  * Les échantillons sont envoyés en valeurs absolues (pas en delta) : une trame perdue ne
+  * corrompt pas les suivantes. Le numéro de séquence et le champ "perdus" rendent les pertes
+  * visibles côté PC. Entiers petit-boutistes, comme la mémoire du Cortex-M4.
+  */
+
+ enum TelemetryFrameType : uint8_t {
+     TELEMETRY_FRAME_SAMPLE = 0x01,
+     TELEMETRY_FRAME_STATUS = 0x02,
+     TELEMETRY_FRAME_PROFILE = 0x03,
+     TELEMETRY_FRAME_WATCHDOG = 0x04,
+     TELEMETRY_CMD_SET_DECIMATION = 0x10,
+     TELEMETRY_CMD_SUBSCRIBE = 0x11,
+     TELEMETRY_CMD_GET_STATUS = 0x12,
+     TELEMETRY_CMD_GET_PROFILE = 0x13,
+     TELEMETRY_CMD_GET_WATCHDOG = 0x14
+ };
+
+ enum TelemetryCommandResult : uint8_t {
+     TELEMETRY_CMD_OK = 0,
+     TELEMETRY_CMD_BAD_LENGTH = 1,
+     TELEMETRY_CMD_BAD_VALUE = 2,
+     TELEMETRY_CMD_UNKNOWN = 3,
+     TELEMETRY_CMD_UNAVAILABLE = 4   // fonction absente de ce firmware (ex. compilé sans ERGO_PROFILE)
+ };
+
+ static const uint16_t TELEMETRY_STREAM_ALL_CHANNELS = (1u << TELEMETRY_CHANNELS) - 1u;
+ static const uint16_t TELEMETRY_STREAM_MAX_DECIMATION = 1000;
+ static const uint32_t TELEMETRY_FRAME_MAX = 48;    // trame décodée la plus longue (SAMPLE, toutes voies : 40)
+ static const uint32_t TELEMETRY_FRAME_ENCODED_MAX = TELEMETRY_FRAME_MAX + TELEMETRY_FRAME_MAX / 254 + 2;
+
+ struct TelemetryStreamStatus {
+     uint8_t command;          // type de la commande traitée (0 si envoi spontané)
+     uint8_t result;           // TelemetryCommandResult
+     uint16_t decimation;
+     uint16_t channels;
+     uint32_t framesSent;
+     uint32_t framesDropped;   // liaison saturée : débit demandé > débit de l'UART
+     uint32_t rxErrors;        // trames de commande invalides (CRC, longueur)
+     uint32_t linkErrors;      // erreurs matérielles de l'UART (overrun, parité, trame, bruit)
+ };
+
+ static const uint8_t TELEMETRY_PROFILE_BINS = 8;
+
+ // Une zone par trame ; l'histogramme est la fenêtre de 8 classes log2 qui commence à la première non vide
+ struct TelemetryProfileFrame {
+     uint8_t zone;             // ProfileZone
+     uint16_t unitsPerUs;      // cycles/µs sur cible
+     uint32_t count;
+     uint32_t min;
+     uint32_t max;
+     uint32_t mean;
+     uint8_t firstBin;         // bins[i] compte les durées dans [2^(firstBin+i), 2^(firstBin+i+1))
+     uint16_t bins[TELEMETRY_PROFILE_BINS];  // saturés à 65535
+ };
+
+ // Statistiques du WatchdogMonitor et enregistrement relu au démarrage
+ struct TelemetryWatchdogFrame {
+     WatchdogStats stats;
+     uint8_t watchdogReset;    // 1 : le dernier démarrage fait suite à une expiration de l'IWDG
+     WatchdogPostMortem previous;  // magic = 0 : aucun enregistrement valide
+ };
+
+ // --- Trames, partagées avec le récepteur PC ---
+
+ uint16_t telemetryFrameCrc(const uint8_t* data, uint32_t len);
+
+ // Code len octets en COBS dans out (len + len/254 + 1 octets), sans le délimiteur final
+ uint32_t cobsEncode(const uint8_t* in, uint32_t len, uint8_t* out);
+
+ // Décode une trame COBS sans son délimiteur ; renvoie la longueur décodée, 0 si malformée
+ uint32_t cobsDecode(const uint8_t* in, uint32_t len, uint8_t* out, uint32_t outSize);
+
+ // Trame complète (type, corps, CRC, COBS, 0x00) ; renvoie sa longueur, 0 si trop longue
+ uint32_t telemetryFrameBuild(uint8_t type, const uint8_t* body, uint32_t bodyLen, uint8_t* out);
+
+ // Corps d'une trame SAMPLE ; renvoie sa longueur
+ uint32_t telemetrySampleBody(const TelemetrySample& sample, uint16_t channels, uint16_t seq, uint16_t lost, uint8_t* out);
+
+ // Relit un corps SAMPLE : les voies absentes du masque sont laissées à 0
+ bool telemetrySampleParse(const uint8_t* body, uint32_t len, TelemetrySample& sample,
+                           uint16_t& channels, uint16_t& seq, uint16_t& lost);
+
+ uint32_t telemetryStatusBody(const TelemetryStreamStatus& status, uint8_t* out);
+ bool telemetryStatusParse(const uint8_t* body, uint32_t len, TelemetryStreamStatus& status);
+
+ uint32_t telemetryProfileBody(const TelemetryProfileFrame& profile, uint8_t* out);
+ bool telemetryProfileParse(const uint8_t* body, uint32_t len, TelemetryProfileFrame& profile);
+
+ uint32_t telemetryWatchdogBody(const TelemetryWatchdogFrame& watchdog, uint8_t* out);
+ bool telemetryWatchdogParse(const uint8_t* body, uint32_t len, TelemetryWatchdogFrame& watchdog);
+
+ /**
+  * @brief Découpe un flux d'octets en trames : COBS décodé, CRC vérifié, type en tête.
+  */
+ class TelemetryFrameReader {
+ public:
+     TelemetryFrameReader() : length(0), frameLength(0), overflow(false), errors(0) {}
+
+     // Vrai quand b termine une trame valide, lisible par frame()/frameLength()
+     bool push(uint8_t b);
+
+     const uint8_t* frame() const { return decoded; }       // type puis corps (CRC retiré)
+     uint32_t getFrameLength() const { return frameLength; }
+     uint32_t getErrors() const { return errors; }
+
+ private:
+     uint8_t raw[TELEMETRY_FRAME_ENCODED_MAX];
+     uint8_t decoded[TELEMETRY_FRAME_MAX];
+     uint32_t length;
+     uint32_t frameLength;
+     bool overflow;
+     uint32_t errors;
+ };
+
+ /**
+  * @brief Liaison série non bloquante : write() lance l'envoi et rend la main.
+  */
+ class TelemetryLink {
+ public:
+     virtual ~TelemetryLink() {}
+
+     virtual bool isTxReady() = 0;                                  // envoi précédent terminé
+     virtual bool write(const uint8_t* data, uint32_t len) = 0;     // data reste valide jusqu'à isTxReady()
+     virtual uint32_t read(uint8_t* data, uint32_t maxLen) = 0;     // octets reçus depuis le dernier appel
+     virtual uint32_t getErrors() const { return 0; }               // erreurs matérielles depuis le démarrage
+ };
+
+ /**
+  * @brief Émetteur côté cible : vide sa propre TelemetryBuffer, décime, répond aux commandes.
+  *
+  * service() est appelé hors du tick de commande, comme SessionLogger::service(). Les trames
+  * s'accumulent dans un tampon pendant que l'autre part sur l'UART (double tampon) ; si la
+  * liaison ne suit pas, les trames en trop sont comptées et annoncées dans la trame suivante.
+  */
+ class TelemetryStream {
+ public:
+     TelemetryStream(TelemetryLink& link, TelemetryBuffer& telemetry);
+
+     void configure(uint16_t decimation, uint16_t channels);
+     void attachWatchdog(const WatchdogMonitor* monitor) { watchdog = monitor; }  // GET_WATCHDOG
+     void service();
+
+     uint16_t getDecimation() const { return decimation; }
+     uint16_t getChannels() const { return channels; }
+     TelemetryStreamStatus getStatus(uint8_t command = 0, uint8_t result = TELEMETRY_CMD_OK) const;
+
+ private:
+     static const uint32_t TX_BUFFER_SIZE = 256;  // ~5 trames complètes, 2,8 ms à 921600 bauds
+
+     TelemetryLink& link;
+     TelemetryBuffer& ring;
+     TelemetryFrameReader reader;
+
+     uint8_t tx[2][TX_BUFFER_SIZE];
+     uint16_t txLength;        // octets en attente dans tx[filling]
+     uint8_t filling;
+
+     uint16_t decimation;
+     uint16_t channels;
+     uint16_t decimationCount;
+     uint16_t sequence;
+     uint16_t lostSinceLast;   // décimés exclus : file pleine + trames abandonnées
+     uint32_t lastOverruns;
+     uint32_t framesSent;
+     uint32_t framesDropped;
+     uint8_t profileNext;      // prochaine zone à envoyer après GET_PROFILE (PROFILE_ZONES = rien)
+     bool profileReset;
+     const WatchdogMonitor* watchdog;
+
+     void queueProfile();
+     void countLost(uint32_t n);
+     void handleCommands();
+     void handleCommand(const uint8_t* frame, uint32_t len);
+     bool queueFrame(uint8_t type, const uint8_t* body, uint32_t bodyLen);
+     void flushTx();
+ };
+
+ /**
+  * @brief TelemetryLink sur un handle HAL.
+  *
+  * Cible : envoi par HAL_UART_Transmit_IT, réception octet par octet par HAL_UART_Receive_IT
+  * dans une petite file ; onRxComplete() est appelé depuis HAL_UART_RxCpltCallback et onError()
+  * depuis HAL_UART_ErrorCallback (overrun, parité, trame, bruit : réception ré-armée, erreur comptée).
+  * PC : même interface sur le HostUartDevice branché par hostAttachUart.
+  */
+ class UartTelemetryLink : public TelemetryLink {
+ public:
+     explicit UartTelemetryLink(UART_HandleTypeDef* uart) : huart(uart), rxHead(0), rxTail(0), rxByte(0), errors(0) {}
+
+     void start();  // arme la réception (après MX_USARTx_UART_Init)
+     void onRxComplete(UART_HandleTypeDef* from);
+     void onError(UART_HandleTypeDef* from);
+
+     bool isTxReady() override;
+     bool write(const uint8_t* data, uint32_t len) override;
+     uint32_t read(uint8_t* data, uint32_t maxLen) override;
+     uint32_t getErrors() const override { return errors; }
+
+ private:
+     static const uint32_t RX_SIZE = 64;  // puissance de 2 ; une commande fait au plus 7 octets codés
+
+     UART_HandleTypeDef* huart;
+     uint8_t rx[RX_SIZE];
+     volatile uint32_t rxHead;  // écrit sous interruption
+     volatile uint32_t rxTail;
+     uint8_t rxByte;
+     volatile uint32_t errors;  // écrit sous interruption
+ };
@@ -4,7 +4,8 @@ using namespace std;
 #include <cstdint>
 #include <cstring>
 
-#include "ScreenDisplay.hpp"
+#include "stm32f4xx_hal.h"
+#include "ControlTypes.hpp"
 
 
 class VESCInterface {
@@ -17,6 +18,9 @@ public:
     float getRPM();
     float getCurrent();
     float getDutyCycle();
+    const VESCValues& getLastValues() const { return values; } // valide après un getValues() réussi
+
+    static uint16_t crc16(const uint8_t* data, uint16_t len); // CRC de la trame VESC, public pour le banc de mesure (ergo_bench)
     
 
 private:
@@ -25,15 +29,16 @@ private:
     // Buffers
     uint8_t txBuffer[64]; // zone mémoire utilisée pour préparer les paquets à envoyer au VESC
     uint8_t rxBuffer[128]; //zone mémoire pour stocker la réponse reçue depuis le VESC
+    static const uint16_t GET_VALUES_MIN_LEN = 29; //commande + champs jusqu'à la tension batterie incluse
 
     // Extracted values
     float rpm; //Vitesse de rotation du moteur exprimée en tours par minute (RPM). Elle est renvoyée par le VESC via COMM_GET_VALUES.
     float inputCurrent; //C’est le courant consommé par le VESC lui-même, depuis la source d’alimentation. Elle est renvoyée par le VESC via COMM_GET_VALUES.
     float dutyCycle; //Cycle de travail PWM appliqué au moteur. (Le VESC gère lui-même le PWM interne pour contrôler le moteur.)
+    VESCValues values; //Tous les champs de la dernière trame, pour ne faire qu'un aller-retour UART par tick
 
-    ScreenDisplay* screen;
-    
     void sendPacket(uint8_t* data, uint16_t len);
     bool receivePacket(uint8_t* buffer, uint16_t& len, uint32_t timeout = 100);
-    uint16_t crc16(const uint8_t* data, uint16_t len);
+    static int16_t readInt16(const uint8_t* ptr);
+    static int32_t readInt32(const uint8_t* ptr);
 };
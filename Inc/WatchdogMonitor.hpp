@@ -0,0 +1,103 @@
+/*
+ * WatchdogMonitor.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #pragma once
+
+ #include <cstdint>
+
+ #include "stm32f4xx_hal.h"
+
+ /**
+  * @brief Marge du watchdog (IWDG) : délai entre deux rafraîchissements, pire cas, tâche fautive.
+  *
+  * La boucle signale l'étape en cours avec enter() (mêmes numéros que ProfileZone) et
+  * rafraîchit l'IWDG par refresh(). onTick(), appelé par la SysTick toutes les millisecondes,
+  * détecte le passage sous le seuil d'alerte *pendant* l'étape bloquante (rampe de stop(),
+  * calibration, suite de timeouts UART) et recopie l'état en RAM de sauvegarde : après un
+  * reset par le watchdog, begin() retrouve la tâche qui tournait au moment de l'expiration.
+  *
+  * Un seul écrivain par donnée partagée : après begin(), seul onTick() écrit l'enregistrement et
+  * les compteurs d'alerte ; refresh() publie l'instant et l'intervalle du rafraîchissement et
+  * onTick() désarme l'enregistrement au tick suivant.
+  *
+  * Délai calculé avec la LSI la plus rapide de la fiche technique (47 kHz au lieu de 32) :
+  * prescaler 64 et reload 4095 donnent 8,2 s nominales mais 5,6 s au pire.
+  */
+
+ static const uint32_t WATCHDOG_RECORD_MAGIC = 0x50444D57u;  // "WMDP"
+ static const uint8_t WATCHDOG_NO_TASK = 0xFF;
+
+ // Enregistrement en RAM de sauvegarde (BKPSRAM) : survit à un reset tant que la carte reste alimentée
+ struct WatchdogPostMortem {
+     uint32_t magic;
+     uint32_t uptimeMs;          // HAL_GetTick() à la dernière mise à jour
+     uint32_t sinceRefreshMs;    // délai depuis le dernier rafraîchissement à ce moment
+     uint32_t worstIntervalMs;   // pire intervalle entre rafraîchissements avant l'incident
+     uint8_t task;               // étape en cours (ProfileZone)
+     uint8_t armed;              // 1 : marge sous le seuil et pas encore rafraîchi
+     uint16_t nearMisses;
+     uint32_t crc;               // CRC32 des champs précédents
+ };
+
+ struct WatchdogStats {
+     uint32_t timeoutMs;          // délai au pire (LSI rapide)
+     uint32_t warningMs;          // seuil d'alerte : délai depuis le rafraîchissement
+     uint32_t lastIntervalMs;     // dernière itération
+     uint32_t worstIntervalMs;
+     uint8_t worstTask;           // étape la plus longue de l'itération la plus longue
+     uint32_t worstTaskMs;
+     uint32_t nearMisses;         // passages sous le seuil d'alerte
+     uint8_t nearMissTask;        // étape en cours au dernier passage sous le seuil
+     uint32_t refreshes;
+ };
+
+ class WatchdogMonitor {
+ public:
+     WatchdogMonitor(IWDG_HandleTypeDef* hiwdg, uint32_t warningMarginMs);
+
+     // Après MX_IWDG_Init : calcule le délai, relit l'enregistrement du démarrage précédent
+     void begin();
+
+     void enter(uint8_t task);  // début d'une étape de la boucle
+     void refresh();            // remplace HAL_IWDG_Refresh
+     void onTick();             // SysTick (interruption) : surveillance pendant les étapes bloquantes
+
+     // nearMisses et nearMissTask sont recopiés des compteurs de onTick() à chaque rafraîchissement
+
+     const WatchdogStats& getStats() const { return stats; }
+
+     // Vrai si le dernier reset vient de l'IWDG ; record.armed = 0 : interruptions masquées (Error_Handler...)
+     bool hadWatchdogReset() const { return watchdogReset; }
+     const WatchdogPostMortem& getPreviousReset() const { return previous; }
+
+ private:
+     IWDG_HandleTypeDef* hiwdg;
+     uint32_t warningMarginMs;
+     WatchdogStats stats;
+     WatchdogPostMortem previous;
+     bool watchdogReset;
+
+     // Écrits par la boucle, lus sous interruption (lastIntervalMs avant lastRefreshMs)
+     volatile bool active;           // begin() terminé : onTick() peut écrire l'enregistrement
+     volatile uint32_t lastRefreshMs;
+     volatile uint32_t lastIntervalMs;
+     volatile uint8_t task;
+
+     // Écrits sous interruption seulement, lus par la boucle
+     volatile bool warned;           // seuil franchi depuis le dernier rafraîchissement
+     volatile uint32_t nearMissCount;
+     volatile uint8_t nearMissTask;
+     uint32_t taskStartMs;
+     uint8_t longestTask;            // étape la plus longue de l'itération en cours
+     uint32_t longestTaskMs;
+
+     void saveRecord(uint32_t nowMs, uint32_t sinceRefreshMs, bool armed);
+ };
+
+ // RAM de sauvegarde et cause du reset : BKPSRAM et RCC sur cible, mémoire ordinaire sur PC
+ WatchdogPostMortem* watchdogBackupRecord();
+ bool watchdogCausedReset();  // lit puis efface les drapeaux de reset
@@ -0,0 +1,51 @@
+/*
+ * DrivetrainParams.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #include "../Inc/DrivetrainParams.hpp"
+
+ #include <cmath>
+ #include <cstddef>
+
+ #include "../Inc/SettingsStore.hpp"
+
+ static uint32_t paramsCrc(const DrivetrainParams& params) {
+     return SettingsStore::crc32(reinterpret_cast<const uint8_t*>(&params), offsetof(DrivetrainParams, crc));
+ }
+
+ void drivetrainParamsSeal(DrivetrainParams& params) {
+     params.magic = DrivetrainParams::MAGIC;
+     params.version = DrivetrainParams::VERSION;
+     params.crc = paramsCrc(params);
+ }
+
+ bool drivetrainParamsValid(const DrivetrainParams& params)
+ // Un fichier écrit par une autre version ou abîmé sur la clé n'est jamais appliqué
+ {
+     if (params.magic != DrivetrainParams::MAGIC || params.version != DrivetrainParams::VERSION) return false;
+     if (params.crc != paramsCrc(params)) return false;
+
+     const float values[] = {params.torqueConstant, params.resistance, params.inertia, params.viscous,
+                             params.coulomb, params.reductionRatio};
+     for (float v : values) {
+         if (!std::isfinite(v)) return false;
+     }
+     return params.reductionRatio > 0.0f;
+ }
+
+ #ifdef ERGO_HOST
+
+ void drivetrainParamsPrint(FILE* out, const DrivetrainParams& p) {
+     fprintf(out, "Kt          %s %.4f Nm/A (R = %.3f Ohm, R² %.4f)\n", (p.flags & DRIVETRAIN_KT) ? " " : "-",
+             p.torqueConstant, p.resistance, p.electricalR2);
+     fprintf(out, "inertie     %s %.4f kg·m² au pédalier\n", (p.flags & DRIVETRAIN_INERTIA) ? " " : "-", p.inertia);
+     fprintf(out, "visqueux    %s %.4f Nm·s/rad\n", (p.flags & DRIVETRAIN_FRICTION) ? " " : "-", p.viscous);
+     fprintf(out, "coulomb     %s %.3f Nm\n", (p.flags & DRIVETRAIN_FRICTION) ? " " : "-", p.coulomb);
+     fprintf(out, "rapport       %.3f, %u échantillons, R² mécanique %.4f  (- : non plausible, non appliqué)\n",
+             p.reductionRatio, p.samples, p.mechanicalR2);
+ }
+
+ #endif
@@ -0,0 +1,37 @@
+/*
+ * DrivetrainParamsFile.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #ifdef ERGO_HOST
+
+ #include <cstdio>
+
+ #include "../Inc/DrivetrainParams.hpp"
+
+ bool readDrivetrainParams(const char* path, DrivetrainParams& params) {
+     FILE* f = fopen(path, "rb");
+     if (!f) return false;
+
+     DrivetrainParams image;
+     bool ok = fread(&image, 1, sizeof(image), f) == sizeof(image);
+     fclose(f);
+     if (!ok || !drivetrainParamsValid(image)) return false;
+
+     params = image;
+     return true;
+ }
+
+ bool writeDrivetrainParams(const char* path, const DrivetrainParams& params) {
+     DrivetrainParams image = params;
+     drivetrainParamsSeal(image);
+
+     FILE* f = fopen(path, "wb");
+     if (!f) return false;
+     bool ok = fwrite(&image, 1, sizeof(image), f) == sizeof(image);
+     return (fclose(f) == 0) && ok;
+ }
+
+ #endif
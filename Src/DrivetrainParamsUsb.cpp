@@ -0,0 +1,40 @@
+/*
+ * DrivetrainParamsUsb.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #ifndef ERGO_HOST
+
+ #include <cstdio>
+
+ #include "../Inc/DrivetrainParams.hpp"
+ #include "fatfs.h"      // USBHFatFS, USBHPath (générés par CubeMX, FatFs sur USB Host MSC)
+
+ bool readDrivetrainParams(const char* path, DrivetrainParams& params)
+ // Monte la clé le temps de la lecture : à appeler avant que SessionLogger n'ouvre ERGO.LOG
+ // (un second f_mount réinitialiserait le volume sous le fichier ouvert)
+ {
+     static FIL file;  // hors pile : FIL contient le tampon de secteur de FatFs
+
+     if (f_mount(&USBHFatFS, USBHPath, 1) != FR_OK) return false;
+
+     char fullPath[16];
+     snprintf(fullPath, sizeof(fullPath), "%s%s", USBHPath, path);
+
+     DrivetrainParams image;
+     UINT read = 0;
+     bool ok = false;
+     if (f_open(&file, fullPath, FA_READ) == FR_OK) {
+         ok = (f_read(&file, &image, sizeof(image), &read) == FR_OK) && read == sizeof(image);
+         f_close(&file);
+     }
+     f_mount(nullptr, USBHPath, 0);
+
+     if (!ok || !drivetrainParamsValid(image)) return false;
+     params = image;
+     return true;
+ }
+
+ #endif
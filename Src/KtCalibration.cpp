@@ -0,0 +1,191 @@
+/*
+ * KtCalibration.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #include "../Inc/KtCalibration.hpp"
+
+ // --- Régression incrémentale ---
+
+ StreamingLinearFit::StreamingLinearFit() {
+     reset();
+ }
+
+ void StreamingLinearFit::reset() {
+     count = 0;
+     meanX = meanY = 0.0f;
+     sxx = sxy = syy = 0.0f;
+ }
+
+ void StreamingLinearFit::add(float x, float y) {
+     count++;
+     float dx = x - meanX;  // écart à l'ancienne moyenne
+     float dy = y - meanY;
+     meanX += dx / count;
+     meanY += dy / count;
+     sxx += dx * (x - meanX);  // produit ancienne × nouvelle moyenne (Welford)
+     sxy += dx * (y - meanY);
+     syy += dy * (y - meanY);
+ }
+
+ float StreamingLinearFit::getSlope() const {
+     if (count < 2 || sxx <= 0.0f) return 0.0f;
+     return sxy / sxx;
+ }
+
+ float StreamingLinearFit::getOffset() const {
+     return meanY - getSlope() * meanX;
+ }
+
+ float StreamingLinearFit::getRSquared() const {
+     if (count < 2 || sxx <= 0.0f || syy <= 0.0f) return 0.0f;
+     return (sxy * sxy) / (sxx * syy);
+ }
+
+ float StreamingLinearFit::getResidualStd() const {
+     if (count < 3) return 0.0f;
+     float sse = syy - getSlope() * sxy;  // somme des carrés des résidus
+     if (sse < 0.0f) sse = 0.0f;
+     return sqrtf(sse / (count - 2));
+ }
+
+ float StreamingLinearFit::residual(float x, float y) const {
+     return y - (getSlope() * x + getOffset());
+ }
+
+ // --- Machine d'états ---
+
+ CalibrationConfig defaultCalibrationConfig() {
+     CalibrationConfig cfg = {};
+     // Jusqu'à 80 % de la vitesse à vide : marge de duty pour la chute résistive et la régulation
+     const float levels[] = {0.2f, 0.35f, 0.5f, 0.65f, 0.8f};
+
+     cfg.levelCount = sizeof(levels) / sizeof(levels[0]);
+     for (uint8_t i = 0; i < cfg.levelCount; i++) cfg.levelFractions[i] = levels[i];
+     cfg.maxMissedTicks = 3;
+
+     cfg.settleMs = 800;
+     cfg.samplesPerLevel = 5;           // 5 × 100 ms par palier
+     cfg.outlierSigma = 3.0f;
+     cfg.minSamplesForRejection = 6;
+     cfg.minRSquared = 0.98f;
+     cfg.ktPerKe = 1.0f;
+     cfg.ktMin = 0.01f;                 // même plage que l'ancienne calibration
+     cfg.ktMax = 1.0f;
+     return cfg;
+ }
+
+ KtCalibrator::KtCalibrator(const CalibrationConfig& cfg)
+     : config(cfg),
+       state(CalibrationState::IDLE),
+       level(0),
+       levelSamples(0),
+       levelStartMs(0),
+       missedTicks(0),
+       noLoadOmega(0.0f),
+       levelOmegaSum(0.0f),
+       levelVoltageSum(0.0f),
+       levelInputSum(0.0f),
+       result{false, 0.0f, 0.0f, 0.0f, 0, 0} {}
+
+ void KtCalibrator::start(uint32_t nowMs, float noLoad) {
+     fit.reset();
+     result = {false, 0.0f, 0.0f, 0.0f, 0, 0};
+     level = 0;
+     levelSamples = 0;
+     levelStartMs = nowMs;
+     missedTicks = 0;
+     noLoadOmega = noLoad;
+     levelOmegaSum = levelVoltageSum = levelInputSum = 0.0f;
+     bool valid = config.levelCount >= 2 && noLoadOmega > 0.0f;
+     state = valid ? CalibrationState::SETTLING : CalibrationState::FAILED;
+ }
+
+ void KtCalibrator::abort() {
+     if (isRunning()) state = CalibrationState::FAILED;
+ }
+
+ float KtCalibrator::getTargetRpm() const {
+     static const float RPM_PER_RAD_S = 30.0f / 3.14159265f;
+     return isRunning() ? config.levelFractions[level] * noLoadOmega * RPM_PER_RAD_S : 0.0f;
+ }
+
+ void KtCalibrator::missed() {
+     if (isRunning() && ++missedTicks > config.maxMissedTicks) state = CalibrationState::FAILED;
+ }
+
+ void KtCalibrator::tick(uint32_t nowMs, float omegaMotor, float phaseVoltage, float inputVoltage) {
+     missedTicks = 0;
+     switch (state) {
+         case CalibrationState::SETTLING:
+             if (nowMs - levelStartMs >= config.settleMs) {
+                 state = CalibrationState::SAMPLING;
+             }
+             break;
+
+         case CalibrationState::SAMPLING:
+         {
+             // Rejet des aberrants une fois que l'ajustement a assez de points pour être fiable
+             bool outlier = false;
+             if (fit.getCount() >= config.minSamplesForRejection) {
+                 float sigma = fit.getResidualStd();
+                 if (sigma > 0.0f && fabsf(fit.residual(omegaMotor, phaseVoltage)) > config.outlierSigma * sigma) {
+                     outlier = true;
+                 }
+             }
+
+             if (outlier) {
+                 result.rejected++;
+             } else {
+                 fit.add(omegaMotor, phaseVoltage);
+             }
+             levelOmegaSum += omegaMotor;
+             levelVoltageSum += phaseVoltage;
+             levelInputSum += inputVoltage;
+
+             if (++levelSamples >= config.samplesPerLevel) {
+                 nextLevel(nowMs);
+             }
+             break;
+         }
+
+         default:
+             break;
+     }
+ }
+
+ void KtCalibrator::updateNoLoadSpeed()
+ // Ke du palier ≈ tension / vitesse (surestimé par la chute résistive : la vitesse à vide est sous-estimée, côté sûr)
+ {
+     if (levelOmegaSum <= 0.0f || levelVoltageSum <= 0.0f) return;
+     float ke = levelVoltageSum / levelOmegaSum;
+     noLoadOmega = (levelInputSum / levelSamples) / ke;
+ }
+
+ void KtCalibrator::nextLevel(uint32_t nowMs) {
+     updateNoLoadSpeed();
+     levelOmegaSum = levelVoltageSum = levelInputSum = 0.0f;
+     level++;
+     levelSamples = 0;
+     levelStartMs = nowMs;
+
+     if (level >= config.levelCount) {
+         finish();
+     } else {
+         state = CalibrationState::SETTLING;
+     }
+ }
+
+ void KtCalibrator::finish() {
+     float kt = config.ktPerKe * fit.getSlope();
+
+     result.torqueConstant = kt;
+     result.offset = fit.getOffset();
+     result.rSquared = fit.getRSquared();
+     result.samples = fit.getCount();
+     result.success = (result.rSquared >= config.minRSquared) && (kt > config.ktMin) && (kt < config.ktMax);
+
+     state = result.success ? CalibrationState::DONE : CalibrationState::FAILED;
+ }
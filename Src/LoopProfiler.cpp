@@ -0,0 +1,71 @@
+/*
+ * LoopProfiler.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #include "../Inc/LoopProfiler.hpp"
+
+ #include <cstring>
+
+ const char* profileZoneName(uint8_t zone) {
+     static const char* const names[PROFILE_ZONES] = {
+         "loop", "updateFromScreen", "sampleTelemetry", "getCadence", "update",
+         "updateScreen", "usbHost", "sessionLog", "telemetryStream",
+         "delay", "startup"
+     };
+     return (zone < PROFILE_ZONES) ? names[zone] : "?";
+ }
+
+ #ifdef ERGO_PROFILE
+
+ ProfileZoneStats profileZones[PROFILE_ZONES];
+ uint32_t profileStart[PROFILE_ZONES];
+
+ void profilerReset() {
+     memset(profileZones, 0, sizeof(profileZones));
+     for (ProfileZoneStats& z : profileZones) z.min = 0xFFFFFFFFu;
+ }
+
+ #ifndef ERGO_HOST
+
+ void profilerInit() {
+     CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;  // trace activée : DWT accessible
+     DWT->CYCCNT = 0;
+     DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+     profilerReset();
+ }
+
+ uint32_t profilerUnitsPerMicrosecond() {
+     return SystemCoreClock / 1000000u;
+ }
+
+ #else
+
+ void profilerInit() {
+     profilerReset();
+ }
+
+ uint32_t profilerUnitsPerMicrosecond() {
+     return 1000u;
+ }
+
+ void profilerPrint(FILE* out) {
+     const double perUs = profilerUnitsPerMicrosecond();
+     fprintf(out, "%-18s %10s %10s %10s %10s  histogramme log2 (µs)\n", "zone", "appels", "min µs", "moy µs", "max µs");
+     for (uint8_t i = 0; i < PROFILE_ZONES; i++) {
+         const ProfileZoneStats& z = profileZones[i];
+         if (z.count == 0) continue;
+         fprintf(out, "%-18s %10u %10.2f %10.2f %10.2f ", profileZoneName(i), z.count,
+                 z.min / perUs, z.total / perUs / z.count, z.max / perUs);
+         for (uint8_t k = 0; k < PROFILE_HISTOGRAM_BINS; k++) {
+             if (z.histogram[k]) fprintf(out, " <%.3g:%u", static_cast<double>(2ull << k) / perUs, z.histogram[k]);
+         }
+         fprintf(out, "\n");
+     }
+ }
+
+ #endif
+
+ #endif
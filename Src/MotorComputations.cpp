@@ -1,14 +1,44 @@
 #include "../Inc/MotorComputations.hpp"
 
-MotorComputations::MotorComputations()
-    : torqueConstant(torqueConstant) {}
+MotorComputations::MotorComputations(float torqueConstant)
+    : torqueConstant(torqueConstant),
+      reductionRatio(1.0f),
+      tempCoefficient(-0.0012f),  // NdFeB : environ -0.12 %/K
+      referenceTemp(25.0f),
+      motorTemp(25.0f),
+      coulombLoss(0.0f),
+      viscousLoss(0.0f),
+      inertia(0.0f)
+{
+    updateCoefficients();
+}
+
+void MotorComputations::updateCoefficients()
+// Recalculé seulement quand un paramètre ou la température change, jamais par conversion
+{
+    float scale = torqueConstant * reductionRatio;
+    ktSlope = scale * tempCoefficient;
+    torquePerAmp = scale + ktSlope * (motorTemp - referenceTemp);
+    if (torquePerAmp < 1e-6f) torquePerAmp = 1e-6f;  // sécurité : pas de division par zéro
+    ampsPerTorque = 1.0f / torquePerAmp;
+}
 
 float MotorComputations::computeTorqueFromCurrent(float current) const {
-    return current * torqueConstant;
+    return current * torquePerAmp;
 }
 
 float MotorComputations::computeCurrentFromTorque(float torque) const {
-    return torque / torqueConstant;
+    return torque * ampsPerTorque;
+}
+
+float MotorComputations::computeLossTorque(float cadence_rpm) const {
+    float omega = computeOmega(cadence_rpm);
+    float coulomb = (omega > 0.0f) ? coulombLoss : ((omega < 0.0f) ? -coulombLoss : 0.0f);
+    return coulomb + viscousLoss * omega;
+}
+
+float MotorComputations::computeShaftTorque(float current, float cadence_rpm) const {
+    return computeTorqueFromCurrent(current) - computeLossTorque(cadence_rpm);
 }
 
 float MotorComputations::computeOmega(float cadence_rpm) const {
@@ -22,6 +52,62 @@ float MotorComputations::computePower(float torque, float cadence_rpm) const {
 
 void MotorComputations::setTorqueConstant(float value) {
     torqueConstant = value;
+    updateCoefficients();
+}
+
+void MotorComputations::setReductionRatio(float ratio) {
+    reductionRatio = (ratio > 0.0f) ? ratio : 1.0f;
+    updateCoefficients();
+}
+
+void MotorComputations::setTemperatureModel(float alphaPerKelvin, float referenceTempC) {
+    tempCoefficient = alphaPerKelvin;
+    referenceTemp = referenceTempC;
+    updateCoefficients();
+}
+
+void MotorComputations::setMotorTemperature(float tempC) {
+    if (tempC == motorTemp) return;
+    motorTemp = tempC;
+    updateCoefficients();
+}
+
+float MotorComputations::referenceTorqueConstant(float measuredKt, float tempC) const {
+    float factor = 1.0f + tempCoefficient * (tempC - referenceTemp);
+    return (factor > 0.0f) ? measuredKt / factor : measuredKt;
+}
+
+void MotorComputations::setLossModel(float coulombNm, float viscousNmPerRadS) {
+    coulombLoss = coulombNm;
+    viscousLoss = viscousNmPerRadS;
+}
+
+void MotorComputations::setInertia(float kgm2) {
+    inertia = kgm2;
+}
+
+float MotorComputations::computeFeedforwardTorque(float cadence_rpm, float cadenceRate) const {
+    return inertia * computeOmega(cadenceRate) + computeLossTorque(cadence_rpm);  // tr/min/s → rad/s²
+}
+
+void MotorComputations::computeTorqueBatch(const float* current, const float* tempC, const float* cadence_rpm,
+                                           float* torqueOut, size_t count) const
+// Boucle sans branche sur les données (hors signe de ω) : vectorisable par le compilateur sur PC
+{
+    const float scale = torqueConstant * reductionRatio;
+    const float rpmToOmega = 2.0f * static_cast<float>(M_PI) / 60.0f;
+
+    for (size_t i = 0; i < count; i++) {
+        float kt = scale + ktSlope * (tempC[i] - referenceTemp);
+        float omega = cadence_rpm[i] * rpmToOmega;
+        float coulomb = (omega > 0.0f) ? coulombLoss : ((omega < 0.0f) ? -coulombLoss : 0.0f);
+        torqueOut[i] = current[i] * kt - (coulomb + viscousLoss * omega);
+    }
+}
 
+void MotorComputations::computePowerBatch(const float* torque, const float* cadence_rpm, float* powerOut, size_t count) const {
+    const float rpmToOmega = 2.0f * static_cast<float>(M_PI) / 60.0f;
+    for (size_t i = 0; i < count; i++) {
+        powerOut[i] = torque[i] * cadence_rpm[i] * rpmToOmega;
+    }
 }
-   
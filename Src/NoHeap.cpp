@@ -0,0 +1,89 @@
+/*
+ * NoHeap.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ /**
+  * Option de build ERGO_NO_HEAP (-DERGO_NO_HEAP, avec -ffunction-sections et -Wl,--gc-sections
+  * comme dans le projet CubeIDE) : toute allocation dynamique fait échouer l'édition de liens.
+  *
+  * Les fonctions ci-dessous appellent un symbole jamais défini. Tant que personne ne les
+  * référence, --gc-sections les supprime et le lien passe ; dès qu'un new/malloc apparaît
+  * dans le code, l'éditeur de liens signale "undefined reference to ergo_heap_is_forbidden".
+  *
+  * Limite : les allocations internes de la newlib (_malloc_r, ex. printf de flottants)
+  * ne passent pas par malloc() et ne sont pas détectées ici.
+  *
+  * Pile USB hôte (clé du journal de séance) : USBH_MSC_InterfaceInit() alloue le handle de classe
+  * avec USBH_malloc, défini à malloc par défaut dans usbh_conf.h. Avec ERGO_NO_HEAP, remplacer dans
+  * usbh_conf.h, comme dans les exemples ST :
+  *     #define USBH_malloc   USBH_static_malloc
+  *     #define USBH_free     USBH_static_free
+  * Un seul bloc statique suffit : une seule classe est active à la fois et le handle est libéré
+  * à chaque débranchement. Oublier ce remplacement fait échouer le lien sur ergo_heap_is_forbidden.
+  * FatFs ne doit pas non plus allouer : _USE_LFN (ffconf.h) différent de 3.
+  */
+
+ #ifdef ERGO_NO_HEAP
+
+ #include <cstddef>
+ #include <cstdint>
+ #include <new>
+
+ #include "usbh_msc.h"
+
+ extern "C" void ergo_heap_is_forbidden(void);  // volontairement jamais défini
+
+ static uint32_t usbhClassPool[sizeof(MSC_HandleTypeDef) / sizeof(uint32_t) + 1];  // aligné sur 4 octets
+
+ // Taille trop grande (autre classe que MSC) : l'énumération échoue proprement, rien n'est écrasé
+ extern "C" void* USBH_static_malloc(uint32_t size) {
+     return (size <= sizeof(usbhClassPool)) ? usbhClassPool : nullptr;
+ }
+
+ extern "C" void USBH_static_free(void*) {}
+
+ void* operator new(std::size_t) {
+     ergo_heap_is_forbidden();
+     return reinterpret_cast<void*>(1);
+ }
+
+ void* operator new[](std::size_t) {
+     ergo_heap_is_forbidden();
+     return reinterpret_cast<void*>(1);
+ }
+
+ void* operator new(std::size_t, const std::nothrow_t&) noexcept {
+     ergo_heap_is_forbidden();
+     return nullptr;
+ }
+
+ void* operator new[](std::size_t, const std::nothrow_t&) noexcept {
+     ergo_heap_is_forbidden();
+     return nullptr;
+ }
+
+ // delete reste défini (vide) : les destructeurs virtuels y font référence même sans aucun new
+ void operator delete(void*) noexcept {}
+ void operator delete[](void*) noexcept {}
+ void operator delete(void*, std::size_t) noexcept {}
+ void operator delete[](void*, std::size_t) noexcept {}
+
+ extern "C" void* malloc(std::size_t) {
+     ergo_heap_is_forbidden();
+     return nullptr;
+ }
+
+ extern "C" void* calloc(std::size_t, std::size_t) {
+     ergo_heap_is_forbidden();
+     return nullptr;
+ }
+
+ extern "C" void* realloc(void*, std::size_t) {
+     ergo_heap_is_forbidden();
+     return nullptr;
+ }
+
+ #endif
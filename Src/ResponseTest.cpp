@@ -0,0 +1,442 @@
+/*
+ * ResponseTest.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #include "../Inc/ResponseTest.hpp"
+
+ #include <cmath>
+ #include <cstring>
+
+ static const float TWO_PI = 6.28318530718f;
+
+ ResponseTestConfig defaultResponseTestConfig() {
+     // Cadence 30 → 45 tr/min : plage d'usage courant, pas assez brutale pour surprendre le cycliste.
+     // Chirp jusqu'à 1 Hz : au-delà, la boucle à ~100 ms + écran n'a plus 2,5 points par période.
+     return ResponseTestConfig{ControlMode::CADENCE, 30.0f, 15.0f, 4, 4000, 8.0f, 0.05f, 1.0f, 60000, 6, 0.05f};
+ }
+
+ // --- Programme ---
+
+ uint8_t ResponseProgram::getStepCount() const {
+     return (config.stepCount < ResponseTestConfig::MAX_STEPS) ? config.stepCount : ResponseTestConfig::MAX_STEPS;
+ }
+
+ uint8_t ResponseProgram::getBandCount() const {
+     if (config.chirpBands == 0) return 1;
+     return (config.chirpBands < ResponseTestConfig::MAX_BANDS) ? config.chirpBands : ResponseTestConfig::MAX_BANDS;
+ }
+
+ uint32_t ResponseProgram::getChirpStartMs() const {
+     uint8_t steps = getStepCount();
+     return (1u + steps + (steps & 1u)) * config.stepHoldMs;  // nombre impair d'échelons : retour à base avant le chirp
+ }
+
+ ResponseSegment ResponseProgram::segmentAt(uint32_t elapsedMs, uint8_t& index, uint32_t& startMs) const {
+     const uint32_t hold = config.stepHoldMs;
+     const uint8_t steps = getStepCount();
+     const uint32_t chirpStart = getChirpStartMs();
+
+     if (hold > 0) {
+         if (elapsedMs < hold) {
+             index = 0;
+             startMs = 0;
+             return ResponseSegment::SETTLE;
+         }
+         if (elapsedMs / hold <= steps) {
+             index = static_cast<uint8_t>(elapsedMs / hold - 1);
+             startMs = (index + 1u) * hold;
+             return ResponseSegment::STEP;
+         }
+         if (elapsedMs < chirpStart) {
+             index = 1;
+             startMs = (1u + steps) * hold;
+             return ResponseSegment::SETTLE;
+         }
+     }
+
+     const uint8_t bands = getBandCount();
+     if (elapsedMs - chirpStart < config.chirpMs) {
+         uint32_t t = elapsedMs - chirpStart;
+         index = static_cast<uint8_t>(static_cast<uint64_t>(t) * bands / config.chirpMs);
+         startMs = chirpStart + static_cast<uint32_t>((static_cast<uint64_t>(config.chirpMs) * index + bands - 1) / bands);
+         return ResponseSegment::CHIRP;
+     }
+     index = 0;
+     startMs = getDurationMs();
+     return ResponseSegment::DONE;
+ }
+
+ float ResponseProgram::setpointAt(uint32_t elapsedMs) const {
+     uint8_t index;
+     uint32_t startMs;
+     switch (segmentAt(elapsedMs, index, startMs)) {
+         case ResponseSegment::STEP:
+             return (index % 2 == 0) ? config.base + config.stepAmplitude : config.base;
+         case ResponseSegment::CHIRP:
+             return config.base + config.chirpAmplitude * sinf(chirpPhase(elapsedMs - getChirpStartMs()));
+         default:
+             return config.base;
+     }
+ }
+
+ float ResponseProgram::chirpPhase(uint32_t chirpMs) const
+ // Chirp exponentiel : f(t) = f0·k^(t/T), φ(t) = 2π·f0·T/ln k·(k^(t/T) − 1)
+ {
+     const float t = chirpMs * 0.001f;
+     const float duration = config.chirpMs * 0.001f;
+     const float f0 = config.chirpStartHz;
+     if (duration <= 0.0f || f0 <= 0.0f || fabsf(config.chirpEndHz - f0) < 1e-6f) return TWO_PI * f0 * t;
+
+     const float logRatio = logf(config.chirpEndHz / f0);
+     return TWO_PI * f0 * duration / logRatio * (expf(logRatio * t / duration) - 1.0f);
+ }
+
+ float ResponseProgram::bandEdgeHz(uint8_t band) const {
+     const uint8_t bands = getBandCount();
+     if (config.chirpStartHz <= 0.0f) return config.chirpStartHz;
+     return config.chirpStartHz * powf(config.chirpEndHz / config.chirpStartHz, static_cast<float>(band) / bands);
+ }
+
+ // --- Analyse ---
+
+ ResponseAnalyzer::ResponseAnalyzer(const ResponseTestConfig& cfg)
+     : program(cfg)
+ {
+     reset();
+ }
+
+ void ResponseAnalyzer::configure(const ResponseTestConfig& cfg) {
+     program = ResponseProgram(cfg);
+     reset();
+ }
+
+ void ResponseAnalyzer::reset() {
+     memset(&result, 0, sizeof(result));
+     result.maxSettlingTimeMs = 0.0f;
+     segment = ResponseSegment::SETTLE;
+     index = 0;
+     segmentStartMs = 0;
+     started = false;
+     lastMs = 0;
+     lastReference = 0.0f;
+     lastMeasured = 0.0f;
+     stepFrom = 0.0f;
+     stepInitial = 0.0f;
+     stepCommandMs = 0;
+     stepCount = 0;
+     tailReference = 0.0f;
+     tailCount = 0;
+     w = ws = wc = wss = wsc = wcc = 0.0f;
+     ru = rs = rc = 0.0f;
+     yu = ys = yc = 0.0f;
+     bandSamples = 0;
+ }
+
+ void ResponseAnalyzer::push(uint32_t elapsedMs, float reference, float measured) {
+     uint8_t nextIndex;
+     uint32_t startMs;
+     ResponseSegment next = program.segmentAt(elapsedMs, nextIndex, startMs);
+
+     uint32_t dt = elapsedMs - lastMs;
+     if (!started) {
+         // Premier point (journal rejoué qui commence en cours de programme) : il sert de point de départ
+         started = true;
+         dt = 0;
+         lastReference = reference;
+         lastMeasured = measured;
+         openSegment(next, nextIndex, startMs);
+     } else if (next != segment || nextIndex != index) {
+         closeSegment();
+         openSegment(next, nextIndex, startMs);
+     }
+     if (dt > MAX_GAP_MS) dt = 0;
+
+     const ResponseTestConfig& cfg = program.getConfig();
+     if (segment == ResponseSegment::STEP) {
+         if (stepCount == 0) stepCommandMs = elapsedMs;
+         if (stepCount < STEP_SAMPLES) {
+             stepTimeMs[stepCount] = elapsedMs - stepCommandMs;
+             stepMeasured[stepCount] = measured;
+             stepCount++;
+         }
+         if ((elapsedMs - segmentStartMs) * 4u >= cfg.stepHoldMs * 3u) {
+             tailReference += reference;
+             tailCount++;
+         }
+     } else if (segment == ResponseSegment::CHIRP) {
+         float phase = program.chirpPhase(elapsedMs - program.getChirpStartMs());
+         float s = sinf(phase), c = cosf(phase);
+         float weight = static_cast<float>(dt);
+         w += weight;
+         ws += weight * s;
+         wc += weight * c;
+         wss += weight * s * s;
+         wsc += weight * s * c;
+         wcc += weight * c * c;
+         ru += weight * reference;
+         rs += weight * reference * s;
+         rc += weight * reference * c;
+         yu += weight * measured;
+         ys += weight * measured * s;
+         yc += weight * measured * c;
+         bandSamples++;
+     }
+
+     lastMs = elapsedMs;
+     lastReference = reference;
+     lastMeasured = measured;
+ }
+
+ void ResponseAnalyzer::finish() {
+     if (started && segment != ResponseSegment::DONE) closeSegment();
+     segment = ResponseSegment::DONE;
+     summarize();
+ }
+
+ void ResponseAnalyzer::openSegment(ResponseSegment next, uint8_t nextIndex, uint32_t startMs) {
+     segment = next;
+     index = nextIndex;
+     segmentStartMs = startMs;
+     if (next == ResponseSegment::STEP) {
+         stepFrom = lastReference;    // dernier point du segment précédent : état avant l'échelon
+         stepInitial = lastMeasured;
+         stepCount = 0;
+         tailReference = 0.0f;
+         tailCount = 0;
+     } else if (next == ResponseSegment::CHIRP) {
+         w = ws = wc = wss = wsc = wcc = 0.0f;
+         ru = rs = rc = 0.0f;
+         yu = ys = yc = 0.0f;
+         bandSamples = 0;
+     }
+ }
+
+ void ResponseAnalyzer::closeSegment() {
+     if (segment == ResponseSegment::STEP) closeStep();
+     else if (segment == ResponseSegment::CHIRP) closeBand();
+ }
+
+ void ResponseAnalyzer::closeStep() {
+     if (index >= ResponseTestConfig::MAX_STEPS) return;
+     const ResponseTestConfig& cfg = program.getConfig();
+     StepMetrics& m = result.steps[index];
+     if (index + 1u > result.stepCount) result.stepCount = index + 1u;
+
+     const uint16_t n = stepCount;
+     m.samples = n;
+     m.from = stepFrom;
+     m.to = tailCount ? tailReference / tailCount : lastReference;
+     m.initial = stepInitial;
+
+     // Valeur finale : dernier quart du palier, ou dernier quart du tampon s'il a débordé
+     const uint32_t tailMs = segmentStartMs + cfg.stepHoldMs * 3u / 4u - stepCommandMs;
+     float sum = 0.0f;
+     uint16_t count = 0;
+     for (uint16_t i = 0; i < n; i++) {
+         if (stepTimeMs[i] >= tailMs) {
+             sum += stepMeasured[i];
+             count++;
+         }
+     }
+     if (count == 0) {
+         for (uint16_t i = n - n / 4u; n > 0 && i < n; i++) {
+             sum += stepMeasured[i];
+             count++;
+         }
+     }
+     m.final = count ? sum / count : stepInitial;
+     m.steadyStateError = m.to - m.final;
+
+     const float delta = m.final - m.initial;
+     const float magnitude = fabsf(delta);
+     m.valid = n >= 4 && magnitude > 1e-6f && magnitude >= 0.1f * fabsf(m.to - m.from);
+     m.deadTimeMs = m.riseTimeMs = m.settlingTimeMs = -1.0f;
+     m.overshootPct = 0.0f;
+     if (!m.valid) return;
+
+     const float sign = (delta > 0.0f) ? 1.0f : -1.0f;
+
+     // Premier passage à level × variation, interpolé entre deux points (le point 0 est l'état initial)
+     auto crossing = [&](float level) -> float {
+         float threshold = level * magnitude;
+         float prevT = 0.0f, prevY = 0.0f;
+         for (uint16_t i = 0; i < n; i++) {
+             float y = sign * (stepMeasured[i] - m.initial);
+             float t = static_cast<float>(stepTimeMs[i]);
+             if (y >= threshold) {
+                 if (y <= prevY) return t;
+                 return prevT + (t - prevT) * (threshold - prevY) / (y - prevY);
+             }
+             prevT = t;
+             prevY = y;
+         }
+         return -1.0f;
+     };
+     m.deadTimeMs = crossing(cfg.settleBand);
+     float t10 = crossing(0.1f), t90 = crossing(0.9f);
+     if (t10 >= 0.0f && t90 >= 0.0f) m.riseTimeMs = t90 - t10;
+
+     float peak = 0.0f;
+     int32_t lastOutside = -1;
+     for (uint16_t i = 0; i < n; i++) {
+         float error = sign * (stepMeasured[i] - m.final);
+         if (error > peak) peak = error;
+         if (fabsf(error) > cfg.settleBand * magnitude) lastOutside = i;
+     }
+     m.overshootPct = 100.0f * peak / magnitude;
+     if (lastOutside < 0) m.settlingTimeMs = static_cast<float>(stepTimeMs[0]);
+     else if (lastOutside + 1 < n) m.settlingTimeMs = static_cast<float>(stepTimeMs[lastOutside + 1]);
+ }
+
+ void ResponseAnalyzer::closeBand() {
+     if (index >= ResponseTestConfig::MAX_BANDS) return;
+     FrequencyPoint& p = result.bands[index];
+     if (index + 1u > result.bandCount) result.bandCount = index + 1u;
+
+     const float lowHz = program.bandEdgeHz(index), highHz = program.bandEdgeHz(index + 1);
+     p.hz = sqrtf(lowHz * highHz);
+     p.samples = bandSamples;
+     p.valid = false;
+     p.gain = p.phaseDeg = p.delayMs = 0.0f;
+     if (w <= 0.0f || bandSamples < 8) return;
+
+     // Moindres carrés sur (sin, cos, 1) : l'offset est éliminé, il reste un système 2×2 par signal
+     const float ss = wss - ws * ws / w, sc = wsc - ws * wc / w, cc = wcc - wc * wc / w;
+     const float det = ss * cc - sc * sc;
+     if (fabsf(det) <= 1e-6f * w * w) return;  // moins d'une fraction de période : mal conditionné
+     const float rS0 = rs - ru * ws / w, rC0 = rc - ru * wc / w;
+     const float yS0 = ys - yu * ws / w, yC0 = yc - yu * wc / w;
+     const float rS = (cc * rS0 - sc * rC0) / det, rC = (ss * rC0 - sc * rS0) / det;  // x ≈ rS·sin + rC·cos
+     const float yS = (cc * yS0 - sc * yC0) / det, yC = (ss * yC0 - sc * yS0) / det;
+     const float rAmp = sqrtf(rS * rS + rC * rC), yAmp = sqrtf(yS * yS + yC * yC);
+     if (rAmp <= 0.0f) return;
+
+     const float meanDtMs = w / bandSamples;
+     p.valid = meanDtMs > 0.0f && 1000.0f / (highHz * meanDtMs) >= 2.5f;
+     p.gain = yAmp / rAmp;
+
+     float phase = (atan2f(yC, yS) - atan2f(rC, rS)) * (360.0f / TWO_PI);
+     while (phase > 180.0f) phase -= 360.0f;
+     while (phase <= -180.0f) phase += 360.0f;
+     for (int8_t b = static_cast<int8_t>(index) - 1; b >= 0; b--) {
+         if (!result.bands[b].samples) continue;
+         float previous = result.bands[b].phaseDeg;  // déroulée : continuité avec la bande précédente
+         while (phase - previous > 180.0f) phase -= 360.0f;
+         while (phase - previous < -180.0f) phase += 360.0f;
+         break;
+     }
+     p.phaseDeg = phase;
+     p.delayMs = (p.hz > 0.0f) ? -phase / (360.0f * p.hz) * 1000.0f : 0.0f;
+ }
+
+ void ResponseAnalyzer::summarize() {
+     float dead = 0.0f, rise = 0.0f;
+     uint8_t deadCount = 0, riseCount = 0;
+     result.maxOvershootPct = 0.0f;
+     result.maxSettlingTimeMs = 0.0f;
+     for (uint8_t i = 0; i < result.stepCount; i++) {
+         const StepMetrics& m = result.steps[i];
+         if (!m.valid) continue;
+         if (m.deadTimeMs >= 0.0f) { dead += m.deadTimeMs; deadCount++; }
+         if (m.riseTimeMs >= 0.0f) { rise += m.riseTimeMs; riseCount++; }
+         if (m.overshootPct > result.maxOvershootPct) result.maxOvershootPct = m.overshootPct;
+         if (m.settlingTimeMs < 0.0f || result.maxSettlingTimeMs < 0.0f) result.maxSettlingTimeMs = -1.0f;
+         else if (m.settlingTimeMs > result.maxSettlingTimeMs) result.maxSettlingTimeMs = m.settlingTimeMs;
+     }
+     result.meanDeadTimeMs = deadCount ? dead / deadCount : -1.0f;
+     result.meanRiseTimeMs = riseCount ? rise / riseCount : -1.0f;
+
+     // Bande passante : premier passage sous -3 dB du gain de la bande la plus basse, interpolé en log(f)
+     result.bandwidthHz = 0.0f;
+     const FrequencyPoint* reference = nullptr;
+     const FrequencyPoint* previous = nullptr;
+     for (uint8_t b = 0; b < result.bandCount; b++) {
+         const FrequencyPoint& p = result.bands[b];
+         if (!p.valid) continue;
+         if (!reference) {
+             reference = previous = &p;
+             continue;
+         }
+         const float threshold = reference->gain * 0.7071f;
+         if (p.gain < threshold) {
+             float fraction = (previous->gain - threshold) / (previous->gain - p.gain);
+             result.bandwidthHz = previous->hz * powf(p.hz / previous->hz, fraction);
+             break;
+         }
+         previous = &p;
+     }
+ }
+
+ // --- Séquenceur ---
+
+ ResponseTest::ResponseTest(const ResponseTestConfig& cfg)
+     : analyzer(cfg),
+       running(false),
+       complete(false),
+       startMs(0)
+ {
+ }
+
+ void ResponseTest::start(const ResponseTestConfig& cfg, uint32_t nowMs) {
+     analyzer.configure(cfg);
+     running = true;
+     complete = false;
+     startMs = nowMs;
+ }
+
+ void ResponseTest::abort() {
+     if (running) analyzer.finish();  // résultat partiel conservé
+     running = false;
+ }
+
+ float ResponseTest::getSetpoint(uint32_t nowMs) const {
+     return analyzer.getProgram().setpointAt(nowMs - startMs);
+ }
+
+ void ResponseTest::tick(uint32_t nowMs, float reference, float measured, bool valid) {
+     if (!running) return;
+     uint32_t elapsed = nowMs - startMs;
+     if (elapsed >= analyzer.getProgram().getDurationMs()) {
+         analyzer.finish();
+         running = false;
+         complete = true;
+         return;
+     }
+     if (valid) analyzer.push(elapsed, reference, measured);
+ }
+
+ #ifdef ERGO_HOST
+
+ void responseTestPrint(FILE* out, const ResponseTestResult& r, const char* unit) {
+     fprintf(out, "échelon        de → à (%s)      mesure finale   retard ms   montée ms   dépassement   établi ms   erreur\n", unit);
+     for (uint8_t i = 0; i < r.stepCount; i++) {
+         const StepMetrics& m = r.steps[i];
+         fprintf(out, "  %u  %9.2f → %-9.2f %12.2f", i, m.from, m.to, m.final);
+         if (!m.valid) {
+             fprintf(out, "   (pas de réponse exploitable, %u points)\n", m.samples);
+             continue;
+         }
+         fprintf(out, " %11.0f %11.0f %12.1f %%", m.deadTimeMs, m.riseTimeMs, m.overshootPct);
+         if (m.settlingTimeMs >= 0.0f) fprintf(out, " %11.0f", m.settlingTimeMs);
+         else fprintf(out, " %11s", "non établi");
+         fprintf(out, " %8.2f\n", m.steadyStateError);
+     }
+     if (r.bandCount) fprintf(out, "bande      f Hz        gain      gain dB    phase °   retard ms   points\n");
+     for (uint8_t b = 0; b < r.bandCount; b++) {
+         const FrequencyPoint& p = r.bands[b];
+         fprintf(out, "  %u  %9.3f  %10.3f  %10.1f  %9.1f  %10.0f  %7u%s\n", b, p.hz, p.gain,
+                 p.gain > 0.0f ? 20.0f * log10f(p.gain) : -INFINITY, p.phaseDeg, p.delayMs, p.samples,
+                 p.valid ? "" : "  (sous-échantillonnée)");
+     }
+     fprintf(out, "synthèse : retard moyen %.0f ms, montée moyenne %.0f ms, dépassement max %.1f %%, ",
+             r.meanDeadTimeMs, r.meanRiseTimeMs, r.maxOvershootPct);
+     if (r.maxSettlingTimeMs >= 0.0f) fprintf(out, "établissement max %.0f ms, ", r.maxSettlingTimeMs);
+     else fprintf(out, "établissement : non atteint, ");
+     if (r.bandwidthHz > 0.0f) fprintf(out, "bande passante -3 dB %.2f Hz\n", r.bandwidthHz);
+     else fprintf(out, "bande passante -3 dB non atteinte\n");
+ }
+
+ #endif
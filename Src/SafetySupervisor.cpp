@@ -0,0 +1,166 @@
+/*
+ * SafetySupervisor.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #include "../Inc/SafetySupervisor.hpp"
+
+ SafetyConfig defaultSafetyConfig() {
+     SafetyConfig cfg;
+     cfg.fetDerateStartC = 70.0f;
+     cfg.fetLimitC = 90.0f;
+     cfg.motorDerateStartC = 80.0f;
+     cfg.motorLimitC = 110.0f;
+
+     cfg.maxCurrent = 20.0f;
+     cfg.stallCurrent = 8.0f;
+     cfg.stallCadence = 2.0f;
+     cfg.stallMs = 2000;
+     cfg.telemetryTimeoutMs = 500;   // 5 ticks de 100 ms sans trame valide...
+     cfg.telemetryMaxMissed = 3;     // ...et au moins 3 trames perdues quand la boucle est plus lente
+     cfg.rampDownRate = 6.0f;        // même rampe par défaut que stop()
+     cfg.tickSeconds = 0.1f;
+     return cfg;
+ }
+
+ SafetySupervisor::SafetySupervisor(const SafetyConfig& cfg)
+     : config(cfg),
+       faults(FAULT_NONE),
+       derating(1.0f),
+       lastOutput(0.0f),
+       lastTelemetryMs(0),
+       lastEvalMs(0),
+       tickSeconds(cfg.tickSeconds),
+       missedFrames(0),
+       stallSinceMs(0),
+       stallTiming(false),
+       started(false),
+       events{},
+       eventHead(0),
+       eventCount(0) {}
+
+ float SafetySupervisor::derate(float temp, float start, float limit) {
+     if (temp <= start) return 1.0f;
+     if (temp >= limit) return 0.0f;
+     return (limit - temp) / (limit - start);
+ }
+
+ uint8_t SafetySupervisor::activeConditions(const SafetyInputs& in, float values[RULE_COUNT]) const
+ // Une évaluation par règle, toujours les mêmes : coût constant quel que soit l'état
+ {
+     uint8_t active = FAULT_NONE;
+
+     uint32_t age = in.nowMs - lastTelemetryMs;
+     values[4] = static_cast<float>(age);
+     if (age > config.telemetryTimeoutMs && missedFrames > config.telemetryMaxMissed) active |= FAULT_COMMS_LOSS;
+
+     // Sans trame fraîche, les mesures ci-dessous sont anciennes : seule la perte de liaison compte
+     if (!in.telemetryFresh) return active;
+
+     values[0] = in.tempFet;
+     values[1] = in.tempMotor;
+     values[2] = in.current;
+     values[3] = in.current;
+
+     if (in.tempFet >= config.fetLimitC) active |= FAULT_OVER_TEMP_FET;
+     if (in.tempMotor >= config.motorLimitC) active |= FAULT_OVER_TEMP_MOTOR;
+     if (fabsf(in.current) > config.maxCurrent) active |= FAULT_OVERCURRENT;
+     if (stallTiming && in.nowMs - stallSinceMs >= config.stallMs) active |= FAULT_STALL;
+
+     return active;
+ }
+
+ void SafetySupervisor::evaluate(const SafetyInputs& in) {
+     if (!started) {
+         lastTelemetryMs = in.nowMs;  // le délai de perte de liaison démarre au premier tick
+         lastEvalMs = in.nowMs;
+         started = true;
+     }
+
+     // Période réelle de la boucle : 100 ms sur le banc, bien plus avec l'écran à 9600 bauds
+     uint32_t elapsedMs = in.nowMs - lastEvalMs;
+     if (elapsedMs > 0) tickSeconds = static_cast<float>(elapsedMs) * 0.001f;
+     lastEvalMs = in.nowMs;
+
+     if (in.telemetryFresh) {
+         lastTelemetryMs = in.nowMs;
+         missedFrames = 0;
+
+         float fetFactor = derate(in.tempFet, config.fetDerateStartC, config.fetLimitC);
+         float motorFactor = derate(in.tempMotor, config.motorDerateStartC, config.motorLimitC);
+         derating = (fetFactor < motorFactor) ? fetFactor : motorFactor;
+
+         // Blocage : fort courant sans que le pédalier ne tourne, chronométré
+         bool stalled = fabsf(in.current) > config.stallCurrent && fabsf(in.cadence) < config.stallCadence;
+         if (stalled && !stallTiming) {
+             stallSinceMs = in.nowMs;
+         }
+         stallTiming = stalled;
+     } else if (missedFrames < 0xFF) {
+         missedFrames++;
+     }
+
+     float values[RULE_COUNT] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+     uint8_t active = activeConditions(in, values);
+
+     // Journal : seulement sur front montant, avec horodatage
+     uint8_t newFaults = active & ~faults;
+     for (uint8_t i = 0; i < RULE_COUNT; i++) {
+         uint8_t bit = static_cast<uint8_t>(1u << i);
+         if (newFaults & bit) logEvent(in.nowMs, bit, values[i]);
+     }
+
+     faults |= active;  // verrouillé jusqu'à clearFaults()
+ }
+
+ float SafetySupervisor::limitCurrent(float requested) {
+     if (isTripped()) {
+         // Repli contrôlé vers 0 A, un pas par tick (comme stop() mais sans bloquer), en A/s quelle que soit la période
+         float step = config.rampDownRate * tickSeconds;
+         if (lastOutput > step) lastOutput -= step;
+         else if (lastOutput < -step) lastOutput += step;
+         else lastOutput = 0.0f;
+         return lastOutput;
+     }
+
+     float limit = config.maxCurrent * derating;
+     if (requested > limit) requested = limit;
+     if (requested < -limit) requested = -limit;
+
+     lastOutput = requested;
+     return requested;
+ }
+
+ bool SafetySupervisor::clearFaults(const SafetyInputs& in) {
+     float values[RULE_COUNT];
+     if (activeConditions(in, values) != FAULT_NONE) return false;
+
+     faults = FAULT_NONE;
+     stallTiming = false;
+     missedFrames = 0;
+     return true;
+ }
+
+ void SafetySupervisor::logEvent(uint32_t nowMs, uint8_t fault, float value) {
+     events[eventHead] = {nowMs, fault, value};
+     eventHead = (eventHead + 1) % LOG_SIZE;
+     if (eventCount < LOG_SIZE) eventCount++;
+ }
+
+ const SafetyEvent& SafetySupervisor::getEvent(uint8_t i) const {
+     uint8_t oldest = (eventHead + LOG_SIZE - eventCount) % LOG_SIZE;
+     return events[(oldest + i) % LOG_SIZE];
+ }
+
+ const char* SafetySupervisor::faultName(uint8_t fault) {
+     switch (fault) {
+         case FAULT_OVER_TEMP_FET:   return "Surchauffe FET";
+         case FAULT_OVER_TEMP_MOTOR: return "Surchauffe moteur";
+         case FAULT_OVERCURRENT:     return "Surintensite";
+         case FAULT_STALL:           return "Moteur bloque";
+         case FAULT_COMMS_LOSS:      return "Perte liaison VESC";
+         default:                    return "Aucun";
+     }
+ }
@@ -9,7 +9,7 @@
  #include "../Inc/ScreenDisplay.hpp"
 
 
- ScreenDisplay::ScreenDisplay(UART_HandleTypeDef* EcranUart) : ecran_uart(EcranUart) {}
+ ScreenDisplay::ScreenDisplay(UART_HandleTypeDef* EcranUart) : ecran_uart(EcranUart), readOk(false) {}
  
  void ScreenDisplay::sendCommand(const char* cmd) {
      HAL_UART_Transmit(ecran_uart, (uint8_t*)cmd, strlen(cmd), HAL_MAX_DELAY);
@@ -77,6 +77,16 @@
      sendText("err", message);  // champ texte nommé "err"
  }
  
+ void ScreenDisplay::showSessionSummary(const SessionSummary& s) {
+     char line[48];
+     uint32_t minutes = s.elapsedMs / 60000u;
+     uint32_t seconds = (s.elapsedMs / 1000u) % 60u;
+     snprintf(line, sizeof(line), "%lu:%02lu %.1f kJ moy %.0f W NP %.0f W max %.0f Nm",
+              static_cast<unsigned long>(minutes), static_cast<unsigned long>(seconds),
+              s.energyJ / 1000.0f, s.averagePower, s.normalizedPower, s.peakTorque);
+     sendText("bilan", line);  // champ texte nommé "bilan"
+ }
+
  void ScreenDisplay::showWelcome() {
      sendText("t0", "Ergocycle S2M Ready!");
  }
@@ -90,11 +100,13 @@
     uint8_t response[8]; //On crée un tableau pour recevoir jusqu’à 8 octets en provenance de l’écran Nextion, via l’UART
 
     //La réponse ressemble à ça: 0x71 [val0] [val1] [val2] [val3] 0xFF 0xFF 0xFF avec de val0 à val3 le message qui nous interesse cdé en little indian
+    readOk = false;  // -1 est aussi une valeur légitime : seul readOk distingue l'échec
     if (HAL_UART_Receive(ecran_uart, response, 8, 100) != HAL_OK) {
         return -1;
     }
 
     if (response[0] != 0x71) return -1;  
+    readOk = true;
 
     int32_t value = (response[1]) |
                     (response[2] << 8) |
@@ -134,7 +146,9 @@ ControlMode ScreenDisplay::getMode() {
         case 2: return ControlMode::POWER_CONCENTRIC;
         case 3: return ControlMode::POWER_ECCENTRIC;
         case 4: return ControlMode::LINEAR;
-        default: return ControlMode::CADENCE;  // valeur par défaut si erreur
+        default:
+            readOk = false;  // valeur hors liste : lecture rejetée, pas un choix de l'utilisateur
+            return ControlMode::CADENCE;
     }
 }
 
@@ -154,7 +168,7 @@ void ScreenDisplay::showDutyCycle(float duty) {
 }
 
 void ScreenDisplay::showDirection(DirectionMode dir) {
-    const char* label = (dir_show == DirectionMode::REVERSE) ? "REVERSE" : "FORWARD";
+    const char* label = (dir == DirectionMode::REVERSE) ? "REVERSE" : "FORWARD";
     sendText("dir_show", label);
 }
 
@@ -168,6 +182,7 @@ bool ScreenDisplay::getStop() {
 DirectionMode ScreenDisplay::getDirection() {
     sendCommand("get dir.val");     // dir
     int32_t value = readInt32();    // Lecture 0 ou 1
+    if (value != 0 && value != 1) readOk = false;
     return (value == 1) ? DirectionMode::REVERSE : DirectionMode::FORWARD;
 }
 
@@ -0,0 +1,153 @@
+/*
+ * SessionAnalytics.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #include "../Inc/SessionAnalytics.hpp"
+
+ #include <cmath>
+ #include <cstring>
+
+ AnalyticsConfig defaultAnalyticsConfig() {
+     // Zones de puissance pour la rééducation (puissances modestes), cadences d'usage courant
+     return AnalyticsConfig{{25.0f, 50.0f, 100.0f, 150.0f, 200.0f}, {20.0f, 40.0f, 60.0f, 80.0f, 100.0f}, 5.0f};
+ }
+
+ static uint8_t zoneOf(float value, const float* limits, uint8_t zones) {
+     uint8_t zone = 0;
+     while (zone < zones - 1 && value >= limits[zone]) zone++;
+     return zone;
+ }
+
+ static uint16_t secondsOf(uint32_t ms) {
+     uint32_t s = ms / 1000u;
+     return static_cast<uint16_t>((s > 0xFFFFu) ? 0xFFFFu : s);  // 18 h par zone
+ }
+
+ SessionAnalytics::SessionAnalytics(const AnalyticsConfig& cfg)
+     : config(cfg)
+ {
+     reset();
+ }
+
+ void SessionAnalytics::reset() {
+     started = false;
+     lastMs = 0;
+     elapsedMs = 0;
+     movingMs = 0;
+     energyJ = 0.0f;
+     peakTorque = 0.0f;
+     peakCadence = 0.0f;
+     peakPower3s = 0.0f;
+     binMs = 0;
+     binEnergy = 0.0f;
+     binCadence = 0.0f;
+     memset(bins, 0, sizeof(bins));
+     binIndex = 0;
+     binsClosed = 0;
+     sumShort = 0.0f;
+     sumLong = 0.0f;
+     np4Sum = 0.0;
+     np4Count = 0;
+     memset(powerZoneMs, 0, sizeof(powerZoneMs));
+     memset(cadenceZoneMs, 0, sizeof(cadenceZoneMs));
+ }
+
+ void SessionAnalytics::pause(uint32_t nowMs) {
+     lastMs = nowMs;
+     started = false;
+ }
+
+ void SessionAnalytics::update(uint32_t nowMs, float power, float torque, float cadence) {
+     power = fabsf(power);
+     torque = fabsf(torque);
+     cadence = fabsf(cadence);
+
+     if (torque > peakTorque) peakTorque = torque;
+     if (cadence > peakCadence) peakCadence = cadence;
+
+     uint32_t dt = nowMs - lastMs;
+     lastMs = nowMs;
+     if (!started || dt > MAX_GAP_MS) {  // premier tick ou trou : rien à intégrer sur cet intervalle
+         started = true;
+         return;
+     }
+
+     // Méthode des rectangles à droite : la valeur du tick vaut pour l'intervalle qui s'achève
+     elapsedMs += dt;
+     energyJ += power * dt * 0.001f;
+     if (cadence >= config.movingCadence) movingMs += dt;
+
+     // Répartition sur les cases d'une seconde (au plus trois avec MAX_GAP_MS = 2 s)
+     while (dt > 0) {
+         uint32_t part = BIN_MS - binMs;
+         if (part > dt) part = dt;
+         accumulate(part, power, cadence);
+         dt -= part;
+         if (binMs == BIN_MS) closeBin();
+     }
+ }
+
+ void SessionAnalytics::accumulate(uint32_t dt, float power, float cadence) {
+     binMs += dt;
+     binEnergy += power * dt * 0.001f;
+     binCadence += cadence * dt;
+ }
+
+ void SessionAnalytics::closeBin() {
+     const float power = binEnergy * (1000.0f / BIN_MS);  // W moyens sur la case
+     const float cadence = binCadence / BIN_MS;
+     binMs = 0;
+     binEnergy = 0.0f;
+     binCadence = 0.0f;
+
+     // Sortants : la case écrasée quitte la fenêtre longue, celle d'il y a 3 s la fenêtre courte
+     sumLong += power - bins[binIndex];
+     sumShort += power - bins[(binIndex + LONG_BINS - SHORT_BINS) % LONG_BINS];
+     bins[binIndex] = power;
+     binIndex = (binIndex + 1) % LONG_BINS;
+     binsClosed++;
+
+     // Les sommes glissantes dérivent d'un arrondi par case : recalcul complet une fois par tour (30 s)
+     if (binIndex == 0) {
+         sumLong = 0.0f;
+         for (uint8_t i = 0; i < LONG_BINS; i++) sumLong += bins[i];
+         sumShort = bins[LONG_BINS - 1] + bins[LONG_BINS - 2] + bins[LONG_BINS - 3];
+     }
+
+     const float p3 = average(sumShort, SHORT_BINS);
+     if (binsClosed >= SHORT_BINS && p3 > peakPower3s) peakPower3s = p3;
+     if (binsClosed >= LONG_BINS) {
+         double p30 = average(sumLong, LONG_BINS);
+         np4Sum += p30 * p30 * p30 * p30;
+         np4Count++;
+     }
+
+     powerZoneMs[zoneOf(p3, config.powerZoneLimits, ANALYTICS_POWER_ZONES)] += BIN_MS;
+     cadenceZoneMs[zoneOf(cadence, config.cadenceZoneLimits, ANALYTICS_CADENCE_ZONES)] += BIN_MS;
+ }
+
+ float SessionAnalytics::average(float sum, uint8_t window) const {
+     uint32_t n = (binsClosed < window) ? binsClosed : window;
+     float mean = n ? sum / n : 0.0f;
+     return (mean > 0.0f) ? mean : 0.0f;  // arrondi des sommes glissantes autour de 0 W
+ }
+
+ SessionSummary SessionAnalytics::getSummary() const {
+     SessionSummary s;
+     s.elapsedMs = elapsedMs;
+     s.movingMs = movingMs;
+     s.energyJ = energyJ;
+     s.averagePower = elapsedMs ? energyJ * 1000.0f / elapsedMs : 0.0f;
+     s.normalizedPower = np4Count ? static_cast<float>(sqrt(sqrt(np4Sum / np4Count))) : 0.0f;
+     s.power3s = average(sumShort, SHORT_BINS);
+     s.power30s = average(sumLong, LONG_BINS);
+     s.peakPower3s = peakPower3s;
+     s.peakTorque = peakTorque;
+     s.peakCadence = peakCadence;
+     for (uint8_t i = 0; i < ANALYTICS_POWER_ZONES; i++) s.powerZoneS[i] = secondsOf(powerZoneMs[i]);
+     for (uint8_t i = 0; i < ANALYTICS_CADENCE_ZONES; i++) s.cadenceZoneS[i] = secondsOf(cadenceZoneMs[i]);
+     return s;
+ }
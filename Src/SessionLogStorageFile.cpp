@@ -0,0 +1,44 @@
+/*
+ * SessionLogStorageFile.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #ifdef ERGO_HOST
+
+ #include "../Inc/SessionLogger.hpp"
+
+ FileLogStorage::FileLogStorage(const char* filePath)
+     : path(filePath), file(nullptr), present(true)
+ {
+ }
+
+ FileLogStorage::~FileLogStorage() {
+     close();
+ }
+
+ bool FileLogStorage::open() {
+     close();
+     file = fopen(path, "ab");
+     return file != nullptr;
+ }
+
+ uint32_t FileLogStorage::size() {
+     if (!file) return 0;
+     fseek(file, 0, SEEK_END);
+     return static_cast<uint32_t>(ftell(file));
+ }
+
+ bool FileLogStorage::write(const uint8_t* data, uint32_t len) {
+     if (!file || !present) return false;
+     if (fwrite(data, 1, len, file) != len) return false;
+     return fflush(file) == 0;  // même garantie que f_sync côté clé USB
+ }
+
+ void FileLogStorage::close() {
+     if (file) fclose(file);
+     file = nullptr;
+ }
+
+ #endif
@@ -0,0 +1,61 @@
+/*
+ * SessionLogStorageUsb.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #ifndef ERGO_HOST
+
+ #include <cstdio>
+
+ #include "../Inc/SessionLogger.hpp"
+ #include "fatfs.h"      // USBHFatFS, USBHFile, USBHPath (générés par CubeMX, FatFs sur USB Host MSC)
+ #include "usb_host.h"   // ApplicationTypeDef
+
+ // Défini dans usb_host.c : passe à APPLICATION_READY quand la classe MSC a énuméré la clé
+ extern ApplicationTypeDef Appli_state;
+
+ static const char LOG_FILE_NAME[] = "ERGO.LOG";  // nom 8.3 : pas besoin des noms longs FatFs
+
+ bool UsbLogStorage::isPresent() {
+     return Appli_state == APPLICATION_READY;
+ }
+
+ bool UsbLogStorage::open() {
+     close();
+     if (f_mount(&USBHFatFS, USBHPath, 1) != FR_OK) return false;
+     mounted = true;
+
+     char path[16];
+     snprintf(path, sizeof(path), "%s%s", USBHPath, LOG_FILE_NAME);
+     if (f_open(&USBHFile, path, FA_OPEN_APPEND | FA_WRITE) != FR_OK) {
+         close();
+         return false;
+     }
+     fileOpen = true;
+     return true;
+ }
+
+ uint32_t UsbLogStorage::size() {
+     return fileOpen ? static_cast<uint32_t>(f_size(&USBHFile)) : 0;
+ }
+
+ bool UsbLogStorage::write(const uint8_t* data, uint32_t len)
+ // Blocs de 4 Ko alignés sur les secteurs : FatFs écrit directement sur la clé, sans recopie dans son tampon
+ {
+     if (!fileOpen) return false;
+
+     UINT written = 0;
+     if (f_write(&USBHFile, data, len, &written) != FR_OK || written != len) return false;
+     return f_sync(&USBHFile) == FR_OK;  // FAT et taille à jour : un retrait ne perd que le bloc en cours
+ }
+
+ void UsbLogStorage::close() {
+     if (fileOpen) f_close(&USBHFile);  // peut échouer si la clé est déjà partie : sans importance
+     if (mounted) f_mount(nullptr, USBHPath, 0);
+     fileOpen = false;
+     mounted = false;
+ }
+
+ #endif
@@ -0,0 +1,222 @@
+/*
+ * SessionLogger.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #include "../Inc/SessionLogger.hpp"
+ #include "../Inc/SettingsStore.hpp"
+
+ #include <cstddef>
+ #include <cstring>
+
+ static const uint32_t CRC_OFFSET = offsetof(LogBlockHeader, crc);
+
+ static uint32_t blockCrc(const uint8_t* block)
+ // CRC32 du bloc avec le champ crc compté à 0 (chaîné en trois morceaux, sans copie du bloc)
+ {
+     static const uint8_t zero[4] = {0, 0, 0, 0};
+     uint32_t crc = SettingsStore::crc32(block, CRC_OFFSET);
+     crc = SettingsStore::crc32(zero, sizeof(zero), ~crc);
+     return SettingsStore::crc32(block + CRC_OFFSET + 4, LOG_BLOCK_SIZE - CRC_OFFSET - 4, ~crc);
+ }
+
+ bool logBlockIsValid(const uint8_t* block) {
+     LogBlockHeader header;
+     memcpy(&header, block, sizeof(header));
+     if (header.magic != LOG_BLOCK_MAGIC || header.version != LOG_BLOCK_VERSION) return false;
+     if (header.payloadBytes + header.summaryBytes > LOG_BLOCK_SIZE - sizeof(LogBlockHeader)) return false;
+     return blockCrc(block) == header.crc;
+ }
+
+ SessionLogger::SessionLogger(LogStorage& backend, TelemetryBuffer& telemetry, LogEncoding blockEncoding)
+     : storage(backend),
+       ring(telemetry),
+       filling(0),
+       pending(false),
+       fillCount(0),
+       fillBytes(0),
+       encoding(blockEncoding),
+       firstTickMs(0),
+       sessionId(0),
+       blockIndex(0),
+       lastOverruns(0),
+       opened(false),
+       started(false),
+       lastAttemptMs(0),
+       stats{0, 0, 0, 0, 0},
+       analytics(nullptr)
+ {
+ }
+
+ void SessionLogger::start(uint32_t id) {
+     if (opened) storage.close();  // ré-ouvert (et recalé sur un bloc) au prochain service()
+     opened = false;
+
+     sessionId = id;
+     blockIndex = 0;
+     filling = 0;
+     pending = false;
+     fillCount = 0;
+     fillBytes = 0;
+     encoder.reset();
+     lastOverruns = ring.getOverruns();
+     started = true;
+     lastAttemptMs = 0u - RETRY_MS;  // première tentative d'ouverture immédiate
+ }
+
+ void SessionLogger::service(uint32_t nowMs) {
+     if (!started) return;
+
+     if (opened && !storage.isPresent()) {
+         storage.close();  // clé retirée : les blocs restent en RAM, on réessaiera
+         opened = false;
+     }
+     if (!opened && storage.isPresent() && nowMs - lastAttemptMs >= RETRY_MS) {
+         lastAttemptMs = nowMs;
+         openStorage();
+     }
+
+     drainRing();
+     if (pending && opened) writePending();  // un seul bloc par appel : durée bornée
+ }
+
+ bool SessionLogger::flush() {
+     if (!started) return false;
+
+     drainRing();
+     if (pending) {
+         if (!opened || !writePending()) return false;
+     }
+     if (fillCount > 0) {
+         sealBlock();
+         if (!opened || !writePending()) return false;
+     }
+     return true;
+ }
+
+ bool SessionLogger::openStorage() {
+     if (!storage.open()) return false;
+
+     // Fin de fichier tronquée (clé arrachée pendant une écriture) : on se recale sur une frontière de bloc
+     uint32_t tail = storage.size() % LOG_BLOCK_SIZE;
+     if (tail) {
+         uint8_t padding[64];
+         memset(padding, 0, sizeof(padding));
+         for (uint32_t left = LOG_BLOCK_SIZE - tail; left > 0;) {
+             uint32_t chunk = (left < sizeof(padding)) ? left : sizeof(padding);
+             if (!storage.write(padding, chunk)) {
+                 storage.close();
+                 stats.writeErrors++;
+                 return false;
+             }
+             left -= chunk;
+         }
+     }
+
+     if (stats.blocksWritten > 0 || stats.writeErrors > 0) stats.reconnects++;
+     opened = true;
+     return true;
+ }
+
+ uint32_t SessionLogger::payloadCapacity() const {
+     return LOG_BLOCK_SIZE - sizeof(LogBlockHeader) - (analytics ? sizeof(SessionSummary) : 0);
+ }
+
+ void SessionLogger::drainRing() {
+     if (encoding == LOG_ENCODING_DELTA) drainDelta();
+     else drainRaw();
+ }
+
+ void SessionLogger::drainRaw() {
+     const uint32_t samples = payloadCapacity() / sizeof(TelemetrySample);
+     for (;;) {
+         if (fillCount >= samples) {
+             if (pending) return;  // les deux blocs sont pleins : la file garde le reste
+             sealBlock();
+         }
+
+         TelemetrySample* payload = reinterpret_cast<TelemetrySample*>(blocks[filling] + sizeof(LogBlockHeader));
+         uint32_t n = ring.drain(payload + fillCount, samples - fillCount);
+         if (n == 0) return;
+         fillCount += n;
+         fillBytes += n * sizeof(TelemetrySample);
+     }
+ }
+
+ void SessionLogger::drainDelta() {
+     const uint32_t capacity = payloadCapacity();
+     TelemetrySample sample;
+     for (;;) {
+         // Place garantie pour le pire cas avant de retirer un échantillon de la file
+         if (capacity - fillBytes < TELEMETRY_ENCODED_MAX) {
+             if (pending) return;
+             sealBlock();
+         }
+         if (!ring.pop(sample)) return;
+
+         if (fillCount == 0) {
+             firstTickMs = sample.tickMs;
+             encoder.reset();  // image clé : le bloc se décode seul
+         }
+         fillBytes += encoder.encode(sample, blocks[filling] + sizeof(LogBlockHeader) + fillBytes);
+         fillCount++;
+     }
+ }
+
+ void SessionLogger::sealBlock() {
+     uint8_t* block = blocks[filling];
+     memset(block + sizeof(LogBlockHeader) + fillBytes, 0, LOG_BLOCK_SIZE - sizeof(LogBlockHeader) - fillBytes);
+     if (encoding == LOG_ENCODING_RAW && fillCount) {
+         firstTickMs = reinterpret_cast<const TelemetrySample*>(block + sizeof(LogBlockHeader))->tickMs;
+     }
+
+     uint32_t overruns = ring.getOverruns();
+     LogBlockHeader header;
+     header.magic = LOG_BLOCK_MAGIC;
+     header.version = LOG_BLOCK_VERSION;
+     header.encoding = encoding;
+     header.recordCount = fillCount;
+     header.payloadBytes = fillBytes;
+     header.summaryBytes = 0;
+     if (analytics) {
+         SessionSummary summary = analytics->getSummary();
+         memcpy(block + LOG_BLOCK_SIZE - sizeof(summary), &summary, sizeof(summary));
+         header.summaryBytes = sizeof(summary);
+     }
+     header.sessionId = sessionId;
+     header.blockIndex = blockIndex++;
+     header.lostSamples = overruns - lastOverruns;
+     header.firstTickMs = fillCount ? firstTickMs : 0;
+     header.crc = 0;
+     memcpy(block, &header, sizeof(header));
+
+     header.crc = blockCrc(block);
+     memcpy(block + CRC_OFFSET, &header.crc, sizeof(header.crc));
+
+     stats.samplesLost += header.lostSamples;
+     lastOverruns = overruns;
+
+     pending = true;
+     filling ^= 1;
+     fillCount = 0;
+     fillBytes = 0;
+ }
+
+ bool SessionLogger::writePending() {
+     const uint8_t* block = blocks[filling ^ 1];
+     if (!storage.write(block, LOG_BLOCK_SIZE)) {
+         stats.writeErrors++;
+         storage.close();  // le bloc reste en attente, réécrit à la prochaine ouverture
+         opened = false;
+         return false;
+     }
+
+     LogBlockHeader header;
+     memcpy(&header, block, sizeof(header));
+     stats.blocksWritten++;
+     stats.samplesLogged += header.recordCount;
+     pending = false;
+     return true;
+ }
@@ -0,0 +1,74 @@
+/*
+ * SettingsStorageFile.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #ifdef ERGO_HOST
+
+ #include "../Inc/SettingsStore.hpp"
+
+ FileFlashStorage::FileFlashStorage(const char* path, uint32_t sectorSize)
+     : file(nullptr), size(sectorSize), eraseCount{0, 0}
+ {
+     file = fopen(path, "r+b");
+     if (!file) {
+         // Nouveau fichier : contenu "effacé" (0xFF) comme une flash neuve
+         file = fopen(path, "w+b");
+         if (file) {
+             eraseSector(0);
+             eraseSector(1);
+             eraseCount[0] = eraseCount[1] = 0;
+         }
+     }
+ }
+
+ FileFlashStorage::~FileFlashStorage() {
+     if (file) fclose(file);
+ }
+
+ bool FileFlashStorage::eraseSector(uint8_t sector) {
+     if (!file || sector > 1) return false;
+
+     uint8_t blank[256];
+     memset(blank, 0xFF, sizeof(blank));
+
+     if (fseek(file, static_cast<long>(sector) * size, SEEK_SET) != 0) return false;
+     for (uint32_t done = 0; done < size; done += sizeof(blank)) {
+         uint32_t chunk = (size - done < sizeof(blank)) ? size - done : sizeof(blank);
+         if (fwrite(blank, 1, chunk, file) != chunk) return false;
+     }
+
+     eraseCount[sector]++;
+     return fflush(file) == 0;
+ }
+
+ bool FileFlashStorage::program(uint8_t sector, uint32_t offset, const uint8_t* data, uint32_t len)
+ // Règle NOR : un bit ne peut que passer de 1 à 0 sans effacement, on fait donc un ET avec l'existant
+ {
+     if (!file || sector > 1 || (len % 4) != 0 || offset + len > size) return false;
+
+     uint8_t current[64];
+     for (uint32_t done = 0; done < len; done += sizeof(current)) {
+         uint32_t chunk = (len - done < sizeof(current)) ? len - done : sizeof(current);
+         long position = static_cast<long>(sector) * size + offset + done;
+
+         if (fseek(file, position, SEEK_SET) != 0) return false;
+         if (fread(current, 1, chunk, file) != chunk) return false;
+         for (uint32_t i = 0; i < chunk; i++) current[i] &= data[done + i];
+
+         if (fseek(file, position, SEEK_SET) != 0) return false;
+         if (fwrite(current, 1, chunk, file) != chunk) return false;
+     }
+
+     return fflush(file) == 0;
+ }
+
+ bool FileFlashStorage::read(uint8_t sector, uint32_t offset, uint8_t* data, uint32_t len) {
+     if (!file || sector > 1 || offset + len > size) return false;
+     if (fseek(file, static_cast<long>(sector) * size + offset, SEEK_SET) != 0) return false;
+     return fread(data, 1, len, file) == len;
+ }
+
+ #endif
@@ -0,0 +1,64 @@
+/*
+ * SettingsStorageFlash.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #ifndef ERGO_HOST
+
+ #include "../Inc/SettingsStore.hpp"
+ #include "stm32f4xx_hal.h"
+
+ #define SETTINGS_SECTOR_A_ADDR  0x080C0000u  // secteur 10
+ #define SETTINGS_SECTOR_B_ADDR  0x080E0000u  // secteur 11
+
+ uint32_t Stm32FlashStorage::baseAddress(uint8_t sector) {
+     return (sector == 0) ? SETTINGS_SECTOR_A_ADDR : SETTINGS_SECTOR_B_ADDR;
+ }
+
+ bool Stm32FlashStorage::eraseSector(uint8_t sector)
+ // Effacement d'un secteur de 128 Ko : ~1 à 2 s, appelé seulement au formatage ou au compactage
+ {
+     if (sector > 1) return false;
+
+     FLASH_EraseInitTypeDef erase = {};
+     erase.TypeErase = FLASH_TYPEERASE_SECTORS;
+     erase.Sector = (sector == 0) ? FLASH_SECTOR_10 : FLASH_SECTOR_11;
+     erase.NbSectors = 1;
+     erase.VoltageRange = FLASH_VOLTAGE_RANGE_3;  // 2.7 V - 3.6 V : effacement par mots de 32 bits
+
+     uint32_t sectorError = 0;
+     HAL_FLASH_Unlock();
+     HAL_StatusTypeDef status = HAL_FLASHEx_Erase(&erase, &sectorError);
+     HAL_FLASH_Lock();
+
+     return status == HAL_OK;
+ }
+
+ bool Stm32FlashStorage::program(uint8_t sector, uint32_t offset, const uint8_t* data, uint32_t len) {
+     if (sector > 1 || (len % 4) != 0 || offset + len > sectorSize()) return false;
+
+     uint32_t address = baseAddress(sector) + offset;
+     bool ok = true;
+
+     HAL_FLASH_Unlock();
+     for (uint32_t i = 0; i < len && ok; i += 4) {
+         uint32_t word;
+         memcpy(&word, &data[i], 4);  // data n'est pas forcément aligné
+         ok = (HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, address + i, word) == HAL_OK);
+     }
+     HAL_FLASH_Lock();
+
+     return ok;
+ }
+
+ bool Stm32FlashStorage::read(uint8_t sector, uint32_t offset, uint8_t* data, uint32_t len) {
+     if (sector > 1 || offset + len > sectorSize()) return false;
+
+     // La flash est mappée en mémoire : lecture directe
+     memcpy(data, reinterpret_cast<const void*>(baseAddress(sector) + offset), len);
+     return true;
+ }
+
+ #endif
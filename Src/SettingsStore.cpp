@@ -0,0 +1,212 @@
+/*
+ * SettingsStore.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #include "../Inc/SettingsStore.hpp"
+
+ SettingsStore::SettingsStore(SettingsStorage& backend)
+     : storage(backend),
+       activeSector(0),
+       generation(0),
+       writeOffset(HEADER_SIZE),
+       sequence(0),
+       deferCompaction(false)
+ {
+     memset(values, 0, sizeof(values));
+     memset(present, 0, sizeof(present));
+ }
+
+ uint32_t SettingsStore::crc32(const uint8_t* data, uint32_t len, uint32_t crc)
+ // CRC-32 IEEE bit à bit : pas de table, quelques octets seulement sont hachés par écriture
+ {
+     for (uint32_t i = 0; i < len; i++) {
+         crc ^= data[i];
+         for (uint8_t bit = 0; bit < 8; bit++) {
+             crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+         }
+     }
+     return ~crc;
+ }
+
+ bool SettingsStore::readHeader(uint8_t sector, SectorHeader& header) {
+     if (!storage.read(sector, 0, reinterpret_cast<uint8_t*>(&header), HEADER_SIZE)) return false;
+     if (header.magic != SECTOR_MAGIC) return false;
+     return crc32(reinterpret_cast<const uint8_t*>(&header), 12) == header.crc;
+ }
+
+ bool SettingsStore::writeHeader(uint8_t sector, uint32_t gen) {
+     SectorHeader header = {SECTOR_MAGIC, gen, 0xFFFFFFFFu, 0};
+     header.crc = crc32(reinterpret_cast<const uint8_t*>(&header), 12);
+     return storage.program(sector, 0, reinterpret_cast<const uint8_t*>(&header), HEADER_SIZE);
+ }
+
+ bool SettingsStore::mount() {
+     memset(present, 0, sizeof(present));
+
+     SectorHeader h0, h1;
+     bool valid0 = readHeader(0, h0);
+     bool valid1 = readHeader(1, h1);
+
+     if (!valid0 && !valid1) return format();
+
+     // Secteur actif = génération la plus récente (l'autre est l'ancienne copie avant compactage)
+     if (valid0 && (!valid1 || h0.generation > h1.generation)) {
+         activeSector = 0;
+         generation = h0.generation;
+     } else {
+         activeSector = 1;
+         generation = h1.generation;
+     }
+
+     scanSector(activeSector);
+     return true;
+ }
+
+ void SettingsStore::scanSector(uint8_t sector)
+ // Parcours unique au démarrage : le dernier enregistrement valide d'une clé gagne
+ {
+     const uint32_t size = storage.sectorSize();
+     uint32_t offset = HEADER_SIZE;
+     sequence = 0;
+
+     while (offset + RECORD_SIZE <= size) {
+         Record rec;
+         if (!storage.read(sector, offset, reinterpret_cast<uint8_t*>(&rec), RECORD_SIZE)) break;
+         if (rec.key == KEY_ERASED) break;  // fin du journal
+
+         offset += RECORD_SIZE;
+
+         // CRC faux = écriture interrompue par une coupure : on l'ignore et on continue
+         if (crc32(reinterpret_cast<const uint8_t*>(&rec), 12) != rec.crc) continue;
+         if (rec.key == 0 || rec.key >= KEY_COUNT) continue;
+
+         values[rec.key] = rec.value;
+         present[rec.key] = true;
+         if (rec.sequence >= sequence) sequence = rec.sequence + 1;
+     }
+
+     writeOffset = offset;
+ }
+
+ bool SettingsStore::format() {
+     activeSector = 0;
+     generation = 1;
+     writeOffset = HEADER_SIZE;
+     sequence = 0;
+
+     if (!storage.eraseSector(0)) return false;
+     return writeHeader(0, generation);
+ }
+
+ bool SettingsStore::appendRecord(uint16_t key, uint32_t raw) {
+     Record rec = {key, 0xFFFF, raw, sequence, 0};
+     rec.crc = crc32(reinterpret_cast<const uint8_t*>(&rec), 12);
+
+     if (!storage.program(activeSector, writeOffset, reinterpret_cast<const uint8_t*>(&rec), RECORD_SIZE)) {
+         // Emplacement à moitié programmé : y réécrire donnerait un ET des deux enregistrements.
+         // Clé mise à 0 (toujours possible sur NOR) pour que mount() ne le prenne pas pour la fin
+         // du journal, puis on passe à l'emplacement suivant ; son CRC faux le fait ignorer.
+         const uint8_t consumed[4] = {0, 0, 0, 0};
+         storage.program(activeSector, writeOffset, consumed, sizeof(consumed));
+         Record check;
+         if (storage.read(activeSector, writeOffset, reinterpret_cast<uint8_t*>(&check), RECORD_SIZE) &&
+             check.key != KEY_ERASED) {
+             writeOffset += RECORD_SIZE;  // sinon l'emplacement est resté vierge : on le réessaiera
+         }
+         return false;
+     }
+
+     writeOffset += RECORD_SIZE;
+     sequence++;
+     return true;
+ }
+
+ bool SettingsStore::compactionPending() const
+ // Plus la place d'un enregistrement par clé : le prochain set() doit compacter
+ {
+     uint32_t reserve = static_cast<uint32_t>(KEY_COUNT) * RECORD_SIZE;
+     return writeOffset + RECORD_SIZE + reserve > storage.sectorSize();
+ }
+
+ bool SettingsStore::compact()
+ // Recopie les valeurs courantes dans l'autre secteur. L'en-tête est écrit en dernier :
+ // une coupure pendant la copie laisse l'ancien secteur actif et intact. En cas d'échec,
+ // l'état RAM revient lui aussi sur l'ancien secteur (les écritures continuent dans sa réserve).
+ {
+     const uint8_t previousSector = activeSector;
+     const uint32_t previousOffset = writeOffset;
+     const uint32_t previousSequence = sequence;
+
+     uint8_t target = activeSector ^ 1u;
+     if (!storage.eraseSector(target)) return false;
+
+     activeSector = target;
+     writeOffset = HEADER_SIZE;
+
+     bool ok = true;
+     for (uint8_t key = 1; ok && key < KEY_COUNT; key++) {
+         if (present[key]) ok = appendRecord(key, values[key]);
+     }
+     if (ok) ok = writeHeader(target, generation + 1);
+
+     if (!ok) {
+         activeSector = previousSector;
+         writeOffset = previousOffset;
+         sequence = previousSequence;
+         return false;
+     }
+
+     generation++;
+     return true;
+ }
+
+ bool SettingsStore::set(SettingKey key, uint32_t raw) {
+     uint8_t index = static_cast<uint8_t>(key);
+     if (index == 0 || index >= KEY_COUNT) return false;
+     if (present[index] && values[index] == raw) return true;  // inchangé : aucune écriture
+
+     // Compactage seulement quand il ne reste plus la place d'un enregistrement par clé
+     if (compactionPending()) {
+         if (!deferCompaction) {
+             if (!compact()) return false;
+         } else if (writeOffset + RECORD_SIZE > storage.sectorSize()) {
+             return false;  // réserve épuisée : on attend le compactage du propriétaire
+         }
+     }
+
+     if (!appendRecord(index, raw)) return false;
+
+     values[index] = raw;
+     present[index] = true;
+     return true;
+ }
+
+ bool SettingsStore::has(SettingKey key) const {
+     uint8_t index = static_cast<uint8_t>(key);
+     return index < KEY_COUNT && present[index];
+ }
+
+ float SettingsStore::getFloat(SettingKey key, float defaultValue) const {
+     if (!has(key)) return defaultValue;
+     float value;
+     memcpy(&value, &values[static_cast<uint8_t>(key)], sizeof(value));
+     return value;
+ }
+
+ int32_t SettingsStore::getInt(SettingKey key, int32_t defaultValue) const {
+     if (!has(key)) return defaultValue;
+     return static_cast<int32_t>(values[static_cast<uint8_t>(key)]);
+ }
+
+ bool SettingsStore::setFloat(SettingKey key, float value) {
+     uint32_t raw;
+     memcpy(&raw, &value, sizeof(raw));
+     return set(key, raw);
+ }
+
+ bool SettingsStore::setInt(SettingKey key, int32_t value) {
+     return set(key, static_cast<uint32_t>(value));
+ }
@@ -0,0 +1,184 @@
+/*
+ * SignalConditioning.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #include "../Inc/SignalConditioning.hpp"
+
+ // --- Biquad passe-bas ---
+
+ BiquadLowPass::BiquadLowPass()
+     : b0(1.0f), b1(0.0f), b2(0.0f), a1(0.0f), a2(0.0f), z1(0.0f), z2(0.0f) {}
+
+ void BiquadLowPass::configure(float cutoffHz, float sampleHz, float q)
+ // Coefficients RBJ (transformée bilinéaire), calculés une seule fois ici et pas à chaque échantillon
+ {
+     if (cutoffHz <= 0.0f || sampleHz <= 0.0f || cutoffHz >= 0.5f * sampleHz) {
+         // Coupure invalide (au-delà de Nyquist) → filtre transparent
+         b0 = 1.0f; b1 = 0.0f; b2 = 0.0f; a1 = 0.0f; a2 = 0.0f;
+         return;
+     }
+
+     float w0 = 2.0f * static_cast<float>(M_PI) * cutoffHz / sampleHz;
+     float cosw = cosf(w0);
+     float alpha = sinf(w0) / (2.0f * q);
+     float a0 = 1.0f + alpha;
+
+     b0 = ((1.0f - cosw) * 0.5f) / a0;
+     b1 = (1.0f - cosw) / a0;
+     b2 = b0;
+     a1 = (-2.0f * cosw) / a0;
+     a2 = (1.0f - alpha) / a0;
+ }
+
+ void BiquadLowPass::reset(float value)
+ // Place le filtre en régime établi sur "value" (gain statique = 1)
+ {
+     z1 = value * (1.0f - b0);
+     z2 = value * (b2 - a2);
+ }
+
+ float BiquadLowPass::process(float x) {
+     float y = b0 * x + z1;
+     z1 = b1 * x - a1 * y + z2;
+     z2 = b2 * x - a2 * y;
+     return y;
+ }
+
+ // --- Médiane 3 ---
+
+ MedianFilter3::MedianFilter3() : window{0.0f, 0.0f, 0.0f}, index(0) {}
+
+ void MedianFilter3::reset(float value) {
+     window[0] = window[1] = window[2] = value;
+     index = 0;
+ }
+
+ float MedianFilter3::process(float x) {
+     window[index] = x;
+     index = (index + 1) % 3;
+
+     float a = window[0], b = window[1], c = window[2];
+     // Médiane sans tri : 3 comparaisons au plus
+     if (a > b) { float t = a; a = b; b = t; }
+     if (b > c) { b = c; }
+     return (a > b) ? a : b;
+ }
+
+ // --- Tracker alpha-beta ---
+
+ AlphaBetaTracker::AlphaBetaTracker()
+     : alpha(0.5f), beta(0.1f), dt(0.1f), estimate(0.0f), rate(0.0f) {}
+
+ void AlphaBetaTracker::configure(float a, float b, float period) {
+     alpha = a;
+     beta = b;
+     dt = (period > 0.0f) ? period : 0.1f;
+ }
+
+ void AlphaBetaTracker::reset(float value) {
+     estimate = value;
+     rate = 0.0f;
+ }
+
+ float AlphaBetaTracker::process(float x) {
+     float predicted = estimate + rate * dt;  // prédiction
+     float residual = x - predicted;          // innovation
+     estimate = predicted + alpha * residual;
+     rate += (beta / dt) * residual;
+     return estimate;
+ }
+
+ // --- Canal ---
+
+ SignalChannel::SignalChannel()
+     : config{false, FilterType::NONE, 0.0f, 0.0f, 0.0f},
+       value(0.0f),
+       previous(0.0f),
+       sampleHz(10.0f),
+       primed(false) {}
+
+ void SignalChannel::configure(const ChannelConfig& cfg, float hz) {
+     config = cfg;
+     sampleHz = hz;
+     lowpass.configure(cfg.cutoffHz, hz);
+     tracker.configure(cfg.alpha, cfg.beta, 1.0f / hz);
+     primed = false;  // les états seront réinitialisés au prochain échantillon
+ }
+
+ float SignalChannel::process(float x) {
+     if (!primed) {
+         median.reset(x);
+         lowpass.reset(x);
+         tracker.reset(x);
+         value = previous = x;
+         primed = true;
+         return value;
+     }
+
+     float y = config.medianEnabled ? median.process(x) : x;
+
+     switch (config.filter) {
+         case FilterType::BIQUAD_LOWPASS:
+             y = lowpass.process(y);
+             break;
+         case FilterType::ALPHA_BETA:
+             y = tracker.process(y);
+             break;
+         default:
+             break;
+     }
+
+     previous = value;
+     value = y;
+     return value;
+ }
+
+ float SignalChannel::getRate() const {
+     if (config.filter == FilterType::ALPHA_BETA) return tracker.getRate();
+     return (value - previous) * sampleHz;
+ }
+
+ // --- Conditionneur ---
+
+ ConditioningConfig defaultConditioningConfig() {
+     ConditioningConfig cfg;
+     cfg.polePairs = 1.0f;             // à renseigner selon le moteur
+     cfg.reductionRatio = 15.0f / 0.39f;
+     cfg.sampleHz = 10.0f;             // boucle principale toutes les 100 ms
+
+     cfg.cadence = {true, FilterType::ALPHA_BETA, 0.0f, 0.5f, 0.1f};
+     cfg.current = {true, FilterType::BIQUAD_LOWPASS, 2.0f, 0.0f, 0.0f};
+     cfg.duty    = {false, FilterType::NONE, 0.0f, 0.0f, 0.0f};
+     return cfg;
+ }
+
+ SignalConditioner::SignalConditioner(const ConditioningConfig& cfg) {
+     configure(cfg);
+ }
+
+ void SignalConditioner::configure(const ConditioningConfig& cfg) {
+     config = cfg;
+     erpmPerCadence = cfg.polePairs * cfg.reductionRatio;
+     if (erpmPerCadence <= 0.0f) erpmPerCadence = 1.0f;  // sécurité : pas de division par zéro
+
+     cadence.configure(cfg.cadence, cfg.sampleHz);
+     current.configure(cfg.current, cfg.sampleHz);
+     duty.configure(cfg.duty, cfg.sampleHz);
+ }
+
+ void SignalConditioner::update(float erpm, float motorCurrent, float dutyCycle) {
+     cadence.process(erpmToCadence(erpm));
+     current.process(motorCurrent);
+     duty.process(dutyCycle);
+ }
+
+ float SignalConditioner::erpmToCadence(float erpm) const {
+     return erpm / erpmPerCadence;
+ }
+
+ float SignalConditioner::cadenceToErpm(float cadenceRpm) const {
+     return cadenceRpm * erpmPerCadence;
+ }
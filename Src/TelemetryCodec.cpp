@@ -0,0 +1,99 @@
+/*
+ * TelemetryCodec.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #include "../Inc/TelemetryCodec.hpp"
+
+ #include <cmath>
+
+ const float telemetryResolution[TELEMETRY_CHANNELS] = {
+     1.0f,      // tick (ms)
+     0.01f,     // consigne
+     0.01f,     // cadence (tr/min)
+     0.001f,    // courant mesuré (A)
+     0.001f,    // courant commandé (A)
+     0.0001f,   // rapport cyclique
+     0.01f,     // tension (V)
+     1.0f,      // mode
+     1.0f,      // drapeaux
+     1.0f       // défauts
+ };
+
+ static int32_t quantize(float value, TelemetryChannel channel)
+ // Saturée : une valeur aberrante (NaN, infini) ne doit pas casser le flux delta
+ {
+     float scaled = value / telemetryResolution[channel];
+     if (!(scaled > -2.0e9f)) return (scaled != scaled) ? 0 : -2000000000;
+     if (scaled > 2.0e9f) return 2000000000;
+     return static_cast<int32_t>(lrintf(scaled));
+ }
+
+ void telemetryQuantize(const TelemetrySample& s, TelemetryQuantized& out) {
+     out.q[TELEMETRY_CH_TICK] = static_cast<int32_t>(s.tickMs);
+     out.q[TELEMETRY_CH_SETPOINT] = quantize(s.setpoint, TELEMETRY_CH_SETPOINT);
+     out.q[TELEMETRY_CH_CADENCE] = quantize(s.cadence, TELEMETRY_CH_CADENCE);
+     out.q[TELEMETRY_CH_CURRENT] = quantize(s.current, TELEMETRY_CH_CURRENT);
+     out.q[TELEMETRY_CH_APPLIED_CURRENT] = quantize(s.appliedCurrent, TELEMETRY_CH_APPLIED_CURRENT);
+     out.q[TELEMETRY_CH_DUTY] = quantize(s.dutyCycle, TELEMETRY_CH_DUTY);
+     out.q[TELEMETRY_CH_VOLTAGE] = quantize(s.inputVoltage, TELEMETRY_CH_VOLTAGE);
+     out.q[TELEMETRY_CH_MODE] = s.mode;
+     out.q[TELEMETRY_CH_FLAGS] = s.flags;
+     out.q[TELEMETRY_CH_FAULTS] = s.faults;
+ }
+
+ void telemetryDequantize(const TelemetryQuantized& in, TelemetrySample& s) {
+     s.tickMs = static_cast<uint32_t>(in.q[TELEMETRY_CH_TICK]);
+     s.setpoint = in.q[TELEMETRY_CH_SETPOINT] * telemetryResolution[TELEMETRY_CH_SETPOINT];
+     s.cadence = in.q[TELEMETRY_CH_CADENCE] * telemetryResolution[TELEMETRY_CH_CADENCE];
+     s.current = in.q[TELEMETRY_CH_CURRENT] * telemetryResolution[TELEMETRY_CH_CURRENT];
+     s.appliedCurrent = in.q[TELEMETRY_CH_APPLIED_CURRENT] * telemetryResolution[TELEMETRY_CH_APPLIED_CURRENT];
+     s.dutyCycle = in.q[TELEMETRY_CH_DUTY] * telemetryResolution[TELEMETRY_CH_DUTY];
+     s.inputVoltage = in.q[TELEMETRY_CH_VOLTAGE] * telemetryResolution[TELEMETRY_CH_VOLTAGE];
+     s.mode = static_cast<uint8_t>(in.q[TELEMETRY_CH_MODE]);
+     s.flags = static_cast<uint8_t>(in.q[TELEMETRY_CH_FLAGS]);
+     s.faults = static_cast<uint8_t>(in.q[TELEMETRY_CH_FAULTS]);
+     s.reserved = 0;
+ }
+
+ void TelemetryEncoder::reset() {
+     for (int32_t& q : previous.q) q = 0;
+ }
+
+ uint32_t TelemetryEncoder::encode(const TelemetrySample& sample, uint8_t* out) {
+     TelemetryQuantized current;
+     telemetryQuantize(sample, current);
+
+     uint8_t* p = out;
+     // Le tick ne fait qu'avancer : écart non signé, 1 octet jusqu'à 127 ms
+     p = varintEncode(static_cast<uint32_t>(current.q[0]) - static_cast<uint32_t>(previous.q[0]), p);
+     for (uint8_t ch = 1; ch < TELEMETRY_CHANNELS; ch++) {
+         uint32_t delta = static_cast<uint32_t>(current.q[ch]) - static_cast<uint32_t>(previous.q[ch]);
+         p = varintEncode(zigzagEncode(static_cast<int32_t>(delta)), p);
+     }
+
+     previous = current;
+     return static_cast<uint32_t>(p - out);
+ }
+
+ void TelemetryDecoder::reset() {
+     for (int32_t& q : previous.q) q = 0;
+ }
+
+ const uint8_t* TelemetryDecoder::decode(const uint8_t* in, const uint8_t* end, TelemetryQuantized& out) {
+     uint32_t v;
+     in = varintDecode(in, end, v);
+     if (!in) return nullptr;
+     out.q[0] = static_cast<int32_t>(static_cast<uint32_t>(previous.q[0]) + v);
+
+     for (uint8_t ch = 1; ch < TELEMETRY_CHANNELS; ch++) {
+         in = varintDecode(in, end, v);
+         if (!in) return nullptr;
+         out.q[ch] = static_cast<int32_t>(static_cast<uint32_t>(previous.q[ch]) + static_cast<uint32_t>(zigzagDecode(v)));
+     }
+
+     previous = out;
+     return in;
+ }
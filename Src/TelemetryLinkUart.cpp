@@ -0,0 +1,82 @@
+/*
+ * TelemetryLinkUart.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #include "../Inc/TelemetryStream.hpp"
+
+ #ifndef ERGO_HOST
+
+ // USART1 : interruption globale activée dans CubeMX (NVIC), sans DMA
+
+ void UartTelemetryLink::start() {
+     HAL_UART_Receive_IT(huart, &rxByte, 1);
+ }
+
+ void UartTelemetryLink::onRxComplete(UART_HandleTypeDef* from)
+ // Sous interruption : un octet dans la file, réception ré-armée ; file pleine = octet perdu (CRC KO au PC)
+ {
+     if (from != huart) return;
+     uint32_t head = rxHead;
+     if (head - rxTail < RX_SIZE) {
+         rx[head & (RX_SIZE - 1)] = rxByte;
+         rxHead = head + 1;
+     }
+     HAL_UART_Receive_IT(huart, &rxByte, 1);
+ }
+
+ void UartTelemetryLink::onError(UART_HandleTypeDef* from)
+ // Sous interruption : sur overrun la HAL abandonne la réception, qui ne serait plus jamais ré-armée
+ {
+     if (from != huart) return;
+     errors++;
+     __HAL_UART_CLEAR_OREFLAG(huart);  // F4 : lecture de SR puis de DR, efface aussi PE/FE/NE
+     HAL_UART_Receive_IT(huart, &rxByte, 1);  // HAL_BUSY si la réception est restée active (PE/FE/NE)
+ }
+
+ bool UartTelemetryLink::isTxReady() {
+     return huart->gState == HAL_UART_STATE_READY;
+ }
+
+ bool UartTelemetryLink::write(const uint8_t* data, uint32_t len) {
+     return HAL_UART_Transmit_IT(huart, const_cast<uint8_t*>(data), static_cast<uint16_t>(len)) == HAL_OK;
+ }
+
+ uint32_t UartTelemetryLink::read(uint8_t* data, uint32_t maxLen) {
+     uint32_t tail = rxTail;
+     uint32_t n = 0;
+     while (n < maxLen && tail != rxHead) {
+         data[n++] = rx[tail & (RX_SIZE - 1)];
+         tail++;
+     }
+     rxTail = tail;
+     return n;
+ }
+
+ #else
+ #include "HostHal.hpp"
+
+ // PC : le HostUartDevice (pty, port série) fait office de tampon d'émission et de réception
+
+ void UartTelemetryLink::start() {}
+
+ void UartTelemetryLink::onRxComplete(UART_HandleTypeDef*) {}
+
+ void UartTelemetryLink::onError(UART_HandleTypeDef*) {}
+
+ bool UartTelemetryLink::isTxReady() {
+     return huart->device != nullptr;
+ }
+
+ bool UartTelemetryLink::write(const uint8_t* data, uint32_t len) {
+     return huart->device->write(data, static_cast<uint16_t>(len));
+ }
+
+ uint32_t UartTelemetryLink::read(uint8_t* data, uint32_t maxLen) {
+     if (!huart->device) return 0;
+     return huart->device->read(data, static_cast<uint16_t>(maxLen), 0);
+ }
+
+ #endif
@@ -0,0 +1,465 @@
+/*
+ * TelemetryStream.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #include "../Inc/TelemetryStream.hpp"
+ #include "../Inc/LoopProfiler.hpp"
+
+ #include <cstring>
+
+ // --- Octets petit-boutistes ---
+
+ static uint8_t* put16(uint8_t* p, uint16_t v) {
+     p[0] = static_cast<uint8_t>(v);
+     p[1] = static_cast<uint8_t>(v >> 8);
+     return p + 2;
+ }
+
+ static uint8_t* put32(uint8_t* p, uint32_t v) {
+     for (int i = 0; i < 4; i++) p[i] = static_cast<uint8_t>(v >> (8 * i));
+     return p + 4;
+ }
+
+ static uint8_t* putFloat(uint8_t* p, float v) {
+     uint32_t bits;
+     memcpy(&bits, &v, sizeof(bits));
+     return put32(p, bits);
+ }
+
+ static uint16_t get16(const uint8_t* p) {
+     return static_cast<uint16_t>(p[0] | (p[1] << 8));
+ }
+
+ static uint32_t get32(const uint8_t* p) {
+     return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+            (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+ }
+
+ static float getFloat(const uint8_t* p) {
+     uint32_t bits = get32(p);
+     float v;
+     memcpy(&v, &bits, sizeof(v));
+     return v;
+ }
+
+ // --- Trames ---
+
+ uint16_t telemetryFrameCrc(const uint8_t* data, uint32_t len)
+ // CRC-16/XMODEM bit à bit, comme la trame VESC : une quarantaine d'octets par trame
+ {
+     uint16_t crc = 0;
+     for (uint32_t i = 0; i < len; i++) {
+         crc ^= static_cast<uint16_t>(data[i]) << 8;
+         for (uint8_t bit = 0; bit < 8; bit++) {
+             crc = (crc & 0x8000u) ? static_cast<uint16_t>((crc << 1) ^ 0x1021u) : static_cast<uint16_t>(crc << 1);
+         }
+     }
+     return crc;
+ }
+
+ uint32_t cobsEncode(const uint8_t* in, uint32_t len, uint8_t* out) {
+     uint8_t* code = out;      // octet de longueur du groupe en cours
+     uint8_t* p = out + 1;
+     uint8_t run = 1;
+     for (uint32_t i = 0; i < len; i++) {
+         if (in[i] == 0) {
+             *code = run;
+             code = p++;
+             run = 1;
+             continue;
+         }
+         *p++ = in[i];
+         if (++run == 0xFF) {  // groupe plein : 254 octets non nuls
+             *code = run;
+             code = p++;
+             run = 1;
+         }
+     }
+     *code = run;
+     return static_cast<uint32_t>(p - out);
+ }
+
+ uint32_t cobsDecode(const uint8_t* in, uint32_t len, uint8_t* out, uint32_t outSize) {
+     uint32_t i = 0, n = 0;
+     while (i < len) {
+         uint8_t code = in[i++];
+         if (code == 0 || i + code - 1 > len) return 0;
+         for (uint8_t k = 1; k < code; k++) {
+             if (n >= outSize || in[i] == 0) return 0;
+             out[n++] = in[i++];
+         }
+         if (code != 0xFF && i < len) {
+             if (n >= outSize) return 0;
+             out[n++] = 0;
+         }
+     }
+     return n;
+ }
+
+ uint32_t telemetryFrameBuild(uint8_t type, const uint8_t* body, uint32_t bodyLen, uint8_t* out) {
+     uint8_t frame[TELEMETRY_FRAME_MAX];
+     if (bodyLen > sizeof(frame) - 3) return 0;
+
+     frame[0] = type;
+     memcpy(frame + 1, body, bodyLen);
+     put16(frame + 1 + bodyLen, telemetryFrameCrc(frame, bodyLen + 1));
+
+     uint32_t n = cobsEncode(frame, bodyLen + 3, out);
+     out[n++] = 0;
+     return n;
+ }
+
+ uint32_t telemetrySampleBody(const TelemetrySample& s, uint16_t channels, uint16_t seq, uint16_t lost, uint8_t* out) {
+     uint8_t* p = put16(out, seq);
+     p = put16(p, lost);
+     p = put16(p, channels);
+
+     if (channels & (1u << TELEMETRY_CH_TICK)) p = put32(p, s.tickMs);
+     if (channels & (1u << TELEMETRY_CH_SETPOINT)) p = putFloat(p, s.setpoint);
+     if (channels & (1u << TELEMETRY_CH_CADENCE)) p = putFloat(p, s.cadence);
+     if (channels & (1u << TELEMETRY_CH_CURRENT)) p = putFloat(p, s.current);
+     if (channels & (1u << TELEMETRY_CH_APPLIED_CURRENT)) p = putFloat(p, s.appliedCurrent);
+     if (channels & (1u << TELEMETRY_CH_DUTY)) p = putFloat(p, s.dutyCycle);
+     if (channels & (1u << TELEMETRY_CH_VOLTAGE)) p = putFloat(p, s.inputVoltage);
+     if (channels & (1u << TELEMETRY_CH_MODE)) *p++ = s.mode;
+     if (channels & (1u << TELEMETRY_CH_FLAGS)) *p++ = s.flags;
+     if (channels & (1u << TELEMETRY_CH_FAULTS)) *p++ = s.faults;
+     return static_cast<uint32_t>(p - out);
+ }
+
+ static uint32_t sampleBodyLength(uint16_t channels) {
+     uint32_t len = 6;
+     for (uint8_t ch = 0; ch < TELEMETRY_CHANNELS; ch++) {
+         if (channels & (1u << ch)) len += (ch < TELEMETRY_CH_MODE) ? 4 : 1;
+     }
+     return len;
+ }
+
+ bool telemetrySampleParse(const uint8_t* body, uint32_t len, TelemetrySample& s,
+                           uint16_t& channels, uint16_t& seq, uint16_t& lost)
+ {
+     if (len < 6) return false;
+     seq = get16(body);
+     lost = get16(body + 2);
+     channels = get16(body + 4);
+     if ((channels & ~TELEMETRY_STREAM_ALL_CHANNELS) || len != sampleBodyLength(channels)) return false;
+
+     memset(&s, 0, sizeof(s));
+     const uint8_t* p = body + 6;
+     if (channels & (1u << TELEMETRY_CH_TICK)) { s.tickMs = get32(p); p += 4; }
+     if (channels & (1u << TELEMETRY_CH_SETPOINT)) { s.setpoint = getFloat(p); p += 4; }
+     if (channels & (1u << TELEMETRY_CH_CADENCE)) { s.cadence = getFloat(p); p += 4; }
+     if (channels & (1u << TELEMETRY_CH_CURRENT)) { s.current = getFloat(p); p += 4; }
+     if (channels & (1u << TELEMETRY_CH_APPLIED_CURRENT)) { s.appliedCurrent = getFloat(p); p += 4; }
+     if (channels & (1u << TELEMETRY_CH_DUTY)) { s.dutyCycle = getFloat(p); p += 4; }
+     if (channels & (1u << TELEMETRY_CH_VOLTAGE)) { s.inputVoltage = getFloat(p); p += 4; }
+     if (channels & (1u << TELEMETRY_CH_MODE)) s.mode = *p++;
+     if (channels & (1u << TELEMETRY_CH_FLAGS)) s.flags = *p++;
+     if (channels & (1u << TELEMETRY_CH_FAULTS)) s.faults = *p++;
+     return true;
+ }
+
+ uint32_t telemetryStatusBody(const TelemetryStreamStatus& status, uint8_t* out) {
+     uint8_t* p = out;
+     *p++ = status.command;
+     *p++ = status.result;
+     p = put16(p, status.decimation);
+     p = put16(p, status.channels);
+     p = put32(p, status.framesSent);
+     p = put32(p, status.framesDropped);
+     p = put32(p, status.rxErrors);
+     p = put32(p, status.linkErrors);
+     return static_cast<uint32_t>(p - out);
+ }
+
+ bool telemetryStatusParse(const uint8_t* body, uint32_t len, TelemetryStreamStatus& status) {
+     if (len != 22) return false;
+     status.command = body[0];
+     status.result = body[1];
+     status.decimation = get16(body + 2);
+     status.channels = get16(body + 4);
+     status.framesSent = get32(body + 6);
+     status.framesDropped = get32(body + 10);
+     status.rxErrors = get32(body + 14);
+     status.linkErrors = get32(body + 18);
+     return true;
+ }
+
+ uint32_t telemetryProfileBody(const TelemetryProfileFrame& profile, uint8_t* out) {
+     uint8_t* p = out;
+     *p++ = profile.zone;
+     p = put16(p, profile.unitsPerUs);
+     p = put32(p, profile.count);
+     p = put32(p, profile.min);
+     p = put32(p, profile.max);
+     p = put32(p, profile.mean);
+     *p++ = profile.firstBin;
+     for (uint8_t i = 0; i < TELEMETRY_PROFILE_BINS; i++) p = put16(p, profile.bins[i]);
+     return static_cast<uint32_t>(p - out);
+ }
+
+ bool telemetryProfileParse(const uint8_t* body, uint32_t len, TelemetryProfileFrame& profile) {
+     if (len != 20 + 2 * TELEMETRY_PROFILE_BINS) return false;
+     profile.zone = body[0];
+     profile.unitsPerUs = get16(body + 1);
+     profile.count = get32(body + 3);
+     profile.min = get32(body + 7);
+     profile.max = get32(body + 11);
+     profile.mean = get32(body + 15);
+     profile.firstBin = body[19];
+     for (uint8_t i = 0; i < TELEMETRY_PROFILE_BINS; i++) profile.bins[i] = get16(body + 20 + 2 * i);
+     return true;
+ }
+
+ uint32_t telemetryWatchdogBody(const TelemetryWatchdogFrame& w, uint8_t* out)
+ // 42 octets : la trame complète tient dans TELEMETRY_FRAME_MAX ; le CRC du post-mortem n'est pas transmis
+ {
+     uint8_t* p = out;
+     p = put32(p, w.stats.timeoutMs);
+     p = put32(p, w.stats.warningMs);
+     p = put32(p, w.stats.lastIntervalMs);
+     p = put32(p, w.stats.worstIntervalMs);
+     *p++ = w.stats.worstTask;
+     p = put32(p, w.stats.worstTaskMs);
+     p = put32(p, w.stats.nearMisses);
+     *p++ = w.stats.nearMissTask;
+     p = put32(p, w.stats.refreshes);
+     *p++ = w.watchdogReset;
+     *p++ = (w.previous.magic == WATCHDOG_RECORD_MAGIC) ? 1 : 0;
+     *p++ = w.previous.task;
+     *p++ = w.previous.armed;
+     p = put32(p, w.previous.uptimeMs);
+     p = put32(p, w.previous.sinceRefreshMs);
+     return static_cast<uint32_t>(p - out);
+ }
+
+ bool telemetryWatchdogParse(const uint8_t* body, uint32_t len, TelemetryWatchdogFrame& w) {
+     if (len != 42) return false;
+     memset(&w, 0, sizeof(w));
+     w.stats.timeoutMs = get32(body);
+     w.stats.warningMs = get32(body + 4);
+     w.stats.lastIntervalMs = get32(body + 8);
+     w.stats.worstIntervalMs = get32(body + 12);
+     w.stats.worstTask = body[16];
+     w.stats.worstTaskMs = get32(body + 17);
+     w.stats.nearMisses = get32(body + 21);
+     w.stats.nearMissTask = body[25];
+     w.stats.refreshes = get32(body + 26);
+     w.watchdogReset = body[30];
+     w.previous.magic = body[31] ? WATCHDOG_RECORD_MAGIC : 0;
+     w.previous.task = body[32];
+     w.previous.armed = body[33];
+     w.previous.uptimeMs = get32(body + 34);
+     w.previous.sinceRefreshMs = get32(body + 38);
+     return true;
+ }
+
+ bool TelemetryFrameReader::push(uint8_t b) {
+     if (b != 0) {
+         if (length < sizeof(raw)) raw[length++] = b;
+         else overflow = true;
+         return false;
+     }
+
+     // Délimiteur : fin de trame
+     uint32_t n = length;
+     bool tooLong = overflow;
+     length = 0;
+     overflow = false;
+     if (n == 0) return false;  // délimiteurs consécutifs (recalage)
+
+     uint32_t decodedLength = tooLong ? 0 : cobsDecode(raw, n, decoded, sizeof(decoded));
+     if (decodedLength < 3 || get16(decoded + decodedLength - 2) != telemetryFrameCrc(decoded, decodedLength - 2)) {
+         errors++;
+         return false;
+     }
+     frameLength = decodedLength - 2;
+     return true;
+ }
+
+ // --- Émetteur ---
+
+ TelemetryStream::TelemetryStream(TelemetryLink& output, TelemetryBuffer& telemetry)
+     : link(output),
+       ring(telemetry),
+       txLength(0),
+       filling(0),
+       decimation(1),
+       channels(TELEMETRY_STREAM_ALL_CHANNELS),
+       decimationCount(0),
+       sequence(0),
+       lostSinceLast(0),
+       lastOverruns(0),
+       framesSent(0),
+       framesDropped(0),
+       profileNext(PROFILE_ZONES),
+       profileReset(false),
+       watchdog(nullptr)
+ {
+ }
+
+ void TelemetryStream::configure(uint16_t rate, uint16_t mask) {
+     decimation = (rate > TELEMETRY_STREAM_MAX_DECIMATION) ? TELEMETRY_STREAM_MAX_DECIMATION : rate;
+     channels = mask & TELEMETRY_STREAM_ALL_CHANNELS;
+     decimationCount = 0;
+ }
+
+ TelemetryStreamStatus TelemetryStream::getStatus(uint8_t command, uint8_t result) const {
+     return TelemetryStreamStatus{command, result, decimation, channels, framesSent, framesDropped, reader.getErrors(),
+                                  link.getErrors()};
+ }
+
+ void TelemetryStream::service() {
+     handleCommands();
+
+     uint32_t overruns = ring.getOverruns();
+     countLost(overruns - lastOverruns);
+     lastOverruns = overruns;
+
+     TelemetrySample sample;
+     uint8_t body[TELEMETRY_FRAME_MAX];
+     while (ring.pop(sample)) {
+         if (decimation == 0) continue;  // pause : la file est vidée sans rien émettre
+         if (++decimationCount < decimation) continue;
+         decimationCount = 0;
+
+         uint32_t len = telemetrySampleBody(sample, channels, sequence, lostSinceLast, body);
+         if (queueFrame(TELEMETRY_FRAME_SAMPLE, body, len)) {
+             sequence++;
+             lostSinceLast = 0;
+         } else {
+             framesDropped++;
+             countLost(1);
+         }
+     }
+
+     queueProfile();
+     flushTx();
+ }
+
+ void TelemetryStream::queueProfile()
+ // Une zone par trame, autant que le tampon d'émission en accepte ; la suite au prochain service()
+ {
+ #ifdef ERGO_PROFILE
+     while (profileNext < PROFILE_ZONES) {
+         ProfileZoneStats& z = profileZones[profileNext];
+
+         TelemetryProfileFrame frame;
+         frame.zone = profileNext;
+         frame.unitsPerUs = static_cast<uint16_t>(profilerUnitsPerMicrosecond());
+         frame.count = z.count;
+         frame.min = z.count ? z.min : 0;
+         frame.max = z.max;
+         frame.mean = z.count ? static_cast<uint32_t>(z.total / z.count) : 0;
+         frame.firstBin = 0;
+         while (frame.firstBin < PROFILE_HISTOGRAM_BINS - TELEMETRY_PROFILE_BINS && z.histogram[frame.firstBin] == 0) {
+             frame.firstBin++;
+         }
+         for (uint8_t i = 0; i < TELEMETRY_PROFILE_BINS; i++) {
+             uint32_t n = z.histogram[frame.firstBin + i];
+             frame.bins[i] = static_cast<uint16_t>((n > 0xFFFFu) ? 0xFFFFu : n);
+         }
+
+         uint8_t body[TELEMETRY_FRAME_MAX];
+         if (!queueFrame(TELEMETRY_FRAME_PROFILE, body, telemetryProfileBody(frame, body))) return;
+         if (profileReset) {
+             memset(&z, 0, sizeof(z));
+             z.min = 0xFFFFFFFFu;
+         }
+         profileNext++;
+     }
+ #endif
+ }
+
+ void TelemetryStream::countLost(uint32_t n) {
+     uint32_t total = lostSinceLast + n;
+     lostSinceLast = (total > 0xFFFFu) ? 0xFFFFu : static_cast<uint16_t>(total);  // saturé : champ de 16 bits
+ }
+
+ void TelemetryStream::handleCommands() {
+     uint8_t bytes[16];
+     for (;;) {
+         uint32_t n = link.read(bytes, sizeof(bytes));
+         if (n == 0) return;
+         for (uint32_t i = 0; i < n; i++) {
+             if (reader.push(bytes[i])) handleCommand(reader.frame(), reader.getFrameLength());
+         }
+     }
+ }
+
+ void TelemetryStream::handleCommand(const uint8_t* frame, uint32_t len) {
+     const uint8_t type = frame[0];
+     const uint8_t* body = frame + 1;
+     const uint32_t bodyLen = len - 1;
+     uint8_t result = TELEMETRY_CMD_OK;
+
+     switch (type) {
+         case TELEMETRY_CMD_SET_DECIMATION:
+             if (bodyLen != 2) result = TELEMETRY_CMD_BAD_LENGTH;
+             else if (get16(body) > TELEMETRY_STREAM_MAX_DECIMATION) result = TELEMETRY_CMD_BAD_VALUE;
+             else configure(get16(body), channels);
+             break;
+         case TELEMETRY_CMD_SUBSCRIBE:
+             if (bodyLen != 2) result = TELEMETRY_CMD_BAD_LENGTH;
+             else if (get16(body) & ~TELEMETRY_STREAM_ALL_CHANNELS) result = TELEMETRY_CMD_BAD_VALUE;
+             else configure(decimation, get16(body));
+             break;
+         case TELEMETRY_CMD_GET_STATUS:
+             if (bodyLen != 0) result = TELEMETRY_CMD_BAD_LENGTH;
+             break;
+         case TELEMETRY_CMD_GET_PROFILE:
+ #ifdef ERGO_PROFILE
+             if (bodyLen != 1) result = TELEMETRY_CMD_BAD_LENGTH;
+             else {
+                 profileNext = 0;  // zones envoyées après cette réponse, au fil des service()
+                 profileReset = (body[0] != 0);
+             }
+ #else
+             result = TELEMETRY_CMD_UNAVAILABLE;
+ #endif
+             break;
+         case TELEMETRY_CMD_GET_WATCHDOG:
+             if (bodyLen != 0) result = TELEMETRY_CMD_BAD_LENGTH;
+             else if (!watchdog) result = TELEMETRY_CMD_UNAVAILABLE;
+             break;
+         default:
+             result = TELEMETRY_CMD_UNKNOWN;
+             break;
+     }
+
+     // Toute commande reçoit l'état courant en réponse : le PC sait si elle a été appliquée
+     uint8_t reply[TELEMETRY_FRAME_MAX];
+     uint32_t n = telemetryStatusBody(getStatus(type, result), reply);
+     if (!queueFrame(TELEMETRY_FRAME_STATUS, reply, n)) framesDropped++;
+
+     if (type == TELEMETRY_CMD_GET_WATCHDOG && result == TELEMETRY_CMD_OK) {
+         TelemetryWatchdogFrame frame;
+         frame.stats = watchdog->getStats();
+         frame.watchdogReset = watchdog->hadWatchdogReset() ? 1 : 0;
+         frame.previous = watchdog->getPreviousReset();
+         n = telemetryWatchdogBody(frame, reply);
+         if (!queueFrame(TELEMETRY_FRAME_WATCHDOG, reply, n)) framesDropped++;
+     }
+ }
+
+ bool TelemetryStream::queueFrame(uint8_t type, const uint8_t* body, uint32_t bodyLen) {
+     if (txLength + TELEMETRY_FRAME_ENCODED_MAX > TX_BUFFER_SIZE) {
+         flushTx();  // l'UART a peut-être fini entre-temps
+         if (txLength + TELEMETRY_FRAME_ENCODED_MAX > TX_BUFFER_SIZE) return false;
+     }
+     uint32_t n = telemetryFrameBuild(type, body, bodyLen, tx[filling] + txLength);
+     if (n == 0) return false;
+     txLength += n;
+     framesSent++;
+     return true;
+ }
+
+ void TelemetryStream::flushTx() {
+     if (txLength == 0 || !link.isTxReady()) return;
+     if (!link.write(tx[filling], txLength)) return;  // réessayé au prochain appel
+     filling ^= 1;  // tx[filling ^ 1] appartient à l'UART jusqu'à la fin de l'envoi
+     txLength = 0;
+ }
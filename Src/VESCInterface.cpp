@@ -1,14 +1,13 @@
 #include "../Inc/VESCInterface.hpp"
 
-//C'est VESCI qui décide
-#define COMM_SET_CURRENT    5
-#define COMM_SET_RPM        8
+//Identifiants de l'énumération COMM_PACKET_ID du firmware VESC (bldc, datatypes.h) ; 5 = COMM_SET_DUTY
 #define COMM_GET_VALUES     4
+#define COMM_SET_CURRENT    6
+#define COMM_SET_RPM        8
 
 VESCInterface::VESCInterface(UART_HandleTypeDef* ControlUart)
-    : control_uart(ControlUart), rpm(0.0f), inputCurrent(0.0f), dutyCycle(0.0f) 
+    : control_uart(ControlUart), rpm(0.0f), inputCurrent(0.0f), dutyCycle(0.0f), values{} 
     {
-        screen = new ScreenDisplay(screen_uart);
     }
 
 void VESCInterface::setCurrent(float current) 
@@ -55,78 +54,39 @@ bool VESCInterface::getValues()
     if (!receivePacket(rxBuffer, len)) return false;
 
     if (rxBuffer[0] != COMM_GET_VALUES) return false; //rxBuffer[0] n’est pas le 1er octet total de la trame C’est le 1er octet du payload
+    if (len < GET_VALUES_MIN_LEN) return false;       //trame tronquée : on ne décode pas au-delà de ce qui a été reçu
 
     uint8_t* ptr = &rxBuffer[1]; //On fait pointer ptr vers la première donnée utile
 
-    ptr += 4;  //  saute Temp FET
-    ptr += 4;  //  saute Temp moteur
-    ptr += 4;  //  saute courant moteur
-    ptr += 4;  //  saute courant batterie (input current)
-    ptr += 4;  //  saute ID moteur
-    ptr += 4;  //  saute IQ moteur
-
-    //Après ces 6 sauts, ptr pointe maintenant vers le champ suivant : le RPM (encodé sur 4 octets)
-
-    int32_t rpmRaw = (ptr[0] << 24) | (ptr[1] << 16) | (ptr[2] << 8) | ptr[3];
-    rpm = static_cast<float>(rpmRaw);
+    //On décode toute la trame d'un coup : une seule transaction sert la commande ET l'affichage.
+    //Format du VESC (bldc, commands.c) : entiers big-endian en virgule fixe, largeur et échelle par champ
+    values.tempFet      = readInt16(ptr) / 10.0f;    ptr += 2;  //  Temp FET (°C ×10)
+    values.tempMotor    = readInt16(ptr) / 10.0f;    ptr += 2;  //  Temp moteur (°C ×10)
+    values.motorCurrent = readInt32(ptr) / 100.0f;   ptr += 4;  //  courant moteur (A ×100)
+    values.inputCurrent = readInt32(ptr) / 100.0f;   ptr += 4;  //  courant batterie (A ×100)
+    ptr += 4;  //  saute Id (A ×100)
+    ptr += 4;  //  saute Iq (A ×100)
+    values.dutyCycle    = readInt16(ptr) / 1000.0f;  ptr += 2;  //  duty cycle (×1000), AVANT le RPM
+    values.rpm          = static_cast<float>(readInt32(ptr)); ptr += 4;  //  ERPM
+    values.inputVoltage = readInt16(ptr) / 10.0f;               //  tension batterie (V ×10)
+    //Suivent Ah, Wh, tachymètre et code de défaut : inutilisés ici
+
+    rpm = values.rpm;
+    inputCurrent = values.inputCurrent;
+    dutyCycle = values.dutyCycle;
     return true;
 }
 
-float VESCInterface::getCurrent() {
-    uint8_t cmd = COMM_GET_VALUES;
-    sendPacket(&cmd, 1);
-
-    uint16_t len;
-    if (!receivePacket(rxBuffer, len)) return -1.0f;
-
-    if (rxBuffer[0] != COMM_GET_VALUES) return -1.0f;
-
-    uint8_t* ptr = &rxBuffer[1]; // Pointeur sur le début du payload (après code commande)
-
-    ptr += 4;  // Temp FET
-    ptr += 4;  // Temp motor
-    ptr += 4;  // Current motor
-
-    union {
-        float f;
-        uint8_t b[4];
-    } uCurrent;
-    /*Une union est un type spécial qui permet de partager la même zone mémoire entre plusieurs variables.
-    Ça veut dire que toutes les variables dans la union occupent le même espace mémoire, on peux accéder à ces données sous différentes formes.*/
-
-    uCurrent.b[0] = ptr[0];
-    uCurrent.b[1] = ptr[1];
-    uCurrent.b[2] = ptr[2];
-    uCurrent.b[3] = ptr[3];
-
-    return uCurrent.f;  // En ampères
+float VESCInterface::getCurrent()
+//Courant moteur de la trame complète : même décodage que getValues()
+{
+    if (!getValues()) return -1.0f;
+    return values.motorCurrent;  // En ampères
 }
 
 float VESCInterface::getDutyCycle() {
-    uint8_t cmd = COMM_GET_VALUES;
-    sendPacket(&cmd, 1);
-
-    uint16_t len;
-    if (!receivePacket(rxBuffer, len)) return -1.0f;
-    if (rxBuffer[0] != COMM_GET_VALUES) return -1.0f;
-
-    uint8_t* ptr = &rxBuffer[1];
-    ptr += 4 * 6;  // Skip to RPM
-    ptr += 4;      // RPM
-    ptr += 4;      // Input voltage. La tension de ta batterie
-
-    // Lecture du dutyCycle (4 octets float)
-    union {
-        float f;
-        uint8_t b[4];
-    } uDuty;
-
-    uDuty.b[0] = ptr[0];
-    uDuty.b[1] = ptr[1];
-    uDuty.b[2] = ptr[2];
-    uDuty.b[3] = ptr[3];
-
-    return uDuty.f;  // entre -1.0 et 1.0
+    if (!getValues()) return -1.0f;
+    return values.dutyCycle;  // entre -1.0 et 1.0
 }
 
 void VESCInterface::sendPacket(uint8_t* data, uint16_t len) {
@@ -156,6 +116,7 @@ bool VESCInterface::receivePacket(uint8_t* buffer, uint16_t& len, uint32_t timeo
 
     if (header[0] != 2) return false;
     len = header[1];
+    if (len + 3u > sizeof(rxBuffer)) return false; //trame plus longue que le tampon de réception
 
     if (HAL_UART_Receive(control_uart, buffer, len + 3, timeout) != HAL_OK) return false;
     /*On lit les len + 3 octets suivants:
@@ -181,3 +142,15 @@ uint16_t VESCInterface::crc16(const uint8_t* data, uint16_t len) {
     }
     return crc;
 }
+
+int16_t VESCInterface::readInt16(const uint8_t* ptr)
+//Entier 16 bits big-endian signé (températures, duty, tension)
+{
+    return static_cast<int16_t>((ptr[0] << 8) | ptr[1]);
+}
+
+int32_t VESCInterface::readInt32(const uint8_t* ptr)
+//Entier 32 bits big-endian, comme le RPM
+{
+    return static_cast<int32_t>((static_cast<uint32_t>(ptr[0]) << 24) | (ptr[1] << 16) | (ptr[2] << 8) | ptr[3]);
+}
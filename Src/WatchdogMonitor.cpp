@@ -0,0 +1,167 @@
+/*
+ * WatchdogMonitor.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Yasmine Salmouni
+ */
+
+ #include "../Inc/WatchdogMonitor.hpp"
+ #include "../Inc/SettingsStore.hpp"
+
+ #include <cstddef>
+ #include <cstring>
+
+ static const uint32_t LSI_MAX_HZ = 47000;  // LSI du STM32F407 : 17 à 47 kHz
+
+ static uint32_t recordCrc(const WatchdogPostMortem& record) {
+     return SettingsStore::crc32(reinterpret_cast<const uint8_t*>(&record), offsetof(WatchdogPostMortem, crc));
+ }
+
+ WatchdogMonitor::WatchdogMonitor(IWDG_HandleTypeDef* watchdog, uint32_t marginMs)
+     : hiwdg(watchdog),
+       warningMarginMs(marginMs),
+       stats{0, 0, 0, 0, WATCHDOG_NO_TASK, 0, 0, WATCHDOG_NO_TASK, 0},
+       previous{0, 0, 0, 0, WATCHDOG_NO_TASK, 0, 0, 0},
+       watchdogReset(false),
+       active(false),
+       lastRefreshMs(0),
+       lastIntervalMs(0),
+       task(WATCHDOG_NO_TASK),
+       warned(false),
+       nearMissCount(0),
+       nearMissTask(WATCHDOG_NO_TASK),
+       taskStartMs(0),
+       longestTask(WATCHDOG_NO_TASK),
+       longestTaskMs(0)
+ {
+ }
+
+ void WatchdogMonitor::begin()
+ // La SysTick tourne déjà : onTick() reste inerte (active) tant que l'enregistrement est réécrit ici
+ {
+     active = false;
+     uint32_t divider = 4u << hiwdg->Init.Prescaler;
+     stats.timeoutMs = static_cast<uint32_t>(static_cast<uint64_t>(divider) * (hiwdg->Init.Reload + 1u) * 1000u / LSI_MAX_HZ);
+     stats.warningMs = (stats.timeoutMs > warningMarginMs) ? stats.timeoutMs - warningMarginMs : stats.timeoutMs / 2;
+
+     // Enregistrement du démarrage précédent, puis remis à zéro pour celui-ci
+     WatchdogPostMortem* record = watchdogBackupRecord();
+     watchdogReset = watchdogCausedReset();
+     if (record->magic == WATCHDOG_RECORD_MAGIC && record->crc == recordCrc(*record)) previous = *record;
+     else memset(&previous, 0, sizeof(previous));
+
+     uint32_t now = HAL_GetTick();
+     lastRefreshMs = now;
+     taskStartMs = now;
+     saveRecord(now, 0, false);
+     active = true;
+ }
+
+ void WatchdogMonitor::enter(uint8_t next) {
+     uint32_t now = HAL_GetTick();
+     uint32_t elapsed = now - taskStartMs;
+     if (elapsed >= longestTaskMs) {
+         longestTaskMs = elapsed;
+         longestTask = task;
+     }
+     taskStartMs = now;
+     task = next;
+ }
+
+ void WatchdogMonitor::refresh()
+ // Boucle principale : n'écrit jamais l'enregistrement, onTick() le désarme en voyant le nouvel instant
+ {
+     HAL_IWDG_Refresh(hiwdg);
+
+     uint32_t now = HAL_GetTick();
+     uint32_t interval = now - lastRefreshMs;
+     lastIntervalMs = interval;
+     lastRefreshMs = now;
+
+     stats.refreshes++;
+     stats.lastIntervalMs = interval;
+     if (interval >= stats.worstIntervalMs) {
+         enter(task);  // clôt l'étape en cours pour la compter
+         stats.worstIntervalMs = interval;
+         stats.worstTask = longestTask;
+         stats.worstTaskMs = longestTaskMs;
+     }
+     longestTaskMs = 0;
+     longestTask = task;
+     taskStartMs = now;
+
+     stats.nearMisses = nearMissCount;
+     stats.nearMissTask = nearMissTask;
+ }
+
+ void WatchdogMonitor::onTick()
+ // Sous interruption, toutes les millisecondes : une soustraction et une comparaison hors alerte.
+ // Seul écrivain de l'enregistrement : refresh() ne peut pas être interrompu au milieu d'une copie.
+ {
+     if (!active) return;
+     uint32_t now = HAL_GetTick();
+     uint32_t sinceRefresh = now - lastRefreshMs;
+
+     if (sinceRefresh < stats.warningMs) {
+         if (warned) {
+             warned = false;
+             saveRecord(now, lastIntervalMs, false);  // alerte sans reset : l'enregistrement n'est plus "armé"
+         }
+         return;
+     }
+
+     if (!warned) {
+         warned = true;
+         nearMissCount = nearMissCount + 1;
+         nearMissTask = task;
+     }
+     saveRecord(now, sinceRefresh, true);  // tenu à jour jusqu'au rafraîchissement... ou au reset
+ }
+
+ void WatchdogMonitor::saveRecord(uint32_t nowMs, uint32_t sinceRefreshMs, bool armed) {
+     WatchdogPostMortem* record = watchdogBackupRecord();
+     WatchdogPostMortem r;
+     r.magic = WATCHDOG_RECORD_MAGIC;
+     r.uptimeMs = nowMs;
+     r.sinceRefreshMs = sinceRefreshMs;
+     r.worstIntervalMs = stats.worstIntervalMs;
+     r.task = task;
+     r.armed = armed ? 1 : 0;
+     uint32_t misses = nearMissCount;
+     r.nearMisses = static_cast<uint16_t>((misses > 0xFFFFu) ? 0xFFFFu : misses);
+     r.crc = recordCrc(r);
+     *record = r;
+ }
+
+ #ifndef ERGO_HOST
+
+ WatchdogPostMortem* watchdogBackupRecord() {
+     static bool enabled = false;
+     if (!enabled) {
+         __HAL_RCC_PWR_CLK_ENABLE();
+         HAL_PWR_EnableBkUpAccess();
+         __HAL_RCC_BKPSRAM_CLK_ENABLE();
+         enabled = true;
+     }
+     return reinterpret_cast<WatchdogPostMortem*>(BKPSRAM_BASE);
+ }
+
+ bool watchdogCausedReset() {
+     bool iwdg = __HAL_RCC_GET_FLAG(RCC_FLAG_IWDGRST) != RESET;
+     __HAL_RCC_CLEAR_RESET_FLAGS();
+     return iwdg;
+ }
+
+ #else
+
+ // PC : pas de reset réel, l'enregistrement vit le temps du processus (lu par le gestionnaire d'expiration)
+ WatchdogPostMortem* watchdogBackupRecord() {
+     static WatchdogPostMortem record;
+     return &record;
+ }
+
+ bool watchdogCausedReset() {
+     return false;
+ }
+
+ #endif
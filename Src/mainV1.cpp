@@ -22,6 +22,12 @@
 
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include <cstdio>
+#include "SessionLogger.hpp"
+#include "TelemetryStream.hpp"
+#include "LoopProfiler.hpp"
+#include "WatchdogMonitor.hpp"
+#include "DrivetrainParams.hpp"
 
 /* USER CODE END Includes */
 
@@ -37,6 +43,8 @@
 
 /* Private macro -------------------------------------------------------------*/
 /* USER CODE BEGIN PM */
+// Début d'une étape de la boucle : tâche courante pour le moniteur du watchdog, et zone de profilage
+#define LOOP_STAGE_BEGIN(zone) (watchdogMonitor.enter(zone), PROFILE_BEGIN(zone))
 
 /* USER CODE END PM */
 
@@ -53,11 +61,24 @@ UART_HandleTypeDef huart2;
 UART_HandleTypeDef huart3;
 
 /* USER CODE BEGIN PV */
-// Pointeur vers le contrôleur moteur
-MotorController* motor = nullptr;
-
-// Constante de couple initiale
-float initialTorqueConstant = 0.05f;
+// USART1 n'est pas activé dans le .ioc : handle, init, MSP et IRQ vivent ici pour survivre à la régénération
+UART_HandleTypeDef huart1;
+
+// Constante de couple initiale (si aucune calibration n'est en flash)
+const float initialTorqueConstant = 0.05f;
+
+// Graphe d'objets statique : construit avant main(), dans l'ordre de déclaration, sans tas.
+// Les constructeurs ne font que mémoriser les handles UART ; les périphériques sont initialisés dans main().
+Stm32FlashStorage flashStorage;                                   // secteurs flash 10 et 11
+SettingsStore settings(flashStorage);                             // réglages persistants
+MotorController motor(&huart3, &huart2, initialTorqueConstant);  // USART3 = VESC, USART2 = Ecran
+TelemetryBuffer telemetry;                                        // un échantillon par tick, vidé hors boucle de commande
+UsbLogStorage logStorage;                                         // ERGO.LOG sur la clé USB (USB Host MSC)
+SessionLogger sessionLog(logStorage, telemetry);                  // 2 blocs de 4 Ko, écrits entre deux ticks
+TelemetryBuffer streamTelemetry;                                  // seconde file : un lecteur par file
+UartTelemetryLink telemetryLink(&huart1);                         // USART1 (PA9/PA10) = télémétrie PC
+TelemetryStream telemetryStream(telemetryLink, streamTelemetry);  // trames COBS, décimation réglable depuis le PC
+WatchdogMonitor watchdogMonitor(&hiwdg, 2000);                    // alerte à 2 s de l'expiration, post-mortem en BKPSRAM
 
 /* USER CODE END PV */
 
@@ -73,6 +94,7 @@ static void MX_USART3_UART_Init(void);
 void MX_USB_HOST_Process(void);
 
 /* USER CODE BEGIN PFP */
+static void Telemetry_UART_Init(void);
 
 /* USER CODE END PFP */
 
@@ -118,17 +140,44 @@ int main(void)
   MX_USART2_UART_Init();
   MX_USART3_UART_Init();
   /* USER CODE BEGIN 2 */
-  HAL_IWDG_Refresh(&hiwdg);
-
-  //Création du contrôleur moteur : USART3 = VESC, USART2 = Ecran
-  motor = new MotorController(&huart3, &huart2, initialTorqueConstant);
-  motor->calibrateTorqueConstant();
-  HAL_Delay(500);
+  Telemetry_UART_Init();    // USART1 (télémétrie PC), hors CubeMX : voir USER CODE 4
+  watchdogMonitor.begin();  // relit le post-mortem du démarrage précédent avant de l'écraser
+  watchdogMonitor.enter(PROFILE_STARTUP);
+  PROFILE_INIT();  // compteur de cycles DWT (build avec -DERGO_PROFILE, sinon rien)
+
+  // Le contrôleur moteur est un objet statique (voir PV) : rien à allouer ici
+  settings.mount();
+  motor.attachSettings(&settings);
+  motor.attachTelemetry(&telemetry);
+  motor.attachTelemetry(&streamTelemetry);
+  telemetryLink.start();
+  telemetryStream.attachWatchdog(&watchdogMonitor);
+
+  // Une séance par démarrage : numéro persistant pour distinguer les séances dans ERGO.LOG
+  uint32_t sessionId = static_cast<uint32_t>(settings.getInt(SettingKey::SESSION_COUNT, 0)) + 1;
+  settings.setInt(SettingKey::SESSION_COUNT, static_cast<int32_t>(sessionId));
+  sessionLog.attachAnalytics(&motor.getAnalytics());  // bilan de séance en fin de chaque bloc
+  sessionLog.start(sessionId);
+
+  // Calibration valide en flash → démarrage immédiat, sinon on calibre
+  if (!motor.loadSettings()) {
+    motor.calibrateTorqueConstant();  // non bloquant : les paliers avancent dans motor.update()
+    HAL_Delay(500);
+  }
 
   // Afficher les valeurs initiales
-  motor->updateScreen();  
+  motor.updateScreen();  
   HAL_Delay(100);
-  motor->getScreen()->showWelcome();
+  motor.getScreen().showWelcome();
+
+  // Redémarrage par le watchdog : étape fautive (post-mortem armé) ou interruptions masquées
+  if (watchdogMonitor.hadWatchdogReset()) {
+    const WatchdogPostMortem& reset = watchdogMonitor.getPreviousReset();
+    char message[48];
+    if (reset.armed) snprintf(message, sizeof(message), "Reset IWDG : %s", profileZoneName(reset.task));
+    else snprintf(message, sizeof(message), "Reset IWDG : IRQ masquees");
+    motor.getScreen().showError(message);
+  }
 
   /* USER CODE END 2 */
 
@@ -136,26 +185,71 @@ int main(void)
   /* USER CODE BEGIN WHILE */
   while (1)
   {
-	  HAL_IWDG_Refresh(&hiwdg);  // Rafraîchit le Watchdog
+    watchdogMonitor.refresh();  // Rafraîchit le Watchdog et mesure l'intervalle depuis le précédent
+    PROFILE_BEGIN(PROFILE_LOOP);
 
     // Met à jour les paramètres utilisateur (mode, direction, stop, etc.)
-    motor->updateFromScreen();
-
-    // Lecture de la cadence actuelle (depuis VESC)
-    float cadence = motor->getCadence();
+    LOOP_STAGE_BEGIN(PROFILE_UPDATE_FROM_SCREEN);
+    motor.updateFromScreen();
+    PROFILE_END(PROFILE_UPDATE_FROM_SCREEN);
+
+    // Une seule lecture VESC par tick, filtrée et partagée par la commande et l'affichage
+    LOOP_STAGE_BEGIN(PROFILE_SAMPLE_TELEMETRY);
+    motor.sampleTelemetry();
+    PROFILE_END(PROFILE_SAMPLE_TELEMETRY);
+
+    // Lecture de la cadence actuelle (cadence pédalier filtrée)
+    LOOP_STAGE_BEGIN(PROFILE_GET_CADENCE);
+    float cadence = motor.getCadence();
+    PROFILE_END(PROFILE_GET_CADENCE);
+
+#ifdef ERGO_RESPONSE_TEST
+    // Firmware de banc : échelons + chirp lancés une fois la calibration finie, lus dans ERGO.LOG par ergo_response
+    static bool responseTestStarted = false;
+    if (!responseTestStarted && !motor.isCalibrating()) responseTestStarted = motor.startResponseTest(defaultResponseTestConfig());
+#endif
 
     // Mise à jour dynamique du moteur (mode LINEAR si actif)
-    motor->update(cadence);
+    LOOP_STAGE_BEGIN(PROFILE_UPDATE);
+    motor.update(cadence);
+    PROFILE_END(PROFILE_UPDATE);
 
     // Affiche les valeurs sur l'écran (couple, duty, etc.)
-    motor->updateScreen();
+    LOOP_STAGE_BEGIN(PROFILE_UPDATE_SCREEN);
+    motor.updateScreen();
+    PROFILE_END(PROFILE_UPDATE_SCREEN);
 
+    PROFILE_END(PROFILE_LOOP);  // hors attente : temps de calcul et d'échanges UART seulement
+    watchdogMonitor.enter(PROFILE_DELAY);
     HAL_Delay(100);  // rafraîchissement toutes les 100 ms
+    LOOP_STAGE_BEGIN(PROFILE_USB_HOST);  // MX_USB_HOST_Process() est hors des sections USER CODE
 
     /* USER CODE END WHILE */
     MX_USB_HOST_Process();
 
     /* USER CODE BEGIN 3 */
+    PROFILE_END(PROFILE_USB_HOST);
+
+    // Modèle de transmission (ERGO.PAR écrit par ergo_sysid) : lu à la première apparition de la clé,
+    // avant que le journal ne monte le volume pour ERGO.LOG
+    static bool drivetrainChecked = false;
+    if (!drivetrainChecked && logStorage.isPresent()) {
+      drivetrainChecked = true;
+      DrivetrainParams drivetrain;
+      if (readDrivetrainParams("ERGO.PAR", drivetrain) && motor.applyDrivetrainParams(drivetrain)) {
+        motor.getScreen().sendText("t0", "Modele ERGO.PAR charge");
+      }
+    }
+
+    // Journal de séance : après la pile USB (état de la clé à jour), hors du tick de commande
+    LOOP_STAGE_BEGIN(PROFILE_SESSION_LOG);
+    sessionLog.service(HAL_GetTick());
+    PROFILE_END(PROFILE_SESSION_LOG);
+
+    // Télémétrie en direct : commandes reçues, trames lancées sous interruption, aucune attente
+    LOOP_STAGE_BEGIN(PROFILE_TELEMETRY_STREAM);
+    telemetryStream.service();
+    PROFILE_END(PROFILE_TELEMETRY_STREAM);
   }
   /* USER CODE END 3 */
 }
@@ -505,6 +599,66 @@ static void MX_GPIO_Init(void)
 }
 
 /* USER CODE BEGIN 4 */
+// USART1 à 921600 bauds sur PA9/PA10 (étiquetées Odrive_TX/Odrive_RX dans le .ioc), interruption globale
+// sans DMA. HAL_UART_MspInit() généré ne connaît que USART2/USART3 : horloges, broches et NVIC sont
+// configurés ici avant HAL_UART_Init(). Si USART1 est un jour activé dans CubeMX, supprimer ce bloc
+// et USART1_IRQHandler() (doublons avec stm32f4xx_hal_msp.c et stm32f4xx_it.c).
+static void Telemetry_UART_Init(void)
+{
+  GPIO_InitTypeDef GPIO_InitStruct = {0};
+
+  __HAL_RCC_USART1_CLK_ENABLE();
+  __HAL_RCC_GPIOA_CLK_ENABLE();
+  GPIO_InitStruct.Pin = Odrive_TX_Pin|Odrive_RX_Pin;
+  GPIO_InitStruct.Mode = GPIO_MODE_AF_PP;
+  GPIO_InitStruct.Pull = GPIO_NOPULL;
+  GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+  GPIO_InitStruct.Alternate = GPIO_AF7_USART1;
+  HAL_GPIO_Init(Odrive_TX_GPIO_Port, &GPIO_InitStruct);
+
+  huart1.Instance = USART1;
+  huart1.Init.BaudRate = 921600;
+  huart1.Init.WordLength = UART_WORDLENGTH_8B;
+  huart1.Init.StopBits = UART_STOPBITS_1;
+  huart1.Init.Parity = UART_PARITY_NONE;
+  huart1.Init.Mode = UART_MODE_TX_RX;
+  huart1.Init.HwFlowCtl = UART_HWCONTROL_NONE;
+  huart1.Init.OverSampling = UART_OVERSAMPLING_16;
+  if (HAL_UART_Init(&huart1) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  // Le gestionnaire ne fait que ranger un octet reçu ou enchaîner l'émission : priorité basse
+  HAL_NVIC_SetPriority(USART1_IRQn, 5, 0);
+  HAL_NVIC_EnableIRQ(USART1_IRQn);
+}
+
+// Vecteur de USART1 : non généré dans stm32f4xx_it.c tant que l'interruption n'est pas cochée dans le .ioc
+extern "C" void USART1_IRQHandler(void)
+{
+  HAL_UART_IRQHandler(&huart1);
+}
+
+// Réception des commandes de télémétrie (USART1) ; les autres UART restent en mode bloquant
+void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
+{
+  telemetryLink.onRxComplete(huart);
+}
+
+// Erreurs de réception USART1 : sans ré-armement, un overrun couperait les commandes PC jusqu'au reset
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+  telemetryLink.onError(huart);
+}
+
+// SysTick (1 kHz) : remplace la version faible de la HAL pour surveiller la marge du watchdog
+// pendant les étapes bloquantes de la boucle ; onTick() est le seul écrivain du post-mortem en BKPSRAM
+void HAL_IncTick(void)
+{
+  uwTick += uwTickFreq;
+  watchdogMonitor.onTick();
+}
 
 /* USER CODE END 4 */
 
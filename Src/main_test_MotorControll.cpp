@@ -55,7 +55,8 @@ UART_HandleTypeDef huart2;
 UART_HandleTypeDef huart3;
 
 /* USER CODE BEGIN PV */
-MotorController* motor = nullptr;
+// Contrôleur statique, sans tas : USART3 = ODrive, USART2 = Ecran
+MotorController motor(&huart3, &huart2, 0.45f);  // Kt à ajuster selon ton moteur
 char debugMessage[64];  // Taille à ajuster selon besoin
 volatile int count;
 /* USER CODE END PV */
@@ -77,7 +78,16 @@ void MX_USB_HOST_Process(void);
 
 /* Private user code ---------------------------------------------------------*/
 /* USER CODE BEGIN 0 */
-
+// Boucle de commande pendant durationMs, au rythme du firmware (100 ms) : une trame VESC par tour,
+// sans quoi la cadence filtrée reste invalide et les modes puissance/linéaire ne commandent rien
+static void runControlLoop(uint32_t durationMs)
+{
+  for (uint32_t elapsed = 0; elapsed < durationMs; elapsed += 100) {
+    motor.sampleTelemetry();
+    motor.update(motor.getCadence());  // aussi sans télémétrie : le superviseur détecte la perte de liaison
+    HAL_Delay(100);
+  }
+}
 /* USER CODE END 0 */
 
 /**
@@ -119,63 +129,59 @@ int main(void)
   /* USER CODE BEGIN 2 */
   //HAL_IWDG_Refresh(&hiwdg);
 
-   // Création du contrôleur moteur : USART3 = ODrive, USART2 = Ecran
-   float torqueConstant = 0.45f; // Ajuste selon ton moteur
-   motor = new MotorController(&huart3, &huart2, torqueConstant);
-   motor->calibrateTorqueConstant();
+   // Calibration non bloquante : on fait tourner la boucle jusqu'à la fin des paliers (20 s au plus),
+   // sinon le stop() du test 1 l'interromprait aussitôt
+   motor.calibrateTorqueConstant();
+   for (uint32_t elapsed = 0; motor.isCalibrating() && elapsed < 20000; elapsed += 100) {
+     runControlLoop(100);
+   }
 
    // Direction par défaut
-   motor->setDirection(DirectionMode::FORWARD);
+   motor.setDirection(DirectionMode::FORWARD);
    // --- Test 1 : Cadence control ---
-	 motor->stop();  // Reset speed
-	 motor->setControlMode(ControlMode::CADENCE);
-	 motor->setInstruction(60.0f);  // 60 tr/min
+	 motor.stop();  // Reset speed
+	 motor.setControlMode(ControlMode::CADENCE);
+	 motor.setInstruction(60.0f);  // 60 tr/min
 	 snprintf(debugMessage, sizeof(debugMessage), "Mode: Cadence");
-	 HAL_Delay(500);
+	 runControlLoop(500);
 	 count=1;
 
 	 // --- Test 2 : Torque control ---
-	 motor->setControlMode(ControlMode::TORQUE);
-	 motor->setInstruction(2.0f);  // 2 Nm
+	 motor.setControlMode(ControlMode::TORQUE);
+	 motor.setInstruction(2.0f);  // 2 Nm
 
 	 snprintf(debugMessage, sizeof(debugMessage), "Mode: Torque");
-	 HAL_Delay(500);
+	 runControlLoop(500);
 	 count=2;
 
 	 // --- Test 3 : Power concentrique ---
-	 motor->setControlMode(ControlMode::POWER_CONCENTRIC);
-	 motor->setInstruction(100.0f);  // 100 W
+	 motor.setControlMode(ControlMode::POWER_CONCENTRIC);
+	 motor.setInstruction(100.0f);  // 100 W
 
 	 snprintf(debugMessage, sizeof(debugMessage), "Mode: Powerr");
-	 HAL_Delay(500);
+	 runControlLoop(500);
 	 count=3;
 
 	 // --- Test 4 : Power excentrique ---
-	 motor->setControlMode(ControlMode::POWER_ECCENTRIC);
-	 motor->setInstruction(100.0f);  // 100 W
+	 motor.setControlMode(ControlMode::POWER_ECCENTRIC);
+	 motor.setInstruction(100.0f);  // 100 W
 
 	 snprintf(debugMessage, sizeof(debugMessage), "Mode: Power");
-	 HAL_Delay(500);
+	 runControlLoop(500);
 	 count=4;
 
 	 // --- Test 5 : Linear mode ---
-	 motor->setControlMode(ControlMode::LINEAR);
-	 motor->setInstruction(0.05f);  // 0.05 Nm/tr/min
+	 motor.setControlMode(ControlMode::LINEAR);
+	 motor.setInstruction(0.05f);  // 0.05 Nm/tr/min
 
 	 snprintf(debugMessage, sizeof(debugMessage), "Mode: Linear");
 
 	 // Mise à jour en boucle pendant quelques secondes
-	 for (int i = 0; i < 25; i++) {
-		 float cadence = motor->getCadence();
-		 if (cadence >= 0.0f) {
-			 motor->update(cadence);
-		 }
-		 HAL_Delay(20);
-	 }
+	 runControlLoop(2500);
 	 count=5;
 
 	 // --- Fin du test : arrêt du moteur ---
-	 motor->stop();  // Stop
+	 motor.stop();  // Stop
 
 	 snprintf(debugMessage, sizeof(debugMessage), "Test terminé");
 